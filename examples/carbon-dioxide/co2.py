@@ -3,11 +3,13 @@
 import vfl
 
 # load the input dataset.
-dat = vfl.Data(file = 'co2.dat')
+raw = vfl.Data(file = 'co2.dat')
 
-# shift the data locations for simpler inference.
-for d in dat:
-  d[0] -= 1995
+# shift the data locations for simpler inference. dataset entries
+# are copies, so the shifted data are built into a new dataset.
+x = memoryview(raw.x).tolist()
+y = memoryview(raw.y).tolist()
+dat = vfl.Data(x = [[xi[0] - 1995] for xi in x], y = y)
 
 # create a model without an explicit linear trend.
 mdl = {}
@@ -54,16 +56,14 @@ for b in mdl:
   opt.model = mdl[b]
   opt.execute()
 
-  # build the output datasets.
-  mean = vfl.Data(grid = G)
-  var = vfl.Data(grid = G)
+  # compute the model prediction over the grid.
+  x = memoryview(vfl.Data(grid = G).x).tolist()
+  mu, eta = mdl[b].predict(x = x)
 
-  # compute the model prediction.
-  mdl[b].predict(mean = mean, var = var)
-
-  # shift the predictions back to the original data locations.
-  for d in mean: d[0] += 1995
-  for d in var:  d[0] += 1995
+  # build the output datasets at the original data locations.
+  xout = [[xi[0] + 1995] for xi in x]
+  mean = vfl.Data(x = xout, y = mu)
+  var = vfl.Data(x = xout, y = eta)
 
   # write the prediction results.
   mean.write(file = 'mean-{}.out'.format(S[b]))
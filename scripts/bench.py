@@ -0,0 +1,374 @@
+#!/usr/bin/env python3
+
+# benchmark suite for vfl: times the per-observation factor functions,
+# inference, optimization, prediction and search over synthetic
+# workloads that scale the number of observations (N), dimensions (D),
+# factors (M), weights per factor (K) and factor mix, and over the
+# datasets of the shipped examples. results are written as json, and
+# may be compared against a saved baseline:
+#
+#   python3 scripts/bench.py -o base.json
+#   python3 scripts/bench.py --compare base.json
+#   python3 scripts/bench.py --compare base.json --results new.json
+
+import argparse, fnmatch, json, os, platform, random
+import statistics, sys, tempfile, time
+from math import sin
+
+# locate the repository root, and prefer an in-place build of vfl.
+root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.insert(0, root)
+
+# factor functions timed by vfl.bench_factor().
+factor_ops = ['mean', 'var', 'cov', 'diff_mean', 'diff_var',
+              'mean_all', 'var_all']
+
+# model operations timed by bench_model().
+model_ops = ['infer', 'update', 'bound', 'FullGradient', 'MeanField',
+             'predict', 'search']
+
+# sizes of the synthetic workloads, in full and quick mode.
+sizes = {
+  False: {'N': [1000, 4000, 16000], 'D': [1, 2, 4], 'M': [5, 10, 20],
+          'K': [1, 4, 8], 'base': (4000, 2, 10), 'factorN': 20000,
+          'iters': 5, 'search': 400, 'grid': 2000},
+  True:  {'N': [500, 2000], 'D': [1, 2], 'M': [5, 10],
+          'K': [1, 4], 'base': (1000, 2, 5), 'factorN': 2000,
+          'iters': 2, 'search': 100, 'grid': 500}
+}
+
+# shipped examples used as fixtures: data file, model builder,
+# optimizer settings, prediction grid and whether to search it. the
+# carbon dioxide and decay models have numerically singular gaussian
+# process covariances, and are not searched.
+def ripley(dat, rnd):
+  return vfl.model.VFC(
+    nu = 1e-6, data = dat,
+    factors = [vfl.factor.Impulse(dim = 0, mu = rnd.gauss(-0.25, 0.5),
+                                  tau = 10) *
+               vfl.factor.Impulse(dim = 1, mu = rnd.gauss(0.45, 0.5),
+                                  tau = 10)
+               for i in range(10)])
+
+def co2(dat, rnd):
+  x = memoryview(dat.x).tolist()
+  y = memoryview(dat.y).tolist()
+  dat = vfl.Data(x = [[xi[0] - 1995] for xi in x], y = y)
+  return vfl.model.VFR(
+    alpha0 = 100, beta0 = 1, nu = 1e-6, data = dat,
+    factors = [vfl.factor.Polynomial(order = 1)] +
+              [vfl.factor.Cosine(mu = mu, tau = tau) for mu, tau in
+               [(1e-3, 1e4), (1e-2, 100), (1e-1, 100), (5, 1), (10, 1)]])
+
+def multexp(dat, rnd):
+  return vfl.model.VFR(
+    alpha0 = 10, beta0 = 40, nu = 1e-3, data = dat,
+    factors = [vfl.factor.Decay(alpha = 10, beta = 10 ** i)
+               for i in range(5)])
+
+def sinc(dat, rnd):
+  return vfl.model.VFR(
+    alpha0 = 1000, beta0 = 2.5, nu = 1e-3, data = dat,
+    factors = [vfl.factor.Impulse(mu = rnd.gauss(0, 2.5), tau = 0.01)
+               for i in range(10)])
+
+fixtures = {
+  'ripley':  ('ripley/ripley.dat', ripley, 1e-3,
+              [[-1.5, 0.01, 1.0], [-0.3, 0.02, 1.2]], False),
+  'co2':     ('carbon-dioxide/co2.dat', co2, 1e-4, [[-25, 1e-2, 75]],
+              False),
+  'multexp': ('multexp/multexp.dat', multexp, 1e-3, [[0, 0.1, 150]],
+              False),
+  'sinc':    ('sinc/sinc.dat', sinc, 1e-4, [[-10, 1e-3, 10]], True)
+}
+
+# synth(): build a synthetic regression dataset of N observations
+# in D dimensions.
+def synth(N, D, rnd):
+  fd, fname = tempfile.mkstemp(suffix = '.dat')
+  with os.fdopen(fd, 'w') as fh:
+    fh.write('# {} {}\n'.format(N, D))
+    for i in range(N):
+      x = [rnd.uniform(-1, 1) for d in range(D)]
+      y = sum(sin(3 * xd) for xd in x) + rnd.gauss(0, 0.1)
+      fh.write('0 ' + ' '.join('{:.9e}'.format(v) for v in x + [y]) + '\n')
+
+  dat = vfl.Data(file = fname)
+  os.remove(fname)
+  return dat
+
+# factor(): build a factor of a given kind over D dimensions, using a
+# product of one-dimensional factors when D exceeds one.
+def factor(kind, D, K, rnd):
+  def one(d):
+    if kind == 'impulse':
+      return vfl.factor.Impulse(dim = d, mu = rnd.uniform(-1, 1), tau = 10)
+    if kind == 'cosine':
+      return vfl.factor.Cosine(dim = d, mu = rnd.uniform(0, 3), tau = 1)
+    if kind == 'decay':
+      return vfl.factor.Decay(dim = d, alpha = 2, beta = 10)
+    if kind == 'polynomial':
+      return vfl.factor.Polynomial(dim = d, order = K - 1)
+
+  if kind == 'mixed':
+    kind = ['impulse', 'cosine', 'decay'][rnd.randrange(3)]
+
+  f = one(0)
+  for d in range(1, D):
+    f = f * one(d)
+
+  if D > 1:
+    f.update()
+
+  return f
+
+# Bench: accumulator of timed results.
+class Bench:
+  def __init__(self, repeat, pattern):
+    self.repeat = repeat
+    self.pattern = pattern
+    self.results = []
+
+  # wanted(): check whether a named benchmark should run.
+  def wanted(self, name):
+    return fnmatch.fnmatch(name, self.pattern)
+
+  # wanted_model(): check whether any operation of a model should run.
+  def wanted_model(self, prefix):
+    return any(self.wanted(prefix + '/' + op) for op in model_ops)
+
+  # run(): time a function that returns (seconds, evaluations) or
+  # None, in which case the wall time of the call is used.
+  def run(self, name, fn, **params):
+    if not self.wanted(name):
+      return
+
+    secs, evals = [], 1
+    try:
+      for r in range(self.repeat):
+        t0 = time.perf_counter()
+        res = fn()
+        t = time.perf_counter() - t0
+        if res is not None:
+          t, evals = res
+        secs.append(t)
+
+    except RuntimeError as err:
+      print('{:48s} skipped ({})'.format(name, err), file = sys.stderr)
+      return
+
+    med = statistics.median(secs)
+    self.results.append({
+      'name': name, 'params': params, 'evals': evals,
+      'seconds': med, 'min': min(secs), 'per_eval': med / max(evals, 1)
+    })
+
+    print('{:48s} {:12.6f} s {:12.3f} ns/eval'.format(
+          name, med, 1e9 * med / max(evals, 1)), file = sys.stderr)
+
+# bench_factors(): time each factor function of each factor kind.
+def bench_factors(B, sz, rnd):
+  N = sz['factorN']
+  dat = synth(N, 2, rnd)
+  for kind in ['impulse', 'cosine', 'decay', 'polynomial']:
+    for D in [1, 2]:
+      f = factor(kind, D, 4, rnd)
+      for op in factor_ops:
+        name = 'factor/{}/D{}/{}'.format(kind, D, op)
+        B.run(name, lambda: vfl.bench_factor(f, dat, op), N = N, D = D)
+
+# bench_model(): time inference, updates, optimizer iterations,
+# prediction and search on a single model.
+def bench_model(B, prefix, mdl, grid, sz, lipschitz = None, search = True,
+                **params):
+  mdl.infer()
+  B.run(prefix + '/infer', lambda: vfl.bench_model(mdl, 'infer'), **params)
+  B.run(prefix + '/update', lambda: vfl.bench_model(mdl, 'update'),
+        **params)
+  B.run(prefix + '/bound', lambda: vfl.bench_model(mdl, 'bound', 10),
+        **params)
+
+  # time optimizer iterations on copies of the model.
+  for kind in ['FullGradient', 'MeanField']:
+    name = '{}/{}'.format(prefix, kind)
+    if not B.wanted(name):
+      continue
+
+    def iterate():
+      m = type(mdl).frombytes(mdl.tobytes())
+      m.data = mdl.data
+      m.infer()
+      opt = getattr(vfl.optim, kind)(model = m)
+      if lipschitz is not None and kind == 'FullGradient':
+        opt.lipschitz_init = lipschitz
+
+      t0 = time.perf_counter()
+      for i in range(sz['iters']):
+        opt.iterate()
+
+      return (time.perf_counter() - t0, sz['iters'])
+
+    B.run(name, iterate, **params)
+
+  # time prediction over the grid.
+  mean = vfl.Data(grid = grid)
+  var = vfl.Data(grid = grid)
+  B.run(prefix + '/predict', lambda: mdl.predict(mean = mean, var = var),
+        G = len(mean), **params)
+
+  # time a function-space search over a subset of the observations.
+  if not search or not B.wanted(prefix + '/search'):
+    return
+
+  dat = vfl.Data()
+  n = min(sz['search'], len(mdl.data))
+  for i in range(n):
+    dat.augment(datum = mdl.data[i * len(mdl.data) // n])
+
+  def execute():
+    S = vfl.Search(model = mdl, data = dat, grid = grid, outputs = 1)
+    S.execute()
+
+  B.run(prefix + '/search', execute, n = n, G = len(mean), **params)
+
+# bench_scaling(): sweep each size of the synthetic workload around a
+# base point.
+def bench_scaling(B, sz, rnd):
+  N0, D0, M0 = sz['base']
+  points = [('N', N, D0, M0, 1, 'impulse') for N in sz['N']]
+  points += [('D', N0, D, M0, 1, 'impulse') for D in sz['D']]
+  points += [('M', N0, D0, M, 1, 'impulse') for M in sz['M']]
+  points += [('K', N0, 1, M0, K, 'polynomial') for K in sz['K']]
+  points += [('mix', N0, D0, M0, 1, mix)
+             for mix in ['impulse', 'cosine', 'decay', 'mixed']]
+
+  for axis, N, D, M, K, mix in points:
+    prefix = 'scale/{}/N{}-D{}-M{}-K{}-{}'.format(axis, N, D, M, K, mix)
+    if not B.wanted_model(prefix):
+      continue
+
+    dat = synth(N, D, rnd)
+    mdl = vfl.model.VFR(alpha0 = 1000, beta0 = 1, nu = 1e-3, data = dat,
+                        factors = [factor(mix, D, K, rnd)
+                                   for j in range(M)])
+
+    G = int(round(sz['grid'] ** (1 / D)))
+    grid = [[-1, 2 / max(G - 1, 1), 1] for d in range(D)]
+    bench_model(B, prefix, mdl, grid, sz, lipschitz = 1e-3,
+                search = (D <= 2), N = N, D = D, M = M, K = K, mix = mix)
+
+# bench_fixtures(): time each shipped example.
+def bench_fixtures(B, sz, rnd):
+  for name, (fname, build, lipschitz, grid, search) in fixtures.items():
+    prefix = 'example/' + name
+    if not B.wanted_model(prefix):
+      continue
+
+    dat = vfl.Data(file = os.path.join(root, 'examples', fname))
+    mdl = build(dat, rnd)
+    bench_model(B, prefix, mdl, grid, sz, lipschitz = lipschitz,
+                search = search,
+                N = len(dat))
+
+# compare(): compare results against a baseline, returning the number
+# of regressions beyond the threshold.
+def compare(base, new, threshold):
+  old = {r['name']: r for r in base['results']}
+  regress = 0
+  print('{:48s} {:>12s} {:>12s} {:>8s}'.format(
+        'benchmark', 'base (s)', 'new (s)', 'ratio'))
+
+  for r in new['results']:
+    if r['name'] not in old:
+      continue
+
+    b = old[r['name']]['per_eval']
+    ratio = r['per_eval'] / b if b > 0 else float('inf')
+    flag = ''
+    if ratio > 1 + threshold:
+      flag = '  SLOWER'
+      regress += 1
+    elif ratio < 1 / (1 + threshold):
+      flag = '  faster'
+
+    print('{:48s} {:12.6f} {:12.6f} {:8.3f}{}'.format(
+          r['name'], old[r['name']]['seconds'], r['seconds'], ratio, flag))
+
+  missing = sorted(set(old) - set(r['name'] for r in new['results']))
+  for name in missing:
+    print('{:48s} missing from new results'.format(name))
+
+  return regress
+
+# main(): parse the arguments and run the suite.
+def main():
+  p = argparse.ArgumentParser(description = 'vfl benchmark suite')
+  p.add_argument('-o', '--output', help = 'write results to a json file')
+  p.add_argument('--quick', action = 'store_true',
+                 help = 'run reduced workloads')
+  p.add_argument('--repeat', type = int, default = 3,
+                 help = 'timed repetitions of each benchmark')
+  p.add_argument('--only', default = '*',
+                 help = 'glob pattern of benchmark names to run')
+  p.add_argument('--seed', type = int, default = 1)
+  p.add_argument('--compare', metavar = 'BASE',
+                 help = 'compare results against a baseline json file')
+  p.add_argument('--results', metavar = 'NEW',
+                 help = 'compare a saved results file instead of running')
+  p.add_argument('--threshold', type = float, default = 0.10,
+                 help = 'relative slowdown reported as a regression')
+  args = p.parse_args()
+
+  # load saved results, or run the suite.
+  if args.results:
+    with open(args.results) as fh:
+      out = json.load(fh)
+
+  else:
+    global vfl
+    import vfl
+
+    rnd = random.Random(args.seed)
+    sz = sizes[args.quick]
+    B = Bench(args.repeat, args.only)
+    bench_factors(B, sz, rnd)
+    bench_scaling(B, sz, rnd)
+    bench_fixtures(B, sz, rnd)
+
+    out = {
+      'meta': {
+        'time': time.strftime('%Y-%m-%dT%H:%M:%S'),
+        'host': platform.node(),
+        'machine': platform.machine(),
+        'python': platform.python_version(),
+        'blas': vfl.blas,
+        'threads': vfl.get_threads(),
+        'quick': args.quick,
+        'repeat': args.repeat,
+        'seed': args.seed
+      },
+      'results': B.results
+    }
+
+  # write the results.
+  if args.output:
+    with open(args.output, 'w') as fh:
+      json.dump(out, fh, indent = 1)
+  elif not args.compare:
+    json.dump(out, sys.stdout, indent = 1)
+    print()
+
+  # compare against the baseline.
+  if args.compare:
+    with open(args.compare) as fh:
+      base = json.load(fh)
+
+    n = compare(base, out, args.threshold)
+    if n:
+      print('{} benchmark(s) regressed by more than {:.0f}%'.format(
+            n, 100 * args.threshold))
+      sys.exit(1)
+
+if __name__ == '__main__':
+  main()
+
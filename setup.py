@@ -1,7 +1,8 @@
 
 # import the required functionality.
-from setuptools import setup, Extension
+from setuptools import setup, Extension, Command
 import unittest
+import subprocess
 import os, sys
 
 # initialize the include directories list.
@@ -12,19 +13,73 @@ src = [os.path.join(d, f) for d, base, files in os.walk('src')
        for f in files if f.endswith('.c')]
 
 # initialize the extra compile arguments.
-cflags = ['-std=c99', '-O3', '-Wall']
+cflags = ['-std=c99', '-O3', '-Wall', '-pthread']
 
 # initialize the libraries to link against.
-libs = []
+libs = ['pthread', 'dl']
 
 # initialize the macro definitions.
 defs = []
 
+# option(): check for and remove a build option from the argument list,
+# returning None if absent, True if given alone, or the list of values
+# given as '--name=a,b,...'.
+def option(name):
+  for arg in sys.argv:
+    if arg == name:
+      sys.argv.remove(arg)
+      return True
+    if arg.startswith(name + '='):
+      sys.argv.remove(arg)
+      return [v for v in arg[len(name) + 1:].split(',') if v]
+  return None
+
+# values(): return the libraries or directories of an option, or the
+# default list if the option was given without values.
+def values(opt, default):
+  return default if opt is True else opt
+
 # check if the user specified the use of ATLAS.
-if '--with-atlas' in sys.argv:
+if option('--with-atlas'):
   defs.append(('__VFL_USE_ATLAS', None))
   libs.append('tatlas')
-  sys.argv.remove('--with-atlas')
+
+# check if the user specified the use of OpenBLAS, which also
+# provides the standard LAPACKE interface.
+opt = option('--with-openblas')
+if opt:
+  defs.append(('__VFL_USE_CBLAS', None))
+  defs.append(('__VFL_USE_LAPACKE', None))
+  defs.append(('__VFL_USE_OPENBLAS', None))
+  libs.extend(values(opt, ['openblas']))
+
+# check if the user specified the use of BLIS.
+opt = option('--with-blis')
+if opt:
+  defs.append(('__VFL_USE_CBLAS', None))
+  defs.append(('__VFL_USE_BLIS', None))
+  libs.extend(values(opt, ['blis']))
+
+# check if the user specified the use of any other CBLAS library.
+opt = option('--with-cblas')
+if opt:
+  defs.append(('__VFL_USE_CBLAS', None))
+  libs.extend(values(opt, ['cblas']))
+
+# check if the user specified the use of a LAPACKE library.
+opt = option('--with-lapacke')
+if opt:
+  defs.append(('__VFL_USE_LAPACKE', None))
+  libs.extend(values(opt, ['lapacke']))
+
+# check if the user specified extra header directories, for
+# libraries that install their headers outside the default path.
+opt = option('--blas-include')
+if opt and opt is not True:
+  inc.extend(opt)
+
+# remove duplicate macro definitions.
+defs = list(dict.fromkeys(defs))
 
 # check if the user specified the use of OpenCL.
 if '--with-opencl' in sys.argv:
@@ -42,6 +97,41 @@ vfl_extension = Extension(
   sources = src
 )
 
+# bench: command that builds the extension in place and runs the
+# benchmark suite in scripts/bench.py.
+class bench(Command):
+  description = 'run the benchmark suite'
+  user_options = [
+    ('quick', 'q', 'run reduced problem sizes'),
+    ('output=', 'o', 'write results to a json file'),
+    ('compare=', 'c', 'compare results against a baseline json file')
+  ]
+
+  def initialize_options(self):
+    self.quick = None
+    self.output = None
+    self.compare = None
+
+  def finalize_options(self):
+    pass
+
+  def run(self):
+    # build the extension module in place.
+    self.reinitialize_command('build_ext', inplace = 1)
+    self.run_command('build_ext')
+
+    # build the benchmark arguments.
+    args = [sys.executable, os.path.join('scripts', 'bench.py')]
+    if self.quick:
+      args.append('--quick')
+    if self.output:
+      args.extend(['--output', self.output])
+    if self.compare:
+      args.extend(['--compare', self.compare])
+
+    # run the benchmarks.
+    subprocess.check_call(args)
+
 # run the setup function.
 setup(
   # package name and version.
@@ -84,6 +174,9 @@ setup(
   # project test suite.
   test_suite = 'tests',
 
+  # extra commands.
+  cmdclass = {'bench': bench},
+
   # project package and extension module list.
   ext_modules = [vfl_extension]
 )
@@ -0,0 +1,373 @@
+
+/* include the vfl header. */
+#include <vfl/vfl.h>
+
+/* define documentation strings: */
+
+PyDoc_STRVAR(
+  Array_doc,
+"Array of numbers shared with a vfl object.\n"
+"\n"
+"Arrays support the buffer protocol, so they may be viewed by\n"
+"memoryview() or numpy.asarray() without copying their elements.\n"
+"\n");
+
+PyDoc_STRVAR(
+  Array_getset_shape_doc,
+"Sizes of each array dimension (read-only)\n"
+"\n");
+
+PyDoc_STRVAR(
+  Array_method_tolist_doc,
+"Return the elements of an array as a (nested) list.\n"
+"\n");
+
+/* Array_View(): create an array that views the memory of an object.
+ *
+ * arguments:
+ *  @owner: object holding the viewed memory.
+ *  @count: counter of arrays viewing the owner, or null.
+ *  @data: pointer to the first viewed element.
+ *  @format: buffer format string of the elements.
+ *  @ndim: number of dimensions, one or two.
+ *  @n1: number of rows, or elements if @ndim is one.
+ *  @n2: number of columns, ignored if @ndim is one.
+ *  @readonly: whether the elements may not be modified.
+ *
+ * returns:
+ *  new array object, or null on failure.
+ */
+PyObject*
+Array_View (PyObject *owner, size_t *count, void *data,
+            const char *format, int ndim,
+            size_t n1, size_t n2, int readonly) {
+  /* allocate a new array. */
+  Array *self = (Array*) Array_Type.tp_alloc(&Array_Type, 0);
+  if (!self)
+    return NULL;
+
+  /* determine the element size. */
+  const Py_ssize_t itemsize = (format[0] == ARRAY_DOUBLE[0]
+                               ? sizeof(double) : sizeof(size_t));
+
+  /* store the array layout. */
+  self->data = (char*) data;
+  self->format = format;
+  self->itemsize = itemsize;
+  self->ndim = ndim;
+  self->readonly = readonly;
+  self->shape[0] = (Py_ssize_t) n1;
+  self->shape[1] = (Py_ssize_t) (ndim == 2 ? n2 : 1);
+  self->strides[0] = self->shape[1] * itemsize;
+  self->strides[1] = itemsize;
+  if (ndim == 1)
+    self->strides[0] = itemsize;
+
+  /* take a reference to the owner and register the view. */
+  Py_XINCREF(owner);
+  self->owner = owner;
+  self->count = count;
+  if (count)
+    (*count)++;
+
+  /* return the new array. */
+  return (PyObject*) self;
+}
+
+/* Array_New(): create a one-dimensional array of real numbers that
+ * owns its memory.
+ *
+ * arguments:
+ *  @n: number of array elements.
+ *
+ * returns:
+ *  new array object, or null on failure.
+ */
+PyObject*
+Array_New (size_t n) {
+  /* allocate the array elements. */
+  double *data = malloc((n ? n : 1) * sizeof(double));
+  if (!data)
+    return PyErr_NoMemory();
+
+  /* create the array object. */
+  PyObject *arr = Array_View(NULL, NULL, data, ARRAY_DOUBLE, 1, n, 0, 0);
+  if (!arr)
+    free(data);
+
+  /* return the new array. */
+  return arr;
+}
+
+/* Array_seq_len(): method for getting array lengths.
+ */
+static Py_ssize_t
+Array_seq_len (Array *self) {
+  /* return the size of the leading dimension. */
+  return self->shape[0];
+}
+
+/* Array_seq_get(): method for getting array elements. the rows of
+ * two-dimensional arrays are returned as one-dimensional arrays.
+ */
+static PyObject*
+Array_seq_get (Array *self, Py_ssize_t i) {
+  /* check that the index is in bounds. */
+  if (i < 0 || i >= self->shape[0]) {
+    PyErr_SetNone(PyExc_IndexError);
+    return NULL;
+  }
+
+  /* return rows of two-dimensional arrays as views. */
+  char *ptr = self->data + i * self->strides[0];
+  if (self->ndim == 2)
+    return Array_View((PyObject*) self, NULL, ptr, self->format, 1,
+                      self->shape[1], 0, self->readonly);
+
+  /* return elements of one-dimensional arrays as numbers. */
+  if (self->format[0] == ARRAY_DOUBLE[0])
+    return PyFloat_FromDouble(*(double*) ptr);
+  else
+    return PyLong_FromSize_t(*(size_t*) ptr);
+}
+
+/* Array_seq_set(): method for setting array elements.
+ */
+static int
+Array_seq_set (Array *self, Py_ssize_t i, PyObject *v) {
+  /* check that the index is in bounds. */
+  if (i < 0 || i >= self->shape[0]) {
+    PyErr_SetNone(PyExc_IndexError);
+    return -1;
+  }
+
+  /* check that the element may be modified. */
+  if (!v || self->readonly || self->ndim != 1 ||
+      self->format[0] != ARRAY_DOUBLE[0]) {
+    PyErr_SetString(PyExc_TypeError, "array elements are read-only");
+    return -1;
+  }
+
+  /* get the new value. */
+  const double val = PyFloat_AsDouble(v);
+  if (PyErr_Occurred())
+    return -1;
+
+  /* store the new value and return success. */
+  *(double*) (self->data + i * self->strides[0]) = val;
+  return 0;
+}
+
+/* Array_getbuffer(): buffer export method for arrays.
+ */
+static int
+Array_getbuffer (Array *self, Py_buffer *view, int flags) {
+  /* check that writable requests may be honored. */
+  if ((flags & PyBUF_WRITABLE) && self->readonly) {
+    PyErr_SetString(PyExc_BufferError, "array is read-only");
+    view->obj = NULL;
+    return -1;
+  }
+
+  /* describe the array memory. */
+  view->buf = self->data;
+  view->len = self->shape[0] * (self->ndim == 2 ? self->shape[1] : 1)
+            * self->itemsize;
+  view->itemsize = self->itemsize;
+  view->readonly = self->readonly;
+  view->ndim = self->ndim;
+
+  /* describe the array layout, as requested. arrays are always
+   * stored contiguously in row-major order.
+   */
+  view->format = (flags & PyBUF_FORMAT ? (char*) self->format : NULL);
+  view->shape = (flags & PyBUF_ND ? self->shape : NULL);
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES
+                   ? self->strides : NULL);
+  view->suboffsets = NULL;
+  view->internal = NULL;
+
+  /* hold a reference to the array for the lifetime of the view. */
+  Py_INCREF(self);
+  view->obj = (PyObject*) self;
+
+  /* return success. */
+  return 0;
+}
+
+/* Array_get_shape(): method for getting array shapes.
+ */
+static PyObject*
+Array_get_shape (Array *self) {
+  /* return the shape as a tuple. */
+  if (self->ndim == 2)
+    return Py_BuildValue("(nn)", self->shape[0], self->shape[1]);
+
+  return Py_BuildValue("(n)", self->shape[0]);
+}
+
+/* Array_method_tolist(): return the elements of an array as a list.
+ */
+static PyObject*
+Array_method_tolist (Array *self) {
+  /* allocate a new list of the appropriate size. */
+  PyObject *lst = PyList_New(self->shape[0]);
+  if (!lst)
+    return NULL;
+
+  /* fill the list with elements or lists of elements. */
+  for (Py_ssize_t i = 0; i < self->shape[0]; i++) {
+    /* get the current element. */
+    PyObject *item = Array_seq_get(self, i);
+    if (item && self->ndim == 2) {
+      PyObject *row = Array_method_tolist((Array*) item);
+      Py_DECREF(item);
+      item = row;
+    }
+
+    /* check for failures. */
+    if (!item) {
+      Py_DECREF(lst);
+      return NULL;
+    }
+
+    /* store the element into the list. */
+    PyList_SET_ITEM(lst, i, item);
+  }
+
+  /* return the created list. */
+  return lst;
+}
+
+/* --- */
+
+/* Array_dealloc(): deallocation method for arrays.
+ */
+static void
+Array_dealloc (Array *self) {
+  /* release the owner, or the owned memory. */
+  if (self->owner) {
+    if (self->count)
+      (*self->count)--;
+
+    Py_DECREF(self->owner);
+  }
+  else
+    free(self->data);
+
+  /* release the object memory. */
+  Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/* Array_repr(): representation method for arrays.
+ */
+static PyObject*
+Array_repr (Array *self) {
+  /* build and return the representation string. */
+  return PyUnicode_FromFormat("<vfl.Array at %p>", self);
+}
+
+/* Array_sequence: sequence definition structure for arrays.
+ */
+static PySequenceMethods Array_sequence = {
+  (lenfunc) Array_seq_len,                       /* sq_length         */
+  NULL,                                          /* sq_concat         */
+  NULL,                                          /* sq_repeat         */
+  (ssizeargfunc) Array_seq_get,                  /* sq_item           */
+  NULL,
+  (ssizeobjargproc) Array_seq_set,               /* sq_ass_item       */
+  NULL,
+  NULL,                                          /* sq_contains       */
+  NULL,                                          /* sq_inplace_concat */
+  NULL                                           /* sq_inplace_repeat */
+};
+
+/* Array_buffer: buffer definition structure for arrays.
+ */
+static PyBufferProcs Array_buffer = {
+  (getbufferproc) Array_getbuffer,               /* bf_getbuffer      */
+  NULL                                           /* bf_releasebuffer  */
+};
+
+/* Array_getset: property definition structure for arrays.
+ */
+static PyGetSetDef Array_getset[] = {
+  { "shape",
+    (getter) Array_get_shape,
+    NULL,
+    Array_getset_shape_doc,
+    NULL
+  },
+  { NULL }
+};
+
+/* Array_methods: method definition structure for arrays.
+ */
+static PyMethodDef Array_methods[] = {
+  { "tolist",
+    (PyCFunction) Array_method_tolist,
+    METH_NOARGS,
+    Array_method_tolist_doc
+  },
+  { NULL }
+};
+
+/* Array_Type: type definition structure for arrays.
+ */
+PyTypeObject Array_Type = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "vfl.Array",                                   /* tp_name           */
+  sizeof(Array),                                 /* tp_basicsize      */
+  0,                                             /* tp_itemsize       */
+  (destructor) Array_dealloc,                    /* tp_dealloc        */
+  0,                                             /* tp_print          */
+  0,                                             /* tp_getattr        */
+  0,                                             /* tp_setattr        */
+  0,                                             /* tp_reserved       */
+  (reprfunc) Array_repr,                         /* tp_repr           */
+  0,                                             /* tp_as_number      */
+  &Array_sequence,                               /* tp_as_sequence    */
+  0,                                             /* tp_as_mapping     */
+  0,                                             /* tp_hash           */
+  0,                                             /* tp_call           */
+  (reprfunc) Array_repr,                         /* tp_str            */
+  0,                                             /* tp_getattro       */
+  0,                                             /* tp_setattro       */
+  &Array_buffer,                                 /* tp_as_buffer      */
+  Py_TPFLAGS_DEFAULT,                            /* tp_flags          */
+  Array_doc,                                     /* tp_doc            */
+  0,                                             /* tp_traverse       */
+  0,                                             /* tp_clear          */
+  0,                                             /* tp_richcompare    */
+  0,                                             /* tp_weaklistoffset */
+  0,                                             /* tp_iter           */
+  0,                                             /* tp_iternext       */
+  Array_methods,                                 /* tp_methods        */
+  0,                                             /* tp_members        */
+  Array_getset,                                  /* tp_getset         */
+  0,                                             /* tp_base           */
+  0,                                             /* tp_dict           */
+  0,                                             /* tp_descr_get      */
+  0,                                             /* tp_descr_set      */
+  0,                                             /* tp_dictoffset     */
+  0,                                             /* tp_init           */
+  0,                                             /* tp_alloc          */
+  0                                              /* tp_new            */
+};
+
+/* Array_Type_init(): type initialization function for arrays.
+ */
+int
+Array_Type_init (PyObject *mod) {
+  /* finalize the type object. */
+  if (PyType_Ready(&Array_Type) < 0)
+    return -1;
+
+  /* take a reference to the type and add it to the module. */
+  Py_INCREF(&Array_Type);
+  PyModule_AddObject(mod, "Array", (PyObject*) &Array_Type);
+
+  /* return success. */
+  return 0;
+}
+
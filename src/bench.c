@@ -0,0 +1,203 @@
+
+/* include the vfl header. */
+#include <vfl/vfl.h>
+
+/* include the posix clock header. */
+#include <time.h>
+
+/* bench_sink: destination of benchmarked results, which ensures that
+ * the timed computations are not optimized away.
+ */
+static volatile double bench_sink;
+
+/* bench_clock(): read a monotonic clock.
+ *
+ * returns:
+ *  current clock value, in seconds.
+ */
+double bench_clock (void) {
+  /* read and convert the clock value. */
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec;
+}
+
+/* bench_factor_pass(): evaluate a factor function once over each
+ * observation of a dataset.
+ *
+ * arguments:
+ *  @f: factor structure pointer to access.
+ *  @dat: dataset of observations.
+ *  @op: factor function to evaluate.
+ *  @v: temporary vector of at least max(N, P) elements.
+ *
+ * returns:
+ *  number of function evaluations, or zero on failure.
+ */
+static size_t bench_factor_pass (const Factor *f, const Data *dat,
+                                 BenchFactorOp op, Vector *v) {
+  /* initialize the result accumulator and evaluation count. */
+  const size_t N = dat->N, K = f->K;
+  VectorView df = vector_subvector(v, 0, f->P);
+  VectorView phi = vector_subvector(v, 0, N);
+  double sum = 0.0;
+  size_t evals = 0;
+
+  /* evaluate the dataset-wide functions. */
+  if (op == BENCH_MEAN_ALL || op == BENCH_VAR_ALL) {
+    for (size_t i = 0; i < K; i++) {
+      for (size_t j = (op == BENCH_VAR_ALL ? i : K - 1); j < K; j++) {
+        const int ok = (op == BENCH_MEAN_ALL
+                        ? factor_mean_all(f, dat, i, &phi)
+                        : factor_var_all(f, dat, i, j, &phi));
+        if (!ok)
+          return 0;
+
+        sum += vector_get(&phi, N - 1);
+        evals += N;
+      }
+    }
+
+    bench_sink = sum;
+    return evals;
+  }
+
+  /* evaluate the per-observation functions. */
+  for (size_t n = 0; n < N; n++) {
+    VectorView x = data_x(dat, n);
+    const size_t p = dat->p[n];
+
+    /* the covariance pairs each observation with the next. */
+    if (op == BENCH_COV) {
+      VectorView x2 = data_x(dat, (n + 1) % N);
+      sum += factor_cov(f, &x, &x2, p, dat->p[(n + 1) % N]);
+      evals++;
+      continue;
+    }
+
+    /* the remaining functions loop over the basis elements. */
+    for (size_t i = 0; i < K; i++) {
+      if (op == BENCH_MEAN) {
+        sum += factor_mean(f, &x, p, i);
+        evals++;
+      }
+      else if (op == BENCH_DIFF_MEAN) {
+        if (!factor_diff_mean(f, &x, p, i, &df))
+          return 0;
+
+        sum += (f->P ? vector_get(&df, 0) : 0.0);
+        evals++;
+      }
+      else {
+        for (size_t j = i; j < K; j++) {
+          if (op == BENCH_VAR)
+            sum += factor_var(f, &x, p, i, j);
+          else if (!factor_diff_var(f, &x, p, i, j, &df))
+            return 0;
+          else
+            sum += (f->P ? vector_get(&df, 0) : 0.0);
+
+          evals++;
+        }
+      }
+    }
+  }
+
+  /* store the result and return the evaluation count. */
+  bench_sink = sum;
+  return evals;
+}
+
+/* bench_factor(): time repeated evaluations of a factor function over
+ * the observations of a dataset.
+ *
+ * arguments:
+ *  @f: factor structure pointer to access.
+ *  @dat: dataset of observations.
+ *  @op: factor function to evaluate.
+ *  @reps: number of passes over the dataset.
+ *  @sec: pointer to the output elapsed time, in seconds.
+ *  @evals: pointer to the output number of function evaluations.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int bench_factor (const Factor *f, const Data *dat, BenchFactorOp op,
+                  size_t reps, double *sec, size_t *evals) {
+  /* check the input pointers and sizes. */
+  if (!f || !dat || !sec || !evals || !dat->N || f->D > dat->D)
+    return 0;
+
+  /* allocate a temporary vector. */
+  Vector *v = vector_alloc(dat->N > f->P ? dat->N : f->P);
+  if (!v)
+    return 0;
+
+  /* time each pass over the dataset. */
+  size_t total = 0;
+  const double t0 = bench_clock();
+  for (size_t r = 0; r < reps; r++) {
+    const size_t n = bench_factor_pass(f, dat, op, v);
+    if (!n) {
+      vector_free(v);
+      return 0;
+    }
+
+    total += n;
+  }
+
+  /* store the results. */
+  *sec = bench_clock() - t0;
+  *evals = total;
+
+  /* free the temporary vector and return success. */
+  vector_free(v);
+  return 1;
+}
+
+/* bench_model(): time repeated evaluations of a model function.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to access.
+ *  @op: model function to evaluate.
+ *  @reps: number of evaluations.
+ *  @sec: pointer to the output elapsed time, in seconds.
+ *  @evals: pointer to the output number of function evaluations.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int bench_model (Model *mdl, BenchModelOp op, size_t reps,
+                 double *sec, size_t *evals) {
+  /* check the input pointers. */
+  if (!mdl || !mdl->dat || !sec || !evals)
+    return 0;
+
+  /* time each evaluation. */
+  size_t total = 0;
+  const double t0 = bench_clock();
+  for (size_t r = 0; r < reps; r++) {
+    if (op == BENCH_INFER) {
+      if (!model_infer(mdl))
+        return 0;
+
+      total++;
+    }
+    else if (op == BENCH_UPDATE) {
+      for (size_t j = 0; j < mdl->M; j++, total++) {
+        if (!model_update(mdl, j))
+          return 0;
+      }
+    }
+    else {
+      bench_sink = model_bound(mdl);
+      total++;
+    }
+  }
+
+  /* store the results and return success. */
+  *sec = bench_clock() - t0;
+  *evals = total;
+  return 1;
+}
+
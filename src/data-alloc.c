@@ -2,7 +2,69 @@
 /* include the vfl header. */
 #include <vfl/vfl.h>
 
-/* data_resize(): resize the observation array of a dataset.
+/* DATA_MIN_CAPACITY: smallest number of observations allocated
+ * for a non-empty dataset.
+ */
+#define DATA_MIN_CAPACITY 16
+
+/* include the memory-mapping and threading headers. */
+#include <sys/mman.h>
+#include <pthread.h>
+
+/* data_epoch: most recently assigned dataset version. versions are
+ * unique across all datasets, so that a dataset which replaces another
+ * is never mistaken for it.
+ */
+static size_t data_epoch = 0;
+static pthread_mutex_t data_epoch_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* data_touch(): assign a new version to a dataset, marking any values
+ * computed from its previous contents as stale.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to modify.
+ */
+void data_touch (Data *dat) {
+  /* return if the input pointer is null. */
+  if (!dat)
+    return;
+
+  /* draw the next version from the global counter. */
+  pthread_mutex_lock(&data_epoch_lock);
+  dat->ver = ++data_epoch;
+  pthread_mutex_unlock(&data_epoch_lock);
+}
+
+/* data_release(): release the observation arrays of a dataset, either
+ * by freeing them or by unmapping the file that holds them. the sizes
+ * of the dataset are left unmodified.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to modify.
+ */
+void data_release (Data *dat) {
+  /* unmap or free the arrays. */
+  if (dat->map) {
+    munmap(dat->map, dat->maplen);
+  }
+  else {
+    free(dat->X);
+    free(dat->y);
+    free(dat->p);
+  }
+
+  /* reset the array pointers. */
+  dat->map = NULL;
+  dat->maplen = 0;
+  dat->X = NULL;
+  dat->y = NULL;
+  dat->p = NULL;
+}
+
+/* data_resize(): resize the observation arrays of a dataset. when
+ * the dimensionality is unchanged, storage grows geometrically, so
+ * that repeated augmentation requires amortized constant time per
+ * observation.
  *
  * arguments:
  *  @dat: dataset structure pointer to modify.
@@ -13,55 +75,60 @@
  *  integer indicating success (1) or failure (0).
  */
 int data_resize (Data *dat, size_t N, size_t D) {
-  /* determine the size of the observation array. */
-  const size_t vbytes = vector_bytes(D);
-  const size_t bytes = N * (sizeof(Datum) + vbytes);
-
-  /* reallocate the swap vector. */
-  Vector *swp = vector_alloc(D);
-  if (!swp)
-    return 0;
-
-  /* allocate a new observation array. */
-  Datum *data = malloc(bytes);
-  if (!data)
-    return 0;
+  /* if the current storage suffices, only update the sizes. */
+  if (D == dat->D && N <= dat->cap) {
+    dat->N = N;
+    data_touch(dat);
+    return 1;
+  }
 
-  /* prepare each *new* datum for use within python. */
-  for (size_t i = dat->N; i < N; i++)
-    PyObject_INIT(data + i, &Datum_Type);
+  /* determine the new capacity. */
+  size_t cap = (D == dat->D ? 2 * dat->cap : 0);
+  cap = (cap < DATA_MIN_CAPACITY ? DATA_MIN_CAPACITY : cap);
+  cap = (cap < N ? N : cap);
 
-  /* create a pointer for indexing datum elements. */
-  char *ptr = (char*) data;
-  ptr += N * sizeof(Datum);
+  /* allocate new observation arrays. */
+  double *X = malloc((D ? cap * D : 1) * sizeof(double));
+  double *y = malloc(cap * sizeof(double));
+  size_t *p = malloc(cap * sizeof(size_t));
 
-  /* initialize each member of the observation array. */
-  for (size_t i = 0; i < N; i++) {
-    /* initialize the location vector. */
-    data[i].x = (Vector*) ptr;
-    vector_init(data[i].x, D);
-    ptr += vbytes;
+  /* check for allocation failures. */
+  if (!X || !y || !p) {
+    free(X);
+    free(y);
+    free(p);
+    return 0;
   }
 
-  /* copy any existing observations into the new array. */
-  for (size_t i = 0; i < dat->N; i++) {
-    /* copy the observation data. */
-    vector_copy(data[i].x, dat->data[i].x);
-    data[i].y = dat->data[i].y;
-    data[i].p = dat->data[i].p;
+  /* copy any existing observations into the new arrays. */
+  const size_t n = (dat->N < N ? dat->N : N);
+  const size_t d = (dat->D < D ? dat->D : D);
+  if (D == dat->D) {
+    /* identical row layouts may be copied in bulk. */
+    memcpy(X, dat->X, n * D * sizeof(double));
+  }
+  else {
+    /* otherwise, copy row by row. */
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < d; j++)
+        X[i * D + j] = dat->X[i * dat->D + j];
   }
 
-  /* replace the swap vector. */
-  vector_free(dat->swp.x);
-  dat->swp.x = swp;
+  /* copy the observed values and output indices. */
+  memcpy(y, dat->y, n * sizeof(double));
+  memcpy(p, dat->p, n * sizeof(size_t));
 
-  /* replace the observation array. */
-  free(dat->data);
-  dat->data = data;
+  /* replace the observation arrays. */
+  data_release(dat);
+  dat->X = X;
+  dat->y = y;
+  dat->p = p;
 
   /* store the new dataset sizes. */
+  dat->cap = cap;
   dat->N = N;
   dat->D = D;
+  data_touch(dat);
 
   /* return success. */
   return 1;
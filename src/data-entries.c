@@ -1,7 +1,7 @@
 
-/* include the gridding and dataset headers. */
-#include <vfl/util/grid.h>
+/* include the dataset and gridding headers. */
 #include <vfl/vfl.h>
+#include <vfl/util/grid.h>
 
 /* data_inner(): compute the inner product of the observations
  * stored within a dataset.
@@ -20,31 +20,96 @@ double data_inner (const Data *dat) {
   double yy = 0.0;
 
   /* compute the inner product. */
-  Datum *di = dat->data;
-  for (size_t i = 0; i < dat->N; i++, di++)
-    yy += di->y * di->y;
+  const double *y = dat->y;
+  for (size_t i = 0; i < dat->N; i++)
+    yy += y[i] * y[i];
 
   /* return the result. */
   return yy;
 }
 
-/* data_get(): extract an observation from a dataset.
+/* data_x(): return a view of the location of an observation
+ * in a dataset.
+ *
+ * warning: this function does not check the dataset structure
+ * pointer or observation index for validity; use with caution!
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to access.
+ *  @i: observation index to access.
+ *
+ * returns:
+ *  vector view of the observation location.
+ */
+VectorView data_x (const Data *dat, size_t i) {
+  /* return a view of the location row. */
+  return vector_view_array(dat->X + i * dat->D, dat->D);
+}
+
+/* data_get(): extract a copy of an observation from a dataset.
  *
  * arguments:
  *  @dat: dataset structure pointer to access.
  *  @i: observation index to extract.
+ *  @d: pointer to the output observation, whose location vector
+ *      must be either null or of the dataset dimensionality.
  *
  * returns:
- *  pointer to the requested observation, or NULL if the
- *  observation index is out of bounds.
+ *  integer indicating whether (1) or not (0) the observation
+ *  was extracted.
  */
-Datum *data_get (const Data *dat, size_t i) {
+int data_get (const Data *dat, size_t i, Datum *d) {
   /* check the input arguments. */
-  if (!dat || i >= dat->N)
-    return NULL;
+  if (!dat || !d || i >= dat->N)
+    return 0;
 
-  /* return the observation. */
-  return dat->data + i;
+  /* allocate the location vector, if required. */
+  if (!d->x) {
+    d->x = vector_alloc(dat->D);
+    if (!d->x)
+      return 0;
+  }
+
+  /* check the location dimensionality. */
+  if (d->x->len != dat->D)
+    return 0;
+
+  /* copy the observation. */
+  VectorView x = data_x(dat, i);
+  vector_copy(d->x, &x);
+  d->y = dat->y[i];
+  d->p = dat->p[i];
+
+  /* return success. */
+  return 1;
+}
+
+/* data_view(): create a view of a contiguous range of observations
+ * in a dataset. the view shares its observations with the dataset,
+ * holds no references, and must never be passed to python.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to access.
+ *  @i: index of the first observation in the view.
+ *  @n: number of observations in the view.
+ *
+ * returns:
+ *  dataset structure that views the requested observations.
+ */
+Data data_view (const Data *dat, size_t i, size_t n) {
+  /* copy the dataset structure and narrow its range. */
+  Data view = *dat;
+  view.X += i * dat->D;
+  view.y += i;
+  view.p += i;
+  view.N = n;
+  view.cap = n;
+  view.map = NULL;
+  view.maplen = 0;
+  view.idx = NULL;
+
+  /* return the view. */
+  return view;
 }
 
 /* data_set(): store an observation into a dataset.
@@ -67,9 +132,10 @@ int data_set (Data *dat, size_t i, const Datum *d) {
     return 0;
 
   /* store the observation. */
-  vector_copy(dat->data[i].x, d->x);
-  dat->data[i].y = d->y;
-  dat->data[i].p = d->p;
+  VectorView x = data_x(dat, i);
+  vector_copy(&x, d->x);
+  dat->y[i] = d->y;
+  dat->p[i] = d->p;
 
   /* return success. */
   return data_sort_single(dat, i);
@@ -102,15 +168,17 @@ size_t data_find (const Data *dat, const Datum *d) {
   while (imin <= imax) {
     /* get the midpoint and compare. */
     const size_t i = (imin + imax) / 2;
-    const int cmp = datum_cmp(dat->data + i, d);
+    const int cmp = data_cmp(dat, i, d->p, d->x);
 
     /* check the comparison result. */
     if (cmp == 0)
       return i + 1;
     else if (cmp < 0)
       imin = i + 1;
-    else
+    else if (i > 0)
       imax = i - 1;
+    else
+      break;
   }
 
   /* return failure. */
@@ -140,9 +208,11 @@ int data_augment (Data *dat, const Datum *d) {
     return 0;
 
   /* store the augmenting observation. */
-  vector_copy(dat->data[dat->N - 1].x, d->x);
-  dat->data[dat->N - 1].y = d->y;
-  dat->data[dat->N - 1].p = d->p;
+  const size_t i = dat->N - 1;
+  VectorView x = data_x(dat, i);
+  vector_copy(&x, d->x);
+  dat->y[i] = d->y;
+  dat->p[i] = d->p;
 
   /* return success. */
   return data_sort_single(dat, dat->N - 1);
@@ -197,16 +267,17 @@ int data_augment_from_grid (Data *dat, size_t p, const Matrix *grid) {
   /* loop over every grid point. */
   for (size_t i = 0; i < N; i++) {
     /* store the current grid point. */
-    vector_copy(dat->data[N0 + i].x, x);
-    dat->data[N0 + i].y = 0.0;
-    dat->data[N0 + i].p = p;
+    VectorView xi = data_x(dat, N0 + i);
+    vector_copy(&xi, x);
+    dat->y[N0 + i] = 0.0;
+    dat->p[N0 + i] = p;
 
     /* move to the next grid point. */
     grid_iterator_next(grid, idx, sz, x);
   }
 
   /* indicate successful completion. */
-  status = data_sort(dat);
+  status = data_sort_from(dat, N0);
 
 fail:
   /* free all allocated memory and return. */
@@ -242,19 +313,60 @@ int data_augment_from_data (Data *dat, const Data *dsrc) {
   if (!data_resize(dat, N0 + N, D))
     return 0;
 
+  /* copy every augmenting point. */
+  memcpy(dat->X + N0 * D, dsrc->X, N * D * sizeof(double));
+  memcpy(dat->y + N0, dsrc->y, N * sizeof(double));
+  memcpy(dat->p + N0, dsrc->p, N * sizeof(size_t));
+
+  /* return the result of sorting the augmented dataset. */
+  return data_sort_from(dat, N0);
+}
+
+/* data_augment_from_matrix(): add a block of observations, stored as
+ * the rows of a matrix, into a dataset. the block is sorted and then
+ * merged into the existing observations.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to modify.
+ *  @p: output index of the augmenting observations.
+ *  @X: matrix of observation locations, one per row.
+ *  @y: vector of observed values, or null for zero values.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int data_augment_from_matrix (Data *dat, size_t p, const Matrix *X,
+                              const Vector *y) {
+  /* check the input pointers. */
+  if (!dat || !X)
+    return 0;
+
+  /* initialize the new sizes. */
+  const size_t D = X->cols;
+  const size_t N = X->rows;
+  const size_t N0 = dat->N;
+
+  /* check the dimensionalities of the new observations. */
+  if ((dat->D && dat->N && D != dat->D) || (y && y->len != N))
+    return 0;
+
+  /* attempt to resize the dataset. */
+  if (!data_resize(dat, N0 + N, D))
+    return 0;
+
   /* loop over every augmenting point. */
   for (size_t i = 0; i < N; i++) {
-    /* get the source and destination data. */
-    Datum *di_src = data_get(dsrc, i);
-    Datum *di = data_get(dat, N0 + i);
-
-    /* copy from source to destination. */
-    vector_copy(di->x, di_src->x);
-    di->y = di_src->y;
-    di->p = di_src->p;
+    /* store the location. */
+    double *xi = dat->X + (N0 + i) * D;
+    for (size_t d = 0; d < D; d++)
+      xi[d] = matrix_get(X, i, d);
+
+    /* store the observed value and output index. */
+    dat->y[N0 + i] = (y ? vector_get(y, i) : 0.0);
+    dat->p[N0 + i] = p;
   }
 
   /* return the result of sorting the augmented dataset. */
-  return data_sort(dat);
+  return data_sort_from(dat, N0);
 }
 
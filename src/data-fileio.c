@@ -2,87 +2,519 @@
 /* include the vfl header. */
 #include <vfl/vfl.h>
 
-/* data_fread(): read a text file into an allocated dataset structure.
+/* include the posix file and memory-mapping headers. */
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* DATA_MAGIC: leading bytes of binary dataset files.
+ */
+#define DATA_MAGIC "VFLDATA"
+
+/* DATA_BYTE_ORDER: value used to check the byte order of binary
+ * dataset files.
+ */
+#define DATA_BYTE_ORDER 0x0102030405060708ULL
+
+/* DATA_CHUNK: minimum number of bytes of text parsed by each thread.
+ */
+#define DATA_CHUNK 65536
+
+/* DataHeader: structure of the header of binary dataset files. the
+ * header is followed by the output indices (N uint64), the locations
+ * (N * D double, row-major) and the observed values (N double).
+ */
+typedef struct {
+  /* @magic: leading magic bytes.
+   * @order: byte order check value.
+   * @N, @D: dataset sizes.
+   */
+  char magic[8];
+  uint64_t order;
+  uint64_t N, D;
+}
+DataHeader;
+
+/* DataMap: structure for holding a read-only memory-mapped file.
+ */
+typedef struct {
+  /* @fd: file descriptor.
+   * @buf: mapped file contents.
+   * @len: mapped file size.
+   */
+  int fd;
+  char *buf;
+  size_t len;
+}
+DataMap;
+
+/* data_map_open(): memory-map a file.
  *
  * arguments:
- *  @dat: dataset structure pointer to augment.
- *  @fname: filename to read from.
+ *  @map: pointer to the map structure to initialize.
+ *  @fname: filename to map.
+ *  @prot: memory protection flags.
  *
  * returns:
  *  integer indicating success (1) or failure (0).
  */
-int data_fread (Data *dat, const char *fname) {
-  /* declare required variables:
-   *  @N, @D: sizes of the input data.
-   *  @buf: buffer of input lines.
-   *  @fh: input file handle.
+static int data_map_open (DataMap *map, const char *fname, int prot) {
+  /* open the file and determine its size. */
+  struct stat st;
+  map->buf = NULL;
+  map->fd = open(fname, O_RDONLY);
+  if (map->fd < 0)
+    return 0;
+
+  if (fstat(map->fd, &st) != 0 || st.st_size == 0) {
+    close(map->fd);
+    return 0;
+  }
+
+  /* map the file contents privately. */
+  map->len = (size_t) st.st_size;
+  map->buf = mmap(NULL, map->len, prot, MAP_PRIVATE, map->fd, 0);
+  if (map->buf == MAP_FAILED) {
+    map->buf = NULL;
+    close(map->fd);
+    return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* data_map_close(): unmap a memory-mapped file.
+ *
+ * arguments:
+ *  @map: pointer to the map structure to release.
+ */
+static void data_map_close (DataMap *map) {
+  /* unmap the contents and close the file. */
+  munmap(map->buf, map->len);
+  close(map->fd);
+}
+
+/* data_parse_size(): parse a non-negative decimal integer from text.
+ *
+ * arguments:
+ *  @s: pointer to the start of the text.
+ *  @end: pointer to the end of the text.
+ *  @v: pointer to the output value.
+ *
+ * returns:
+ *  pointer to the first unparsed character, or null on failure.
+ */
+static const char *data_parse_size (const char *s, const char *end,
+                                    size_t *v) {
+  /* skip leading blanks. */
+  while (s < end && (*s == ' ' || *s == '\t'))
+    s++;
+
+  /* accumulate the digits. */
+  const char *s0 = s;
+  size_t val = 0;
+  while (s < end && *s >= '0' && *s <= '9')
+    val = 10 * val + (size_t) (*s++ - '0');
+
+  /* fail if no digits were read. */
+  if (s == s0)
+    return NULL;
+
+  /* store the value and return. */
+  *v = val;
+  return s;
+}
+
+/* data_parse_double(): parse a floating-point number from text. the
+ * common case of at most 19 significant digits and a small exponent
+ * is computed exactly from an integer mantissa, and all other cases
+ * are handed to strtod().
+ *
+ * arguments:
+ *  @s: pointer to the start of the text.
+ *  @end: pointer to the end of the text.
+ *  @v: pointer to the output value.
+ *
+ * returns:
+ *  pointer to the first unparsed character, or null on failure.
+ */
+static const char *data_parse_double (const char *s, const char *end,
+                                      double *v) {
+  /* exactly representable powers of ten. */
+  static const double pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  /* skip leading blanks. */
+  while (s < end && (*s == ' ' || *s == '\t'))
+    s++;
+
+  /* read the sign. */
+  const char *s0 = s;
+  int neg = 0;
+  if (s < end && (*s == '-' || *s == '+'))
+    neg = (*s++ == '-');
+
+  /* read the integer and fractional digits. */
+  uint64_t m = 0;
+  int nd = 0, nsig = 0, e = 0;
+  while (s < end && *s >= '0' && *s <= '9') {
+    if (m || *s != '0') nsig++;
+    if (nsig <= 19) m = 10 * m + (uint64_t) (*s - '0');
+    else e++;
+    s++, nd++;
+  }
+
+  if (s < end && *s == '.') {
+    s++;
+    while (s < end && *s >= '0' && *s <= '9') {
+      if (m || *s != '0') nsig++;
+      if (nsig <= 19) { m = 10 * m + (uint64_t) (*s - '0'); e--; }
+      s++, nd++;
+    }
+  }
+
+  /* read the exponent. */
+  if (nd && s < end && (*s == 'e' || *s == 'E')) {
+    const char *se = s++;
+    int eneg = 0, ev = 0, ned = 0;
+    if (s < end && (*s == '-' || *s == '+'))
+      eneg = (*s++ == '-');
+
+    while (s < end && *s >= '0' && *s <= '9') {
+      if (ev < 100000) ev = 10 * ev + (*s - '0');
+      s++, ned++;
+    }
+
+    /* an exponent without digits is not part of the number. */
+    if (ned)
+      e += (eneg ? -ev : ev);
+    else
+      s = se;
+  }
+
+  /* compute exactly representable values directly. */
+  if (nd && nsig <= 19 && m <= (1ULL << 53) && e >= -22 && e <= 22) {
+    double val = (double) m;
+    val = (e < 0 ? val / pow10[-e] : val * pow10[e]);
+    *v = (neg ? -val : val);
+    return s;
+  }
+
+  /* copy the token for parsing by the c library. */
+  char buf[512];
+  const char *t = s0;
+  while (t < end && t - s0 < 511 && *t != ' ' && *t != '\t' &&
+         *t != '\n' && *t != '\r')
+    t++;
+
+  memcpy(buf, s0, t - s0);
+  buf[t - s0] = '\0';
+
+  /* parse the token. */
+  char *tend;
+  *v = strtod(buf, &tend);
+  if (tend == buf)
+    return NULL;
+
+  /* return the end of the parsed token. */
+  return s0 + (tend - buf);
+}
+
+/* DataParse: structure for holding the shared argument of parallel
+ * text parsing tasks.
+ */
+typedef struct {
+  /* @dat: dataset to fill.
+   * @buf, @len: text to parse.
+   * @N0: offset of the first parsed observation in the dataset.
    */
-  char buf[1024];
+  Data *dat;
+  const char *buf;
+  size_t len, N0;
+
+  /* @start: (T + 1) array of chunk boundaries.
+   * @rows: (T + 1) array of chunk row offsets.
+   * @ok: per-thread status flags.
+   */
+  size_t *start;
+  size_t *rows;
+  int *ok;
+}
+DataParse;
+
+/* data_next_line(): find the start of the next line of text.
+ */
+static inline const char *data_next_line (const char *s, const char *end) {
+  /* locate the next newline. */
+  const char *nl = memchr(s, '\n', end - s);
+  return (nl ? nl + 1 : end);
+}
+
+/* data_is_row(): check whether a line of text holds an observation.
+ */
+static inline int data_is_row (const char *s, const char *end) {
+  /* skip leading blanks, then check for content. */
+  while (s < end && (*s == ' ' || *s == '\t' || *s == '\r'))
+    s++;
+
+  /* blank and comment lines hold no observations. */
+  return (s < end && *s != '\n' && *s != '#');
+}
+
+/* data_count_thread(): count the observations in a chunk of text.
+ *  - see thread_fn() for more information.
+ */
+static void data_count_thread (void *arg, size_t tid, size_t T) {
+  /* get the chunk of text. */
+  DataParse *task = (DataParse*) arg;
+  const char *s = task->buf + task->start[tid];
+  const char *end = task->buf + task->start[tid + 1];
+
+  /* count the lines that hold observations. */
+  size_t n = 0;
+  while (s < end) {
+    const char *next = data_next_line(s, end);
+    n += data_is_row(s, next);
+    s = next;
+  }
+
+  /* store the count. */
+  task->rows[tid + 1] = n;
+}
+
+/* data_parse_thread(): parse the observations in a chunk of text.
+ *  - see thread_fn() for more information.
+ */
+static void data_parse_thread (void *arg, size_t tid, size_t T) {
+  /* get the chunk of text and the dataset. */
+  DataParse *task = (DataParse*) arg;
+  const char *s = task->buf + task->start[tid];
+  const char *end = task->buf + task->start[tid + 1];
+  Data *dat = task->dat;
+  const size_t D = dat->D;
+
+  /* loop over the lines of the chunk. */
+  size_t i = task->N0 + task->rows[tid];
+  task->ok[tid] = 1;
+  while (s < end) {
+    /* skip lines that hold no observations. */
+    const char *next = data_next_line(s, end);
+    if (!data_is_row(s, next)) {
+      s = next;
+      continue;
+    }
+
+    /* read the output index. */
+    s = data_parse_size(s, next, dat->p + i);
+
+    /* read each observation input value. */
+    double *xi = dat->X + i * D;
+    for (size_t d = 0; d < D && s; d++)
+      s = data_parse_double(s, next, xi + d);
+
+    /* read the observed value. */
+    if (s)
+      s = data_parse_double(s, next, dat->y + i);
+
+    /* fail on malformed lines. */
+    if (!s) {
+      task->ok[tid] = 0;
+      return;
+    }
+
+    /* move to the next line and observation. */
+    s = next;
+    i++;
+  }
+}
+
+/* data_fread_text(): read a memory-mapped text file into an allocated
+ * dataset structure. the file is divided into chunks at line breaks,
+ * and the chunks are counted and parsed in parallel.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to augment.
+ *  @map: memory-mapped file contents.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int data_fread_text (Data *dat, const DataMap *map) {
+  /* parse the header line. */
+  const char *buf = map->buf;
+  const char *end = buf + map->len;
+  const char *body = data_next_line(buf, end);
   size_t N, D;
-  FILE *fh;
+  const char *s = buf;
+  if (*s++ != '#' ||
+      !(s = data_parse_size(s, body, &N)) ||
+      !(s = data_parse_size(s, body, &D)))
+    return 0;
 
-  /* check the input pointers. */
-  if (!dat || !fname)
+  /* check that the dataset has conforming dimensionality. */
+  if (dat->D && D != dat->D)
     return 0;
 
-  /* open the input file. */
-  fh = fopen(fname, "r");
-  if (!fh)
+  /* divide the body into chunks that begin at line breaks. */
+  const size_t len = end - body;
+  const size_t T = thread_plan(len, DATA_CHUNK);
+  size_t start[T + 1], rows[T + 1];
+  int ok[T];
+  start[0] = 0;
+  start[T] = len;
+  for (size_t t = 1; t < T; t++) {
+    size_t i0, i1;
+    thread_range(len, t, T, &i0, &i1);
+    i0 = (i0 < start[t - 1] ? start[t - 1] : i0);
+    start[t] = (i0 > 0 ? data_next_line(body + i0 - 1, end) - body : 0);
+  }
+
+  /* count the observations in each chunk. */
+  DataParse task = { dat, body, len, dat->N, start, rows, ok };
+  thread_execute(data_count_thread, &task, T);
+
+  /* compute the row offset of each chunk. */
+  rows[0] = 0;
+  for (size_t t = 0; t < T; t++)
+    rows[t + 1] += rows[t];
+
+  /* attempt to resize the dataset to accomodate the augmenting data.
+   * the header count is only advisory, and the counted lines are used.
+   */
+  const size_t N0 = dat->N;
+  if (!data_resize(dat, N0 + rows[T], D))
     return 0;
 
-  /* attempt to read and parse the first line of input. */
-  if (!fgets(buf, 1024, fh) || sscanf(buf, "# %zu %zu", &N, &D) != 2)
-    goto fail;
+  /* parse the observations of each chunk. */
+  thread_execute(data_parse_thread, &task, T);
+  for (size_t t = 0; t < T; t++) {
+    if (!ok[t]) {
+      data_resize(dat, N0, D);
+      return 0;
+    }
+  }
+
+  /* sort the new observations into the dataset. */
+  return data_sort_from(dat, N0);
+}
+
+/* data_fread_binary(): read a memory-mapped binary file into a dataset
+ * structure. if the dataset is empty, its arrays are pointed into a
+ * private memory map of the file, and no data are copied.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to augment.
+ *  @fname: filename to read from.
+ *  @map: memory-mapped file contents.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int data_fread_binary (Data *dat, const char *fname,
+                              const DataMap *map) {
+  /* check the header. */
+  const DataHeader *hdr = (const DataHeader*) map->buf;
+  if (map->len < sizeof(DataHeader) || hdr->order != DATA_BYTE_ORDER)
+    return 0;
+
+  /* check that the file size is representable. */
+  const uint64_t nmax = (SIZE_MAX - sizeof(DataHeader)) / sizeof(double);
+  if (hdr->D > nmax - 2 || hdr->N > nmax / (hdr->D + 2))
+    return 0;
+
+  /* check the file size. */
+  const size_t N = hdr->N;
+  const size_t D = hdr->D;
+  const size_t bytes = sizeof(DataHeader) + N * (D + 2) * sizeof(double);
+  if (map->len != bytes)
+    return 0;
 
   /* check that the dataset has conforming dimensionality. */
   if (dat->D && D != dat->D)
-    goto fail;
-
-  /* determine the total observation count. */
-  size_t i = dat->N;
-  N += dat->N;
-
-  /* attempt to resize the dataset to accomodate the augmenting data. */
-  if (!data_resize(dat, N, D))
-    goto fail;
-
-  /* read the remainder of the file. */
-  while (!feof(fh)) {
-    /* read a new line of the file. */
-    if (fgets(buf, 1024, fh)) {
-      /* skip commented lines. */
-      if (buf[0] == '#')
-        continue;
-
-      /* read the output index. */
-      char *tok = strtok(buf, " ");
-      dat->data[i].p = atoi(tok);
-
-      /* read each observation input value. */
-      for (size_t d = 0; d < D; d++) {
-        tok = strtok(NULL, " ");
-        vector_set(dat->data[i].x, d, atof(tok));
-      }
-
-      /* read the observed value. */
-      tok = strtok(NULL, " ");
-      dat->data[i].y = atof(tok);
-
-      /* increment the observation index. */
-      i++;
-    }
+    return 0;
+
+  /* locate the arrays within the file. */
+  const size_t off_p = sizeof(DataHeader);
+  const size_t off_X = off_p + N * sizeof(uint64_t);
+  const size_t off_y = off_X + N * D * sizeof(double);
+
+  /* map empty datasets directly onto a private copy of the file. */
+  if (dat->N == 0 && N && sizeof(size_t) == sizeof(uint64_t)) {
+    /* map the file with write access, so that modifications to the
+     * dataset are stored in private pages.
+     */
+    DataMap wmap;
+    if (!data_map_open(&wmap, fname, PROT_READ | PROT_WRITE))
+      return 0;
+
+    close(wmap.fd);
+
+    /* replace the arrays of the dataset. */
+    data_release(dat);
+    dat->map = wmap.buf;
+    dat->maplen = wmap.len;
+    dat->p = (size_t*) (wmap.buf + off_p);
+    dat->X = (double*) (wmap.buf + off_X);
+    dat->y = (double*) (wmap.buf + off_y);
+    dat->N = dat->cap = N;
+    dat->D = D;
+
+    /* binary files are written in sorted order, so this is cheap. */
+    return data_sort_from(dat, 0);
   }
 
-  /* close the input file. */
-  fclose(fh);
+  /* otherwise, copy the observations into the dataset. */
+  const size_t N0 = dat->N;
+  if (!data_resize(dat, N0 + N, D))
+    return 0;
 
-  /* return success. */
-  return data_sort(dat);
+  const uint64_t *p = (const uint64_t*) (map->buf + off_p);
+  for (size_t i = 0; i < N; i++)
+    dat->p[N0 + i] = (size_t) p[i];
 
-fail:
-  /* close the input file and return failure. */
-  fclose(fh);
-  return 0;
+  memcpy(dat->X + N0 * D, map->buf + off_X, N * D * sizeof(double));
+  memcpy(dat->y + N0, map->buf + off_y, N * sizeof(double));
+
+  /* sort the new observations into the dataset. */
+  return data_sort_from(dat, N0);
+}
+
+/* data_fread(): read a text or binary file into an allocated dataset
+ * structure. the file format is detected from its leading bytes.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to augment.
+ *  @fname: filename to read from.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int data_fread (Data *dat, const char *fname) {
+  /* check the input pointers. */
+  if (!dat || !fname)
+    return 0;
+
+  /* map the input file. */
+  DataMap map;
+  if (!data_map_open(&map, fname, PROT_READ))
+    return 0;
+
+  /* read the file in the appropriate format. */
+  int status;
+  if (map.len >= sizeof(DATA_MAGIC) &&
+      memcmp(map.buf, DATA_MAGIC, sizeof(DATA_MAGIC)) == 0)
+    status = data_fread_binary(dat, fname, &map);
+  else
+    status = data_fread_text(dat, &map);
+
+  /* unmap the file and return. */
+  data_map_close(&map);
+  return status;
 }
 
 /* data_fwrite(): write the contents of a dataset to a text file.
@@ -110,14 +542,16 @@ int data_fwrite (const Data *dat, const char *fname) {
   /* loop over each observation. */
   for (size_t i = 0; i < dat->N; i++) {
     /* write the observation output index. */
-    fprintf(fh, "%zu", dat->data[i].p);
+    fprintf(fh, "%zu", dat->p[i]);
 
-    /* write the observation location. */
+    /* write the observation location. seventeen significant digits
+     * are written, so that every value is read back exactly.
+     */
     for (size_t d = 0; d < dat->D; d++)
-      fprintf(fh, " %le", vector_get(dat->data[i].x, d));
+      fprintf(fh, " %.17g", dat->X[i * dat->D + d]);
 
     /* write the observed value. */
-    fprintf(fh, " %le\n", dat->data[i].y);
+    fprintf(fh, " %.17g\n", dat->y[i]);
   }
 
   /* close the output file and return success. */
@@ -125,3 +559,48 @@ int data_fwrite (const Data *dat, const char *fname) {
   return 1;
 }
 
+/* data_fwrite_binary(): write the contents of a dataset to a binary
+ * file, which may later be memory-mapped by data_fread().
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to access.
+ *  @fname: filename to write to.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int data_fwrite_binary (const Data *dat, const char *fname) {
+  /* check the input pointers. */
+  if (!dat || !fname)
+    return 0;
+
+  /* open the output file. */
+  FILE *fh = fopen(fname, "wb");
+  if (!fh)
+    return 0;
+
+  /* build the header. */
+  DataHeader hdr;
+  memset(&hdr, 0, sizeof(DataHeader));
+  memcpy(hdr.magic, DATA_MAGIC, sizeof(DATA_MAGIC));
+  hdr.order = DATA_BYTE_ORDER;
+  hdr.N = dat->N;
+  hdr.D = dat->D;
+
+  /* write the header and output indices. */
+  int ok = (fwrite(&hdr, sizeof(DataHeader), 1, fh) == 1);
+  for (size_t i = 0; i < dat->N && ok; i++) {
+    const uint64_t p = dat->p[i];
+    ok = (fwrite(&p, sizeof(uint64_t), 1, fh) == 1);
+  }
+
+  /* write the locations and observed values. */
+  const size_t nx = dat->N * dat->D;
+  ok = ok && fwrite(dat->X, sizeof(double), nx, fh) == nx;
+  ok = ok && fwrite(dat->y, sizeof(double), dat->N, fh) == dat->N;
+
+  /* close the output file and return. */
+  ok = (fclose(fh) == 0) && ok;
+  return ok;
+}
+
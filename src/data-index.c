@@ -0,0 +1,281 @@
+
+/* include the vfl header. */
+#include <vfl/vfl.h>
+
+/* include the threading header. */
+#include <pthread.h>
+
+/* data_index_lock: mutex guarding the construction and use of dataset
+ * indices, which may be requested concurrently by models sharing
+ * a dataset.
+ */
+static pthread_mutex_t data_index_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* data_index_keys: locations along the dimension being sorted, used
+ * by data_index_cmp() during index construction.
+ */
+static const double *data_index_keys;
+static size_t data_index_stride;
+
+/* data_index_cmp(): compare two observation indices by their locations
+ * along the dimension being sorted, breaking ties by index.
+ *
+ * arguments:
+ *  @a, @b: pointers to the observation indices to compare.
+ *
+ * returns:
+ *  comparison result, as in qsort().
+ */
+static int data_index_cmp (const void *a, const void *b) {
+  /* get the observation indices and their locations. */
+  const size_t i = *((const size_t*) a);
+  const size_t j = *((const size_t*) b);
+  const double xi = data_index_keys[i * data_index_stride];
+  const double xj = data_index_keys[j * data_index_stride];
+
+  /* compare the locations, and then the indices. */
+  if (xi < xj) return -1;
+  if (xi > xj) return +1;
+  return (i < j ? -1 : i > j ? +1 : 0);
+}
+
+/* data_index_sizecmp(): compare two observation indices.
+ *
+ * arguments:
+ *  @a, @b: pointers to the observation indices to compare.
+ *
+ * returns:
+ *  comparison result, as in qsort().
+ */
+static int data_index_sizecmp (const void *a, const void *b) {
+  /* compare the indices. */
+  const size_t i = *((const size_t*) a);
+  const size_t j = *((const size_t*) b);
+  return (i < j ? -1 : i > j ? +1 : 0);
+}
+
+/* data_index_build(): build a sorted index of the observations within
+ * a dataset. the caller must hold the index lock.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to access.
+ *
+ * returns:
+ *  pointer to the new index, or null on failure.
+ */
+static DataIndex *data_index_build (const Data *dat) {
+  /* allocate the index structure and arrays. */
+  const size_t N = dat->N, D = dat->D;
+  const size_t len = (N && D ? N * D : 1);
+  DataIndex *idx = malloc(sizeof(DataIndex));
+  size_t *order = malloc(len * sizeof(size_t));
+  double *keys = malloc(len * sizeof(double));
+  if (!idx || !order || !keys) {
+    free(idx);
+    free(order);
+    free(keys);
+    return NULL;
+  }
+
+  /* sort the observations along each dimension. */
+  for (size_t d = 0; d < D; d++) {
+    size_t *od = order + d * N;
+    for (size_t i = 0; i < N; i++)
+      od[i] = i;
+
+    data_index_keys = dat->X + d;
+    data_index_stride = D;
+    qsort(od, N, sizeof(size_t), data_index_cmp);
+
+    /* store the sorted locations. */
+    double *kd = keys + d * N;
+    for (size_t i = 0; i < N; i++)
+      kd[i] = dat->X[od[i] * D + d];
+  }
+
+  /* store the index contents and return. */
+  idx->ver = dat->ver;
+  idx->N = N;
+  idx->D = D;
+  idx->order = order;
+  idx->keys = keys;
+  return idx;
+}
+
+/* data_index_free(): free the sorted index of a dataset, if any.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to modify.
+ */
+void data_index_free (Data *dat) {
+  /* return if the dataset has no index. */
+  if (!dat || !dat->idx)
+    return;
+
+  /* free the index arrays and structure. */
+  free(dat->idx->order);
+  free(dat->idx->keys);
+  free(dat->idx);
+  dat->idx = NULL;
+}
+
+/* data_index_get(): get the current sorted index of a dataset, building
+ * it if the dataset has changed since it was last built. the caller must
+ * hold the index lock for as long as the index is used, as another
+ * caller may replace it.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to access.
+ *
+ * returns:
+ *  pointer to the index, or null on failure.
+ */
+static const DataIndex *data_index_get (Data *dat) {
+  /* check whether the index is current. */
+  DataIndex *idx = dat->idx;
+  if (!idx || idx->ver != dat->ver || idx->N != dat->N ||
+      idx->D != dat->D) {
+    /* replace the stale index. */
+    data_index_free(dat);
+    dat->idx = idx = data_index_build(dat);
+  }
+
+  /* return the index. */
+  return idx;
+}
+
+/* data_index_lower(): find the first position within a sorted array
+ * that holds a value not less than a bound.
+ *
+ * arguments:
+ *  @keys: sorted array of values.
+ *  @n: length of the array.
+ *  @v: bound to search for.
+ *
+ * returns:
+ *  position of the first value >= @v, or @n if none exists.
+ */
+static inline size_t data_index_lower (const double *keys, size_t n,
+                                       double v) {
+  /* bisect the array. */
+  size_t a = 0, b = n;
+  while (a < b) {
+    const size_t m = a + (b - a) / 2;
+    if (keys[m] < v)
+      a = m + 1;
+    else
+      b = m;
+  }
+
+  /* return the position. */
+  return a;
+}
+
+/* data_index_upper(): find the first position within a sorted array
+ * that holds a value greater than a bound.
+ *
+ * arguments:
+ *  @keys: sorted array of values.
+ *  @n: length of the array.
+ *  @v: bound to search for.
+ *
+ * returns:
+ *  position of the first value > @v, or @n if none exists.
+ */
+static inline size_t data_index_upper (const double *keys, size_t n,
+                                       double v) {
+  /* bisect the array. */
+  size_t a = 0, b = n;
+  while (a < b) {
+    const size_t m = a + (b - a) / 2;
+    if (keys[m] <= v)
+      a = m + 1;
+    else
+      b = m;
+  }
+
+  /* return the position. */
+  return a;
+}
+
+/* data_index_box(): find the observations of a dataset that lie within
+ * an axis-aligned box. the observations are located using the sorted
+ * index of the dataset along the most selective dimension of the box,
+ * and are filtered along the remaining dimensions.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to access.
+ *  @lo: (D, 1) array of lower bounds, which may be -inf.
+ *  @hi: (D, 1) array of upper bounds, which may be +inf.
+ *  @n: pointer to the output number of observations.
+ *
+ * returns:
+ *  newly allocated array of the indices of the observations within
+ *  the box, in increasing order, or null on failure.
+ */
+size_t *data_index_box (Data *dat, const double *lo, const double *hi,
+                        size_t *n) {
+  /* check the input pointers. */
+  if (!dat || !lo || !hi || !n)
+    return NULL;
+
+  /* lock and get the current index. */
+  pthread_mutex_lock(&data_index_lock);
+  const DataIndex *idx = data_index_get(dat);
+  if (!idx) {
+    pthread_mutex_unlock(&data_index_lock);
+    return NULL;
+  }
+
+  /* find the dimension whose bounds admit the fewest observations. */
+  const size_t N = dat->N, D = dat->D;
+  size_t dmin = D, a = 0, b = N;
+  for (size_t d = 0; d < D; d++) {
+    /* skip unbounded dimensions. */
+    if (isinf(lo[d]) && isinf(hi[d]))
+      continue;
+
+    /* locate the range of admitted observations. */
+    const double *kd = idx->keys + d * N;
+    const size_t ad = data_index_lower(kd, N, lo[d]);
+    const size_t bd = (ad < N ? data_index_upper(kd, N, hi[d]) : N);
+    if (dmin == D || (bd > ad ? bd - ad : 0) < b - a) {
+      dmin = d;
+      a = ad;
+      b = (bd > ad ? bd : ad);
+    }
+  }
+
+  /* allocate the output array. */
+  size_t *out = malloc((b > a ? b - a : 1) * sizeof(size_t));
+  if (!out) {
+    pthread_mutex_unlock(&data_index_lock);
+    return NULL;
+  }
+
+  /* gather the admitted observations along the selected dimension,
+   * keeping those within the bounds of the other dimensions.
+   */
+  size_t len = 0;
+  const size_t *od = idx->order + (dmin < D ? dmin : 0) * N;
+  for (size_t r = a; r < b; r++) {
+    const size_t i = (dmin < D ? od[r] : r);
+    const double *xi = dat->X + i * D;
+
+    int inside = 1;
+    for (size_t d = 0; d < D && inside; d++)
+      inside = (xi[d] >= lo[d] && xi[d] <= hi[d]);
+
+    if (inside)
+      out[len++] = i;
+  }
+
+  /* unlock the index. */
+  pthread_mutex_unlock(&data_index_lock);
+
+  /* sort the observations by index and return. */
+  qsort(out, len, sizeof(size_t), data_index_sizecmp);
+  *n = len;
+  return out;
+}
+
@@ -2,28 +2,178 @@
 /* include the vfl header. */
 #include <vfl/vfl.h>
 
-/* data_swap(): swap two data within a dataset.
+/* data_cmp(): compare an observation within a dataset against an
+ * output index and location.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer.
+ *  @i: dataset element index.
+ *  @p: output index to compare against.
+ *  @x: location to compare against.
+ *
+ * returns:
+ *  -1,  if dat[i] < (p, x)
+ *  +1,  if dat[i] > (p, x)
+ *   0,  if dat[i] = (p, x)
+ */
+int data_cmp (const Data *dat, size_t i, size_t p, const Vector *x) {
+  /* examine output indices first. */
+  if (dat->p[i] < p)
+    return -1;
+  else if (dat->p[i] > p)
+    return +1;
+
+  /* examine locations next. */
+  const double *xi = dat->X + i * dat->D;
+  for (size_t d = 0; d < dat->D; d++) {
+    /* get the location vector element. */
+    const double xd = vector_get(x, d);
+
+    /* compare the vector elements. */
+    if (xi[d] < xd)
+      return -1;
+    else if (xi[d] > xd)
+      return +1;
+  }
+
+  /* no differences detected, return equality. */
+  return 0;
+}
+
+/* data_cmp_entries(): compare two observations within a dataset.
  *
  * arguments:
  *  @dat: dataset structure pointer.
  *  @i: first element index.
  *  @j: second element index.
+ *
+ * returns:
+ *  comparison result, as in data_cmp().
+ */
+static inline int data_cmp_entries (const Data *dat, size_t i, size_t j) {
+  /* examine output indices first. */
+  if (dat->p[i] < dat->p[j])
+    return -1;
+  else if (dat->p[i] > dat->p[j])
+    return +1;
+
+  /* examine locations next. */
+  const double *xi = dat->X + i * dat->D;
+  const double *xj = dat->X + j * dat->D;
+  for (size_t d = 0; d < dat->D; d++) {
+    if (xi[d] < xj[d])
+      return -1;
+    else if (xi[d] > xj[d])
+      return +1;
+  }
+
+  /* no differences detected, return equality. */
+  return 0;
+}
+
+/* data_merge(): merge two sorted arrays of observation indices.
+ * when observations compare equal, those from the first array
+ * are placed first.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer.
+ *  @a: first sorted array of indices.
+ *  @na: length of the first array.
+ *  @b: second sorted array of indices.
+ *  @nb: length of the second array.
+ *  @out: output array of (na + nb) indices.
+ */
+static void data_merge (const Data *dat,
+                        const size_t *a, size_t na,
+                        const size_t *b, size_t nb,
+                        size_t *out) {
+  /* take the lesser of the two leading elements until one is empty. */
+  size_t ia = 0, ib = 0;
+  while (ia < na && ib < nb)
+    *out++ = (data_cmp_entries(dat, b[ib], a[ia]) < 0 ? b[ib++] : a[ia++]);
+
+  /* copy the remaining elements. */
+  while (ia < na) *out++ = a[ia++];
+  while (ib < nb) *out++ = b[ib++];
+}
+
+/* data_msort(): stably sort an array of observation indices using a
+ * bottom-up merge sort.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer.
+ *  @idx: array of indices to sort.
+ *  @tmp: temporary array having the same length as @idx.
+ *  @n: length of the arrays.
+ *
+ * returns:
+ *  pointer to the sorted indices, either @idx or @tmp.
+ */
+static size_t *data_msort (const Data *dat, size_t *idx, size_t *tmp,
+                           size_t n) {
+  /* merge runs of doubling width, alternating between arrays. */
+  size_t *src = idx, *dst = tmp;
+  for (size_t w = 1; w < n; w *= 2) {
+    /* merge each pair of neighboring runs. */
+    for (size_t i = 0; i < n; i += 2 * w) {
+      const size_t na = (i + w < n ? w : n - i);
+      const size_t nb = (i + na + w < n ? w : n - i - na);
+      data_merge(dat, src + i, na, src + i + na, nb, dst + i);
+    }
+
+    /* swap the source and destination arrays. */
+    size_t *swp = src;
+    src = dst;
+    dst = swp;
+  }
+
+  /* return the sorted array. */
+  return src;
+}
+
+/* data_permute(): reorder the trailing observations of a dataset.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer.
+ *  @k: index of the first observation to reorder.
+ *  @idx: array of (N - k) source observation indices, all >= k.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
  */
-static inline void data_swap (Data *dat, size_t i, size_t j) {
-  /* copy the first element into the swap location. */
-  vector_copy(dat->swp.x, dat->data[i].x);
-  dat->swp.y = dat->data[i].y;
-  dat->swp.p = dat->data[i].p;
-
-  /* copy the second to the first. */
-  vector_copy(dat->data[i].x, dat->data[j].x);
-  dat->data[i].y = dat->data[j].y;
-  dat->data[i].p = dat->data[j].p;
-
-  /* copy the swap to the second. */
-  vector_copy(dat->data[j].x, dat->swp.x);
-  dat->data[j].y = dat->swp.y;
-  dat->data[j].p = dat->swp.p;
+static int data_permute (Data *dat, size_t k, const size_t *idx) {
+  /* allocate temporary arrays for the reordered observations. */
+  const size_t n = dat->N - k;
+  const size_t D = dat->D;
+  double *X = malloc((n && D ? n * D : 1) * sizeof(double));
+  double *y = malloc(n * sizeof(double));
+  size_t *p = malloc(n * sizeof(size_t));
+
+  /* check for allocation failures. */
+  if (!X || !y || !p) {
+    free(X);
+    free(y);
+    free(p);
+    return 0;
+  }
+
+  /* gather the observations in their new order. */
+  for (size_t m = 0; m < n; m++) {
+    memcpy(X + m * D, dat->X + idx[m] * D, D * sizeof(double));
+    y[m] = dat->y[idx[m]];
+    p[m] = dat->p[idx[m]];
+  }
+
+  /* store the reordered observations. */
+  memcpy(dat->X + k * D, X, n * D * sizeof(double));
+  memcpy(dat->y + k, y, n * sizeof(double));
+  memcpy(dat->p + k, p, n * sizeof(size_t));
+
+  /* free the temporary arrays and return success. */
+  free(X);
+  free(y);
+  free(p);
+  return 1;
 }
 
 /* data_sort(): sort the entries of a dataset.
@@ -39,24 +189,91 @@ static inline void data_swap (Data *dat, size_t i, size_t j) {
  *  integer indicating sort success (1) or failure (0).
  */
 int data_sort (Data *dat) {
-  /* check the structure pointer. */
-  if (!dat)
+  /* sort every element of the dataset. */
+  return data_sort_from(dat, 0);
+}
+
+/* data_sort_from(): sort a block of new entries at the end of a
+ * dataset and merge them into the preceding entries, which must
+ * already be in sorted order. the new entries are sorted over an
+ * index permutation, so the whole operation requires O(n log n + N)
+ * comparisons and a single pass of data movement.
+ *
+ * this function should never be necessary to call from the
+ * outside world, as all dataset functions already maintain
+ * sorted elements.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer.
+ *  @i: index of the first new entry.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int data_sort_from (Data *dat, size_t i) {
+  /* check the input arguments. */
+  if (!dat || i > dat->N)
     return 0;
 
-  /* run an outer loop to sort every element. */
-  for (size_t i = 0; i < dat->N; i++) {
-    /* initialize the starting index. */
-    size_t j = i;
+  /* the dataset contents will change. */
+  data_touch(dat);
 
-    /* loop until the current element has been sorted. */
-    while (j > 0 && datum_cmp(dat->data + (j - 1), dat->data + j) > 0) {
-      data_swap(dat, j - 1, j);
-      j--;
-    }
+  /* return if there are no new entries. */
+  const size_t N = dat->N;
+  const size_t n = N - i;
+  if (n == 0)
+    return 1;
+
+  /* allocate index arrays for sorting the new entries. */
+  size_t *idx = malloc(2 * n * sizeof(size_t));
+  if (!idx)
+    return 0;
+
+  /* sort the indices of the new entries. */
+  for (size_t m = 0; m < n; m++)
+    idx[m] = i + m;
+
+  const size_t *tail = data_msort(dat, idx, idx + n, n);
+
+  /* find the first sorted entry that follows the least new entry.
+   * all sorted entries before it remain in place.
+   */
+  size_t k = 0, kmax = i;
+  while (k < kmax) {
+    const size_t mid = (k + kmax) / 2;
+    if (data_cmp_entries(dat, mid, tail[0]) <= 0)
+      k = mid + 1;
+    else
+      kmax = mid;
   }
 
-  /* return success. */
-  return 1;
+  /* if no sorted entries are displaced, reorder the new entries. */
+  int status;
+  if (k == i) {
+    status = data_permute(dat, i, tail);
+    free(idx);
+    return status;
+  }
+
+  /* allocate index arrays for merging. */
+  size_t *head = malloc((i - k + N - k) * sizeof(size_t));
+  if (!head) {
+    free(idx);
+    return 0;
+  }
+
+  /* merge the displaced sorted entries with the new entries. */
+  size_t *out = head + (i - k);
+  for (size_t m = k; m < i; m++)
+    head[m - k] = m;
+
+  data_merge(dat, head, i - k, tail, n, out);
+  status = data_permute(dat, k, out);
+
+  /* free the index arrays and return. */
+  free(head);
+  free(idx);
+  return status;
 }
 
 /* data_sort_single(): move a single entry within a dataset to
@@ -79,25 +296,65 @@ int data_sort_single (Data *dat, size_t i) {
   if (!dat || i >= dat->N)
     return 0;
 
-  /* initialize the sorting index. */
-  const size_t jmax = dat->N - 1;
-  size_t j = i;
+  /* the dataset contents will change. */
+  data_touch(dat);
 
-  /* while the element is less than its leftmost neighbor... */
-  while (j > 0 && datum_cmp(dat->data + j, dat->data + (j - 1)) < 0) {
-    /* ... shift it left. */
-    data_swap(dat, j, j - 1);
-    j--;
+  /* binary search for the new location of the element. */
+  size_t j;
+  if (i > 0 && data_cmp_entries(dat, i, i - 1) < 0) {
+    /* the element belongs before its left neighbor. */
+    size_t jmin = 0, jmax = i - 1;
+    while (jmin < jmax) {
+      const size_t mid = (jmin + jmax) / 2;
+      if (data_cmp_entries(dat, mid, i) <= 0)
+        jmin = mid + 1;
+      else
+        jmax = mid;
+    }
+
+    j = jmin;
   }
+  else if (i + 1 < dat->N && data_cmp_entries(dat, i, i + 1) > 0) {
+    /* the element belongs after its right neighbor. */
+    size_t jmin = i + 1, jmax = dat->N - 1;
+    while (jmin < jmax) {
+      const size_t mid = (jmin + jmax + 1) / 2;
+      if (data_cmp_entries(dat, mid, i) < 0)
+        jmin = mid;
+      else
+        jmax = mid - 1;
+    }
 
-  /* while the element is greater than its rightmost neighbor... */
-  while (j < jmax && datum_cmp(dat->data + j, dat->data + (j + 1)) > 0) {
-    /* ... shift it right. */
-    data_swap(dat, j, j + 1);
-    j++;
+    j = jmin;
   }
+  else
+    return 1;
+
+  /* store the element in temporary memory. */
+  const size_t D = dat->D;
+  double *x = malloc((D ? D : 1) * sizeof(double));
+  if (!x)
+    return 0;
+
+  memcpy(x, dat->X + i * D, D * sizeof(double));
+  const double y = dat->y[i];
+  const size_t p = dat->p[i];
+
+  /* shift the intervening elements by one position. */
+  const size_t lo = (j < i ? j : i + 1);
+  const size_t n = (j < i ? i - j : j - i);
+  const size_t dst = (j < i ? j + 1 : i);
+  memmove(dat->X + dst * D, dat->X + lo * D, n * D * sizeof(double));
+  memmove(dat->y + dst, dat->y + lo, n * sizeof(double));
+  memmove(dat->p + dst, dat->p + lo, n * sizeof(size_t));
+
+  /* store the element at its new location. */
+  memcpy(dat->X + j * D, x, D * sizeof(double));
+  dat->y[j] = y;
+  dat->p[j] = p;
 
-  /* return success. */
+  /* free the temporary memory and return success. */
+  free(x);
   return 1;
 }
 
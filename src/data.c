@@ -14,14 +14,35 @@ PyDoc_STRVAR(
 "Dimensionality of a dataset (read-only)\n"
 "\n");
 
+PyDoc_STRVAR(
+  Data_getset_x_doc,
+"Locations of all observations (read-only array)\n"
+"\n");
+
+PyDoc_STRVAR(
+  Data_getset_y_doc,
+"Observed values of all observations (read-only array)\n"
+"\n");
+
+PyDoc_STRVAR(
+  Data_getset_output_doc,
+"Output indices of all observations (read-only array)\n"
+"\n");
+
 PyDoc_STRVAR(
   Data_method_augment_doc,
 "Augment a dataset with new observations.\n"
+"\n"
+"Blocks of observations may be added at once using the 'x'\n"
+"(list of locations), 'y' (list of values) and 'output' arguments.\n"
 "\n");
 
 PyDoc_STRVAR(
   Data_method_write_doc,
 "Write the contents of a dataset to a file.\n"
+"\n"
+"If 'binary' is true, the dataset is written in a binary format\n"
+"that is memory-mapped when it is read back into a dataset.\n"
 "\n");
 
 /* Data_seq_len(): method for getting dataset sizes.
@@ -32,7 +53,9 @@ Data_seq_len (Data *self) {
   return (Py_ssize_t) self->N;
 }
 
-/* Data_seq_get(): method for getting dataset entries.
+/* Data_seq_get(): method for getting dataset entries. each entry is
+ * returned as a new datum holding a copy of the observation, whose
+ * observed value is written through to the dataset.
  */
 static PyObject*
 Data_seq_get (Data *self, Py_ssize_t i) {
@@ -43,9 +66,26 @@ Data_seq_get (Data *self, Py_ssize_t i) {
     return NULL;
   }
 
-  /* return a new reference to the datum. */
-  Py_INCREF(self->data + i);
-  return (PyObject*) (self->data + i);
+  /* create a new datum object. */
+  Datum *d = (Datum*) PyObject_CallObject((PyObject*) &Datum_Type, NULL);
+  if (!d)
+    return NULL;
+
+  /* copy the observation into the datum. */
+  if (!data_get(self, i, d)) {
+    Py_DECREF(d);
+    PyErr_NoMemory();
+    return NULL;
+  }
+
+  /* bind the datum to the dataset entry. */
+  Py_INCREF(self);
+  d->dat = (PyObject*) self;
+  d->i = (size_t) i;
+  d->ver = self->ver;
+
+  /* return the new datum. */
+  return (PyObject*) d;
 }
 
 /* Data_seq_set(): method for setting dataset entries.
@@ -65,6 +105,12 @@ Data_seq_set (Data *self, Py_ssize_t i, PyObject *v) {
     return -1;
   }
 
+  /* the dataset may not be modified while it is being read. */
+  if (self->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "dataset is in use");
+    return -1;
+  }
+
   /* copy the datum information into the dataset. */
   if (!data_set(self, i, (Datum*) v)) {
     PyErr_SetNone(PyExc_RuntimeError);
@@ -85,6 +131,36 @@ Data_get_dims (Data *self) {
   return PyLong_FromSize_t(self->D);
 }
 
+/* Data_get_x(): method for getting dataset locations.
+ */
+static PyObject*
+Data_get_x (Data *self) {
+  /* return a read-only view of the locations. */
+  return Array_View((PyObject*) self, &self->arrays, self->X,
+                    ARRAY_DOUBLE, 2, self->N, self->D, 1);
+}
+
+/* Data_get_y(): method for getting dataset observed values.
+ */
+static PyObject*
+Data_get_y (Data *self) {
+  /* return a read-only view of the observed values. writes are made
+   * through dataset entries, which check that the dataset is not in
+   * use and assign it a new version.
+   */
+  return Array_View((PyObject*) self, &self->arrays, self->y,
+                    ARRAY_DOUBLE, 1, self->N, 0, 1);
+}
+
+/* Data_get_output(): method for getting dataset output indices.
+ */
+static PyObject*
+Data_get_output (Data *self) {
+  /* return a read-only view of the output indices. */
+  return Array_View((PyObject*) self, &self->arrays, self->p,
+                    ARRAY_SIZE, 1, self->N, 0, 1);
+}
+
 /* --- */
 
 /* Data_method_augment(): augment a dataset with new points.
@@ -93,9 +169,21 @@ static PyObject*
 Data_method_augment (Data *self, PyObject *args, PyObject *kwargs) {
   /* define the keyword argument list. */
   static char *kwlist[] = {
-    "file", "datum", "data", "grid", "output", "outputs", NULL
+    "file", "datum", "data", "grid", "output", "outputs", "x", "y", NULL
   };
 
+  /* the arrays may not be reallocated while they are viewed. */
+  if (self->arrays) {
+    PyErr_SetString(PyExc_BufferError, "dataset arrays are in use");
+    return NULL;
+  }
+
+  /* the dataset may not be modified while it is being read. */
+  if (self->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "dataset is in use");
+    return NULL;
+  }
+
   /* parse the method arguments. */
   PyObject *fobj = NULL;
   PyObject *dobj = NULL;
@@ -103,14 +191,52 @@ Data_method_augment (Data *self, PyObject *args, PyObject *kwargs) {
   PyObject *pobj = NULL;
   PyObject *Pobj = NULL;
   Matrix *grid = NULL;
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O&$O!O!O&OO", kwlist,
+  Matrix *X = NULL;
+  Vector *y = NULL;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O&$O!O!O&OOO&O&", kwlist,
                                    PyUnicode_FSConverter, &fobj,
                                    &Datum_Type, &dobj,
                                    &Data_Type, &Dobj,
                                    Matrix_Converter, &grid,
-                                   &pobj, &Pobj))
+                                   &pobj, &Pobj,
+                                   Matrix_Converter, &X,
+                                   Vector_Converter, &y))
                                      return NULL;
 
+  /* if a block of locations was specified, add it first, so we
+   * can deallocate it before any other augmentation.
+   */
+  if (X) {
+    /* set the default output index value. */
+    size_t pval = 0;
+
+    /* check if an output index was specified. */
+    if (pobj) {
+      /* get the output index value. */
+      pval = PyLong_AsSize_t(pobj);
+      if (PyErr_Occurred()) {
+        matrix_free(X);
+        vector_free(y);
+        return NULL;
+      }
+    }
+
+    /* augment from the block of observations. */
+    const int status = data_augment_from_matrix(self, pval, X, y);
+    matrix_free(X);
+    vector_free(y);
+    if (!status) {
+      PyErr_SetString(PyExc_RuntimeError, "failed to append observations");
+      return NULL;
+    }
+  }
+  else if (y) {
+    /* observed values require locations. */
+    PyErr_SetString(PyExc_ValueError, "'y' given without 'x'");
+    vector_free(y);
+    return NULL;
+  }
+
   /* if a grid was specified, do grid augmentation first, so we
    * can deallocate it and assume its null from here on out.
    */
@@ -211,16 +337,24 @@ Data_method_augment (Data *self, PyObject *args, PyObject *kwargs) {
 static PyObject*
 Data_method_write (Data *self, PyObject *args, PyObject *kwargs) {
   /* define the keyword argument list. */
-  static char *kwlist[] = { "file", NULL };
+  static char *kwlist[] = { "file", "binary", NULL };
 
-  /* parse the filename argument. */
+  /* parse the filename and format arguments. */
   PyObject *fobj = NULL;
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&", kwlist,
-                                   PyUnicode_FSConverter, &fobj))
-                                     return NULL;
+  int binary = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|p", kwlist,
+                                   PyUnicode_FSConverter, &fobj,
+                                   &binary))
+    return NULL;
 
   /* write the data to the file. */
-  if (!data_fwrite(self, PyBytes_AsString(fobj))) {
+  const char *fname = PyBytes_AsString(fobj);
+  const int status = (binary ? data_fwrite_binary(self, fname)
+                             : data_fwrite(self, fname));
+
+  /* release the filename and check for failures. */
+  Py_DECREF(fobj);
+  if (!status) {
     PyErr_SetNone(PyExc_IOError);
     return NULL;
   }
@@ -243,14 +377,24 @@ Data_new (PyTypeObject *type, PyObject *args, PyObject *kwargs) {
   /* initialize the size of the dataset. */
   self->N = 0;
   self->D = 0;
+  self->cap = 0;
 
-  /* initialize the data array. */
-  self->data = NULL;
+  /* initialize the data arrays. */
+  self->X = NULL;
+  self->y = NULL;
+  self->p = NULL;
 
-  /* initialize the swap datum. */
-  self->swp.p = 0;
-  self->swp.x = NULL;
-  self->swp.y = 0.0;
+  /* initialize the file mapping. */
+  self->map = NULL;
+  self->maplen = 0;
+  self->arrays = 0;
+  self->busy = 0;
+
+  /* initialize the sorted index. */
+  self->idx = NULL;
+
+  /* assign an initial version. */
+  data_touch(self);
 
   /* return the new object. */
   return (PyObject*) self;
@@ -274,11 +418,9 @@ Data_init (Data *self, PyObject *args, PyObject *kwargs) {
  */
 static void
 Data_dealloc (Data *self) {
-  /* free the array of observations. */
-  free(self->data);
-
-  /* free the swap vector. */
-  vector_free(self->swp.x);
+  /* release the arrays of observations and their index. */
+  data_release(self);
+  data_index_free(self);
 
   /* release the object memory. */
   Py_TYPE(self)->tp_free((PyObject*) self);
@@ -316,6 +458,24 @@ static PyGetSetDef Data_getset[] = {
     Data_getset_dims_doc,
     NULL
   },
+  { "x",
+    (getter) Data_get_x,
+    NULL,
+    Data_getset_x_doc,
+    NULL
+  },
+  { "y",
+    (getter) Data_get_y,
+    NULL,
+    Data_getset_y_doc,
+    NULL
+  },
+  { "output",
+    (getter) Data_get_output,
+    NULL,
+    Data_getset_output_doc,
+    NULL
+  },
   { NULL }
 };
 
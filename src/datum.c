@@ -16,12 +16,12 @@ PyDoc_STRVAR(
 
 PyDoc_STRVAR(
   Datum_getset_output_doc,
-"Output index of a datum (read/write)\n"
+"Output index of a datum (read/write, read-only for dataset entries)\n"
 "\n");
 
 PyDoc_STRVAR(
   Datum_getset_input_doc,
-"Input location of a datum (read/write)\n"
+"Input location of a datum (read/write, read-only for dataset entries)\n"
 "\n");
 
 PyDoc_STRVAR(
@@ -29,6 +29,51 @@ PyDoc_STRVAR(
 "Observed value of a datum (read/write)"
 "\n");
 
+/* Datum_check_entry(): check that a datum may be modified. datums read
+ * from a dataset write their observed values through to the dataset
+ * entry, which must not have been modified, moved or removed since it
+ * was read. their locations and output indices determine the order of
+ * the dataset, and may not be modified in place.
+ *
+ * arguments:
+ *  @self: datum object to check.
+ *  @value: whether (1) or not (0) the observed value is being set.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the datum may be modified.
+ */
+static int
+Datum_check_entry (Datum *self, int value) {
+  /* datums not read from a dataset may always be modified. */
+  if (!self->dat)
+    return 1;
+
+  /* check that the location and output index are not being set. */
+  if (!value) {
+    PyErr_SetString(PyExc_TypeError,
+                    "locations and outputs of dataset entries are "
+                    "read-only");
+    return 0;
+  }
+
+  /* check that the dataset may be modified. */
+  const Data *dat = (Data*) self->dat;
+  if (dat->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "dataset is in use");
+    return 0;
+  }
+
+  /* check that the entry is unchanged. */
+  if (dat->ver != self->ver || self->i >= dat->N) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "dataset was modified after the datum was read");
+    return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
 /* Datum_seq_len(): method for getting datum dimensionalities.
  */
 static Py_ssize_t
@@ -63,6 +108,10 @@ Datum_seq_set (Datum *self, Py_ssize_t i, PyObject *v) {
     return -1;
   }
 
+  /* check that the location may be modified. */
+  if (!Datum_check_entry(self, 0))
+    return -1;
+
   /* get the new vector element value. */
   const double xi = PyFloat_AsDouble(v);
   if (PyErr_Occurred())
@@ -93,6 +142,10 @@ Datum_get_output (Datum *self) {
  */
 static int
 Datum_set_output (Datum *self, PyObject *value, void *closure) {
+  /* check that the output index may be modified. */
+  if (!Datum_check_entry(self, 0))
+    return -1;
+
   /* get the new value. */
   const size_t pval = PyLong_AsSize_t(value);
   if (PyErr_Occurred())
@@ -115,6 +168,10 @@ Datum_get_input (Datum *self) {
  */
 static int
 Datum_set_input (Datum *self, PyObject *value, void *closure) {
+  /* check that the location may be modified. */
+  if (!Datum_check_entry(self, 0))
+    return -1;
+
   /* get the new value. */
   Vector *xval = PySequence_AsVector(value);
   if (!xval)
@@ -140,13 +197,27 @@ Datum_get_value (Datum *self) {
  */
 static int
 Datum_set_value (Datum *self, PyObject *value, void *closure) {
+  /* check that the observed value may be modified. */
+  if (!Datum_check_entry(self, 1))
+    return -1;
+
   /* get the new value. */
   const double yval = PyFloat_AsDouble(value);
   if (PyErr_Occurred())
     return -1;
 
-  /* set the observed value and return success. */
+  /* set the observed value. */
   self->y = yval;
+
+  /* write the value through to the dataset entry, if any. */
+  if (self->dat) {
+    Data *dat = (Data*) self->dat;
+    dat->y[self->i] = yval;
+    data_touch(dat);
+    self->ver = dat->ver;
+  }
+
+  /* return success. */
   return 0;
 }
 
@@ -168,6 +239,10 @@ Datum_new (PyTypeObject *type, PyObject *args, PyObject *kwargs) {
   /* initialize the location vector. */
   self->x = NULL;
 
+  /* initialize the dataset entry. */
+  self->dat = NULL;
+  self->i = self->ver = 0;
+
   /* return the new object. */
   return (PyObject*) self;
 }
@@ -209,6 +284,9 @@ Datum_dealloc (Datum *self) {
   /* free the location vector. */
   vector_free(self->x);
 
+  /* release the reference to the dataset. */
+  Py_XDECREF(self->dat);
+
   /* release the object memory. */
   Py_TYPE(self)->tp_free((PyObject*) self);
 }
@@ -1,6 +1,16 @@
 
-/* include the vfl header. */
+/* include the vfl headers. */
 #include <vfl/vfl.h>
+#include <vfl/factor/product.h>
+
+/* include the threading header. */
+#include <pthread.h>
+
+/* factor_epoch: most recently assigned factor version, drawn in the
+ * same way as dataset versions (see data_epoch in data-alloc.c).
+ */
+static size_t factor_epoch = 0;
+static pthread_mutex_t factor_epoch_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /* Factor_reset(): reset the contents of a factor structure.
  *
@@ -17,15 +27,20 @@ void Factor_reset (Factor *f) {
   f->mean = NULL;
   f->var = NULL;
   f->cov = NULL;
+  f->mean_all = NULL;
+  f->var_all = NULL;
   f->diff_mean = NULL;
   f->diff_var = NULL;
   f->meanfield = NULL;
   f->div = NULL;
+  f->support = NULL;
   f->init = NULL;
   f->resize = NULL;
   f->kernel = NULL;
   f->set = NULL;
   f->copy = NULL;
+  f->pack = NULL;
+  f->unpack = NULL;
   f->free = NULL;
 
   /* initialize the sizes. */
@@ -38,10 +53,17 @@ void Factor_reset (Factor *f) {
 
   /* initialize the flags. */
   f->fixed = 0;
+  f->busy = 0;
+
+  /* assign an initial version. */
+  factor_touch(f);
 
   /* initialize the core data. */
   f->inf = NULL;
   f->par = NULL;
+
+  /* initialize the profiling counts. */
+  memset(&f->prof, 0, sizeof(FactorProfile));
 }
 
 /* factor_copy(): create a copy of a factor.
@@ -88,6 +110,9 @@ Factor *factor_copy (const Factor *f) {
     return NULL;
   }
 
+  /* assign a new version to the duplicate. */
+  factor_touch(g);
+
   /* return the new factor. */
   return g;
 }
@@ -142,6 +167,7 @@ int factor_resize (Factor *f, size_t D, size_t P, size_t K) {
   f->D = D;
   f->P = P;
   f->K = K;
+  factor_touch(f);
 
   /* return success. */
   return 1;
@@ -224,7 +250,96 @@ int factor_set (Factor *f, size_t i, double value) {
     return 0;
 
   /* execute the parameter assignment function. */
-  return f->set(f, i, value);
+  if (!f->set(f, i, value))
+    return 0;
+
+  /* assign a new version and return success. */
+  factor_touch(f);
+  return 1;
+}
+
+/* factor_touch(): assign a new version to a factor, marking any values
+ * computed from its previous state as stale.
+ *
+ * arguments:
+ *  @f: factor structure pointer to modify.
+ */
+void factor_touch (Factor *f) {
+  /* return if the input pointer is null. */
+  if (!f)
+    return;
+
+  /* draw the next version from the global counter. */
+  pthread_mutex_lock(&factor_epoch_lock);
+  f->ver = ++factor_epoch;
+  pthread_mutex_unlock(&factor_epoch_lock);
+}
+
+/* factor_version(): get the version of the state of a factor. the
+ * version of a product factor also reflects the state of each of its
+ * member factors.
+ *
+ * arguments:
+ *  @f: factor structure pointer to access.
+ *
+ * returns:
+ *  version of the factor, which changes along with its parameters.
+ */
+size_t factor_version (const Factor *f) {
+  /* return zero if the input pointer is null. */
+  if (!f)
+    return 0;
+
+  /* return the latest version among the product members. */
+  size_t ver = f->ver;
+  if (Product_Check(f)) {
+    for (size_t n = 0; n < Product_GET_SIZE(f); n++) {
+      const size_t vn = factor_version(Product_GET_ITEM(f, n));
+      if (vn > ver)
+        ver = vn;
+    }
+  }
+
+  /* return the version. */
+  return ver;
+}
+
+/* factor_hold(): mark a factor, and each member of a product factor,
+ * as in use by a computation that runs without the interpreter lock.
+ *
+ * arguments:
+ *  @f: factor structure pointer to modify.
+ */
+void factor_hold (Factor *f) {
+  /* return if the input pointer is null. */
+  if (!f)
+    return;
+
+  /* increment the counts of the factor and its members. */
+  f->busy++;
+  if (Product_Check(f)) {
+    for (size_t n = 0; n < Product_GET_SIZE(f); n++)
+      factor_hold(Product_GET_ITEM(f, n));
+  }
+}
+
+/* factor_release(): release a factor, and each member of a product
+ * factor, from a computation started by factor_hold().
+ *
+ * arguments:
+ *  @f: factor structure pointer to modify.
+ */
+void factor_release (Factor *f) {
+  /* return if the input pointer is null. */
+  if (!f)
+    return;
+
+  /* decrement the counts of the factor and its members. */
+  f->busy--;
+  if (Product_Check(f)) {
+    for (size_t n = 0; n < Product_GET_SIZE(f); n++)
+      factor_release(Product_GET_ITEM(f, n));
+  }
 }
 
 /* factor_fix(): set the fixed flag of a variational factor.
@@ -272,8 +387,14 @@ double factor_mean (const Factor *f, const Vector *x,
   if (!f->mean)
     return 0.0;
 
-  /* execute the mean function. */
-  return f->mean(f, x, p, i);
+  /* execute the mean function, timing the call while profiling. */
+  if (!factor_profiling)
+    return f->mean(f, x, p, i);
+
+  const uint64_t t0 = factor_profile_cycles();
+  const double mean = f->mean(f, x, p, i);
+  factor_profile_record(f, FACTOR_OP_MEAN, t0);
+  return mean;
 }
 
 /* factor_var(): evaluate the variance function of a factor.
@@ -289,8 +410,14 @@ double factor_var (const Factor *f, const Vector *x,
   if (!f->var)
     return 0.0;
 
-  /* execute the variance function. */
-  return f->var(f, x, p, i, j);
+  /* execute the variance function, timing the call while profiling. */
+  if (!factor_profiling)
+    return f->var(f, x, p, i, j);
+
+  const uint64_t t0 = factor_profile_cycles();
+  const double var = f->var(f, x, p, i, j);
+  factor_profile_record(f, FACTOR_OP_VAR, t0);
+  return var;
 }
 
 /* factor_cov(): evaluate the covariance function of a factor.
@@ -306,8 +433,78 @@ double factor_cov (const Factor *f, const Vector *x1, const Vector *x2,
   if (!f->cov)
     return 0.0;
 
-  /* execute the covariance function. */
-  return f->cov(f, x1, x2, p1, p2);
+  /* execute the covariance function, timing the call while profiling. */
+  if (!factor_profiling)
+    return f->cov(f, x1, x2, p1, p2);
+
+  const uint64_t t0 = factor_profile_cycles();
+  const double cov = f->cov(f, x1, x2, p1, p2);
+  factor_profile_record(f, FACTOR_OP_COV, t0);
+  return cov;
+}
+
+/* factor_mean_all(): evaluate the mean function of a factor at every
+ * observation in a dataset. factors that do not provide a batched
+ * mean function are evaluated one observation at a time.
+ *  - see factor_mean_all_fn() for more information.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int factor_mean_all (const Factor *f, const Data *dat,
+                     size_t i, Vector *phi) {
+  /* check the input pointers, basis index, and output length. */
+  if (!f || !dat || !phi || i >= f->K || phi->len != dat->N)
+    return 0;
+
+  /* if available, execute the batched mean function. */
+  if (f->mean_all) {
+    const uint64_t t0 = FACTOR_PROFILE_START();
+    f->mean_all(f, dat, i, phi);
+    FACTOR_PROFILE_STOP(f, FACTOR_OP_MEAN_ALL, t0);
+    return 1;
+  }
+
+  /* otherwise, evaluate the mean function at each observation. */
+  for (size_t n = 0; n < dat->N; n++) {
+    VectorView x = data_x(dat, n);
+    vector_set(phi, n, factor_mean(f, &x, dat->p[n], i));
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* factor_var_all(): evaluate the variance function of a factor at every
+ * observation in a dataset. factors that do not provide a batched
+ * variance function are evaluated one observation at a time.
+ *  - see factor_var_all_fn() for more information.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int factor_var_all (const Factor *f, const Data *dat,
+                    size_t i, size_t j, Vector *phi) {
+  /* check the input pointers, basis indices, and output length. */
+  if (!f || !dat || !phi || i >= f->K || j >= f->K || phi->len != dat->N)
+    return 0;
+
+  /* if available, execute the batched variance function. */
+  if (f->var_all) {
+    const uint64_t t0 = FACTOR_PROFILE_START();
+    f->var_all(f, dat, i, j, phi);
+    FACTOR_PROFILE_STOP(f, FACTOR_OP_VAR_ALL, t0);
+    return 1;
+  }
+
+  /* otherwise, evaluate the variance function at each observation. */
+  for (size_t n = 0; n < dat->N; n++) {
+    VectorView x = data_x(dat, n);
+    vector_set(phi, n, factor_var(f, &x, dat->p[n], i, j));
+  }
+
+  /* return success. */
+  return 1;
 }
 
 /* factor_diff_mean(): evaluate the mean gradient function of a factor.
@@ -330,7 +527,9 @@ int factor_diff_mean (const Factor *f, const Vector *x,
     return 0;
 
   /* execute the mean gradient function and return success. */
+  const uint64_t t0 = FACTOR_PROFILE_START();
   f->diff_mean(f, x, p, i, df);
+  FACTOR_PROFILE_STOP(f, FACTOR_OP_DIFF_MEAN, t0);
   return 1;
 }
 
@@ -355,7 +554,9 @@ int factor_diff_var (const Factor *f, const Vector *x,
     return 0;
 
   /* execute the variance gradient function and return success. */
+  const uint64_t t0 = FACTOR_PROFILE_START();
   f->diff_var(f, x, p, i, j, df);
+  FACTOR_PROFILE_STOP(f, FACTOR_OP_DIFF_VAR, t0);
   return 1;
 }
 
@@ -376,8 +577,16 @@ int factor_meanfield (Factor *f, const Factor *fp, const Datum *dat,
   if (!f->meanfield)
     return 0;
 
-  /* execute the mean-field update function. */
-  return f->meanfield(f, fp, dat, b, B);
+  /* execute the mean-field update function, which may modify the
+   * factor parameters.
+   */
+  const uint64_t t0 = FACTOR_PROFILE_START();
+  const int ret = f->meanfield(f, fp, dat, b, B);
+  FACTOR_PROFILE_STOP(f, FACTOR_OP_MEANFIELD, t0);
+  if (FACTOR_MEANFIELD_END)
+    factor_touch(f);
+
+  return ret;
 }
 
 /* factor_div(): evaluate the divergence function of a factor.
@@ -396,6 +605,39 @@ double factor_div (const Factor *f, const Factor *f2) {
   return f->div(f, f2);
 }
 
+/* factor_support(): compute the effective support of a factor, as an
+ * axis-aligned box of input locations.
+ *  - see factor_support_fn() for more information.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the support is bounded
+ *  along any dimension.
+ */
+int factor_support (const Factor *f, double tol, size_t D,
+                    double *lo, double *hi) {
+  /* begin with an unbounded box. */
+  for (size_t d = 0; d < D; d++) {
+    lo[d] = -INFINITY;
+    hi[d] = INFINITY;
+  }
+
+  /* check the input pointer, function pointer and tolerance. */
+  if (!f || !f->support || !(tol > 0.0 && tol < 1.0))
+    return 0;
+
+  /* narrow the box. */
+  f->support(f, tol, D, lo, hi);
+
+  /* check for bounded dimensions. */
+  for (size_t d = 0; d < D; d++) {
+    if (isfinite(lo[d]) || isfinite(hi[d]))
+      return 1;
+  }
+
+  /* the support is unbounded. */
+  return 0;
+}
+
 /* factor_kernel(): write covariance kernel code of a factor.
  *  - see factor_kernel_fn() for more information.
  */
@@ -412,3 +654,108 @@ char *factor_kernel (const Factor *f, size_t p0) {
   return f->kernel(f, p0);
 }
 
+/* factor_pack(): append the complete state of a factor, including its
+ * type, to a packed buffer.
+ *
+ * arguments:
+ *  @f: factor structure pointer to access.
+ *  @pk: packed buffer to write into.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int factor_pack (const Factor *f, Pack *pk) {
+  /* check the input pointers. */
+  if (!f || !pk)
+    return 0;
+
+  /* write the type, sizes, dimension index and flags. */
+  if (!pack_write_type(pk, (const PyObject*) f) ||
+      !pack_write_size(pk, f->D) ||
+      !pack_write_size(pk, f->P) ||
+      !pack_write_size(pk, f->K) ||
+      !pack_write_size(pk, f->d) ||
+      !pack_write_size(pk, f->fixed))
+    return 0;
+
+  /* write the parameter vector and information matrix. */
+  if (!pack_write_vector(pk, f->par) ||
+      !pack_write_matrix(pk, f->inf))
+    return 0;
+
+  /* if the factor has a pack function assigned, call it. */
+  if (f->pack && !f->pack(f, pk))
+    return 0;
+
+  /* return success. */
+  return 1;
+}
+
+/* factor_unpack(): create a factor from its complete state, as written
+ * into a packed buffer by factor_pack().
+ *
+ * arguments:
+ *  @pk: packed buffer to read from.
+ *
+ * returns:
+ *  pointer to a new factor structure, or null on failure.
+ *  (New reference)
+ */
+Factor *factor_unpack (Pack *pk) {
+  /* check the input pointer. */
+  if (!pk)
+    return NULL;
+
+  /* read and resolve the factor type. */
+  PyTypeObject *type = pack_read_type(pk, &Factor_Type);
+  if (!type)
+    return NULL;
+
+  /* allocate a new factor having the stored type. */
+  Factor *f = (Factor*) PyObject_CallObject((PyObject*) type, NULL);
+  Py_DECREF(type);
+  if (!f) {
+    PyErr_Clear();
+    return NULL;
+  }
+
+  /* read the sizes, dimension index and flags. */
+  size_t D, P, K, d, fixed;
+  if (!pack_read_size(pk, &D) || !pack_read_size(pk, &P) ||
+      !pack_read_size(pk, &K) || !pack_read_size(pk, &d) ||
+      !pack_read_size(pk, &fixed))
+    goto fail;
+
+  /* check that the parameters fit within the buffer. */
+  const size_t avail = (pk->len - pk->pos) / sizeof(double);
+  if (P && avail / P < P + 1)
+    goto fail;
+
+  /* resize the factor to match, if required. */
+  if ((f->D != D || f->P != P || f->K != K) &&
+      !factor_resize(f, D, P, K))
+    goto fail;
+
+  /* store the dimension index and flags. */
+  f->d = d;
+  f->fixed = (fixed != 0);
+
+  /* read the parameter vector and information matrix. */
+  if (!pack_read_vector(pk, f->par) ||
+      !pack_read_matrix(pk, f->inf))
+    goto fail;
+
+  /* if the factor has an unpack function assigned, call it. */
+  if (f->unpack && !f->unpack(f, pk))
+    goto fail;
+
+  /* assign a new version and return the factor. */
+  factor_touch(f);
+  return f;
+
+fail:
+  /* release the factor and return failure. */
+  Py_DECREF(f);
+  return NULL;
+}
+
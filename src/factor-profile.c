@@ -0,0 +1,342 @@
+
+/* include the vfl header. */
+#include <vfl/vfl.h>
+
+/* include c library headers. */
+#include <pthread.h>
+#include <time.h>
+
+/* include the cycle counter intrinsics, where available. */
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define FACTOR_PROFILE_TSC
+#endif
+
+/* FACTOR_PROFILE_TYPES: maximum number of distinct factor types whose
+ * counts are accumulated within a profiling session.
+ */
+#define FACTOR_PROFILE_TYPES 64
+
+/* FactorProfileType: structure for holding the counts of a factor type.
+ */
+typedef struct {
+  PyTypeObject *type;
+  FactorCounts counts;
+}
+FactorProfileType;
+
+/* FactorProfileEntry: structure for holding a factor instance that was
+ * called within a profiling session. once the factor is deallocated,
+ * its counts are copied into the entry.
+ */
+typedef struct {
+  Factor *f;
+  const char *name;
+  FactorCounts counts;
+}
+FactorProfileEntry;
+
+/* factor_profiling: whether or not factor functions are profiled.
+ */
+int factor_profiling = 0;
+
+/* profile state, guarded by the profile lock:
+ *  @prof_session: index of the current profiling session.
+ *  @prof_types: counts of each factor type.
+ *  @prof_ntypes: number of factor types.
+ *  @prof_entries: registry of profiled factor instances.
+ *  @prof_len: number of registered factor instances.
+ *  @prof_cap: capacity of the registry.
+ */
+static size_t prof_session = 0;
+static FactorProfileType prof_types[FACTOR_PROFILE_TYPES];
+static size_t prof_ntypes = 0;
+static FactorProfileEntry *prof_entries = NULL;
+static size_t prof_len = 0, prof_cap = 0;
+static pthread_mutex_t prof_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* factor_profile_cycles(): read the cycle counter used for profiling.
+ *
+ * returns:
+ *  time stamp counter on x86 processors, and the monotonic clock in
+ *  nanoseconds otherwise.
+ */
+uint64_t factor_profile_cycles (void) {
+#ifdef FACTOR_PROFILE_TSC
+  /* read the time stamp counter. */
+  return __rdtsc();
+#else
+  /* read and convert the monotonic clock. */
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+/* factor_profile_clock(): get the name of the profiling counter.
+ *
+ * returns:
+ *  static string naming the units of the profiled cycle counts.
+ */
+const char *factor_profile_clock (void) {
+#ifdef FACTOR_PROFILE_TSC
+  return "tsc";
+#else
+  return "ns";
+#endif
+}
+
+/* factor_profile_op_name(): get the name of a profiled function.
+ *
+ * arguments:
+ *  @op: profiled factor function.
+ *
+ * returns:
+ *  static string naming the function.
+ */
+const char *factor_profile_op_name (FactorOp op) {
+  /* define the function names. */
+  static const char *names[FACTOR_OPS] = {
+    "mean", "var", "cov", "mean_all", "var_all",
+    "diff_mean", "diff_var", "meanfield"
+  };
+
+  /* return the name. */
+  return (op < FACTOR_OPS ? names[op] : "unknown");
+}
+
+/* factor_profile_enable(): start a new profiling session, discarding
+ * the counts of any previous session.
+ *
+ * returns:
+ *  integer indicating success (1), or failure (0) if a profiling
+ *  session is already active.
+ */
+int factor_profile_enable (void) {
+  /* check that profiling is not already enabled. */
+  if (factor_profiling)
+    return 0;
+
+  /* begin a new session, which marks the counts of every factor
+   * instance as stale.
+   */
+  pthread_mutex_lock(&prof_lock);
+  prof_session++;
+  prof_len = 0;
+
+  /* reset the counts of each known factor type. */
+  for (size_t t = 0; t < prof_ntypes; t++)
+    memset(&prof_types[t].counts, 0, sizeof(FactorCounts));
+
+  /* enable profiling. */
+  pthread_mutex_unlock(&prof_lock);
+  factor_profiling = 1;
+  return 1;
+}
+
+/* factor_profile_disable(): stop the current profiling session. the
+ * counts of the session remain available until the next session.
+ */
+void factor_profile_disable (void) {
+  /* disable profiling. */
+  factor_profiling = 0;
+}
+
+/* factor_profile_register(): add a factor instance to the registry of
+ * the current profiling session, and reset its counts.
+ *
+ * arguments:
+ *  @f: factor structure pointer to register.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int factor_profile_register (Factor *f) {
+  /* lock the profile state. */
+  int ok = 1;
+  pthread_mutex_lock(&prof_lock);
+
+  /* check that no other thread has registered the factor. */
+  if (f->prof.session == prof_session)
+    goto done;
+
+  /* grow the registry, if required. */
+  if (prof_len == prof_cap) {
+    const size_t cap = (prof_cap ? 2 * prof_cap : 64);
+    FactorProfileEntry *entries =
+      realloc(prof_entries, cap * sizeof(FactorProfileEntry));
+
+    if (!entries) {
+      ok = 0;
+      goto done;
+    }
+
+    prof_entries = entries;
+    prof_cap = cap;
+  }
+
+  /* locate or add the counts of the factor type. */
+  PyTypeObject *type = Py_TYPE(f);
+  FactorCounts *tc = NULL;
+  for (size_t t = 0; t < prof_ntypes && !tc; t++) {
+    if (prof_types[t].type == type)
+      tc = &prof_types[t].counts;
+  }
+
+  if (!tc && prof_ntypes < FACTOR_PROFILE_TYPES) {
+    prof_types[prof_ntypes].type = type;
+    tc = &prof_types[prof_ntypes].counts;
+    memset(tc, 0, sizeof(FactorCounts));
+    prof_ntypes++;
+  }
+
+  /* add the factor to the registry. */
+  FactorProfileEntry *e = prof_entries + prof_len;
+  e->f = f;
+  e->name = type->tp_name;
+
+  /* reset the factor counts before publishing the new session, so
+   * that other threads only count calls into the reset values.
+   */
+  memset(&f->prof.counts, 0, sizeof(FactorCounts));
+  f->prof.type = tc;
+  f->prof.slot = prof_len++;
+  __atomic_store_n(&f->prof.session, prof_session, __ATOMIC_RELEASE);
+
+done:
+  /* unlock the profile state and return. */
+  pthread_mutex_unlock(&prof_lock);
+  return ok;
+}
+
+/* factor_profile_record(): record a call to a profiled factor function.
+ * the counts are bookkeeping, and are modified even through constant
+ * factor pointers.
+ *
+ * arguments:
+ *  @f: factor structure pointer that was called.
+ *  @op: profiled function that was called.
+ *  @t0: cycle counter value at the start of the call.
+ */
+void factor_profile_record (const Factor *f, FactorOp op, uint64_t t0) {
+  /* compute the elapsed cycles. */
+  const uint64_t dt = factor_profile_cycles() - t0;
+  Factor *g = (Factor*) f;
+
+  /* register the factor on its first call within the session. */
+  const size_t session = __atomic_load_n(&g->prof.session, __ATOMIC_ACQUIRE);
+  if (session != prof_session && !factor_profile_register(g))
+    return;
+
+  /* accumulate the instance counts. */
+  FactorCounts *c = &g->prof.counts;
+  __atomic_fetch_add(&c->calls[op], 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&c->cycles[op], dt, __ATOMIC_RELAXED);
+
+  /* accumulate the type counts. */
+  c = g->prof.type;
+  if (c) {
+    __atomic_fetch_add(&c->calls[op], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&c->cycles[op], dt, __ATOMIC_RELAXED);
+  }
+}
+
+/* factor_profile_forget(): detach a factor that is being deallocated
+ * from the registry, keeping a copy of its counts.
+ *
+ * arguments:
+ *  @f: factor structure pointer to detach.
+ */
+void factor_profile_forget (Factor *f) {
+  /* return if the factor was not called in the current session. */
+  if (!f || !prof_session || f->prof.session != prof_session)
+    return;
+
+  /* copy the counts into the registry entry. */
+  pthread_mutex_lock(&prof_lock);
+  if (f->prof.slot < prof_len && prof_entries[f->prof.slot].f == f) {
+    FactorProfileEntry *e = prof_entries + f->prof.slot;
+    e->counts = f->prof.counts;
+    e->f = NULL;
+  }
+
+  /* mark the factor as unregistered. */
+  f->prof.session = 0;
+  pthread_mutex_unlock(&prof_lock);
+}
+
+/* factor_profile_types(): get the counts of each factor type within
+ * the most recent profiling session.
+ *
+ * arguments:
+ *  @types: output array of factor types, or null.
+ *  @counts: output array of type counts, or null.
+ *  @n: length of the output arrays.
+ *
+ * returns:
+ *  number of factor types in the session, which may exceed @n.
+ */
+size_t factor_profile_types (PyTypeObject **types, FactorCounts *counts,
+                             size_t n) {
+  /* copy the types that have been called. */
+  size_t len = 0;
+  pthread_mutex_lock(&prof_lock);
+  for (size_t t = 0; t < prof_ntypes; t++) {
+    /* skip types that were not called in the session. */
+    size_t calls = 0;
+    for (FactorOp op = 0; op < FACTOR_OPS; op++)
+      calls += prof_types[t].counts.calls[op];
+
+    if (!calls)
+      continue;
+
+    /* store the type and its counts. */
+    if (len < n && types)
+      types[len] = prof_types[t].type;
+
+    if (len < n && counts)
+      counts[len] = prof_types[t].counts;
+
+    len++;
+  }
+
+  /* unlock the profile state and return. */
+  pthread_mutex_unlock(&prof_lock);
+  return len;
+}
+
+/* factor_profile_factors(): get the counts of each factor instance
+ * within the most recent profiling session.
+ *
+ * arguments:
+ *  @factors: output array of factors, or null. deallocated factors
+ *            are stored as null pointers.
+ *  @names: output array of factor type names, or null.
+ *  @counts: output array of factor counts, or null.
+ *  @n: length of the output arrays.
+ *
+ * returns:
+ *  number of factor instances in the session, which may exceed @n.
+ */
+size_t factor_profile_factors (Factor **factors, const char **names,
+                               FactorCounts *counts, size_t n) {
+  /* copy each registry entry. */
+  pthread_mutex_lock(&prof_lock);
+  for (size_t i = 0; i < prof_len && i < n; i++) {
+    const FactorProfileEntry *e = prof_entries + i;
+    if (factors)
+      factors[i] = e->f;
+
+    if (names)
+      names[i] = e->name;
+
+    if (counts)
+      counts[i] = (e->f ? e->f->prof.counts : e->counts);
+  }
+
+  /* unlock the profile state and return. */
+  const size_t len = prof_len;
+  pthread_mutex_unlock(&prof_lock);
+  return len;
+}
+
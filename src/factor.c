@@ -55,6 +55,16 @@ PyDoc_STRVAR(
 "Kullback-Liebler divergence from another factor.\n"
 "\n");
 
+PyDoc_STRVAR(
+  Factor_method_tobytes_doc,
+"Return the binary representation of a factor.\n"
+"\n");
+
+PyDoc_STRVAR(
+  Factor_method_frombytes_doc,
+"Create a factor from a binary representation returned by tobytes().\n"
+"\n");
+
 /* Factor_get_dims(): method for getting factor dimension counts.
  */
 static PyObject*
@@ -96,8 +106,17 @@ Factor_set_dim (Factor *self, PyObject *value, void *closure) {
   if (PyErr_Occurred())
     return -1;
 
-  /* set the dimension index and return success. */
+  /* the factor may not be modified while it is in use. */
+  if (self->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "factor is in use");
+    return -1;
+  }
+
+  /* set the dimension index, which changes the factor state. */
   self->d = d;
+  factor_touch(self);
+
+  /* return success. */
   return 0;
 }
 
@@ -119,6 +138,12 @@ Factor_set_fixed (Factor *self, PyObject *value, void *closure) {
     return -1;
   }
 
+  /* the factor may not be modified while it is in use. */
+  if (self->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "factor is in use");
+    return -1;
+  }
+
   /* set the fixed flag and return success. */
   self->fixed = (int) PyLong_AsLong(value);
   return 0;
@@ -233,7 +258,7 @@ Factor_method_mean (Factor *self, PyObject *args) {
                           return NULL;
 
   /* call the mean function and return the result. */
-  return PyFloat_FromDouble(self->mean(self, dat->x, dat->p, i));
+  return PyFloat_FromDouble(factor_mean(self, dat->x, dat->p, i));
 }
 
 /* Factor_method_var(): compute the variance of a factor.
@@ -253,7 +278,7 @@ Factor_method_var (Factor *self, PyObject *args) {
                           return NULL;
 
   /* call the variance function and return the result. */
-  return PyFloat_FromDouble(self->var(self, dat->x, dat->p, i, j));
+  return PyFloat_FromDouble(factor_var(self, dat->x, dat->p, i, j));
 }
 
 /* Factor_method_cov(): compute the covariance of a factor.
@@ -272,7 +297,7 @@ Factor_method_cov (Factor *self, PyObject *args) {
                           return NULL;
 
   /* call the covariance function and return the result. */
-  return PyFloat_FromDouble(self->cov(self, d1->x, d2->x, d1->p, d2->p));
+  return PyFloat_FromDouble(factor_cov(self, d1->x, d2->x, d1->p, d2->p));
 }
 
 /* Factor_method_div(): compute the divergence to another factor.
@@ -292,6 +317,84 @@ Factor_method_div (Factor *self, PyObject *args) {
   return PyFloat_FromDouble(self->div(self, f));
 }
 
+/* Factor_method_tobytes(): return the binary representation of a factor.
+ */
+static PyObject*
+Factor_method_tobytes (Factor *self, PyObject *args) {
+  /* pack the factor state. */
+  Pack pk;
+  pack_init(&pk);
+  if (!factor_pack(self, &pk)) {
+    pack_free(&pk);
+    PyErr_SetString(PyExc_RuntimeError, "failed to pack factor");
+    return NULL;
+  }
+
+  /* return the packed state as bytes. */
+  PyObject *bytes = PyBytes_FromStringAndSize(pk.buf, pk.len);
+  pack_free(&pk);
+  return bytes;
+}
+
+/* Factor_method_frombytes(): create a factor from its binary
+ * representation.
+ */
+static PyObject*
+Factor_method_frombytes (PyObject *cls, PyObject *args) {
+  /* parse the buffer argument. */
+  Py_buffer buf;
+  if (!PyArg_ParseTuple(args, "y*", &buf))
+    return NULL;
+
+  /* unpack the factor state, which must be completely consumed. */
+  Pack pk;
+  pack_view(&pk, buf.buf, buf.len);
+  Factor *f = factor_unpack(&pk);
+  if (f && pk.pos != pk.len) {
+    Py_DECREF(f);
+    f = NULL;
+  }
+
+  /* release the buffer and check for failures. */
+  PyBuffer_Release(&buf);
+  if (!f) {
+    PyErr_SetString(PyExc_ValueError, "invalid factor representation");
+    return NULL;
+  }
+
+  /* check the factor type. */
+  if (!PyObject_TypeCheck((PyObject*) f, (PyTypeObject*) cls)) {
+    PyErr_Format(PyExc_TypeError, "expected %s, found %s",
+                 ((PyTypeObject*) cls)->tp_name, Py_TYPE(f)->tp_name);
+    Py_DECREF(f);
+    return NULL;
+  }
+
+  /* return the factor. */
+  return (PyObject*) f;
+}
+
+/* Factor_method_reduce(): return the pickled state of a factor.
+ */
+static PyObject*
+Factor_method_reduce (Factor *self, PyObject *args) {
+  /* get the constructor, which is resolved through the base type. */
+  PyObject *fn = PyObject_GetAttrString((PyObject*) &Factor_Type,
+                                        "frombytes");
+  if (!fn)
+    return NULL;
+
+  /* get the binary representation. */
+  PyObject *bytes = Factor_method_tobytes(self, NULL);
+  if (!bytes) {
+    Py_DECREF(fn);
+    return NULL;
+  }
+
+  /* return the constructor and its arguments. */
+  return Py_BuildValue("(N(N))", fn, bytes);
+}
+
 /* --- */
 
 /* Factor_new(): allocation method for factors.
@@ -320,6 +423,9 @@ Factor_dealloc (Factor *self) {
   if (self->free)
     self->free(self);
 
+  /* keep the counts of the most recent profiling session. */
+  factor_profile_forget(self);
+
   /* free the information matrix and parameter vector. */
   matrix_free(self->inf);
   vector_free(self->par);
@@ -456,6 +562,21 @@ static PyMethodDef Factor_methods[] = {
     METH_VARARGS,
     Factor_method_div_doc
   },
+  { "tobytes",
+    (PyCFunction) Factor_method_tobytes,
+    METH_NOARGS,
+    Factor_method_tobytes_doc
+  },
+  { "frombytes",
+    (PyCFunction) Factor_method_frombytes,
+    METH_VARARGS | METH_CLASS,
+    Factor_method_frombytes_doc
+  },
+  { "__reduce__",
+    (PyCFunction) Factor_method_reduce,
+    METH_NOARGS,
+    NULL
+  },
   { NULL }
 };
 
@@ -85,6 +85,49 @@ FACTOR_VAR (Cosine) {
   return 0.5 * (ep + em);
 }
 
+/* Cosine_mean_all(): evaluate the cosine factor mean over a dataset.
+ *  - see factor_mean_all_fn() for more information.
+ */
+FACTOR_MEAN_ALL (Cosine) {
+  /* get the factor parameters and the phase offset. */
+  const double mu = vector_get(f->par, P_MU);
+  const double tau = vector_get(f->par, P_TAU);
+  const double z = M_PI_2 * (double) i;
+
+  /* compute the expectation at each observation. */
+  const double *x = dat->X + f->d;
+  const size_t D = dat->D;
+  for (size_t n = 0; n < dat->N; n++) {
+    const double xd = x[n * D];
+    vector_set(phi, n, exp(-0.5 * xd * xd / tau) * cos(mu * xd + z));
+  }
+}
+
+/* Cosine_var_all(): evaluate the cosine factor variance over a dataset.
+ *  - see factor_var_all_fn() for more information.
+ */
+FACTOR_VAR_ALL (Cosine) {
+  /* compute the sum and difference of the phase offsets. */
+  const double zp = M_PI_2 * ((double) i + (double) j);
+  const double zm = M_PI_2 * ((double) i - (double) j);
+
+  /* get the factor parameters. */
+  const double mu = vector_get(f->par, P_MU);
+  const double tau = vector_get(f->par, P_TAU);
+
+  /* the expectation of the difference term is constant. */
+  const double em = cos(zm);
+
+  /* compute the expectation at each observation. */
+  const double *x = dat->X + f->d;
+  const size_t D = dat->D;
+  for (size_t n = 0; n < dat->N; n++) {
+    const double xd = x[n * D];
+    const double ep = exp(-2.0 * xd * xd / tau) * cos(2.0 * mu * xd + zp);
+    vector_set(phi, n, 0.5 * (ep + em));
+  }
+}
+
 /* Cosine_cov(): evaluate the cosine factor covariance.
  *  - see factor_cov_fn() for more information.
  */
@@ -95,7 +138,7 @@ FACTOR_COV (Cosine) {
 
   /* compute the difference of the inputs and the phase offset. */
   const double xm = vector_get(x1, f->d) - vector_get(x2, f->d);
-  const int zm = (p1 == p2 ? 0 : p1 ? -1 : 1);
+  const double zm = M_PI_2 * ((double) p1 - (double) p2);
 
   /* compute and return the covariance. */
   return exp(-0.5 * xm * xm / tau) * cos(mu * xm + zm);
@@ -183,19 +226,18 @@ FACTOR_KERNEL (Cosine) {
 const double xd = x1[%u] - x2[%u];\n\
 const double mu = par[%u];\n\
 const double tau = par[%u];\n\
-const double zd = (p1 == p2 ? 0.0 : p1 ? -%lf : %lf);\n\
+const double zd = %.17g * ((double) p1 - (double) p2);\n\
 cov = exp(-0.5 * xd * xd / tau) * cos(mu * xd + zd);\n\
 ";
 
   /* allocate the kernel code string. */
-  char *kstr = malloc(strlen(fmt) + 24);
+  char *kstr = malloc(strlen(fmt) + 64);
   if (!kstr)
     return NULL;
 
   /* write the kernel code string. */
   sprintf(kstr, fmt, f->d, f->d,
-          p0 + P_MU, p0 + P_TAU,
-          M_PI_2, M_PI_2);
+          p0 + P_MU, p0 + P_TAU, M_PI_2);
 
   /* return the new string. */
   return kstr;
@@ -249,6 +291,8 @@ VFL_TYPE_NEW (Cosine) {
   f->eval      = Cosine_eval;
   f->mean      = Cosine_mean;
   f->var       = Cosine_var;
+  f->mean_all  = Cosine_mean_all;
+  f->var_all   = Cosine_var_all;
   f->cov       = Cosine_cov;
   f->diff_mean = Cosine_diff_mean;
   f->diff_var  = Cosine_diff_var;
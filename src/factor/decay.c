@@ -81,6 +81,40 @@ FACTOR_VAR (Decay) {
   return pow(beta / (beta + xp), alpha);
 }
 
+/* Decay_mean_all(): evaluate the decay factor mean over a dataset.
+ *  - see factor_mean_all_fn() for more information.
+ */
+FACTOR_MEAN_ALL (Decay) {
+  /* get the factor parameters. */
+  const double alpha = vector_get(f->par, P_ALPHA);
+  const double beta = vector_get(f->par, P_BETA);
+
+  /* compute the expectation at each observation. */
+  const double *x = dat->X + f->d;
+  const size_t D = dat->D;
+  for (size_t n = 0; n < dat->N; n++) {
+    const double xd = x[n * D];
+    vector_set(phi, n, pow(beta / (beta + xd), alpha));
+  }
+}
+
+/* Decay_var_all(): evaluate the decay factor variance over a dataset.
+ *  - see factor_var_all_fn() for more information.
+ */
+FACTOR_VAR_ALL (Decay) {
+  /* get the factor parameters. */
+  const double alpha = vector_get(f->par, P_ALPHA);
+  const double beta = vector_get(f->par, P_BETA);
+
+  /* compute the expectation at each observation. */
+  const double *x = dat->X + f->d;
+  const size_t D = dat->D;
+  for (size_t n = 0; n < dat->N; n++) {
+    const double xp = 2.0 * x[n * D];
+    vector_set(phi, n, pow(beta / (beta + xp), alpha));
+  }
+}
+
 /* Decay_cov(): evaluate the decay factor covariance.
  *  - see factor_cov_fn() for more information.
  */
@@ -247,6 +281,8 @@ VFL_TYPE_NEW (Decay) {
   f->eval      = Decay_eval;
   f->mean      = Decay_mean;
   f->var       = Decay_var;
+  f->mean_all  = Decay_mean_all;
+  f->var_all   = Decay_var_all;
   f->cov       = Decay_cov;
   f->diff_mean = Decay_diff_mean;
   f->diff_var  = Decay_diff_var;
@@ -79,6 +79,36 @@ FACTOR_VAR (FixedImpulse) {
   return FixedImpulse_mean(f, x, p, i);
 }
 
+/* FixedImpulse_mean_all(): evaluate the fixed impulse factor mean
+ * over a dataset.
+ *  - see factor_mean_all_fn() for more information.
+ */
+FACTOR_MEAN_ALL (FixedImpulse) {
+  /* get the location parameter. */
+  FixedImpulse *fx = (FixedImpulse*) f;
+  const double mu = fx->mu;
+
+  /* get the factor parameter. */
+  const double tau = vector_get(f->par, P_TAU);
+
+  /* compute the expectation at each observation. */
+  const double *x = dat->X + f->d;
+  const size_t D = dat->D;
+  for (size_t n = 0; n < dat->N; n++) {
+    const double u = x[n * D] - mu;
+    vector_set(phi, n, exp(-0.5 * tau * u * u));
+  }
+}
+
+/* FixedImpulse_var_all(): evaluate the fixed impulse factor variance
+ * over a dataset.
+ *  - see factor_var_all_fn() for more information.
+ */
+FACTOR_VAR_ALL (FixedImpulse) {
+  /* call the batched mean function. */
+  FixedImpulse_mean_all(f, dat, i, phi);
+}
+
 /* FixedImpulse_diff_mean(): evaluate the fixed impulse factor
  * mean gradient.
  *  - see factor_diff_mean_fn() for more information.
@@ -128,6 +158,24 @@ FACTOR_DIV (FixedImpulse) {
        - 0.5 * log(tau2 / tau) - 0.5;
 }
 
+/* FixedImpulse_support(): narrow a box to the support of the impulse factor.
+ *  - see factor_support_fn() for more information.
+ */
+FACTOR_SUPPORT (FixedImpulse) {
+  /* get the factor parameters. */
+  const double mu = ((FixedImpulse*) f)->mu;
+  const double tau = vector_get(f->par, P_TAU);
+
+  /* compute the distance beyond which the moments fall below the
+   * tolerance, and narrow the bounds of the factor dimension.
+   */
+  const double r = sqrt(-2.0 * log(tol) / tau);
+  if (f->d < D && isfinite(r)) {
+    lo[f->d] = (mu - r > lo[f->d] ? mu - r : lo[f->d]);
+    hi[f->d] = (mu + r < hi[f->d] ? mu + r : hi[f->d]);
+  }
+}
+
 /* FixedImpulse_set(): store a parameter into a fixed impulse factor.
  *  - see factor_set_fn() for more information.
  */
@@ -166,6 +214,26 @@ FACTOR_COPY (FixedImpulse) {
   return 1;
 }
 
+/* FixedImpulse_pack(): write extra information of a fixed impulse
+ * factor into a packed buffer.
+ *  - see factor_pack_fn() for more information.
+ */
+FACTOR_PACK (FixedImpulse) {
+  /* write the location parameter. */
+  FixedImpulse *fx = (FixedImpulse*) f;
+  return pack_write_double(pk, fx->mu);
+}
+
+/* FixedImpulse_unpack(): read extra information of a fixed impulse
+ * factor from a packed buffer.
+ *  - see factor_unpack_fn() for more information.
+ */
+FACTOR_UNPACK (FixedImpulse) {
+  /* read the location parameter. */
+  FixedImpulse *fx = (FixedImpulse*) f;
+  return pack_read_double(pk, &fx->mu);
+}
+
 /* --- */
 
 /* FixedImpulse_new(): allocate a new fixed impulse factor.
@@ -183,10 +251,16 @@ VFL_TYPE_NEW (FixedImpulse) {
   f->eval      = FixedImpulse_eval;
   f->mean      = FixedImpulse_mean;
   f->var       = FixedImpulse_var;
+  f->mean_all  = FixedImpulse_mean_all;
+  f->var_all   = FixedImpulse_var_all;
   f->diff_mean = FixedImpulse_diff_mean;
   f->diff_var  = FixedImpulse_diff_var;
   f->div       = FixedImpulse_div;
+  f->support   = FixedImpulse_support;
   f->set       = FixedImpulse_set;
+  f->copy      = FixedImpulse_copy;
+  f->pack      = FixedImpulse_pack;
+  f->unpack    = FixedImpulse_unpack;
 
   /* resize to the default size. */
   if (!factor_resize(f, 1, 1, 1)) {
@@ -219,8 +293,17 @@ FixedImpulse_set_mu (FixedImpulse *fx, PyObject *value, void *closure) {
   if (PyErr_Occurred())
     return -1;
 
-  /* set the new value and return success. */
+  /* the factor may not be modified while it is in use. */
+  if (((Factor*) fx)->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "factor is in use");
+    return -1;
+  }
+
+  /* set the new value, which changes the factor state. */
   fx->mu = v;
+  factor_touch((Factor*) fx);
+
+  /* return success. */
   return 0;
 }
 
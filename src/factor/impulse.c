@@ -71,6 +71,31 @@ FACTOR_VAR (Impulse) {
   return Impulse_mean(f, x, p, i);
 }
 
+/* Impulse_mean_all(): evaluate the impulse factor mean over a dataset.
+ *  - see factor_mean_all_fn() for more information.
+ */
+FACTOR_MEAN_ALL (Impulse) {
+  /* get the factor parameters. */
+  const double mu = vector_get(f->par, P_MU);
+  const double tau = vector_get(f->par, P_TAU);
+
+  /* compute the expectation at each observation. */
+  const double *x = dat->X + f->d;
+  const size_t D = dat->D;
+  for (size_t n = 0; n < dat->N; n++) {
+    const double u = x[n * D] - mu;
+    vector_set(phi, n, exp(-0.5 * tau * u * u));
+  }
+}
+
+/* Impulse_var_all(): evaluate the impulse factor variance over a dataset.
+ *  - see factor_var_all_fn() for more information.
+ */
+FACTOR_VAR_ALL (Impulse) {
+  /* call the batched mean function. */
+  Impulse_mean_all(f, dat, i, phi);
+}
+
 /* Impulse_diff_mean(): evaluate the impulse factor mean gradient.
  *  - see factor_diff_mean_fn() for more information.
  */
@@ -120,6 +145,24 @@ FACTOR_DIV (Impulse) {
        - 0.5 * log(tau2 / tau) - 0.5;
 }
 
+/* Impulse_support(): narrow a box to the support of the impulse factor.
+ *  - see factor_support_fn() for more information.
+ */
+FACTOR_SUPPORT (Impulse) {
+  /* get the factor parameters. */
+  const double mu = vector_get(f->par, P_MU);
+  const double tau = vector_get(f->par, P_TAU);
+
+  /* compute the distance beyond which the moments fall below the
+   * tolerance, and narrow the bounds of the factor dimension.
+   */
+  const double r = sqrt(-2.0 * log(tol) / tau);
+  if (f->d < D && isfinite(r)) {
+    lo[f->d] = (mu - r > lo[f->d] ? mu - r : lo[f->d]);
+    hi[f->d] = (mu + r < hi[f->d] ? mu + r : hi[f->d]);
+  }
+}
+
 /* Impulse_set(): store a parameter into a impulse factor.
  *  - see factor_set_fn() for more information.
  */
@@ -168,9 +211,12 @@ VFL_TYPE_NEW (Impulse) {
   f->eval      = Impulse_eval;
   f->mean      = Impulse_mean;
   f->var       = Impulse_var;
+  f->mean_all  = Impulse_mean_all;
+  f->var_all   = Impulse_var_all;
   f->diff_mean = Impulse_diff_mean;
   f->diff_var  = Impulse_diff_var;
   f->div       = Impulse_div;
+  f->support   = Impulse_support;
   f->set       = Impulse_set;
 
   /* resize to the default size. */
@@ -46,6 +46,32 @@ FACTOR_VAR (Polynomial) {
   return pow(xd, i) * pow(xd, j);
 }
 
+/* Polynomial_mean_all(): evaluate the polynomial factor mean
+ * over a dataset.
+ *  - see factor_mean_all_fn() for more information.
+ */
+FACTOR_MEAN_ALL (Polynomial) {
+  /* compute the expectation at each observation. */
+  const double *x = dat->X + f->d;
+  const size_t D = dat->D;
+  for (size_t n = 0; n < dat->N; n++)
+    vector_set(phi, n, pow(x[n * D], i));
+}
+
+/* Polynomial_var_all(): evaluate the polynomial factor variance
+ * over a dataset.
+ *  - see factor_var_all_fn() for more information.
+ */
+FACTOR_VAR_ALL (Polynomial) {
+  /* compute the expectation at each observation. */
+  const double *x = dat->X + f->d;
+  const size_t D = dat->D;
+  for (size_t n = 0; n < dat->N; n++) {
+    const double xd = x[n * D];
+    vector_set(phi, n, pow(xd, i) * pow(xd, j));
+  }
+}
+
 /* Polynomial_cov(): evaluate the polynomial factor covariance.
  *  - see factor_cov_fn() for more information.
  */
@@ -78,6 +104,35 @@ FACTOR_COV (Polynomial) {
   return cov;
 }
 
+/* Polynomial_kernel(): write the kernel code of a polynomial factor.
+ *  - see factor_kernel_fn() for more information.
+ */
+FACTOR_KERNEL (Polynomial) {
+  /* define the kernel code format string. */
+  const char *fmt = "\
+const double xd1 = x1[%zu];\n\
+const double xd2 = x2[%zu];\n\
+double xi = 1.0;\n\
+cov = 0.0;\n\
+for (unsigned int i = 0; i < %zu; i++) {\n\
+  double xj = 1.0;\n\
+  for (unsigned int j = 0; j < %zu; j++) {\n\
+    cov += xi * xj;\n\
+    xj *= xd2;\n\
+  }\n\
+  xi *= xd1;\n\
+}\n\
+";
+
+  /* allocate and write the kernel code string. */
+  char *kstr = malloc(strlen(fmt) + 80);
+  if (kstr)
+    sprintf(kstr, fmt, f->d, f->d, f->K, f->K);
+
+  /* return the new string. */
+  return kstr;
+}
+
 /* --- */
 
 /* Polynomial_new(): allocate a new polynomial factor.
@@ -95,7 +150,10 @@ VFL_TYPE_NEW (Polynomial) {
   f->eval      = Polynomial_mean;
   f->mean      = Polynomial_mean;
   f->var       = Polynomial_var;
+  f->mean_all  = Polynomial_mean_all;
+  f->var_all   = Polynomial_var_all;
   f->cov       = Polynomial_cov;
+  f->kernel    = Polynomial_kernel;
 
   /* resize to the default size. */
   if (!factor_resize(f, 1, 0, 1)) {
@@ -124,6 +182,12 @@ Polynomial_set_order (Factor *f, PyObject *value, void *closure) {
   if (PyErr_Occurred())
     return -1;
 
+  /* the factor may not be modified while it is in use. */
+  if (f->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "factor is in use");
+    return -1;
+  }
+
   /* attempt to resize the factor. */
   if (!factor_resize(f, f->D, f->P, v + 1)) {
     PyErr_SetString(PyExc_RuntimeError, "failed to set polynomial order");
@@ -200,6 +200,71 @@ FACTOR_VAR (Product) {
   return var;
 }
 
+/* Product_mean_all(): evaluate the product factor mean over a dataset.
+ *  - see factor_mean_all_fn() for more information.
+ */
+FACTOR_MEAN_ALL (Product) {
+  /* get the extended structure pointer. */
+  Product *fx = (Product*) f;
+
+  /* allocate a vector for holding the means of each factor. */
+  Vector *phin = vector_alloc(dat->N);
+  if (!phin) {
+    /* fall back to evaluating each observation separately. */
+    for (size_t n = 0; n < dat->N; n++) {
+      VectorView x = data_x(dat, n);
+      vector_set(phi, n, Product_mean(f, &x, dat->p[n], i));
+    }
+
+    return;
+  }
+
+  /* include the means of each factor. */
+  vector_set_all(phi, 1.0);
+  for (size_t n = 0; n < fx->F; n++) {
+    Factor *fn = fx->factors[n];
+    factor_mean_all(fn, dat, i % fn->K, phin);
+    for (size_t m = 0; m < dat->N; m++)
+      vector_set(phi, m, vector_get(phi, m) * vector_get(phin, m));
+  }
+
+  /* free the temporary vector. */
+  vector_free(phin);
+}
+
+/* Product_var_all(): evaluate the product factor variance
+ * over a dataset.
+ *  - see factor_var_all_fn() for more information.
+ */
+FACTOR_VAR_ALL (Product) {
+  /* get the extended structure pointer. */
+  Product *fx = (Product*) f;
+
+  /* allocate a vector for holding the variances of each factor. */
+  Vector *phin = vector_alloc(dat->N);
+  if (!phin) {
+    /* fall back to evaluating each observation separately. */
+    for (size_t n = 0; n < dat->N; n++) {
+      VectorView x = data_x(dat, n);
+      vector_set(phi, n, Product_var(f, &x, dat->p[n], i, j));
+    }
+
+    return;
+  }
+
+  /* include the variances of each factor. */
+  vector_set_all(phi, 1.0);
+  for (size_t n = 0; n < fx->F; n++) {
+    Factor *fn = fx->factors[n];
+    factor_var_all(fn, dat, i % fn->K, j % fn->K, phin);
+    for (size_t m = 0; m < dat->N; m++)
+      vector_set(phi, m, vector_get(phi, m) * vector_get(phin, m));
+  }
+
+  /* free the temporary vector. */
+  vector_free(phin);
+}
+
 /* Product_cov(): evaluate the product factor covariance.
  *  - see factor_cov_fn() for more information.
  */
@@ -404,6 +469,30 @@ FACTOR_DIV (Product) {
   return div;
 }
 
+/* Product_support(): narrow a box to the support of the product factor,
+ * which is the intersection of the supports of its factors. a factor
+ * without a support function may be arbitrarily large outside of the
+ * supports of the others, so the support of the product is unbounded
+ * unless every factor has one.
+ *  - see factor_support_fn() for more information.
+ */
+FACTOR_SUPPORT (Product) {
+  /* get the extended structure pointer. */
+  Product *fx = (Product*) f;
+
+  /* leave the box unchanged if any factor has unbounded support. */
+  for (size_t n = 0; n < fx->F; n++) {
+    if (!fx->factors[n]->support)
+      return;
+  }
+
+  /* narrow the box by the support of each factor. */
+  for (size_t n = 0; n < fx->F; n++) {
+    const Factor *fn = fx->factors[n];
+    fn->support(fn, tol, D, lo, hi);
+  }
+}
+
 /* Product_resize(): handle resizes of the product factor.
  *  - see factor_resize_fn() for more information.
  */
@@ -456,8 +545,13 @@ FACTOR_KERNEL (Product) {
     fstr[n] = factor_kernel(fn, pn);
 
     /* check for failure. */
-    if (!fstr[n])
+    if (!fstr[n]) {
+      while (n--)
+        free(fstr[n]);
+
+      free(fstr);
       return NULL;
+    }
 
     /* advance the sub-factor parameter offset. */
     pn += fn->P;
@@ -470,8 +564,13 @@ FACTOR_KERNEL (Product) {
 
   /* allocate the kernel code string. */
   char *kstr = malloc(len);
-  if (!kstr)
+  if (!kstr) {
+    for (size_t n = 0; n < fx->F; n++)
+      free(fstr[n]);
+
+    free(fstr);
     return NULL;
+  }
 
   /* write the header. */
   char *pos = kstr;
@@ -560,7 +659,6 @@ FACTOR_COPY (Product) {
   /* copy each factor into the duplicate factor array. */
   for (size_t i = 0; i < F; i++) {
     fdupx->factors[i] = factor_copy(fx->factors[i]);
-    Py_XINCREF(fdupx->factors[i]);
     if (!fdupx->factors[i])
       return 0;
   }
@@ -569,6 +667,69 @@ FACTOR_COPY (Product) {
   return 1;
 }
 
+/* Product_pack(): write the sub-factors of a product factor into
+ * a packed buffer.
+ *  - see factor_pack_fn() for more information.
+ */
+FACTOR_PACK (Product) {
+  /* get the extended structure pointer. */
+  Product *fx = (Product*) f;
+
+  /* write the factor count. */
+  if (!pack_write_size(pk, fx->F))
+    return 0;
+
+  /* write each factor. */
+  for (size_t i = 0; i < fx->F; i++) {
+    if (!factor_pack(fx->factors[i], pk))
+      return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* Product_unpack(): read the sub-factors of a product factor from
+ * a packed buffer.
+ *  - see factor_unpack_fn() for more information.
+ */
+FACTOR_UNPACK (Product) {
+  /* get the extended structure pointer. */
+  Product *fx = (Product*) f;
+
+  /* read the factor count. */
+  size_t F;
+  if (!pack_read_size(pk, &F) || F > pk->len - pk->pos)
+    return 0;
+
+  /* allocate the factor array. */
+  Factor **factors = malloc((F ? F : 1) * sizeof(Factor*));
+  if (!factors)
+    return 0;
+
+  /* release any existing factors and store the new array. */
+  for (size_t i = 0; i < fx->F; i++)
+    Py_XDECREF(fx->factors[i]);
+
+  free(fx->factors);
+  fx->factors = factors;
+  fx->F = F;
+
+  /* initialize the factor array. */
+  for (size_t i = 0; i < F; i++)
+    fx->factors[i] = NULL;
+
+  /* read each factor. */
+  for (size_t i = 0; i < F; i++) {
+    fx->factors[i] = factor_unpack(pk);
+    if (!fx->factors[i])
+      return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
 /* Product_free(): free extra information from product factors.
  *  - see factor_free_fn() for more information.
  */
@@ -620,6 +781,12 @@ Product_seq_get (Product *self, Py_ssize_t i) {
  */
 static PyObject*
 Product_method_update (PyObject *self, PyObject *args) {
+  /* the factor may not be modified while it is in use. */
+  if (((Factor*) self)->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "factor is in use");
+    return NULL;
+  }
+
   /* call the product factor update function. */
   product_update(self);
   Py_RETURN_NONE;
@@ -650,15 +817,20 @@ VFL_TYPE_NEW (Product) {
   f->eval      = Product_eval;
   f->mean      = Product_mean;
   f->var       = Product_var;
+  f->mean_all  = Product_mean_all;
+  f->var_all   = Product_var_all;
   f->cov       = Product_cov;
   f->diff_mean = Product_diff_mean;
   f->diff_var  = Product_diff_var;
   f->meanfield = Product_meanfield;
   f->div       = Product_div;
+  f->support   = Product_support;
   f->resize    = Product_resize;
   f->kernel    = Product_kernel;
   f->set       = Product_set;
   f->copy      = Product_copy;
+  f->pack      = Product_pack;
+  f->unpack    = Product_unpack;
   f->free      = Product_free;
 
   /* resize to the default size. */
@@ -2,6 +2,9 @@
 /* include the vfl header. */
 #include <vfl/vfl.h>
 
+/* include c library headers. */
+#include <float.h>
+
 /* model_kmax(): determine the maximum weight count from an array
  * of factors.
  *
@@ -47,13 +50,49 @@ model_tmp (Factor **fv, size_t P, size_t M, size_t K, size_t Knew) {
    *  z: (K, 1)         | b: (max(k), 1)
    *  U: (max(k), K)    | B: (max(k), max(k))
    *  V: (max(k), K)    |
+   *  Zu: (max(k), K)   |
+   *  Zv: (max(k), K)   |
+   *  Cu: (max(k), max(k))
+   *  Cv: (max(k), max(k))
+   *  T: (max(k), max(k))
    */
-  const size_t ntmp = K + P + 2 * Kmax * K;
+  const size_t ntmp = K + P + 4 * Kmax * K + 3 * Kmax * Kmax;
 
   /* return the computed scalar count. */
   return ntmp;
 }
 
+/* model_moments_free(): free the batched moment buffers of a model.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ */
+static void model_moments_free (Model *mdl) {
+  /* free the matrices. */
+  matrix_free(mdl->Phi);
+  matrix_free(mdl->Psi);
+  mdl->Phi = mdl->Psi = NULL;
+
+  /* free the vectors. */
+  vector_free(mdl->hc);
+  vector_free(mdl->Gc);
+  vector_free(mdl->vc);
+  mdl->hc = mdl->Gc = mdl->vc = NULL;
+
+  /* free the excess moment blocks. */
+  for (size_t j = 0; mdl->Omega && j < mdl->M; j++)
+    matrix_free(mdl->Omega[j]);
+
+  /* free the cache arrays. */
+  free(mdl->Omega);
+  free(mdl->mver);
+  free(mdl->over);
+  free(mdl->oused);
+  mdl->Omega = NULL;
+  mdl->mver = mdl->over = mdl->oused = NULL;
+  mdl->mdat = NULL;
+}
+
 /* model_internal_refresh(): refresh the internal state of a model.
  *
  * arguments:
@@ -135,6 +174,11 @@ model_internal_refresh (Model *mdl, size_t D, size_t P, size_t M, size_t K,
   matrix_free(mdl->Sinv);
   matrix_free(mdl->L);
 
+  /* free the batched moment buffers, which are sized by the weight
+   * count and will be reallocated on their next use.
+   */
+  model_moments_free(mdl);
+
   /* set the new factor array. */
   mdl->factors = factors;
   mdl->priors = priors;
@@ -155,6 +199,9 @@ model_internal_refresh (Model *mdl, size_t D, size_t P, size_t M, size_t K,
   mdl->M = M;
   mdl->K = K;
 
+  /* the weight posterior must be inferred again. */
+  mdl->iver = 0;
+
   /* return success. */
   return 1;
 
@@ -193,8 +240,11 @@ void Model_reset (Model *mdl) {
   mdl->init      = NULL;
   mdl->bound     = NULL;
   mdl->predict   = NULL;
+  mdl->predict_moments = NULL;
   mdl->infer     = NULL;
   mdl->update    = NULL;
+  mdl->observe   = NULL;
+  mdl->step      = NULL;
   mdl->gradient  = NULL;
   mdl->meanfield = NULL;
 
@@ -226,15 +276,40 @@ void Model_reset (Model *mdl) {
   mdl->L = NULL;
   mdl->h = NULL;
 
+  /* initialize the batched moment buffers. */
+  mdl->Phi = mdl->Psi = NULL;
+  mdl->hc = mdl->Gc = mdl->vc = NULL;
+
+  /* initialize the moment cache. */
+  mdl->mver = mdl->over = mdl->oused = NULL;
+  mdl->mdat = NULL;
+  mdl->mdver = 0;
+  mdl->Omega = NULL;
+  mdl->opass = 0;
+  mdl->budget = MODEL_CACHE_BUDGET;
+
+  /* initialize the support tolerance. */
+  mdl->stol = 0.0;
+
   /* initialize the prior and posterior factor arrays. */
   mdl->factors = NULL;
   mdl->priors = NULL;
 
-  /* initialize the associated dataset. */
+  /* initialize the associated dataset and inference state. */
   mdl->dat = NULL;
+  mdl->iver = 0;
+  mdl->ifver = 0;
 
   /* initialize the temporary vector. */
   mdl->tmp = NULL;
+
+  /* initialize the file mapping. */
+  mdl->map = NULL;
+  mdl->maplen = 0;
+
+  /* initialize the computation state. */
+  mdl->busy = 0;
+  mdl->excl = 0;
 }
 
 /* model_set_alpha0(): set the noise precision shape-prior of a model.
@@ -254,6 +329,7 @@ int model_set_alpha0 (Model *mdl, double alpha0) {
   /* store the parameter and return success. */
   mdl->alpha = mdl->alpha0 = alpha0;
   mdl->tau = mdl->alpha / mdl->beta;
+  mdl->iver = 0;
   return 1;
 }
 
@@ -274,6 +350,7 @@ int model_set_beta0 (Model *mdl, double beta0) {
   /* store the parameter and return success. */
   mdl->beta = mdl->beta0 = beta0;
   mdl->tau = mdl->alpha / mdl->beta;
+  mdl->iver = 0;
   return 1;
 }
 
@@ -293,6 +370,7 @@ int model_set_nu (Model *mdl, double nu) {
 
   /* store the parameter and return success. */
   mdl->nu = nu;
+  mdl->iver = 0;
   return 1;
 }
 
@@ -360,10 +438,11 @@ int model_set_data (Model *mdl, Data *dat) {
   /* initialize the logistic parameters. */
   vector_set_all(mdl->xi, 1.0);
 
-  /* store the new dataset. */
+  /* store the new dataset, which must be inferred. */
   Py_XDECREF(mdl->dat);
   Py_INCREF(dat);
   mdl->dat = dat;
+  mdl->iver = 0;
 
   /* return succes. */
   return 1;
@@ -486,6 +565,156 @@ int model_clear_factors (Model *mdl) {
   return model_internal_refresh(mdl, 0, 0, 0, 0, 0);
 }
 
+/* model_copy(): create an independent replica of a model, having
+ * copies of its factors, priors, noise parameters and weight posterior.
+ * the replica shares the (read-only) dataset of the model.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to copy.
+ *
+ * returns:
+ *  pointer to a new model, or null on failure.
+ */
+Model *model_copy (const Model *mdl) {
+  /* check the input pointer. */
+  if (!mdl)
+    return NULL;
+
+  /* allocate a new model having the same type. */
+  PyObject *type = (PyObject*) Py_TYPE(mdl);
+  Model *dup = (Model*) PyObject_CallObject(type, NULL);
+  if (!dup) {
+    PyErr_Clear();
+    return NULL;
+  }
+
+  /* copy and add each factor. */
+  for (size_t j = 0; j < mdl->M; j++) {
+    Factor *f = factor_copy(mdl->factors[j]);
+    const int ok = (f && model_add_factor(dup, f));
+    Py_XDECREF(f);
+    if (!ok)
+      goto fail;
+  }
+
+  /* copy and replace each prior. */
+  for (size_t j = 0; j < mdl->M; j++) {
+    Factor *f = factor_copy(mdl->priors[j]);
+    if (!f)
+      goto fail;
+
+    Py_DECREF(dup->priors[j]);
+    dup->priors[j] = f;
+  }
+
+  /* copy the noise parameters, cache budget and support tolerance. */
+  dup->alpha0 = mdl->alpha0;
+  dup->beta0 = mdl->beta0;
+  dup->nu = mdl->nu;
+  dup->alpha = mdl->alpha;
+  dup->beta = mdl->beta;
+  dup->tau = mdl->tau;
+  model_set_budget(dup, mdl->budget);
+  dup->stol = mdl->stol;
+
+  /* copy the weight posterior and intermediates. */
+  if (mdl->K) {
+    vector_copy(dup->wbar, mdl->wbar);
+    matrix_copy(dup->Sigma, mdl->Sigma);
+    matrix_copy(dup->Sinv, mdl->Sinv);
+    matrix_copy(dup->L, mdl->L);
+    vector_copy(dup->h, mdl->h);
+  }
+
+  /* share the dataset, and copy the logistic parameters. */
+  if (mdl->dat) {
+    if (!model_set_data(dup, mdl->dat))
+      goto fail;
+
+    if (mdl->xi && mdl->xi->len == dup->xi->len)
+      vector_copy(dup->xi, mdl->xi);
+  }
+
+  /* return the replica. */
+  return dup;
+
+fail:
+  /* release the replica and return failure. */
+  Py_DECREF(dup);
+  return NULL;
+}
+
+/* model_hold(): mark a model, its factors and its dataset as in use
+ * by a computation that runs without the interpreter lock. computations
+ * that modify the model require that nothing else is using it or its
+ * factors, and all others only require that no such computation is
+ * running.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ *  @excl: whether the computation modifies the model.
+ *
+ * returns:
+ *  integer indicating whether the model was held (1) or whether it
+ *  was in use by a conflicting computation (0).
+ */
+int model_hold (Model *mdl, int excl) {
+  /* check the input pointer. */
+  if (!mdl)
+    return 0;
+
+  /* check for conflicting computations on the model. */
+  if (mdl->excl || (excl && mdl->busy))
+    return 0;
+
+  /* modified factors may not be used by any other model. */
+  for (size_t j = 0; excl && j < mdl->M; j++) {
+    if (mdl->factors[j]->busy)
+      return 0;
+  }
+
+  /* mark the model as in use. */
+  mdl->busy++;
+  mdl->excl = excl;
+
+  /* mark the factors, priors and dataset as in use. */
+  for (size_t j = 0; j < mdl->M; j++) {
+    factor_hold(mdl->factors[j]);
+    factor_hold(mdl->priors[j]);
+  }
+
+  if (mdl->dat)
+    mdl->dat->busy++;
+
+  /* return success. */
+  return 1;
+}
+
+/* model_release(): release a model, its factors and its dataset from
+ * a computation started by model_hold().
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ */
+void model_release (Model *mdl) {
+  /* check the input pointer. */
+  if (!mdl)
+    return;
+
+  /* release the factors, priors and dataset. */
+  for (size_t j = 0; j < mdl->M; j++) {
+    factor_release(mdl->factors[j]);
+    factor_release(mdl->priors[j]);
+  }
+
+  if (mdl->dat)
+    mdl->dat->busy--;
+
+  /* release the model. */
+  mdl->busy--;
+  mdl->excl = 0;
+}
+
 /* model_mean(): return the first moment of a model basis element.
  *
  * arguments:
@@ -573,7 +802,9 @@ double model_cov (const Model *mdl, const Vector *x1, const Vector *x2,
 }
 
 /* model_kernel(): write the covariance kernel function code
- * of a variational feature model.
+ * of a variational feature model. factors without a covariance
+ * function contribute nothing to model covariances, and are
+ * omitted from the code.
  *
  * arguments:
  *  @mdl: model structure pointer to access.
@@ -600,11 +831,16 @@ char *model_kernel (const Model *mdl) {
   for (size_t j = 0, pj = 1; j < mdl->M; j++) {
     /* get the current factor string. */
     const Factor *fj = mdl->factors[j];
-    fstr[j] = factor_kernel(fj, pj);
+    fstr[j] = (fj->cov ? factor_kernel(fj, pj) : calloc(1, 1));
 
     /* check for failure. */
-    if (!fstr[j])
+    if (!fstr[j]) {
+      while (j--)
+        free(fstr[j]);
+
+      free(fstr);
       return NULL;
+    }
 
     /* advance the factor parameter offset. */
     pj += fj->P;
@@ -617,13 +853,21 @@ char *model_kernel (const Model *mdl) {
 
   /* allocate the kernel code string. */
   char *kstr = malloc(len);
-  if (!kstr)
+  if (!kstr) {
+    for (size_t j = 0; j < mdl->M; j++)
+      free(fstr[j]);
+
+    free(fstr);
     return NULL;
+  }
 
   /* write each factor string. */
   char *pos = kstr;
+  *pos = '\0';
   for (size_t j = 0; j < mdl->M; j++) {
-    pos += sprintf(pos, fmt, fstr[j]);
+    if (*fstr[j])
+      pos += sprintf(pos, fmt, fstr[j]);
+
     free(fstr[j]);
   }
 
@@ -733,8 +977,243 @@ int model_eval_all (const Model *mdl, Data *dat) {
   /* loop over each observation. */
   for (size_t i = 0; i < dat->N; i++) {
     /* compute and store the model evaluation. */
-    Datum *di = data_get(dat, i);
-    di->y = model_eval(mdl, di->x, di->p);
+    VectorView x = data_x(dat, i);
+    dat->y[i] = model_eval(mdl, &x, dat->p[i]);
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* MODEL_PREDICT_BLOCK: number of locations processed together by each
+ * thread during batched prediction.
+ */
+#define MODEL_PREDICT_BLOCK 256
+
+/* model_predict_task: structure for holding the shared argument of
+ * parallel batched predictions.
+ */
+typedef struct {
+  /* @mdl: model structure pointer.
+   * @X: (N, D) row-major array of input locations.
+   * @N, @D: number and dimensionality of the locations.
+   * @p: array of output indices, or null to use @p0 everywhere.
+   * @p0: output index used when @p is null.
+   */
+  const Model *mdl;
+  const double *X;
+  size_t N, D;
+  const size_t *p;
+  size_t p0;
+
+  /* @mean, @var: output arrays, either of which may be null.
+   * @ok: per-thread status flags.
+   */
+  double *mean, *var;
+  int *ok;
+}
+model_predict_task;
+
+/* model_predict_moments(): compute the posterior mean and variance of
+ * the latent function of a model at a block of locations, from the
+ * first moments of every basis element and the second moments of the
+ * basis elements within each factor. the variance is computed as the
+ * quadratic form of the weight covariances with the first moments,
+ * plus a correction from each diagonal block of (Sigma + wbar wbar').
+ *
+ * arguments:
+ *  @mdl: model structure pointer.
+ *  @blk: dataset holding the block of locations.
+ *  @Phi: (K, n) matrix for storing first moments.
+ *  @Q: (K, n) matrix for storing intermediate products.
+ *  @v: (n, 1) vector for storing second moments.
+ *  @mu: (n, 1) output array of latent means.
+ *  @eta: (n, 1) output array of latent variances, or null.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int model_predict_moments (const Model *mdl, const Data *blk,
+                                  Matrix *Phi, Matrix *Q, Vector *v,
+                                  double *mu, double *eta) {
+  /* compute the first moments of every basis element. */
+  const size_t n = blk->N;
+  for (size_t j = 0, i = 0; j < mdl->M; j++) {
+    const Factor *f = mdl->factors[j];
+    for (size_t k = 0; k < f->K; k++, i++) {
+      VectorView phi = matrix_row(Phi, i);
+      if (!factor_mean_all(f, blk, k, &phi))
+        return 0;
+    }
+  }
+
+  /* compute the latent means. */
+  for (size_t b = 0; b < n; b++)
+    mu[b] = 0.0;
+
+  for (size_t i = 0; i < mdl->K; i++) {
+    const double wi = vector_get(mdl->wbar, i);
+    const double *phi = Phi->data + i * Phi->stride;
+    for (size_t b = 0; b < n; b++)
+      mu[b] += wi * phi[b];
+  }
+
+  /* return if no variances were requested. */
+  if (!eta)
+    return 1;
+
+  /* compute the quadratic form of the weight covariances. */
+  blas_dgemm(BLAS_NO_TRANS, BLAS_NO_TRANS, 1.0, mdl->Sigma, Phi, 0.0, Q);
+  for (size_t b = 0; b < n; b++)
+    eta[b] = 0.0;
+
+  for (size_t i = 0; i < mdl->K; i++) {
+    const double *phi = Phi->data + i * Phi->stride;
+    const double *q = Q->data + i * Q->stride;
+    for (size_t b = 0; b < n; b++)
+      eta[b] += phi[b] * q[b];
+  }
+
+  /* include the second moments within each factor. */
+  for (size_t j = 0, i0 = 0; j < mdl->M; i0 += mdl->factors[j++]->K) {
+    const Factor *f = mdl->factors[j];
+    for (size_t k1 = 0; k1 < f->K; k1++) {
+      for (size_t k2 = k1; k2 < f->K; k2++) {
+        /* compute the second moments of the basis element pair. */
+        if (!factor_var_all(f, blk, k1, k2, v))
+          return 0;
+
+        /* get the coefficient of the pair. */
+        const size_t i1 = i0 + k1, i2 = i0 + k2;
+        const double a = (k1 == k2 ? 1.0 : 2.0) *
+          (matrix_get(mdl->Sigma, i1, i2) +
+           vector_get(mdl->wbar, i1) * vector_get(mdl->wbar, i2));
+
+        /* include the excess of the second moments over the
+         * products of first moments.
+         */
+        const double *phi1 = Phi->data + i1 * Phi->stride;
+        const double *phi2 = Phi->data + i2 * Phi->stride;
+        for (size_t b = 0; b < n; b++)
+          eta[b] += a * (vector_get(v, b) - phi1[b] * phi2[b]);
+      }
+    }
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* model_predict_thread(): compute the predictions at the locations
+ * assigned to a single thread, one block at a time.
+ *  - see thread_fn() for more information.
+ */
+static void model_predict_thread (void *arg, size_t tid, size_t T) {
+  /* get the task structure and the range of locations. */
+  model_predict_task *task = (model_predict_task*) arg;
+  const Model *mdl = task->mdl;
+  const size_t K = mdl->K;
+  const size_t B = MODEL_PREDICT_BLOCK;
+  size_t i0, i1;
+  thread_range(task->N, tid, T, &i0, &i1);
+
+  /* allocate the block buffers. */
+  task->ok[tid] = 0;
+  double *buf = malloc(((2 * K + 3) * B) * sizeof(double));
+  size_t *p = malloc(B * sizeof(size_t));
+  if (!buf || !p) {
+    free(buf);
+    free(p);
+    return;
+  }
+
+  /* partition the buffers. */
+  double *mu = buf + 2 * K * B;
+  double *eta = mu + B;
+  double *vdata = eta + B;
+  for (size_t b = 0; b < B; b++)
+    p[b] = task->p0;
+
+  /* determine whether the latent moments may be used. */
+  const int batched = (mdl->predict_moments && K);
+
+  /* loop over the blocks of locations. */
+  int ok = 1;
+  for (size_t ib = i0; ib < i1 && ok; ib += B) {
+    /* build a dataset holding the block of locations. */
+    const size_t n = (ib + B < i1 ? B : i1 - ib);
+    Data blk;
+    memset(&blk, 0, sizeof(Data));
+    blk.N = blk.cap = n;
+    blk.D = task->D;
+    blk.X = (double*) task->X + ib * task->D;
+    blk.p = (task->p ? (size_t*) task->p + ib : p);
+
+    /* get the output arrays for the block. */
+    double *mean = (task->mean ? task->mean + ib : NULL);
+    double *var = (task->var ? task->var + ib : NULL);
+
+    /* without latent moments, predict at each location. */
+    if (!batched) {
+      for (size_t b = 0; b < n && ok; b++) {
+        double mb, vb;
+        VectorView x = data_x(&blk, b);
+        ok = model_predict(mdl, &x, blk.p[b], &mb, &vb);
+        if (mean) mean[b] = mb;
+        if (var)  var[b] = vb;
+      }
+
+      continue;
+    }
+
+    /* compute the latent moments of the block. */
+    MatrixView Phi = matrix_view_array(buf, K, n);
+    MatrixView Q = matrix_view_array(buf + K * B, K, n);
+    VectorView v = vector_view_array(vdata, n);
+    ok = model_predict_moments(mdl, &blk, &Phi, &Q, &v,
+                               mu, var ? eta : NULL);
+
+    /* compute the predictions from the latent moments. */
+    for (size_t b = 0; b < n && ok; b++) {
+      double mb, vb;
+      mdl->predict_moments(mdl, mu[b], var ? eta[b] : 0.0, &mb, &vb);
+      if (mean) mean[b] = mb;
+      if (var)  var[b] = vb;
+    }
+  }
+
+  /* free the block buffers and store the status. */
+  free(buf);
+  free(p);
+  task->ok[tid] = ok;
+}
+
+/* model_predict_batch(): compute model posterior predictions at a set
+ * of locations in parallel. models that compute predictions from the
+ * moments of their latent function are evaluated in blocks, and all
+ * others are evaluated one location at a time.
+ *
+ * arguments:
+ *  @task: prediction task, without thread status flags.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int model_predict_batch (model_predict_task *task) {
+  /* check that the model is able to predict. */
+  if (!task->mdl->predict || task->D < task->mdl->D)
+    return 0;
+
+  /* execute the prediction over blocks of locations in parallel. */
+  const size_t T = thread_plan(task->N, MODEL_PREDICT_BLOCK);
+  int ok[T];
+  task->ok = ok;
+  thread_execute(model_predict_thread, task, T);
+
+  /* check the status of each thread. */
+  for (size_t t = 0; t < T; t++) {
+    if (!ok[t])
+      return 0;
   }
 
   /* return success. */
@@ -756,10 +1235,8 @@ int model_eval_all (const Model *mdl, Data *dat) {
  */
 int model_predict_all (const Model *mdl, Data *mean, Data *var) {
   /* declare required variables:
-   *  @mu, @eta: individual means and variances.
    *  @xdata: dataset used for predictions.
    */
-  double mu, eta;
   Data *xdata;
 
   /* check the input pointers. */
@@ -782,19 +1259,42 @@ int model_predict_all (const Model *mdl, Data *mean, Data *var) {
   if (xdata->D != mdl->D)
     return 0;
 
-  /* loop over each observation. */
-  for (size_t i = 0; i < xdata->N; i++) {
-    /* compute the posterior mean and variance. */
-    Datum *xdatum = data_get(xdata, i);
-    model_predict(mdl, xdatum->x, xdatum->p, &mu, &eta);
+  /* compute the predictions. */
+  model_predict_task task = {
+    mdl, xdata->X, xdata->N, xdata->D, xdata->p, 0,
+    mean ? mean->y : NULL,
+    var ? var->y : NULL,
+    NULL
+  };
 
-    /* store the predictions. */
-    if (mean) mean->data[i].y = mu;
-    if (var)  var->data[i].y = eta;
-  }
+  return model_predict_batch(&task);
+}
 
-  /* return success. */
-  return 1;
+/* model_predict_array(): return model posterior predictions at each
+ * row of a matrix of locations, all having the same output index.
+ *
+ * arguments:
+ *  @mdl: model structure pointer.
+ *  @X: matrix of input locations, one per row.
+ *  @p: function output index.
+ *  @mean: output array of predicted means, or null.
+ *  @var: output array of predicted variances, or null.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_predict_array (const Model *mdl, const Matrix *X, size_t p,
+                         double *mean, double *var) {
+  /* check the input pointers and the location layout. */
+  if (!mdl || !X || X->stride != X->cols)
+    return 0;
+
+  /* compute the predictions. */
+  model_predict_task task = {
+    mdl, X->data, X->rows, X->cols, NULL, p, mean, var, NULL
+  };
+
+  return model_predict_batch(&task);
 }
 
 /* model_reset(): reset the factor parameters of a model to those
@@ -823,6 +1323,28 @@ int model_reset (Model *mdl) {
   return model_infer(mdl);
 }
 
+/* model_factor_version(): get the latest version among the factors
+ * of a model, which changes whenever any factor changes.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to access.
+ *
+ * returns:
+ *  latest factor version of the model.
+ */
+static size_t model_factor_version (const Model *mdl) {
+  /* find the latest version. */
+  size_t ver = 0;
+  for (size_t j = 0; j < mdl->M; j++) {
+    const size_t vj = factor_version(mdl->factors[j]);
+    if (vj > ver)
+      ver = vj;
+  }
+
+  /* return the version. */
+  return ver;
+}
+
 /* model_infer(): fully update the nuisance parameters of a model.
  *  - see model_infer_fn() for more information.
  */
@@ -836,7 +1358,14 @@ int model_infer (Model *mdl) {
     return 0;
 
   /* execute the assigned inference function. */
-  return mdl->infer(mdl);
+  const int ok = mdl->infer(mdl);
+
+  /* store the inference state. */
+  mdl->iver = (ok && mdl->dat ? mdl->dat->ver : 0);
+  mdl->ifver = model_factor_version(mdl);
+
+  /* return the result. */
+  return ok;
 }
 
 /* model_update(): efficiently update the nuisance parameters of a model.
@@ -847,6 +1376,9 @@ int model_update (Model *mdl, size_t j) {
   if (!mdl || j >= mdl->M)
     return 0;
 
+  /* the weight posterior is no longer completely inferred. */
+  mdl->iver = 0;
+
   /* if an update function is assigned, execute it. */
   if (mdl->update && mdl->update(mdl, j))
     return 1;
@@ -859,6 +1391,115 @@ int model_update (Model *mdl, size_t j) {
   return 0;
 }
 
+/* model_observe_index(): locate an observation within a sorted dataset,
+ * as placed by data_augment() after all equal observations.
+ *
+ * arguments:
+ *  @dat: dataset structure pointer to access.
+ *  @d: observation to locate.
+ *
+ * returns:
+ *  index of the last observation that compares equal to @d.
+ */
+static size_t model_observe_index (const Data *dat, const Datum *d) {
+  /* bisect for the first observation greater than the datum. */
+  size_t a = 0, b = dat->N;
+  while (a < b) {
+    const size_t m = a + (b - a) / 2;
+    if (data_cmp(dat, m, d->p, d->x) <= 0)
+      a = m + 1;
+    else
+      b = m;
+  }
+
+  /* return the index of the preceding observation. */
+  return (a ? a - 1 : 0);
+}
+
+/* model_observe(): add a single observation into the dataset of a model
+ * and efficiently update its nuisance parameters to include it. models
+ * without an assigned observe function, and models whose posterior was
+ * not completely inferred from the current dataset and factors, are
+ * fully re-inferred.
+ *
+ * arguments:
+ *  @mdl: model structure pointer.
+ *  @d: observation to add.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_observe (Model *mdl, const Datum *d) {
+  /* check the input pointers. */
+  if (!mdl || !mdl->dat || !mdl->xi || !d || !d->x)
+    return 0;
+
+  /* check the observation dimensionality. */
+  if (mdl->D && d->x->len < mdl->D)
+    return 0;
+
+  /* check whether the posterior may be updated in place. */
+  Data *dat = mdl->dat;
+  const int current = (mdl->iver == dat->ver &&
+                       mdl->ifver == model_factor_version(mdl) &&
+                       mdl->xi->len == dat->N);
+
+  /* reserve a logistic parameter for the new observation, so that
+   * the dataset is only modified once the model can follow it.
+   */
+  Vector *xi = realloc(mdl->xi, vector_bytes(dat->N + 1));
+  if (!xi)
+    return 0;
+
+  mdl->xi = xi;
+
+  /* add the observation into the dataset. */
+  if (!data_augment(dat, d))
+    return 0;
+
+  /* insert a logistic parameter for the new observation, or reset
+   * every parameter if they no longer match the dataset.
+   */
+  const size_t N = dat->N;
+  const size_t i = model_observe_index(dat, d);
+  const size_t len = xi->len;
+  vector_init(xi, N);
+  if (len == N - 1) {
+    memmove(xi->data + i + 1, xi->data + i, (N - i - 1) * sizeof(double));
+    vector_set(xi, i, 1.0);
+  }
+  else
+    vector_set_all(xi, 1.0);
+
+  /* if an observe function is assigned, execute it. */
+  if (current && mdl->observe && mdl->K && mdl->observe(mdl, i)) {
+    mdl->iver = dat->ver;
+    return 1;
+  }
+
+  /* fall back to complete inference. */
+  return model_infer(mdl);
+}
+
+/* model_step(): stochastically update the nuisance parameters of a model.
+ *  - see model_step_fn() for more information.
+ */
+int model_step (Model *mdl, size_t N, double rho) {
+  /* check the input pointers and arguments. */
+  if (!mdl || !mdl->dat || !mdl->dat->N || rho <= 0.0 || rho > 1.0)
+    return 0;
+
+  /* check the function pointer. */
+  if (!mdl->step)
+    return 0;
+
+  /* the weight posterior is no longer completely inferred. */
+  mdl->iver = 0;
+
+  /* execute the assigned step function. */
+  return mdl->step(mdl, N, rho);
+}
+
 /* model_gradient(): return the gradient of the lower bound.
  *  - see model_gradient_fn() for more information.
  */
@@ -883,57 +1524,240 @@ int model_gradient (const Model *mdl, size_t i, size_t j, Vector *grad) {
   return mdl->gradient(mdl, i, j, grad);
 }
 
-/* model_meanfield(): perform an assumed-density mean-field factor update.
+/* model_gradient_task: structure for holding the shared argument of
+ * parallel gradient computations.
+ */
+typedef struct {
+  /* @mdl: model structure pointer.
+   * @j: index of the factor to differentiate.
+   * @idx: observations within the support of the factor, or null.
+   * @n: number of observations to accumulate.
+   */
+  const Model *mdl;
+  size_t j;
+  const size_t *idx;
+  size_t n;
+
+  /* @G: per-thread gradient accumulators.
+   * @ok: per-thread status flags.
+   */
+  Matrix *G;
+  int *ok;
+}
+model_gradient_task;
+
+/* model_gradient_thread(): accumulate the gradient of the lower bound
+ * over the observations assigned to a single thread.
+ *  - see thread_fn() for more information.
+ */
+static void model_gradient_thread (void *arg, size_t tid, size_t T) {
+  /* get the task structure and the range of observations. */
+  model_gradient_task *task = (model_gradient_task*) arg;
+  size_t i0, i1;
+  thread_range(task->n, tid, T, &i0, &i1);
+
+  /* accumulate the gradients of each observation. */
+  VectorView g = matrix_row(task->G, tid);
+  vector_set_zero(&g);
+  task->ok[tid] = 1;
+  for (size_t i = i0; i < i1; i++) {
+    const size_t ii = (task->idx ? task->idx[i] : i);
+    task->ok[tid] &= model_gradient(task->mdl, ii, task->j, &g);
+  }
+}
+
+/* model_gradient_all(): return the gradient of the lower bound, summed
+ * over every observation in the dataset, or over the observations
+ * within the support of the factor. observations are divided among
+ * threads, and the per-thread gradients are summed in thread order.
  *
  * arguments:
  *  @mdl: model structure pointer.
- *  @j: index of the factor to update.
+ *  @j: index of the factor to differentiate.
+ *  @grad: output gradient vector.
  *
  * returns:
  *  integer indicating success (1) or failure (0).
  */
-int model_meanfield (const Model *mdl, size_t j) {
+int model_gradient_all (const Model *mdl, size_t j, Vector *grad) {
   /* check the input pointers and factor index. */
-  if (!mdl || !mdl->dat || j >= mdl->M)
+  if (!mdl || !mdl->dat || !grad || j >= mdl->M)
     return 0;
 
-  /* gain access to the factor and its number of weights and parameters. */
-  Factor *f = mdl->factors[j];
-  const size_t K = f->K;
-  const size_t P = f->P;
-
   /* check if the factor has no parameters. */
+  const size_t P = mdl->factors[j]->P;
   if (P == 0)
     return 1;
 
-  /* check the model and factor function pointers. */
-  if (!mdl->meanfield || !f->meanfield)
+  /* check the gradient size and function pointer. */
+  if (grad->len != P || !mdl->gradient)
     return 0;
 
-  /* gain access to the associated prior. */
-  const Factor *fp = mdl->priors[j];
-
-  /* create sets of coefficients for mean-field updates. */
-  VectorView b = vector_view_array(mdl->tmp->data, K);
-  MatrixView B = matrix_view_array(mdl->tmp->data + K, K, K);
-
-  /* initialize the factor update. */
-  if (!f->meanfield(f, NULL, NULL, NULL, NULL))
+  /* locate the observations within the support of the factor. */
+  size_t *idx, n;
+  if (!model_support(mdl, j, &idx, &n))
     return 0;
 
-  /* loop over each data point. */
-  Datum *di = mdl->dat->data;
+  /* allocate the per-thread accumulators. */
+  const size_t T = thread_plan(n, THREAD_GRAIN);
+  Matrix *G = matrix_alloc(T, P);
+  if (!G) {
+    free(idx);
+    return 0;
+  }
+
+  /* compute the per-thread gradients. */
+  int ok[T];
+  model_gradient_task task = { mdl, j, idx, n, G, ok };
+  thread_execute(model_gradient_thread, &task, T);
+  free(idx);
+
+  /* sum the per-thread gradients in order. */
+  int status = 1;
+  vector_set_zero(grad);
+  for (size_t t = 0; t < T; t++) {
+    VectorView g = matrix_row(G, t);
+    vector_add(grad, &g);
+    status = status && ok[t];
+  }
+
+  /* free the accumulators and return. */
+  matrix_free(G);
+  return status;
+}
+
+/* MODEL_MEANFIELD_BUFFER: maximum number of scalars used to buffer
+ * mean-field coefficients between their (parallel) computation and
+ * their (sequential) streaming to the updated factor.
+ */
+#define MODEL_MEANFIELD_BUFFER 1048576
+
+/* model_meanfield_task: structure for holding the shared argument of
+ * parallel mean-field coefficient computations.
+ */
+typedef struct {
+  /* @mdl: model structure pointer.
+   * @j: index of the factor to update.
+   */
+  const Model *mdl;
+  size_t j;
+
+  /* @i0: index of the first observation in the current block.
+   * @n: number of observations in the current block.
+   * @buf: coefficient buffer of the current block.
+   */
+  size_t i0, n;
+  double *buf;
+}
+model_meanfield_task;
+
+/* model_meanfield_thread(): compute the mean-field coefficients of the
+ * observations assigned to a single thread.
+ *  - see thread_fn() for more information.
+ */
+static void model_meanfield_thread (void *arg, size_t tid, size_t T) {
+  /* get the task structure and the range of observations. */
+  model_meanfield_task *task = (model_meanfield_task*) arg;
+  const size_t K = task->mdl->factors[task->j]->K;
+  size_t i0, i1;
+  thread_range(task->n, tid, T, &i0, &i1);
+
+  /* compute the coefficients of each observation. */
+  for (size_t i = i0; i < i1; i++) {
+    double *bi = task->buf + i * (K + K * K);
+    VectorView b = vector_view_array(bi, K);
+    MatrixView B = matrix_view_array(bi + K, K, K);
+    task->mdl->meanfield(task->mdl, task->i0 + i, task->j, &b, &B);
+  }
+}
+
+/* model_meanfield(): perform an assumed-density mean-field factor update.
+ * the coefficients of each block of observations are computed in
+ * parallel, and then streamed to the factor in observation order.
+ *
+ * arguments:
+ *  @mdl: model structure pointer.
+ *  @j: index of the factor to update.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_meanfield (const Model *mdl, size_t j) {
+  /* check the input pointers and factor index. */
+  if (!mdl || !mdl->dat || j >= mdl->M)
+    return 0;
+
+  /* gain access to the factor and its number of weights and parameters. */
+  Factor *f = mdl->factors[j];
+  const size_t K = f->K;
+  const size_t P = f->P;
+
+  /* check if the factor has no parameters. */
+  if (P == 0)
+    return 1;
+
+  /* check the model and factor function pointers. */
+  if (!mdl->meanfield || !f->meanfield)
+    return 0;
+
+  /* gain access to the associated prior. */
+  const Factor *fp = mdl->priors[j];
+
+  /* determine the number of observations per block. */
   const size_t N = mdl->dat->N;
-  for (size_t i = 0; i < N; i++, di++) {
-    /* 1. compute the coefficients of the data point.
-     * 2. stream the data point and coefficients to the factor.
+  const size_t nc = K + K * K;
+  size_t nblk = MODEL_MEANFIELD_BUFFER / nc;
+  nblk = (nblk < 1 ? 1 : nblk);
+  nblk = (nblk > N ? N : nblk);
+
+  /* allocate the coefficient buffer. */
+  double *buf = malloc((nblk ? nblk : 1) * nc * sizeof(double));
+  if (!buf)
+    return 0;
+
+  /* initialize the factor update. */
+  uint64_t t0 = FACTOR_PROFILE_START();
+  const int ok = f->meanfield(f, NULL, NULL, NULL, NULL);
+  FACTOR_PROFILE_STOP(f, FACTOR_OP_MEANFIELD, t0);
+  if (!ok) {
+    free(buf);
+    return 0;
+  }
+
+  /* loop over each block of data points. */
+  model_meanfield_task task = { mdl, j, 0, 0, buf };
+  for (size_t i0 = 0; i0 < N; i0 += nblk) {
+    /* 1. compute the coefficients of the block in parallel. */
+    task.i0 = i0;
+    task.n = (i0 + nblk < N ? nblk : N - i0);
+    thread_execute(model_meanfield_thread, &task,
+                   thread_plan(task.n, THREAD_GRAIN));
+
+    /* 2. stream the data points and coefficients to the factor,
+     *    using a datum structure that is never exposed to python.
      */
-    mdl->meanfield(mdl, i, j, &b, &B);
-    f->meanfield(f, fp, di, &b, &B);
+    for (size_t i = 0; i < task.n; i++) {
+      VectorView x = data_x(mdl->dat, i0 + i);
+      Datum di;
+      di.p = mdl->dat->p[i0 + i];
+      di.x = &x;
+      di.y = mdl->dat->y[i0 + i];
+
+      double *bi = buf + i * nc;
+      VectorView b = vector_view_array(bi, K);
+      MatrixView B = matrix_view_array(bi + K, K, K);
+      t0 = FACTOR_PROFILE_START();
+      f->meanfield(f, fp, &di, &b, &B);
+      FACTOR_PROFILE_STOP(f, FACTOR_OP_MEANFIELD, t0);
+    }
   }
 
   /* finalize the factor update. */
-  return f->meanfield(f, fp, NULL, NULL, NULL);
+  free(buf);
+  t0 = FACTOR_PROFILE_START();
+  const int ret = f->meanfield(f, fp, NULL, NULL, NULL);
+  FACTOR_PROFILE_STOP(f, FACTOR_OP_MEANFIELD, t0);
+  return ret;
 }
 
 /* --- */
@@ -963,6 +1787,972 @@ size_t model_weight_idx (const Model *mdl, size_t j, size_t k) {
   return idx + k;
 }
 
+/* model_set_support_tol(): set the tolerance below which the moments
+ * of factors having compact support are treated as zero, discarding
+ * any cached moments.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ *  @tol: new tolerance, in [0, 1).
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_set_support_tol (Model *mdl, double tol) {
+  /* check the input arguments. */
+  if (!mdl || !(tol >= 0.0 && tol < 1.0))
+    return 0;
+
+  /* mark every cached moment as stale. */
+  for (size_t j = 0; mdl->mver && j < mdl->M; j++)
+    mdl->mver[j] = mdl->over[j] = 0;
+
+  /* store the tolerance and return success. */
+  mdl->stol = tol;
+  return 1;
+}
+
+/* MODEL_SUPPORT_DENSE: inverse of the fraction of observations above
+ * which a factor is evaluated at every observation of the dataset,
+ * rather than only at those within its support.
+ */
+#define MODEL_SUPPORT_DENSE 4
+
+/* model_support(): locate the observations within the effective support
+ * of a model factor, using the support tolerance of the model.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to access.
+ *  @j: model factor index.
+ *  @idx: pointer to the output array of observation indices, in
+ *        increasing order, or null if the factor must be evaluated
+ *        at every observation. the caller must free the array.
+ *  @n: pointer to the output number of observations.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_support (const Model *mdl, size_t j, size_t **idx, size_t *n) {
+  /* default to every observation. */
+  const size_t N = mdl->dat->N, D = mdl->dat->D;
+  *idx = NULL;
+  *n = N;
+
+  /* check if the support tolerance is enabled. */
+  if (!(mdl->stol > 0.0) || N == 0)
+    return 1;
+
+  /* compute the support of the factor. */
+  double lo[D ? D : 1], hi[D ? D : 1];
+  if (!factor_support(mdl->factors[j], mdl->stol, D, lo, hi))
+    return 1;
+
+  /* locate the observations within the support. */
+  size_t len;
+  size_t *list = data_index_box(mdl->dat, lo, hi, &len);
+  if (!list)
+    return 0;
+
+  /* fall back to every observation for widely supported factors. */
+  if (len > N / MODEL_SUPPORT_DENSE) {
+    free(list);
+    return 1;
+  }
+
+  /* return the located observations. */
+  *idx = list;
+  *n = len;
+  return 1;
+}
+
+/* model_support_range(): find the positions within a sorted array of
+ * observation indices that fall within a range of observations.
+ *
+ * arguments:
+ *  @idx: sorted array of observation indices.
+ *  @n: length of the array.
+ *  @i0, @i1: range of observations, [i0, i1).
+ *  @c0, @c1: pointers to the output range of positions.
+ */
+static void model_support_range (const size_t *idx, size_t n,
+                                 size_t i0, size_t i1,
+                                 size_t *c0, size_t *c1) {
+  /* bisect the array for each end of the range. */
+  const size_t ends[2] = { i0, i1 };
+  size_t *out[2] = { c0, c1 };
+  for (size_t e = 0; e < 2; e++) {
+    size_t a = 0, b = n;
+    while (a < b) {
+      const size_t m = a + (b - a) / 2;
+      if (idx[m] < ends[e])
+        a = m + 1;
+      else
+        b = m;
+    }
+
+    *out[e] = a;
+  }
+}
+
+/* MODEL_GRAM_BLOCK: number of precision matrix rows computed by each
+ * matrix-matrix product during batched precision construction.
+ */
+#define MODEL_GRAM_BLOCK 32
+
+/* model_moments_task: structure for holding the shared argument of
+ * parallel moment computations.
+ */
+typedef struct {
+  /* @mdl: model structure pointer.
+   * @stale: flags indicating the factors whose moments are computed.
+   * @sidx: observations within the support of each factor, or null.
+   * @sn: number of observations within the support of each factor.
+   * @ok: per-thread status flags.
+   */
+  Model *mdl;
+  const char *stale;
+  size_t **sidx, *sn;
+  int *ok;
+}
+model_moments_task;
+
+/* model_moments_thread(): compute the first moments of every basis
+ * element of the stale factors, at the observations assigned to a
+ * single thread.
+ *  - see thread_fn() for more information.
+ */
+static void model_moments_thread (void *arg, size_t tid, size_t T) {
+  /* get the task structure and the range of observations. */
+  model_moments_task *task = (model_moments_task*) arg;
+  Model *mdl = task->mdl;
+  size_t i0, i1;
+  thread_range(mdl->dat->N, tid, T, &i0, &i1);
+
+  /* create a view of the assigned observations. */
+  const Data dat = data_view(mdl->dat, i0, i1 - i0);
+  task->ok[tid] = 1;
+
+  /* loop over the factors. */
+  for (size_t j = 0, i = 0; j < mdl->M; j++) {
+    /* skip factors having cached moments. */
+    const Factor *f = mdl->factors[j];
+    if (!task->stale[j]) {
+      i += f->K;
+      continue;
+    }
+
+    /* compute the moments of each weight of the current factor. */
+    const size_t *idx = task->sidx[j];
+    for (size_t k = 0; k < f->K; k++, i++) {
+      VectorView row = matrix_row(mdl->Phi, i);
+      VectorView phi = vector_subvector(&row, i0, i1 - i0);
+
+      /* evaluate factors having compact support at the observations
+       * within their support, and set the others to zero.
+       */
+      if (idx) {
+        size_t c0, c1;
+        model_support_range(idx, task->sn[j], i0, i1, &c0, &c1);
+        vector_set_zero(&phi);
+        for (size_t c = c0; c < c1; c++) {
+          VectorView x = data_x(mdl->dat, idx[c]);
+          vector_set(&row, idx[c],
+                     factor_mean(f, &x, mdl->dat->p[idx[c]], k));
+        }
+
+        continue;
+      }
+
+      if (!factor_mean_all(f, &dat, k, &phi)) {
+        task->ok[tid] = 0;
+        return;
+      }
+    }
+  }
+}
+
+/* model_moments(): compute the first moments of every basis element
+ * of a model at every observation in its associated dataset. the
+ * batched moment buffers are allocated as required.
+ *
+ * the moments of each factor are cached along with the version of
+ * the factor, and are only recomputed when the factor or the dataset
+ * has changed since they were last computed.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to access.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_moments (Model *mdl) {
+  /* check the input pointers. */
+  if (!mdl || !mdl->dat)
+    return 0;
+
+  /* get the weight, observation and factor counts. */
+  const size_t K = mdl->K;
+  const size_t N = mdl->dat->N;
+  const size_t M = mdl->M;
+
+  /* check if the buffers require (re)allocation. */
+  if (!mdl->Phi || mdl->Phi->rows != K || mdl->Phi->cols != N) {
+    /* free the existing buffers. */
+    model_moments_free(mdl);
+
+    /* allocate new buffers. */
+    mdl->Phi = matrix_alloc(K, N);
+    mdl->Psi = matrix_alloc(K, N);
+    mdl->hc = vector_alloc(N);
+    mdl->Gc = vector_alloc(N);
+    mdl->vc = vector_alloc(N);
+
+    /* allocate new cache arrays. */
+    mdl->mver = calloc(M ? M : 1, sizeof(size_t));
+    mdl->over = calloc(M ? M : 1, sizeof(size_t));
+    mdl->oused = calloc(M ? M : 1, sizeof(size_t));
+    mdl->Omega = calloc(M ? M : 1, sizeof(Matrix*));
+    mdl->mdat = NULL;
+
+    /* check for allocation failures. */
+    if (!mdl->Phi || !mdl->Psi || !mdl->hc || !mdl->Gc || !mdl->vc ||
+        !mdl->mver || !mdl->over || !mdl->oused || !mdl->Omega) {
+      model_moments_free(mdl);
+      return 0;
+    }
+  }
+
+  /* invalidate the cache if the dataset has changed. */
+  if (mdl->mdat != mdl->dat || mdl->mdver != mdl->dat->ver) {
+    for (size_t j = 0; j < M; j++)
+      mdl->mver[j] = mdl->over[j] = 0;
+
+    mdl->mdat = mdl->dat;
+    mdl->mdver = mdl->dat->ver;
+  }
+
+  /* determine which factors have changed. */
+  size_t ver[M ? M : 1];
+  char stale[M ? M : 1];
+  int any = 0;
+  for (size_t j = 0; j < M; j++) {
+    ver[j] = factor_version(mdl->factors[j]);
+    stale[j] = (mdl->mver[j] != ver[j]);
+    any = any || stale[j];
+  }
+
+  /* return if every factor has cached moments. */
+  if (!any)
+    return 1;
+
+  /* locate the observations within the support of each stale factor. */
+  size_t *sidx[M ? M : 1], sn[M ? M : 1];
+  int status = 1;
+  for (size_t j = 0; j < M; j++) {
+    sidx[j] = NULL;
+    if (stale[j] && status)
+      status = model_support(mdl, j, &sidx[j], &sn[j]);
+  }
+
+  /* compute the moments over blocks of observations in parallel. */
+  const size_t T = thread_plan(N, THREAD_GRAIN);
+  int ok[T];
+  model_moments_task task = { mdl, stale, sidx, sn, ok };
+  if (status)
+    thread_execute(model_moments_thread, &task, T);
+
+  /* check the status of each thread. */
+  for (size_t t = 0; t < T && status; t++)
+    status = ok[t];
+
+  /* free the support arrays. */
+  for (size_t j = 0; j < M; j++)
+    free(sidx[j]);
+
+  if (!status)
+    return 0;
+
+  /* store the versions of the computed moments. */
+  for (size_t j = 0; j < M; j++)
+    mdl->mver[j] = ver[j];
+
+  /* return success. */
+  return 1;
+}
+
+/* model_moments_fresh(): check whether the cached first moments of
+ * a factor are current for the associated dataset of a model.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to access.
+ *  @j: factor index to check.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the rows of the factor
+ *  in the first moment buffer may be used in place of evaluations.
+ */
+int model_moments_fresh (const Model *mdl, size_t j) {
+  /* check the buffers and the dataset. */
+  if (!mdl || !mdl->dat || !mdl->Phi || !mdl->mver || j >= mdl->M ||
+      mdl->mdat != mdl->dat || mdl->mdver != mdl->dat->ver ||
+      mdl->Phi->cols != mdl->dat->N)
+    return 0;
+
+  /* check the factor version. */
+  return (mdl->mver[j] && mdl->mver[j] == factor_version(mdl->factors[j]));
+}
+
+/* model_excess_task: structure for holding the shared arguments of
+ * parallel excess moment computations.
+ */
+typedef struct {
+  /* @mdl: model structure pointer.
+   * @j: index of the factor to compute.
+   * @k0: weight offset of the factor.
+   * @O: output matrix of excess moments.
+   * @idx: observations within the support of the factor, or null.
+   * @n: number of observations within the support of the factor.
+   * @ok: per-thread status flags.
+   */
+  Model *mdl;
+  size_t j, k0;
+  Matrix *O;
+  const size_t *idx;
+  size_t n;
+  int *ok;
+}
+model_excess_task;
+
+/* model_excess_thread(): compute the excess second moments of the
+ * basis elements within a factor, at the observations assigned to
+ * a single thread.
+ *  - see thread_fn() for more information.
+ */
+static void model_excess_thread (void *arg, size_t tid, size_t T) {
+  /* get the task structure and the range of observations. */
+  model_excess_task *task = (model_excess_task*) arg;
+  Model *mdl = task->mdl;
+  size_t i0, i1;
+  thread_range(mdl->dat->N, tid, T, &i0, &i1);
+
+  /* create a view of the assigned observations. */
+  const Data dat = data_view(mdl->dat, i0, i1 - i0);
+  const Factor *f = mdl->factors[task->j];
+  const size_t k0 = task->k0;
+  const size_t n = i1 - i0;
+  task->ok[tid] = 1;
+
+  /* locate the observations within the support of the factor. */
+  size_t c0 = 0, c1 = 0;
+  if (task->idx)
+    model_support_range(task->idx, task->n, i0, i1, &c0, &c1);
+
+  /* loop over the unique pairs of basis elements in the factor. */
+  for (size_t k1 = 0, r = 0; k1 < f->K; k1++) {
+    for (size_t k2 = k1; k2 < f->K; k2++, r++) {
+      /* get the first moments of the pair. */
+      VectorView row = matrix_row(task->O, r);
+      VectorView omega = vector_subvector(&row, i0, n);
+      const double *phi1 = mdl->Phi->data + (k0 + k1) * mdl->Phi->stride;
+      const double *phi2 = mdl->Phi->data + (k0 + k2) * mdl->Phi->stride;
+
+      /* compute the excess moments within the support, if any. */
+      if (task->idx) {
+        vector_set_zero(&omega);
+        for (size_t c = c0; c < c1; c++) {
+          const size_t i = task->idx[c];
+          VectorView x = data_x(mdl->dat, i);
+          row.data[i] = factor_var(f, &x, mdl->dat->p[i], k1, k2) -
+                        phi1[i] * phi2[i];
+        }
+
+        continue;
+      }
+
+      /* compute the second moments of the pair. */
+      if (!factor_var_all(f, &dat, k1, k2, &omega)) {
+        task->ok[tid] = 0;
+        return;
+      }
+
+      /* subtract the products of first moments. */
+      for (size_t i = 0; i < n; i++)
+        omega.data[i] -= phi1[i0 + i] * phi2[i0 + i];
+    }
+  }
+}
+
+/* model_excess_reserve(): evict the least recently used excess moment
+ * blocks of a model until a new block fits within its memory budget.
+ * blocks that were used during the current pass are never evicted.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ *  @bytes: size of the new block.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the block fits.
+ */
+static int model_excess_reserve (Model *mdl, size_t bytes) {
+  /* compute the size of the cached blocks. */
+  size_t used = 0;
+  for (size_t j = 0; j < mdl->M; j++) {
+    const Matrix *O = mdl->Omega[j];
+    if (O)
+      used += O->rows * O->cols * sizeof(double);
+  }
+
+  /* evict blocks until the new block fits. */
+  while (used + bytes > mdl->budget) {
+    /* find the least recently used block outside the current pass. */
+    size_t jmin = mdl->M;
+    for (size_t j = 0; j < mdl->M; j++) {
+      if (mdl->Omega[j] && mdl->oused[j] < mdl->opass &&
+          (jmin == mdl->M || mdl->oused[j] < mdl->oused[jmin]))
+        jmin = j;
+    }
+
+    /* fail if no block may be evicted. */
+    if (jmin == mdl->M)
+      return 0;
+
+    /* evict the block. */
+    Matrix *O = mdl->Omega[jmin];
+    used -= O->rows * O->cols * sizeof(double);
+    matrix_free(O);
+    mdl->Omega[jmin] = NULL;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* model_excess(): cache the excess of the second moments over the
+ * products of first moments of every pair of basis elements within
+ * each factor of a model, at every observation in its associated
+ * dataset. the first moments must be current.
+ *
+ * blocks of excess moments are held for each factor, and are only
+ * recomputed when the first moments of the factor were recomputed.
+ * blocks that do not fit within the memory budget of the model are
+ * left uncached, and are computed on demand by model_excess_row().
+ *
+ * arguments:
+ *  @mdl: model structure pointer to access.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_excess (Model *mdl) {
+  /* check the input pointers. */
+  if (!mdl || !mdl->dat || !mdl->Phi || !mdl->Omega)
+    return 0;
+
+  /* begin a new pass over the blocks. */
+  const size_t N = mdl->dat->N;
+  mdl->opass++;
+
+  /* loop over the factors. */
+  for (size_t j = 0, k0 = 0; j < mdl->M; k0 += mdl->factors[j++]->K) {
+    /* get the pair count of the factor. */
+    const size_t K = mdl->factors[j]->K;
+    const size_t S = K * (K + 1) / 2;
+
+    /* keep blocks that are current. */
+    Matrix *O = mdl->Omega[j];
+    if (O && O->rows == S && O->cols == N &&
+        mdl->over[j] && mdl->over[j] == mdl->mver[j]) {
+      mdl->oused[j] = mdl->opass;
+      continue;
+    }
+
+    /* drop stale blocks. */
+    matrix_free(O);
+    mdl->Omega[j] = NULL;
+
+    /* leave the block uncached if it does not fit. */
+    if (!model_excess_reserve(mdl, S * N * sizeof(double)))
+      continue;
+
+    /* allocate the block, or leave it uncached. */
+    O = matrix_alloc(S, N);
+    if (!O)
+      continue;
+
+    /* locate the observations within the support of the factor. */
+    size_t *idx, n;
+    if (!model_support(mdl, j, &idx, &n)) {
+      matrix_free(O);
+      return 0;
+    }
+
+    /* compute the excess moments over blocks of observations. */
+    const size_t T = thread_plan(N, THREAD_GRAIN);
+    int ok[T];
+    model_excess_task task = { mdl, j, k0, O, idx, n, ok };
+    thread_execute(model_excess_thread, &task, T);
+    free(idx);
+
+    /* check the status of each thread. */
+    for (size_t t = 0; t < T; t++) {
+      if (!ok[t]) {
+        matrix_free(O);
+        return 0;
+      }
+    }
+
+    /* store the block. */
+    mdl->Omega[j] = O;
+    mdl->over[j] = mdl->mver[j];
+    mdl->oused[j] = mdl->opass;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* model_excess_row(): get the excess second moments of a pair of basis
+ * elements within a factor, at every observation in the associated
+ * dataset of a model. model_excess() must have been called prior to
+ * this function.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to access.
+ *  @j: factor index.
+ *  @k1, @k2: basis indices of the pair, where k1 <= k2.
+ *  @v: (N, 1) vector for storing uncached excess moments.
+ *
+ * returns:
+ *  pointer to the excess moments, either cached or stored in @v,
+ *  or null on failure.
+ */
+const double *model_excess_row (const Model *mdl, size_t j,
+                                 size_t k1, size_t k2, Vector *v) {
+  /* get the factor and its pair index. */
+  const Factor *f = mdl->factors[j];
+  const size_t r = k1 * f->K - k1 * (k1 + 1) / 2 + k2;
+
+  /* return the cached row, if available. */
+  const Matrix *O = mdl->Omega ? mdl->Omega[j] : NULL;
+  if (O)
+    return O->data + r * O->stride;
+
+  /* get the first moments of the pair. */
+  const size_t k0 = model_weight_idx(mdl, j, 0);
+  const double *phi1 = mdl->Phi->data + (k0 + k1) * mdl->Phi->stride;
+  const double *phi2 = mdl->Phi->data + (k0 + k2) * mdl->Phi->stride;
+
+  /* locate the observations within the support of the factor. */
+  size_t *idx, n;
+  if (!model_support(mdl, j, &idx, &n))
+    return NULL;
+
+  /* compute the excess moments within the support, if any. */
+  if (idx) {
+    vector_set_zero(v);
+    for (size_t c = 0; c < n; c++) {
+      const size_t i = idx[c];
+      VectorView x = data_x(mdl->dat, i);
+      vector_set(v, i, factor_var(f, &x, mdl->dat->p[i], k1, k2) -
+                       phi1[i] * phi2[i]);
+    }
+
+    free(idx);
+    return v->data;
+  }
+
+  /* compute the second moments of the pair. */
+  if (!factor_var_all(f, mdl->dat, k1, k2, v))
+    return NULL;
+
+  /* subtract the products of first moments. */
+  for (size_t i = 0; i < v->len; i++)
+    vector_set(v, i, vector_get(v, i) - phi1[i] * phi2[i]);
+
+  /* return the computed row. */
+  return v->data;
+}
+
+/* model_set_budget(): set the memory budget of the excess moment cache
+ * of a model, evicting cached blocks that no longer fit.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ *  @bytes: new memory budget, in bytes.
+ */
+void model_set_budget (Model *mdl, size_t bytes) {
+  /* store the new budget. */
+  mdl->budget = bytes;
+
+  /* evict blocks outside of a new pass until the cache fits. */
+  if (mdl->Omega) {
+    mdl->opass++;
+    model_excess_reserve(mdl, 0);
+  }
+}
+
+/* model_gram_weights(): prepare the precision-weighted first moments
+ * used to construct the off-diagonal blocks of the weight precisions.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to access.
+ *  @w: precision coefficients, or null for unit coefficients.
+ *
+ * returns:
+ *  pointer to the weighted first moments.
+ */
+static const Matrix *model_gram_weights (Model *mdl, const Vector *w) {
+  /* unit coefficients require no weighting. */
+  if (!w)
+    return mdl->Phi;
+
+  /* scale each column of the first moments by its coefficient. */
+  const size_t N = mdl->Phi->cols;
+  for (size_t k = 0; k < mdl->K; k++) {
+    const double *phi = mdl->Phi->data + k * mdl->Phi->stride;
+    double *psi = mdl->Psi->data + k * mdl->Psi->stride;
+    for (size_t i = 0; i < N; i++)
+      psi[i] = phi[i] * vector_get(w, i);
+  }
+
+  /* return the weighted moments. */
+  return mdl->Psi;
+}
+
+/* model_var_task: structure for holding the shared argument of
+ * parallel second moment computations.
+ */
+typedef struct {
+  /* @f: factor structure pointer.
+   * @dat: dataset structure pointer.
+   * @k1, @k2: basis indices of the factor.
+   */
+  const Factor *f;
+  const Data *dat;
+  size_t k1, k2;
+
+  /* @idx: observations within the support of the factor, or null.
+   * @n: number of observations within the support of the factor.
+   */
+  const size_t *idx;
+  size_t n;
+
+  /* @v: output vector of second moments.
+   * @ok: per-thread status flags.
+   */
+  Vector *v;
+  int *ok;
+}
+model_var_task;
+
+/* model_var_thread(): compute the second moments of a pair of basis
+ * elements at the observations assigned to a single thread.
+ *  - see thread_fn() for more information.
+ */
+static void model_var_thread (void *arg, size_t tid, size_t T) {
+  /* get the task structure and the range of observations. */
+  model_var_task *task = (model_var_task*) arg;
+  size_t i0, i1;
+  thread_range(task->dat->N, tid, T, &i0, &i1);
+
+  /* compute the moments of the assigned observations. */
+  const Data dat = data_view(task->dat, i0, i1 - i0);
+  VectorView v = vector_subvector(task->v, i0, i1 - i0);
+  if (!task->idx) {
+    task->ok[tid] = factor_var_all(task->f, &dat, task->k1, task->k2, &v);
+    return;
+  }
+
+  /* or compute the moments within the support of the factor. */
+  size_t c0, c1;
+  model_support_range(task->idx, task->n, i0, i1, &c0, &c1);
+  vector_set_zero(&v);
+  for (size_t c = c0; c < c1; c++) {
+    const size_t i = task->idx[c];
+    VectorView x = data_x(task->dat, i);
+    vector_set(task->v, i, factor_var(task->f, &x, task->dat->p[i],
+                                      task->k1, task->k2));
+  }
+
+  task->ok[tid] = 1;
+}
+
+/* model_gram_block(): compute the diagonal block of the weight
+ * precisions that corresponds to a single factor, using the
+ * second moments of its basis elements.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to access.
+ *  @j: model factor index.
+ *  @w: precision coefficients, or null for unit coefficients.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int model_gram_block (Model *mdl, size_t j, const Vector *w) {
+  /* get the factor and its weight offset. */
+  const Factor *f = mdl->factors[j];
+  const size_t k0 = model_weight_idx(mdl, j, 0);
+  const size_t N = mdl->dat->N;
+
+  /* locate the observations within the support of the factor. */
+  size_t *idx, n;
+  if (!model_support(mdl, j, &idx, &n))
+    return 0;
+
+  /* loop over the unique pairs of factor weights. */
+  for (size_t k1 = 0; k1 < f->K; k1++) {
+    for (size_t k2 = k1; k2 < f->K; k2++) {
+      /* compute the second moments of the current pair. */
+      const size_t T = thread_plan(N, THREAD_GRAIN);
+      int ok[T];
+      model_var_task task = { f, mdl->dat, k1, k2, idx, n, mdl->vc, ok };
+      thread_execute(model_var_thread, &task, T);
+      for (size_t t = 0; t < T; t++) {
+        if (!ok[t]) {
+          free(idx);
+          return 0;
+        }
+      }
+
+      /* sum the (weighted) contributions of each observation. */
+      double gkk = 0.0;
+      if (w) {
+        for (size_t i = 0; i < N; i++)
+          gkk += vector_get(w, i) * vector_get(mdl->vc, i);
+      }
+      else {
+        for (size_t i = 0; i < N; i++)
+          gkk += vector_get(mdl->vc, i);
+      }
+
+      /* store the precision matrix elements. */
+      matrix_set(mdl->Sinv, k0 + k1, k0 + k2, gkk);
+      matrix_set(mdl->Sinv, k0 + k2, k0 + k1, gkk);
+    }
+  }
+
+  /* free the support array and return success. */
+  free(idx);
+  return 1;
+}
+
+/* model_gram_task: structure for holding the shared argument of
+ * parallel precision matrix computations.
+ */
+typedef struct {
+  /* @mdl: model structure pointer.
+   * @Psi: weighted first moments.
+   */
+  Model *mdl;
+  const Matrix *Psi;
+}
+model_gram_task;
+
+/* model_gram_thread(): compute the row panels of the lower triangle of
+ * the weight precisions that are assigned to a single thread:
+ *  Sinv(i0 : i1, 1 : i1) <- Phi(i0 : i1, :) Psi(1 : i1, :)'
+ *
+ * the cost of each panel grows with its row index, so the panels are
+ * divided at square-root boundaries to balance the work among threads.
+ *  - see thread_fn() for more information.
+ */
+static void model_gram_thread (void *arg, size_t tid, size_t T) {
+  /* get the task structure and the model. */
+  model_gram_task *task = (model_gram_task*) arg;
+  Model *mdl = task->mdl;
+  const Matrix *Psi = task->Psi;
+  const size_t K = mdl->K;
+
+  /* determine the range of panels assigned to the thread. */
+  const size_t npanels = (K + MODEL_GRAM_BLOCK - 1) / MODEL_GRAM_BLOCK;
+  const size_t p0 = (size_t) (npanels * sqrt((double) tid / T));
+  const size_t p1 = (size_t) (npanels * sqrt((double) (tid + 1) / T));
+
+  /* compute each assigned panel. */
+  for (size_t p = p0; p < p1; p++) {
+    const size_t i0 = p * MODEL_GRAM_BLOCK;
+    const size_t n = (i0 + MODEL_GRAM_BLOCK < K ? MODEL_GRAM_BLOCK : K - i0);
+    MatrixView Pr = matrix_submatrix(mdl->Phi, i0, 0, n, mdl->Phi->cols);
+    MatrixView Pc = matrix_submatrix(Psi, 0, 0, i0 + n, Psi->cols);
+    MatrixView G = matrix_submatrix(mdl->Sinv, i0, 0, n, i0 + n);
+    blas_dgemm(BLAS_NO_TRANS, BLAS_TRANS, 1.0, &Pr, &Pc, 0.0, &G);
+  }
+}
+
+/* model_gram(): compute the projection vector and weight precisions
+ * of a model from the batched first moments of its basis elements.
+ * model_moments() must have been called prior to this function.
+ *
+ * operation:
+ *  h <- sum_i c_i E[phi_i]
+ *  Sinv <- sum_i w_i E[phi_i phi_i']
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ *  @c: projection coefficients of each observation.
+ *  @w: precision coefficients of each observation, or null.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_gram (Model *mdl, const Vector *c, const Vector *w) {
+  /* check the input pointers. */
+  if (!mdl || !mdl->dat || !mdl->Phi || !c)
+    return 0;
+
+  /* locally store the weight count. */
+  const size_t K = mdl->K;
+
+  /* compute the projection vector: h <- Phi c */
+  blas_dgemv(BLAS_NO_TRANS, 1.0, mdl->Phi, c, 0.0, mdl->h);
+
+  /* get the weighted first moments. */
+  const Matrix *Psi = model_gram_weights(mdl, w);
+
+  /* compute the lower triangle of the precisions in parallel. */
+  const size_t npanels = (K + MODEL_GRAM_BLOCK - 1) / MODEL_GRAM_BLOCK;
+  model_gram_task task = { mdl, Psi };
+  thread_execute(model_gram_thread, &task, thread_plan(npanels, 1));
+
+  /* symmetrize the precisions. */
+  for (size_t i = 0; i < K; i++)
+    for (size_t i2 = i + 1; i2 < K; i2++)
+      matrix_set(mdl->Sinv, i, i2, matrix_get(mdl->Sinv, i2, i));
+
+  /* replace the diagonal blocks with second moments. */
+  for (size_t j = 0; j < mdl->M; j++) {
+    if (!model_gram_block(mdl, j, w))
+      return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* model_gram_update(): compute the projection vector elements and
+ * weight precision rows/columns of a single model factor from the
+ * batched first moments of its basis elements.
+ *  - see model_gram() for more information.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ *  @j: model factor index.
+ *  @c: projection coefficients of each observation.
+ *  @w: precision coefficients of each observation, or null.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_gram_update (Model *mdl, size_t j,
+                       const Vector *c, const Vector *w) {
+  /* check the input pointers and factor index. */
+  if (!mdl || !mdl->dat || !mdl->Phi || !c || j >= mdl->M)
+    return 0;
+
+  /* get the weight offset and count of the factor. */
+  const size_t k0 = model_weight_idx(mdl, j, 0);
+  const size_t K = mdl->factors[j]->K;
+  const size_t N = mdl->Phi->cols;
+
+  /* compute the projection subvector: h(j) <- Phi(j, :) c */
+  MatrixView Pj = matrix_submatrix(mdl->Phi, k0, 0, K, N);
+  VectorView hj = vector_subvector(mdl->h, k0, K);
+  blas_dgemv(BLAS_NO_TRANS, 1.0, &Pj, c, 0.0, &hj);
+
+  /* compute the precision rows: Sinv(j, :) <- Phi(j, :) Psi' */
+  const Matrix *Psi = model_gram_weights(mdl, w);
+  MatrixView G = matrix_submatrix(mdl->Sinv, k0, 0, K, mdl->K);
+  blas_dgemm(BLAS_NO_TRANS, BLAS_TRANS, 1.0, &Pj, Psi, 0.0, &G);
+
+  /* mirror the precision rows into their columns. */
+  for (size_t k = 0; k < K; k++)
+    for (size_t i = 0; i < mdl->K; i++)
+      matrix_set(mdl->Sinv, i, k0 + k, matrix_get(mdl->Sinv, k0 + k, i));
+
+  /* replace the diagonal block with second moments. */
+  return model_gram_block(mdl, j, w);
+}
+
+/* model_weight_prior(): set the weight posterior of a model to its
+ * prior, without accessing the associated dataset.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ */
+void model_weight_prior (Model *mdl) {
+  /* set the projections and weight means to zero. */
+  vector_set_zero(mdl->h);
+  vector_set_zero(mdl->wbar);
+
+  /* set the precisions, their factors and the covariances
+   * to scaled identity matrices.
+   */
+  matrix_set_ident(mdl->Sinv);
+  matrix_set_ident(mdl->L);
+  matrix_set_ident(mdl->Sigma);
+  for (size_t k = 0; k < mdl->K; k++) {
+    matrix_set(mdl->Sinv, k, k, mdl->nu);
+    matrix_set(mdl->L, k, k, sqrt(mdl->nu));
+    matrix_set(mdl->Sigma, k, k, 1.0 / mdl->nu);
+  }
+}
+
+/* model_gram_step(): blend the projection vector and weight precisions
+ * of a model with scaled estimates computed from the batched first
+ * moments of a minibatch, held as its associated dataset, and factor
+ * the blended precisions. model_moments() must have been called prior
+ * to this function. the weight means and covariances are used as
+ * scratch space, and must be recomputed by the caller.
+ *
+ * operation:
+ *  h <- (1 - rho) h + rho s sum_i c_i E[phi_i]
+ *  Sinv <- (1 - rho) Sinv + rho (nu I + s sum_i w_i E[phi_i phi_i'])
+ *  L <- chol(Sinv)
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ *  @c: projection coefficients of each minibatch observation.
+ *  @w: precision coefficients of each minibatch observation, or null.
+ *  @scale: ratio of the complete dataset size to the minibatch size.
+ *  @rho: step length, in (0, 1].
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_gram_step (Model *mdl, const Vector *c, const Vector *w,
+                     double scale, double rho) {
+  /* hold the current projections and precisions. */
+  vector_copy(mdl->wbar, mdl->h);
+  matrix_copy(mdl->Sigma, mdl->Sinv);
+
+  /* compute the minibatch projections and precisions. */
+  if (!model_gram(mdl, c, w)) {
+    vector_copy(mdl->h, mdl->wbar);
+    matrix_copy(mdl->Sinv, mdl->Sigma);
+    return 0;
+  }
+
+  /* blend the projections. */
+  blas_dscal(rho * scale, mdl->h);
+  blas_daxpy(1.0 - rho, mdl->wbar, mdl->h);
+
+  /* blend the precisions, including the diagonal term. */
+  for (size_t i = 0; i < mdl->K; i++) {
+    for (size_t k = 0; k < mdl->K; k++) {
+      const double g = matrix_get(mdl->Sinv, i, k);
+      const double g0 = matrix_get(mdl->Sigma, i, k);
+      matrix_set(mdl->Sinv, i, k,
+                 (1.0 - rho) * g0 + rho * scale * g +
+                 (i == k ? rho * mdl->nu : 0.0));
+    }
+  }
+
+  /* compute the cholesky decomposition of the weight precisions. */
+  matrix_copy(mdl->L, mdl->Sinv);
+  return chol_decomp(mdl->L);
+}
+
 /* model_weight_adjust_init(): initialize data structures for performing
  * a new low-rank adjustment of the:
  *   a.) precision matrix cholesky factors.
@@ -1007,12 +2797,11 @@ int model_weight_adjust (Model *mdl, size_t j) {
   const size_t K = mdl->factors[j]->K;
 
   /* declare vector views for tracking precision matrix modifications. */
-  VectorView u, v, z;
+  VectorView u, v;
   MatrixView U, V;
 
-  /* create the vector view for holding individual rows/columns. */
+  /* skip the vector view for holding individual rows/columns. */
   double *ptr = mdl->tmp->data;
-  z = vector_view_array(ptr, mdl->K);
   ptr += mdl->K + mdl->P;
 
   /* create the matrix view for storing updates. */
@@ -1080,42 +2869,216 @@ int model_weight_adjust (Model *mdl, size_t j) {
     }
   }
 
-  /* apply the updates. */
-  for (size_t k = 0; k < K; k++) {
-    /* update the cholesky factors. */
-    u = matrix_row(&U, k);
-    matrix_copy_row(&z, &U, k);
-    chol_update(mdl->L, &z);
+  /* create the matrix views for the woodbury products. */
+  ptr += K * mdl->K;
+  MatrixView Zu = matrix_view_array(ptr, K, mdl->K);
+  ptr += K * mdl->K;
+  MatrixView Zv = matrix_view_array(ptr, K, mdl->K);
+  ptr += K * mdl->K;
+  MatrixView Cu = matrix_view_array(ptr, K, K);
+  ptr += K * K;
+  MatrixView Cv = matrix_view_array(ptr, K, K);
+  ptr += K * K;
+  MatrixView T = matrix_view_array(ptr, K, K);
+
+  /* apply the updates to the covariance matrix as a single rank-K
+   * woodbury update:
+   *  Cu <- I + U Sigma U'
+   *  Zu <- inv(chol(Cu)) U Sigma
+   */
+  blas_dgemm(BLAS_NO_TRANS, BLAS_NO_TRANS, 1.0, &U, mdl->Sigma, 0.0, &Zu);
+  matrix_set_ident(&Cu);
+  blas_dgemm(BLAS_NO_TRANS, BLAS_TRANS, 1.0, &Zu, &U, 1.0, &Cu);
+  int ok = chol_decomp(&Cu);
+  blas_dtrsm(BLAS_LEFT, BLAS_LOWER, BLAS_NO_TRANS, 1.0, &Cu, &Zu);
+
+  /* apply the downdates to the updated covariance matrix, without
+   * forming it, as a second rank-K woodbury update:
+   *  Zv <- V (Sigma - Zu' Zu)
+   *  Cv <- I - Zv V'
+   *  Zv <- inv(chol(Cv)) Zv
+   */
+  blas_dgemm(BLAS_NO_TRANS, BLAS_NO_TRANS, 1.0, &V, mdl->Sigma, 0.0, &Zv);
+  blas_dgemm(BLAS_NO_TRANS, BLAS_TRANS, 1.0, &V, &Zu, 0.0, &T);
+  blas_dgemm(BLAS_NO_TRANS, BLAS_NO_TRANS, -1.0, &T, &Zu, 1.0, &Zv);
+  matrix_set_ident(&Cv);
+  blas_dgemm(BLAS_NO_TRANS, BLAS_TRANS, -1.0, &Zv, &V, 1.0, &Cv);
+  ok = ok && chol_decomp(&Cv);
+  blas_dtrsm(BLAS_LEFT, BLAS_LOWER, BLAS_NO_TRANS, 1.0, &Cv, &Zv);
+
+  /* apply the updates and downdates to the cholesky factors. */
+  chol_update_block(mdl->L, &U);
+  ok = ok && chol_downdate_block(mdl->L, &V);
+
+  /* if the adjustment lost positive definiteness to round-off error,
+   * recompute the factors and covariances from the precisions.
+   */
+  if (!ok) {
+    matrix_copy(mdl->L, mdl->Sinv);
+    if (!chol_decomp(mdl->L))
+      return 0;
 
-    /* update the covariance matrix. */
-    blas_dgemv(BLAS_NO_TRANS, 1.0, mdl->Sigma, &u, 0.0, &z);
-    double zudot = blas_ddot(&z, &u);
-    zudot = 1.0 / (1.0 + zudot);
-    for (size_t i = 0; i < mdl->K; i++)
-      for (size_t j = 0; j < mdl->K; j++)
-        matrix_set(mdl->Sigma, i, j,
-          matrix_get(mdl->Sigma, i, j) -
-          zudot * vector_get(&z, i) *
-                  vector_get(&z, j));
+    return chol_invert(mdl->L, mdl->Sigma);
   }
 
-  /* apply the downdates. */
-  for (size_t k = 0; k < K; k++) {
-    /* downdate the cholesky factors. */
-    v = matrix_row(&V, k);
-    matrix_copy_row(&z, &V, k);
-    chol_downdate(mdl->L, &z);
+  /* Sigma <- Sigma - Zu' Zu + Zv' Zv, in the lower triangle. */
+  blas_dsyrk(BLAS_LOWER, BLAS_TRANS, -1.0, &Zu, 1.0, mdl->Sigma);
+  blas_dsyrk(BLAS_LOWER, BLAS_TRANS, 1.0, &Zv, 1.0, mdl->Sigma);
 
-    /* downdate the covariance matrix. */
-    blas_dgemv(BLAS_NO_TRANS, 1.0, mdl->Sigma, &v, 0.0, &z);
-    double zvdot = blas_ddot(&z, &v);
-    zvdot = 1.0 / (1.0 - zvdot);
-    for (size_t i = 0; i < mdl->K; i++)
-      for (size_t j = 0; j < mdl->K; j++)
-        matrix_set(mdl->Sigma, i, j,
-          matrix_get(mdl->Sigma, i, j) +
-          zvdot * vector_get(&z, i) *
-                  vector_get(&z, j));
+  /* mirror the lower triangle of the covariance matrix. */
+  for (size_t i = 0; i < mdl->K; i++)
+    for (size_t k = i + 1; k < mdl->K; k++)
+      matrix_set(mdl->Sigma, i, k, matrix_get(mdl->Sigma, k, i));
+
+  /* return success. */
+  return 1;
+}
+
+/* model_weight_observe_rank1(): apply a symmetric rank-one update to the
+ * weight precisions of a model, and correspondingly update the cholesky
+ * factors (by chol_update()) and covariances (by sherman-morrison).
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ *  @v: (K, 1) update vector, nonzero only within [k0, k1). the
+ *      contents of the vector are destroyed.
+ *  @s: (K, 1) temporary vector.
+ *  @k0: index of the first nonzero element of @v.
+ *  @k1: index after the last nonzero element of @v.
+ */
+static void model_weight_observe_rank1 (Model *mdl, Vector *v, Vector *s,
+                                        size_t k0, size_t k1) {
+  /* get the weight count and the nonzero block of the update. */
+  const size_t K = mdl->K;
+  const size_t n = k1 - k0;
+  VectorView vb = vector_subvector(v, k0, n);
+
+  /* Sinv <- Sinv + v v', within the nonzero block. */
+  for (size_t i = k0; i < k1; i++) {
+    double *si = mdl->Sinv->data + i * mdl->Sinv->stride;
+    const double vi = vector_get(v, i);
+    for (size_t k = k0; k < k1; k++)
+      si[k] += vi * vector_get(v, k);
+  }
+
+  /* s <- Sigma v */
+  MatrixView Sb = matrix_submatrix(mdl->Sigma, 0, k0, K, n);
+  blas_dgemv(BLAS_NO_TRANS, 1.0, &Sb, &vb, 0.0, s);
+
+  /* Sigma <- Sigma - s s' / (1 + v' s) */
+  VectorView sb = vector_subvector(s, k0, n);
+  const double d = 1.0 + blas_ddot(&vb, &sb);
+  const double *sd = s->data;
+  for (size_t i = 0; i < K; i++) {
+    double *si = mdl->Sigma->data + i * mdl->Sigma->stride;
+    const double ai = sd[i * s->stride] / d;
+    for (size_t k = 0; k < K; k++)
+      si[k] -= ai * sd[k * s->stride];
+  }
+
+  /* update the trailing cholesky factors, which are the only ones
+   * affected by an update having leading zeros.
+   */
+  MatrixView Lb = matrix_submatrix(mdl->L, k0, k0, K - k0, K - k0);
+  VectorView vt = vector_subvector(v, k0, K - k0);
+  chol_update(&Lb, &vt);
+}
+
+/* model_weight_observe(): update the weight projections, precisions,
+ * precision cholesky factors and covariances of a model to include a
+ * single observation of its associated dataset. the expected outer
+ * product of the basis at the observation is applied as one rank-one
+ * update of its first moments, followed by rank-one updates of the
+ * excess second moments within each factor. excess moments that are
+ * negligible against the current precisions are skipped.
+ *
+ * computation:
+ *  h <- h + c E[phi(x)]
+ *  Sinv <- Sinv + g E[phi(x) phi(x)']
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ *  @i: dataset observation index.
+ *  @c: projection coefficient of the observation.
+ *  @g: precision coefficient of the observation.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_weight_observe (Model *mdl, size_t i, double c, double g) {
+  /* check the input pointers and arguments. */
+  if (!mdl || !mdl->dat || i >= mdl->dat->N || g < 0.0)
+    return 0;
+
+  /* get the observation location and output index. */
+  const size_t K = mdl->K;
+  const VectorView x = data_x(mdl->dat, i);
+  const size_t p = mdl->dat->p[i];
+
+  /* create views for the first moments, update vectors and
+   * excess moments.
+   */
+  VectorView u = vector_subvector(mdl->tmp, 0, K);
+  VectorView v = vector_subvector(mdl->tmp, K, K);
+  VectorView s = vector_subvector(mdl->tmp, 2 * K, K);
+  double *E = mdl->tmp->data + 3 * K;
+
+  /* compute the first moments of every basis element. */
+  for (size_t j = 0, k = 0; j < mdl->M; j++) {
+    const Factor *f = mdl->factors[j];
+    for (size_t kf = 0; kf < f->K; kf++, k++)
+      vector_set(&u, k, factor_mean(f, &x, p, kf));
+  }
+
+  /* h <- h + c u */
+  blas_daxpy(c, &u, mdl->h);
+
+  /* apply the update of the first moments. */
+  const double sg = sqrt(g);
+  vector_copy(&v, &u);
+  blas_dscal(sg, &v);
+  model_weight_observe_rank1(mdl, &v, &s, 0, K);
+
+  /* loop over the factors, applying their excess moments. */
+  for (size_t j = 0, k0 = 0; j < mdl->M; k0 += mdl->factors[j++]->K) {
+    /* compute the excess moments of the factor. */
+    const Factor *f = mdl->factors[j];
+    const size_t Kf = f->K;
+    for (size_t k1 = 0; k1 < Kf; k1++) {
+      for (size_t k2 = k1; k2 < Kf; k2++) {
+        const double e = factor_var(f, &x, p, k1, k2) -
+                         vector_get(&u, k0 + k1) *
+                         vector_get(&u, k0 + k2);
+
+        E[k1 * Kf + k2] = E[k2 * Kf + k1] = e;
+      }
+    }
+
+    /* decompose the excess moments into rank-one updates. */
+    for (size_t r = 0; r < Kf; r++) {
+      /* skip pivots that are negligible against the precisions. */
+      const double err = E[r * Kf + r];
+      const double srr = matrix_get(mdl->Sinv, k0 + r, k0 + r);
+      if (g * err <= DBL_EPSILON * srr)
+        continue;
+
+      /* build the update vector from the pivot column, and remove
+       * its outer product from the excess moments.
+       */
+      const double er = sqrt(err);
+      vector_set_zero(&v);
+      for (size_t k = r; k < Kf; k++)
+        vector_set(&v, k0 + k, E[k * Kf + r] / er);
+
+      for (size_t k1 = r; k1 < Kf; k1++)
+        for (size_t k2 = r; k2 < Kf; k2++)
+          E[k1 * Kf + k2] -= vector_get(&v, k0 + k1) *
+                             vector_get(&v, k0 + k2);
+
+      /* apply the scaled update. */
+      blas_dscal(sg, &v);
+      model_weight_observe_rank1(mdl, &v, &s, k0 + r, k0 + Kf);
+    }
   }
 
   /* return success. */
@@ -0,0 +1,426 @@
+
+/* include the vfl header. */
+#include <vfl/vfl.h>
+
+/* include the posix file and memory-mapping headers. */
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+/* MODEL_MAGIC: leading bytes of binary model files.
+ */
+#define MODEL_MAGIC "VFLMODL"
+
+/* MODEL_BYTE_ORDER: value used to check the byte order of binary
+ * model files.
+ */
+#define MODEL_BYTE_ORDER 0x0102030405060708ULL
+
+/* MODEL_FORMAT: version of the binary model file layout.
+ */
+#define MODEL_FORMAT 1
+
+/* ModelHeader: structure of the header of binary model files. the
+ * header is followed by the model type, sizes and noise parameters,
+ * the packed factors and priors, and finally the weight means (K),
+ * covariances (K * K), precisions (K * K), precision cholesky factors
+ * (K * K) and projections (K), starting at an aligned offset so that
+ * the file may be memory-mapped in place.
+ */
+typedef struct {
+  /* @magic: leading magic bytes.
+   * @order: byte order check value.
+   * @format: file layout version.
+   */
+  char magic[8];
+  uint64_t order;
+  uint64_t format;
+}
+ModelHeader;
+
+/* model_pack(): write the complete state of a model, excluding its
+ * associated dataset, into a packed buffer.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to access.
+ *  @pk: packed buffer to write into.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_pack (const Model *mdl, Pack *pk) {
+  /* check the input pointers. */
+  if (!mdl || !pk)
+    return 0;
+
+  /* build the header. */
+  ModelHeader hdr;
+  memset(&hdr, 0, sizeof(ModelHeader));
+  memcpy(hdr.magic, MODEL_MAGIC, sizeof(MODEL_MAGIC));
+  hdr.order = MODEL_BYTE_ORDER;
+  hdr.format = MODEL_FORMAT;
+
+  /* write the header, type and sizes. */
+  if (!pack_write(pk, &hdr, sizeof(ModelHeader)) ||
+      !pack_write_type(pk, (const PyObject*) mdl) ||
+      !pack_write_size(pk, mdl->D) ||
+      !pack_write_size(pk, mdl->P) ||
+      !pack_write_size(pk, mdl->M) ||
+      !pack_write_size(pk, mdl->K))
+    return 0;
+
+  /* write the prior and posterior noise parameters. */
+  if (!pack_write_double(pk, mdl->alpha0) ||
+      !pack_write_double(pk, mdl->beta0) ||
+      !pack_write_double(pk, mdl->nu) ||
+      !pack_write_double(pk, mdl->alpha) ||
+      !pack_write_double(pk, mdl->beta) ||
+      !pack_write_double(pk, mdl->tau))
+    return 0;
+
+  /* write the factors and their priors. */
+  for (size_t j = 0; j < mdl->M; j++) {
+    if (!factor_pack(mdl->factors[j], pk))
+      return 0;
+  }
+
+  for (size_t j = 0; j < mdl->M; j++) {
+    if (!factor_pack(mdl->priors[j], pk))
+      return 0;
+  }
+
+  /* return if the model has no weights. */
+  if (!mdl->K)
+    return 1;
+
+  /* write the weight posterior and intermediates. */
+  return (pack_write_align(pk) &&
+          pack_write_vector(pk, mdl->wbar) &&
+          pack_write_matrix(pk, mdl->Sigma) &&
+          pack_write_matrix(pk, mdl->Sinv) &&
+          pack_write_matrix(pk, mdl->L) &&
+          pack_write_vector(pk, mdl->h));
+}
+
+/* model_unpack_vector(): read a vector from a packed buffer into a
+ * model, either by copying it or by viewing it in place.
+ *
+ * arguments:
+ *  @pk: packed buffer to read from.
+ *  @v: pointer to the model vector to store into.
+ *  @share: whether to view the buffer in place.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int model_unpack_vector (Pack *pk, Vector **v, int share) {
+  /* copy the elements into the existing vector. */
+  if (!share)
+    return pack_read_vector(pk, *v);
+
+  /* locate the elements within the buffer. */
+  const size_t n = (*v)->len;
+  double *data = (double*) pack_read(pk, n * sizeof(double));
+  Vector *view = malloc(sizeof(Vector));
+  if (!data || !view) {
+    free(view);
+    return 0;
+  }
+
+  /* replace the vector by a view of the buffer. */
+  *view = vector_view_array(data, n);
+  vector_free(*v);
+  *v = view;
+
+  /* return success. */
+  return 1;
+}
+
+/* model_unpack_matrix(): read a matrix from a packed buffer into a
+ * model, either by copying it or by viewing it in place.
+ *
+ * arguments:
+ *  @pk: packed buffer to read from.
+ *  @A: pointer to the model matrix to store into.
+ *  @share: whether to view the buffer in place.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int model_unpack_matrix (Pack *pk, Matrix **A, int share) {
+  /* copy the elements into the existing matrix. */
+  if (!share)
+    return pack_read_matrix(pk, *A);
+
+  /* locate the elements within the buffer. */
+  const size_t n1 = (*A)->rows, n2 = (*A)->cols;
+  double *data = (double*) pack_read(pk, n1 * n2 * sizeof(double));
+  Matrix *view = malloc(sizeof(Matrix));
+  if (!data || !view) {
+    free(view);
+    return 0;
+  }
+
+  /* replace the matrix by a view of the buffer. */
+  *view = matrix_view_array(data, n1, n2);
+  matrix_free(*A);
+  *A = view;
+
+  /* return success. */
+  return 1;
+}
+
+/* model_unpack(): create a model from its complete state, as written
+ * into a packed buffer by model_pack(). the restored model has no
+ * associated dataset.
+ *
+ * when sharing is requested, the weight posterior and intermediates
+ * of the model are views into the buffer, which must be writable and
+ * must outlive the model, and must be aligned to PACK_ALIGN bytes.
+ *
+ * arguments:
+ *  @pk: packed buffer to read from.
+ *  @share: whether to view the bulk arrays in place.
+ *
+ * returns:
+ *  pointer to a new model structure, or null on failure.
+ *  (New reference)
+ */
+Model *model_unpack (Pack *pk, int share) {
+  /* check the input pointer. */
+  if (!pk)
+    return NULL;
+
+  /* read and check the header. */
+  ModelHeader hdr;
+  const char *ptr = pack_read(pk, sizeof(ModelHeader));
+  if (!ptr)
+    return NULL;
+
+  memcpy(&hdr, ptr, sizeof(ModelHeader));
+  if (memcmp(hdr.magic, MODEL_MAGIC, sizeof(MODEL_MAGIC)) ||
+      hdr.order != MODEL_BYTE_ORDER || hdr.format != MODEL_FORMAT)
+    return NULL;
+
+  /* read and resolve the model type. */
+  PyTypeObject *type = pack_read_type(pk, &Model_Type);
+  if (!type)
+    return NULL;
+
+  /* allocate a new model having the stored type. */
+  Model *mdl = (Model*) PyObject_CallObject((PyObject*) type, NULL);
+  Py_DECREF(type);
+  if (!mdl) {
+    PyErr_Clear();
+    return NULL;
+  }
+
+  /* read the sizes and noise parameters. */
+  size_t D, P, M, K;
+  double alpha0, beta0, nu, alpha, beta, tau;
+  if (!pack_read_size(pk, &D) || !pack_read_size(pk, &P) ||
+      !pack_read_size(pk, &M) || !pack_read_size(pk, &K) ||
+      !pack_read_double(pk, &alpha0) || !pack_read_double(pk, &beta0) ||
+      !pack_read_double(pk, &nu) || !pack_read_double(pk, &alpha) ||
+      !pack_read_double(pk, &beta) || !pack_read_double(pk, &tau) ||
+      M > pk->len - pk->pos)
+    goto fail;
+
+  /* read and add each factor. */
+  for (size_t j = 0; j < M; j++) {
+    Factor *f = factor_unpack(pk);
+    const int ok = (f && model_add_factor(mdl, f));
+    Py_XDECREF(f);
+    if (!ok)
+      goto fail;
+  }
+
+  /* read and replace each prior. */
+  for (size_t j = 0; j < M; j++) {
+    Factor *f = factor_unpack(pk);
+    if (!f)
+      goto fail;
+
+    Py_DECREF(mdl->priors[j]);
+    mdl->priors[j] = f;
+  }
+
+  /* check that the factors reproduce the stored sizes. */
+  if (mdl->D != D || mdl->P != P || mdl->M != M || mdl->K != K)
+    goto fail;
+
+  /* store the noise parameters. */
+  mdl->alpha0 = alpha0;
+  mdl->beta0 = beta0;
+  mdl->nu = nu;
+  mdl->alpha = alpha;
+  mdl->beta = beta;
+  mdl->tau = tau;
+
+  /* read the weight posterior and intermediates, if any. */
+  if (K && (!pack_read_align(pk) ||
+            !model_unpack_vector(pk, &mdl->wbar, share) ||
+            !model_unpack_matrix(pk, &mdl->Sigma, share) ||
+            !model_unpack_matrix(pk, &mdl->Sinv, share) ||
+            !model_unpack_matrix(pk, &mdl->L, share) ||
+            !model_unpack_vector(pk, &mdl->h, share)))
+    goto fail;
+
+  /* check that the buffer was completely consumed. */
+  if (pk->pos != pk->len)
+    goto fail;
+
+  /* return the model. */
+  return mdl;
+
+fail:
+  /* release the model and return failure. */
+  Py_DECREF(mdl);
+  return NULL;
+}
+
+/* model_fwrite(): write the complete state of a model, excluding its
+ * associated dataset, to a binary file. the state is written into a
+ * temporary file in the same directory, which then replaces the target
+ * file, so that models that have mapped the previous file keep their
+ * contents and a failed write leaves the target unchanged.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to access.
+ *  @fname: filename to write to.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_fwrite (const Model *mdl, const char *fname) {
+  /* check the input pointers. */
+  if (!mdl || !fname)
+    return 0;
+
+  /* pack the model state. */
+  Pack pk;
+  pack_init(&pk);
+  if (!model_pack(mdl, &pk)) {
+    pack_free(&pk);
+    return 0;
+  }
+
+  /* allocate the temporary filename. */
+  const size_t n = strlen(fname) + 64;
+  char *tmp = malloc(n);
+  if (!tmp) {
+    pack_free(&pk);
+    return 0;
+  }
+
+  /* create the temporary file, which receives the usual permissions
+   * of new files, under a name that is not already taken.
+   */
+  static unsigned int seq = 0;
+  int fd = -1;
+  for (unsigned int i = 0; i < 100 && fd < 0; i++) {
+    snprintf(tmp, n, "%s.%ld.%u.tmp", fname, (long) getpid(), seq++);
+    fd = open(tmp, O_WRONLY | O_CREAT | O_EXCL, 0666);
+    if (fd < 0 && errno != EEXIST)
+      break;
+  }
+
+  /* check for failures. */
+  if (fd < 0) {
+    pack_free(&pk);
+    free(tmp);
+    return 0;
+  }
+
+  /* write the packed state. */
+  int ok = 1;
+  for (size_t off = 0; off < pk.len && ok;) {
+    const ssize_t w = write(fd, pk.buf + off, pk.len - off);
+    ok = (w > 0);
+    off += (ok ? (size_t) w : 0);
+  }
+
+  /* flush the file to storage before it replaces the target. */
+  ok = ok && (fsync(fd) == 0);
+  ok = (close(fd) == 0) && ok;
+
+  /* replace the target file, or remove the temporary file. */
+  ok = ok && (rename(tmp, fname) == 0);
+  if (!ok)
+    unlink(tmp);
+
+  /* free the temporaries and return. */
+  pack_free(&pk);
+  free(tmp);
+  return ok;
+}
+
+/* model_fread(): read a model from a binary file written by
+ * model_fwrite(). the file is memory-mapped privately, and the weight
+ * posterior and intermediates of the model are views into the mapping,
+ * so processes that read the same file share its pages until they
+ * modify them.
+ *
+ * arguments:
+ *  @fname: filename to read from.
+ *
+ * returns:
+ *  pointer to a new model structure, or null on failure.
+ *  (New reference)
+ */
+Model *model_fread (const char *fname) {
+  /* check the input pointer. */
+  if (!fname)
+    return NULL;
+
+  /* open the file and determine its size. */
+  struct stat st;
+  const int fd = open(fname, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return NULL;
+  }
+
+  /* map the file contents privately. */
+  const size_t len = (size_t) st.st_size;
+  char *buf = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (buf == MAP_FAILED)
+    return NULL;
+
+  /* unpack the model in place. */
+  Pack pk;
+  pack_view(&pk, buf, len);
+  Model *mdl = model_unpack(&pk, 1);
+  if (!mdl) {
+    munmap(buf, len);
+    return NULL;
+  }
+
+  /* store the mapping and return the model. */
+  mdl->map = buf;
+  mdl->maplen = len;
+  return mdl;
+}
+
+/* model_unmap(): release the file mapping that holds the arrays of
+ * a model read by model_fread(). the arrays must no longer be used.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to modify.
+ */
+void model_unmap (Model *mdl) {
+  /* unmap the file, if any. */
+  if (mdl->map)
+    munmap(mdl->map, mdl->maplen);
+
+  /* reset the mapping. */
+  mdl->map = NULL;
+  mdl->maplen = 0;
+}
+
@@ -0,0 +1,555 @@
+
+/* include the vfl headers. */
+#include <vfl/vfl.h>
+#include <vfl/factor/product.h>
+
+/* include headers for compiling and loading kernels. */
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* JIT_FORMAT: constant format string used to generate c program
+ * source code for evaluating the covariances of gaussian processes
+ * derived from variational feature models.
+ */
+#define JIT_FORMAT "\n" \
+"#include <stddef.h>"                                               "\n" \
+"#include <math.h>"                                                 "\n" \
+""                                                                  "\n" \
+"static inline double vfl_covkernel (const double *par,"            "\n" \
+"                                    const double *x1,"             "\n" \
+"                                    const double *x2,"             "\n" \
+"                                    const size_t p1,"              "\n" \
+"                                    const size_t p2) {"            "\n" \
+"  /* initialize the covariance computation. */"                    "\n" \
+"  double cov, sum = 0.0;"                                          "\n" \
+""                                                                  "\n" \
+"  /* begin model-generated kernel code. */"                        "\n" \
+"  %s"                                                              "\n" \
+"  /* end model-generated kernel code. */"                          "\n" \
+""                                                                  "\n" \
+"  /* return the computed result. */"                               "\n" \
+"  return sum;"                                                     "\n" \
+"}"                                                                 "\n" \
+""                                                                  "\n" \
+"double vfl_cov (const double *par,"                                "\n" \
+"                const double nu, const double tau,"                "\n" \
+"                const double *x1, const double *x2,"               "\n" \
+"                const size_t p1, const size_t p2,"                 "\n" \
+"                const size_t D) {"                                 "\n" \
+"  /* test the input locations for equality. */"                    "\n" \
+"  int eq = 1;"                                                     "\n" \
+"  for (size_t d = 0; d < D; d++)"                                  "\n" \
+"    eq &= (x1[d] == x2[d]);"                                       "\n" \
+""                                                                  "\n" \
+"  /* return the computed result. */"                               "\n" \
+"  const double cov = vfl_covkernel(par, x1, x2, p1, p2);"          "\n" \
+"  return (cov / nu + (double) eq) / tau;"                          "\n" \
+"}"                                                                 "\n" \
+""                                                                  "\n" \
+"void vfl_cov_rows (const double *par,"                             "\n" \
+"                   const double nu, const double tau,"             "\n" \
+"                   const double *X1, const size_t *P1,"            "\n" \
+"                   const double *x2, const size_t p2,"             "\n" \
+"                   const size_t n, const size_t D,"                "\n" \
+"                   double *c, const size_t inc) {"                 "\n" \
+"  /* compute each covariance. */"                                  "\n" \
+"  for (size_t i = 0; i < n; i++)"                                  "\n" \
+"    c[i * inc] = vfl_cov(par, nu, tau, X1 + i * D, x2,"            "\n" \
+"                         P1[i], p2, D);"                           "\n" \
+"}\n"
+
+/* jit_flags: compiler arguments used to build kernel code into
+ * shared objects. floating-point contraction is disabled so that
+ * compiled covariances match those computed by model_cov().
+ */
+static const char *jit_flags[] = {
+  "-O3", "-march=native", "-ffp-contract=off",
+  "-fPIC", "-shared", "-w"
+};
+
+/* JitEntry: structure for holding a loaded (or failed) kernel. loaded
+ * kernels are retained for the lifetime of the process.
+ */
+typedef struct jit_entry {
+  /* @src: complete program source code.
+   * @cov: compiled single covariance function.
+   * @rows: compiled multiple covariance function.
+   * @next: next entry in the list.
+   */
+  char *src;
+  model_jit_cov_fn cov;
+  model_jit_rows_fn rows;
+  struct jit_entry *next;
+}
+JitEntry;
+
+/* jit_list: list of kernels requested by the current process.
+ * jit_lock: mutex guarding the list.
+ */
+static JitEntry *jit_list = NULL;
+static pthread_mutex_t jit_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* environ: process environment, passed to the compiler.
+ */
+extern char **environ;
+
+/* jit_enabled(): determine whether compiled kernels are enabled. they
+ * may be disabled by setting the VFL_JIT environment variable to zero.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) kernels are enabled.
+ */
+static int jit_enabled (void) {
+  /* check for a setting in the environment. */
+  const char *env = getenv("VFL_JIT");
+  return !(env && !strcmp(env, "0"));
+}
+
+/* jit_compiler(): determine the c compiler used to build kernels. the
+ * compiler is taken from the CC environment variable, or 'cc'.
+ *
+ * returns:
+ *  name of the compiler executable.
+ */
+static const char *jit_compiler (void) {
+  /* check for a compiler in the environment. */
+  const char *env = getenv("CC");
+  return (env && *env ? env : "cc");
+}
+
+/* jit_target_hash: hash of the code generation target of compiled
+ * kernels, computed once per process by jit_target_init().
+ */
+static uint64_t jit_target_hash = CACHE_HASH_INIT;
+static pthread_once_t jit_target_once = PTHREAD_ONCE_INIT;
+
+/* jit_target_init(): hash the code generation target that the flag
+ * '-march=native' resolves to on the host. the compiler is asked for
+ * the target options it enables, and the processor model and features
+ * are included for compilers that cannot report them. shared objects
+ * built on other hosts that share the cache directory therefore never
+ * collide.
+ */
+static void jit_target_init (void) {
+  /* build the compiler argument list. */
+  char *argv[] = {
+    (char*) jit_compiler(), "-march=native", "-Q", "--help=target", NULL
+  };
+
+  /* run the compiler with its output sent through a pipe. */
+  uint64_t h = CACHE_HASH_INIT;
+  posix_spawn_file_actions_t act;
+  int fd[2];
+  if (!pipe(fd)) {
+    pid_t pid;
+    int spawned = 0, status;
+    if (!posix_spawn_file_actions_init(&act)) {
+      posix_spawn_file_actions_adddup2(&act, fd[1], 1);
+      posix_spawn_file_actions_addopen(&act, 2, "/dev/null", O_WRONLY, 0);
+      posix_spawn_file_actions_addclose(&act, fd[0]);
+      posix_spawn_file_actions_addclose(&act, fd[1]);
+      spawned = !posix_spawnp(&pid, argv[0], &act, NULL, argv, environ);
+      posix_spawn_file_actions_destroy(&act);
+    }
+
+    /* hash the output of the compiler. */
+    close(fd[1]);
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd[0], buf, sizeof(buf) - 1)) > 0) {
+      buf[n] = '\0';
+      h = cache_hash(h, buf);
+    }
+
+    /* wait for the compiler to exit. */
+    close(fd[0]);
+    if (spawned)
+      waitpid(pid, &status, 0);
+  }
+
+  /* hash the model name and features of the first processor. */
+  FILE *fh = fopen("/proc/cpuinfo", "r");
+  if (fh) {
+    char *line = NULL;
+    size_t len = 0;
+    while (getline(&line, &len, fh) > 0 && strcmp(line, "\n")) {
+      if (!strncmp(line, "model name", 10) || !strncmp(line, "flags", 5))
+        h = cache_hash(h, line);
+    }
+
+    free(line);
+    fclose(fh);
+  }
+
+  /* store the hash. */
+  jit_target_hash = h;
+}
+
+/* jit_source(): build the complete program source code of the
+ * compiled covariance kernel of a model.
+ *
+ * arguments:
+ *  @mdl: model structure pointer to access.
+ *
+ * returns:
+ *  newly allocated program source string, or null if any factor
+ *  of the model does not support kernel code.
+ */
+static char *jit_source (const Model *mdl) {
+  /* get the model kernel code. */
+  char *ksrc = model_kernel(mdl);
+  if (!ksrc)
+    return NULL;
+
+  /* allocate the program source string. */
+  char *src = malloc(strlen(JIT_FORMAT) + strlen(ksrc) + 8);
+  if (src)
+    sprintf(src, JIT_FORMAT, ksrc);
+
+  /* free the kernel code and return the program source. */
+  free(ksrc);
+  return src;
+}
+
+/* jit_build(): compile program source code into a shared object. the
+ * object is written under a temporary name and then renamed, so that
+ * concurrent processes never load partially written objects.
+ *
+ * arguments:
+ *  @src: program source code.
+ *  @path: output shared object file name.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int jit_build (const char *src, const char *path) {
+  /* build the temporary file names. */
+  char csrc[CACHE_PATH + 32], tmp[CACHE_PATH + 32];
+  snprintf(csrc, sizeof(csrc), "%s.%ld.c", path, (long) getpid());
+  snprintf(tmp, sizeof(tmp), "%s.%ld", path, (long) getpid());
+
+  /* write the program source. */
+  FILE *fh = fopen(csrc, "w");
+  int ok = (fh != NULL);
+  ok = ok && fputs(src, fh) >= 0;
+  if (fh && fclose(fh))
+    ok = 0;
+
+  /* build the compiler argument list. */
+  const size_t nflags = sizeof(jit_flags) / sizeof(char*);
+  char *argv[nflags + 6];
+  size_t narg = 0;
+  argv[narg++] = (char*) jit_compiler();
+  for (size_t i = 0; i < nflags; i++)
+    argv[narg++] = (char*) jit_flags[i];
+
+  argv[narg++] = "-o";
+  argv[narg++] = tmp;
+  argv[narg++] = csrc;
+  argv[narg++] = "-lm";
+  argv[narg] = NULL;
+
+  /* run the compiler with its output discarded. */
+  posix_spawn_file_actions_t act;
+  pid_t pid;
+  int status = 0;
+  if (ok && !posix_spawn_file_actions_init(&act)) {
+    posix_spawn_file_actions_addopen(&act, 1, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&act, 2, "/dev/null", O_WRONLY, 0);
+    ok = (posix_spawnp(&pid, argv[0], &act, NULL, argv, environ) == 0 &&
+          waitpid(pid, &status, 0) == pid &&
+          WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    posix_spawn_file_actions_destroy(&act);
+  }
+  else
+    ok = 0;
+
+  /* move the object into place, or remove it. */
+  if (!ok || rename(tmp, path))
+    ok = (remove(tmp), 0);
+
+  /* remove the program source and return. */
+  remove(csrc);
+  return ok;
+}
+
+/* jit_load(): load the compiled functions from a shared object.
+ *
+ * arguments:
+ *  @path: shared object file name.
+ *  @ent: kernel entry to store the functions into.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int jit_load (const char *path, JitEntry *ent) {
+  /* open the shared object. */
+  void *lib = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (!lib)
+    return 0;
+
+  /* look up the functions. */
+  ent->cov = (model_jit_cov_fn) dlsym(lib, "vfl_cov");
+  ent->rows = (model_jit_rows_fn) dlsym(lib, "vfl_cov_rows");
+  if (!ent->cov || !ent->rows) {
+    ent->cov = NULL;
+    ent->rows = NULL;
+    dlclose(lib);
+    return 0;
+  }
+
+  /* return success. the object remains open. */
+  return 1;
+}
+
+/* jit_compile(): obtain the compiled functions of program source code,
+ * either from a shared object in the cache directory, or by compiling
+ * the source. when the cache is disabled, the source is compiled in
+ * a temporary directory that is removed after loading.
+ *
+ * arguments:
+ *  @ent: kernel entry holding the program source code.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int jit_compile (JitEntry *ent) {
+  /* hash the program source, compiler and compiler arguments. */
+  uint64_t h = cache_hash(CACHE_HASH_INIT, ent->src);
+  h = cache_hash(h, jit_compiler());
+  for (size_t i = 0; i < sizeof(jit_flags) / sizeof(char*); i++)
+    h = cache_hash(h, jit_flags[i]);
+
+  /* hash the target that the compiler arguments resolve to. */
+  char target[32];
+  pthread_once(&jit_target_once, jit_target_init);
+  snprintf(target, sizeof(target), "%016llx",
+           (unsigned long long) jit_target_hash);
+  h = cache_hash(h, target);
+
+  /* attempt to use the cache directory. */
+  char dir[CACHE_PATH], path[CACHE_PATH + 32];
+  if (cache_dir(dir)) {
+    /* build the object file name. */
+    snprintf(path, sizeof(path), "%s/%016llx.so", dir,
+             (unsigned long long) h);
+
+    /* load a cached object, or compile and load a new one. */
+    return (jit_load(path, ent) ||
+            (jit_build(ent->src, path) && jit_load(path, ent)));
+  }
+
+  /* otherwise, create a temporary directory. */
+  const char *tmpdir = getenv("TMPDIR");
+  snprintf(dir, sizeof(dir), "%s/vfl-XXXXXX",
+           tmpdir && *tmpdir ? tmpdir : "/tmp");
+  if (!mkdtemp(dir))
+    return 0;
+
+  /* compile and load the object, and remove the directory. */
+  snprintf(path, sizeof(path), "%s/%016llx.so", dir,
+           (unsigned long long) h);
+
+  const int ok = (jit_build(ent->src, path) && jit_load(path, ent));
+  remove(path);
+  rmdir(dir);
+
+  /* return the result. */
+  return ok;
+}
+
+/* jit_lookup(): obtain the compiled functions of program source code,
+ * compiling the source only on its first request by the process.
+ *
+ * arguments:
+ *  @src: program source code.
+ *  @cov: pointer to the output single covariance function.
+ *  @rows: pointer to the output multiple covariance function.
+ */
+static void jit_lookup (const char *src, model_jit_cov_fn *cov,
+                        model_jit_rows_fn *rows) {
+  /* search the list for the source. */
+  pthread_mutex_lock(&jit_lock);
+  JitEntry *ent = jit_list;
+  while (ent && strcmp(ent->src, src))
+    ent = ent->next;
+
+  /* on the first request, compile the source. failures are recorded
+   * in the list as well, so that they are not repeated.
+   */
+  if (!ent) {
+    ent = malloc(sizeof(JitEntry));
+    char *str = malloc(strlen(src) + 1);
+    if (ent && str) {
+      ent->src = strcpy(str, src);
+      ent->cov = NULL;
+      ent->rows = NULL;
+      jit_compile(ent);
+
+      ent->next = jit_list;
+      jit_list = ent;
+    }
+    else {
+      free(ent);
+      free(str);
+      ent = NULL;
+    }
+  }
+
+  /* output the functions. */
+  *cov = (ent ? ent->cov : NULL);
+  *rows = (ent ? ent->rows : NULL);
+  pthread_mutex_unlock(&jit_lock);
+}
+
+/* jit_params(): copy the parameters of a factor into a kernel
+ * parameter array. the parameters of product factors are copied from
+ * their members, in the order used to build their kernel code.
+ *
+ * arguments:
+ *  @f: factor structure pointer to access.
+ *  @par: output parameter array.
+ *
+ * returns:
+ *  number of parameters copied.
+ */
+static size_t jit_params (const Factor *f, double *par) {
+  /* copy the parameters of each product member. */
+  if (Product_Check(f)) {
+    size_t P = 0;
+    for (size_t n = 0; n < Product_GET_SIZE(f); n++)
+      P += jit_params(Product_GET_ITEM(f, n), par + P);
+
+    return P;
+  }
+
+  /* copy the parameters of the factor. */
+  for (size_t p = 0; p < f->par->len; p++)
+    par[p] = vector_get(f->par, p);
+
+  /* return the parameter count. */
+  return f->par->len;
+}
+
+/* model_jit_init(): prepare the compiled covariance kernel of a model
+ * for evaluation at its current state. kernels are compiled on first
+ * use and cached alongside compiled search programs. when a kernel is
+ * unavailable, for example when a factor does not support kernel code
+ * or no compiler is present, covariances are computed by model_cov().
+ *
+ * arguments:
+ *  @jit: compiled kernel structure, zeroed or previously initialized.
+ *  @mdl: model structure pointer to access.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int model_jit_init (ModelJit *jit, const Model *mdl) {
+  /* check the input pointers. */
+  if (!jit || !mdl)
+    return 0;
+
+  /* resize the parameter array. */
+  double *par = realloc(jit->par, (mdl->P + 1) * sizeof(double));
+  if (!par)
+    return 0;
+
+  /* store the noise precision and weight ratio, as for the opencl
+   * kernel, and the current factor parameters.
+   */
+  par[0] = 1.0 / (mdl->nu * mdl->tau);
+  for (size_t j = 0, p0 = 1; j < mdl->M; j++)
+    p0 += jit_params(mdl->factors[j], par + p0);
+
+  /* store the model state. */
+  jit->mdl = mdl;
+  jit->par = par;
+  jit->nu = mdl->nu;
+  jit->tau = mdl->tau;
+  jit->D = mdl->D;
+
+  /* obtain the compiled functions, if possible. */
+  jit->cov = NULL;
+  jit->rows = NULL;
+  if (jit_enabled()) {
+    char *src = jit_source(mdl);
+    if (src)
+      jit_lookup(src, &jit->cov, &jit->rows);
+
+    free(src);
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* model_jit_free(): free the contents of a compiled kernel structure.
+ *
+ * arguments:
+ *  @jit: compiled kernel structure to free.
+ */
+void model_jit_free (ModelJit *jit) {
+  /* free the parameter array and reset the structure. */
+  free(jit->par);
+  memset(jit, 0, sizeof(ModelJit));
+}
+
+/* model_jit_cov(): return the covariance of a model function at two
+ * input locations, as by model_cov().
+ *
+ * arguments:
+ *  @jit: compiled kernel structure to access.
+ *  @x1: first input location.
+ *  @x2: second input location.
+ *  @p1: first function output index.
+ *  @p2: second function output index.
+ *
+ * returns:
+ *  covariance of the model function.
+ */
+double model_jit_cov (const ModelJit *jit,
+                      const double *x1, const double *x2,
+                      size_t p1, size_t p2) {
+  /* use the compiled function, if available. */
+  if (jit->cov)
+    return jit->cov(jit->par, jit->nu, jit->tau, x1, x2, p1, p2, jit->D);
+
+  /* otherwise, fall back to the factor functions. */
+  VectorView v1 = vector_view_array((double*) x1, jit->D);
+  VectorView v2 = vector_view_array((double*) x2, jit->D);
+  return model_cov(jit->mdl, &v1, &v2, p1, p2);
+}
+
+/* model_jit_rows(): compute the covariances of a model function between
+ * an array of input locations and a single input location.
+ *
+ * arguments:
+ *  @jit: compiled kernel structure to access.
+ *  @X1: array of first input locations, one per D elements.
+ *  @P1: array of first function output indices.
+ *  @x2: second input location.
+ *  @p2: second function output index.
+ *  @n: number of first input locations.
+ *  @c: output array of covariances.
+ *  @inc: stride between elements of @c.
+ */
+void model_jit_rows (const ModelJit *jit,
+                     const double *X1, const size_t *P1,
+                     const double *x2, size_t p2,
+                     size_t n, double *c, size_t inc) {
+  /* use the compiled function, if available. */
+  if (jit->rows) {
+    jit->rows(jit->par, jit->nu, jit->tau, X1, P1, x2, p2,
+              n, jit->D, c, inc);
+    return;
+  }
+
+  /* otherwise, fall back to the factor functions. */
+  for (size_t i = 0; i < n; i++)
+    c[i * inc] = model_jit_cov(jit, X1 + i * jit->D, x2, P1[i], p2);
+}
+
@@ -34,6 +34,22 @@ PyDoc_STRVAR(
 "Prior noise/weight precision ratio (read/write)\n"
 "\n");
 
+PyDoc_STRVAR(
+  Model_getset_cache_doc,
+"Memory budget of the moment cache, in bytes (read/write)\n"
+"\n");
+
+PyDoc_STRVAR(
+  Model_getset_supptol_doc,
+"Tolerance below which the moments of impulse factors are treated\n"
+"as zero, in [0, 1) (read/write)\n"
+"\n"
+"When positive, factors are only evaluated at the observations within\n"
+"their effective support, which is located using a sorted index of\n"
+"the dataset. When zero, every factor is evaluated at every\n"
+"observation.\n"
+"\n");
+
 PyDoc_STRVAR(
   Model_getset_wmean_doc,
 "Weight mean parameters (read/write)\n"
@@ -74,6 +90,17 @@ PyDoc_STRVAR(
 "Infer the linear parameters of a model.\n"
 "\n");
 
+PyDoc_STRVAR(
+  Model_method_observe_doc,
+"Add an observation into the dataset of a model, and update the\n"
+"linear parameters of the model to include it.\n"
+"\n"
+"The update costs O(K^2) for K weights and does not revisit the\n"
+"previous observations, whose contributions must be current (as\n"
+"they are after infer()). Classification models keep the logistic\n"
+"parameters of the previous observations.\n"
+"\n");
+
 PyDoc_STRVAR(
   Model_method_mean_doc,
 "Mean of a model at a given input.\n"
@@ -87,8 +114,116 @@ PyDoc_STRVAR(
 PyDoc_STRVAR(
   Model_method_predict_doc,
 "Predict multiple means and variances of a model.\n"
+"\n"
+"Predictions are stored into the 'mean' and 'var' datasets, or,\n"
+"if a list of locations 'x' is given, returned as a tuple of\n"
+"arrays of means and variances at the given 'output' index.\n"
+"\n");
+
+PyDoc_STRVAR(
+  Model_method_save_doc,
+"Write a model to a binary file.\n"
+"\n"
+"The factors, priors and weight posterior are stored, but the\n"
+"associated dataset is not.\n"
+"\n");
+
+PyDoc_STRVAR(
+  Model_method_load_doc,
+"Read a model from a binary file written by save().\n"
+"\n"
+"The file is memory-mapped privately, so that processes which\n"
+"load the same file share its pages until they modify the model.\n"
+"The restored model has no associated dataset.\n"
+"\n");
+
+PyDoc_STRVAR(
+  Model_method_tobytes_doc,
+"Return the binary representation of a model, as written by save().\n"
+"\n");
+
+PyDoc_STRVAR(
+  Model_method_frombytes_doc,
+"Create a model from a binary representation returned by tobytes().\n"
 "\n");
 
+/* Model_check_arrays(): check that no python arrays view the weight
+ * means and covariances of a model, which are reallocated whenever
+ * its factors change.
+ */
+static int
+Model_check_arrays (Model *self) {
+  /* fail if any arrays are alive. */
+  if (self->arrays) {
+    PyErr_SetString(PyExc_BufferError, "model arrays are in use");
+    return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* Model_check_busy(): check that a model may be accessed, which is not
+ * the case while a computation modifying it runs without the interpreter
+ * lock, or while any computation runs if the access modifies the model.
+ */
+static int
+Model_check_busy (Model *self, int write) {
+  /* fail if a conflicting computation is running. */
+  if (self->excl || (write && self->busy)) {
+    PyErr_SetString(PyExc_RuntimeError, "model is in use");
+    return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* Model_hold(): mark a model as in use by a computation that runs
+ * without the interpreter lock, failing if it conflicts with another.
+ */
+static int
+Model_hold (Model *self, int excl) {
+  /* attempt to hold the model. */
+  if (!model_hold(self, excl)) {
+    PyErr_SetString(PyExc_RuntimeError, "model is in use");
+    return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* Model_hold_data(): mark an output dataset of a computation that runs
+ * without the interpreter lock as in use, failing if it already is.
+ */
+static int
+Model_hold_data (Data *dat) {
+  /* accept null datasets. */
+  if (!dat)
+    return 1;
+
+  /* fail if the dataset is in use. */
+  if (dat->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "dataset is in use");
+    return 0;
+  }
+
+  /* mark the dataset and return success. */
+  dat->busy++;
+  return 1;
+}
+
+/* Model_release_data(): release an output dataset held by
+ * Model_hold_data().
+ */
+static void
+Model_release_data (Data *dat) {
+  /* release non-null datasets. */
+  if (dat)
+    dat->busy--;
+}
+
 /* Model_seq_len(): method for getting model factor counts.
  */
 static Py_ssize_t
@@ -130,6 +265,10 @@ Model_seq_set (Model *self, Py_ssize_t i, PyObject *v) {
     return -1;
   }
 
+  /* check that the model and its weights may be modified. */
+  if (!Model_check_busy(self, 1) || !Model_check_arrays(self))
+    return -1;
+
   /* attempt to place the factor into the model. */
   if (!model_set_factor(self, i, (Factor*) v)) {
     PyErr_SetString(PyExc_RuntimeError, "failed to set factor");
@@ -170,6 +309,10 @@ Model_get_weights (Model *self) {
  */
 static PyObject*
 Model_get_bound (Model *self) {
+  /* check that the model is not being modified. */
+  if (!Model_check_busy(self, 0))
+    return NULL;
+
   /* return the bound as a float. */
   return PyFloat_FromDouble(model_bound(self));
 }
@@ -188,7 +331,7 @@ static int
 Model_set_nu (Model *mdl, PyObject *value, void *closure) {
   /* get the new value. */
   const double nu = PyFloat_AsDouble(value);
-  if (PyErr_Occurred())
+  if (PyErr_Occurred() || !Model_check_busy(mdl, 1))
     return -1;
 
   /* set the noise/weight precision ratio. */
@@ -201,18 +344,79 @@ Model_set_nu (Model *mdl, PyObject *value, void *closure) {
   return 0;
 }
 
+/* Model_get_cache(): method to get model moment cache budgets.
+ */
+static PyObject*
+Model_get_cache (Model *self) {
+  /* return the memory budget as an integer. */
+  return PyLong_FromSize_t(self->budget);
+}
+
+/* Model_set_cache(): method to set model moment cache budgets.
+ */
+static int
+Model_set_cache (Model *self, PyObject *value, void *closure) {
+  /* get the new value. */
+  const long bytes = PyLong_AsLong(value);
+  if (PyErr_Occurred() || !Model_check_busy(self, 1))
+    return -1;
+
+  /* check that the value is in bounds. */
+  if (bytes < 0) {
+    PyErr_SetString(PyExc_ValueError, "expected non-negative budget");
+    return -1;
+  }
+
+  /* set the budget and return success. */
+  model_set_budget(self, (size_t) bytes);
+  return 0;
+}
+
+/* Model_get_supptol(): method to get model support tolerances.
+ */
+static PyObject*
+Model_get_supptol (Model *self) {
+  /* return the tolerance as a float. */
+  return PyFloat_FromDouble(self->stol);
+}
+
+/* Model_set_supptol(): method to set model support tolerances.
+ */
+static int
+Model_set_supptol (Model *self, PyObject *value, void *closure) {
+  /* get the new value. */
+  const double v = PyFloat_AsDouble(value);
+  if (PyErr_Occurred() || !Model_check_busy(self, 1))
+    return -1;
+
+  /* set the new value. */
+  if (!model_set_support_tol(self, v)) {
+    PyErr_SetString(PyExc_ValueError, "expected float in [0, 1)");
+    return -1;
+  }
+
+  /* return success. */
+  return 0;
+}
+
 /* Model_get_wmean(): method to get model weight means.
  */
 static PyObject*
 Model_get_wmean (Model *self) {
-  /* return the weight means as a list. */
-  return PyList_FromVector(self->wbar);
+  /* return a read-only view of the weight means. */
+  return Array_View((PyObject*) self, &self->arrays,
+                    self->wbar ? self->wbar->data : NULL,
+                    ARRAY_DOUBLE, 1, self->K, 0, 1);
 }
 
 /* Model_set_wmean(): method to set model weight means.
  */
 static int
 Model_set_wmean (Model *self, PyObject *value, void *closure) {
+  /* check that the model may be modified. */
+  if (!Model_check_busy(self, 1))
+    return -1;
+
   /* get the new value. */
   Vector *wbar = PySequence_AsVector(value);
   if (!wbar)
@@ -225,9 +429,12 @@ Model_set_wmean (Model *self, PyObject *value, void *closure) {
     return -1;
   }
 
-  /* copy the vector contents. */
+  /* copy the vector contents, which must no longer be updated
+   * by observations.
+   */
   vector_copy(self->wbar, wbar);
   vector_free(wbar);
+  self->iver = 0;
 
   /* return success. */
   return 0;
@@ -237,14 +444,20 @@ Model_set_wmean (Model *self, PyObject *value, void *closure) {
  */
 static PyObject*
 Model_get_wcov (Model *self) {
-  /* return the weight covariances as a list. */
-  return PyList_FromMatrix(self->Sigma);
+  /* return a read-only view of the weight covariances. */
+  return Array_View((PyObject*) self, &self->arrays,
+                    self->Sigma ? self->Sigma->data : NULL,
+                    ARRAY_DOUBLE, 2, self->K, self->K, 1);
 }
 
 /* Model_set_wcov(): method to set model weight covariances.
  */
 static int
 Model_set_wcov (Model *self, PyObject *value, void *closure) {
+  /* check that the model may be modified. */
+  if (!Model_check_busy(self, 1))
+    return -1;
+
   /* get the new value. */
   Matrix *Sigma = PySequence_AsMatrix(value);
   if (!Sigma)
@@ -283,9 +496,12 @@ Model_set_wcov (Model *self, PyObject *value, void *closure) {
   chol_invert(L, Sigma);
   matrix_copy(self->Sinv, Sigma);
 
-  /* free the temporary matrices. */
+  /* free the temporary matrices. the weights must no longer be
+   * updated by observations.
+   */
   matrix_free(Sigma);
   matrix_free(L);
+  self->iver = 0;
 
   /* return success. */
   return 0;
@@ -314,6 +530,10 @@ Model_set_data (Model *self, PyObject *value, void *closure) {
     return -1;
   }
 
+  /* check that the model may be modified. */
+  if (!Model_check_busy(self, 1))
+    return -1;
+
   /* attempt to set the new dataset. */
   if (!model_set_data(self, (Data*) value)) {
     PyErr_SetString(PyExc_RuntimeError, "failed to set data");
@@ -354,6 +574,10 @@ Model_set_factors (Model *self, PyObject *value, void *closure) {
     return -1;
   }
 
+  /* check that the model and its weights may be modified. */
+  if (!Model_check_busy(self, 1) || !Model_check_arrays(self))
+    return -1;
+
   /* accept either factors or sequences of factors. */
   if (Factor_Check(value)) {
     /* clear the factors from the model and add the new factor. */
@@ -438,6 +662,10 @@ Model_get_priors (Model *self) {
  */
 static PyObject*
 Model_method_reset (Model *self, PyObject *args) {
+  /* check that the model may be modified. */
+  if (!Model_check_busy(self, 1))
+    return NULL;
+
   /* reset the model and return nothing. */
   model_reset(self);
   Py_RETURN_NONE;
@@ -453,6 +681,10 @@ Model_method_add (Model *self, PyObject *args) {
     return NULL;
   }
 
+  /* check that the model and its weights may be modified. */
+  if (!Model_check_busy(self, 1) || !Model_check_arrays(self))
+    return NULL;
+
   /* loop over the arguments. */
   const Py_ssize_t n = PyTuple_GET_SIZE(args);
   for (Py_ssize_t i = 0; i < n; i++) {
@@ -480,8 +712,77 @@ Model_method_add (Model *self, PyObject *args) {
  */
 static PyObject*
 Model_method_infer (Model *self, PyObject *args) {
-  /* run inference and return nothing. */
+  /* hold the model for modification. */
+  if (!Model_hold(self, 1))
+    return NULL;
+
+  /* run inference without holding the interpreter lock. */
+  Py_BEGIN_ALLOW_THREADS
   model_infer(self);
+  Py_END_ALLOW_THREADS
+
+  /* release the model. */
+  model_release(self);
+
+  /* return nothing. */
+  Py_RETURN_NONE;
+}
+
+/* Model_method_observe(): add an observation into the dataset of
+ * a model, and update its weights.
+ */
+static PyObject*
+Model_method_observe (Model *self, PyObject *args) {
+  /* parse the observation. */
+  Datum *d = NULL;
+  if (!PyArg_ParseTuple(args, "O!", &Datum_Type, &d))
+    return NULL;
+
+  /* check that the model has a dataset. */
+  if (!self->dat) {
+    PyErr_SetString(PyExc_ValueError, "model has no associated dataset");
+    return NULL;
+  }
+
+  /* the dataset arrays may not be reallocated while they are viewed. */
+  if (self->dat->arrays) {
+    PyErr_SetString(PyExc_BufferError, "dataset arrays are in use");
+    return NULL;
+  }
+
+  /* the dataset may not be read by any other computation. */
+  if (self->dat->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "dataset is in use");
+    return NULL;
+  }
+
+  /* check the observation dimensionality. */
+  if ((self->dat->N && d->x->len != self->dat->D) ||
+      (self->D && d->x->len < self->D)) {
+    PyErr_SetString(PyExc_ValueError, "datum dimension mismatch");
+    return NULL;
+  }
+
+  /* hold the model for modification. */
+  if (!Model_hold(self, 1))
+    return NULL;
+
+  /* observe the datum without holding the interpreter lock. */
+  int ok;
+  Py_BEGIN_ALLOW_THREADS
+  ok = model_observe(self, d);
+  Py_END_ALLOW_THREADS
+
+  /* release the model. */
+  model_release(self);
+
+  /* check for failures. */
+  if (!ok) {
+    PyErr_SetString(PyExc_RuntimeError, "failed to observe datum");
+    return NULL;
+  }
+
+  /* return nothing. */
   Py_RETURN_NONE;
 }
 
@@ -500,6 +801,9 @@ Model_method_mean (Model *self, PyObject *args) {
   /* first try: parse a datum. */
   if (PyArg_ParseTuple(args, "O!", &Datum_Type, &d)) {
     double mean = 0.0, var = 0.0;
+    if (!Model_check_busy(self, 0))
+      return NULL;
+
     if (model_predict(self, d->x, d->p, &mean, &var))
       return PyFloat_FromDouble(mean);
     else {
@@ -511,7 +815,23 @@ Model_method_mean (Model *self, PyObject *args) {
   /* second try: parse a dataset. */
   PyErr_Clear();
   if (PyArg_ParseTuple(args, "O!", &Data_Type, &dat)) {
-    if (model_predict_all(self, dat, NULL))
+    if (!Model_hold_data(dat))
+      return NULL;
+
+    if (!Model_hold(self, 0)) {
+      Model_release_data(dat);
+      return NULL;
+    }
+
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = model_predict_all(self, dat, NULL);
+    Py_END_ALLOW_THREADS
+
+    model_release(self);
+    Model_release_data(dat);
+
+    if (status)
       Py_RETURN_NONE;
     else {
       PyErr_SetString(PyExc_RuntimeError, "data dimension mismatch");
@@ -538,6 +858,9 @@ Model_method_var (Model *self, PyObject *args) {
   /* first try: parse a datum. */
   if (PyArg_ParseTuple(args, "O!", &Datum_Type, &d)) {
     double mean = 0.0, var = 0.0;
+    if (!Model_check_busy(self, 0))
+      return NULL;
+
     if (model_predict(self, d->x, d->p, &mean, &var))
       return PyFloat_FromDouble(var);
     else {
@@ -549,7 +872,23 @@ Model_method_var (Model *self, PyObject *args) {
   /* second try: parse a dataset. */
   PyErr_Clear();
   if (PyArg_ParseTuple(args, "O!", &Data_Type, &dat)) {
-    if (model_predict_all(self, NULL, dat))
+    if (!Model_hold_data(dat))
+      return NULL;
+
+    if (!Model_hold(self, 0)) {
+      Model_release_data(dat);
+      return NULL;
+    }
+
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = model_predict_all(self, NULL, dat);
+    Py_END_ALLOW_THREADS
+
+    model_release(self);
+    Model_release_data(dat);
+
+    if (status)
       Py_RETURN_NONE;
     else {
       PyErr_SetString(PyExc_RuntimeError, "data dimension mismatch");
@@ -571,16 +910,88 @@ Model_method_predict (Model *self, PyObject *args, PyObject *kwargs) {
 
   /* declare variables for parsing arguments. */
   Data *mean = NULL, *var = NULL;
+  Matrix *X = NULL;
+  size_t p = 0;
 
-  /* parse the datasets. */
-  static char *kwlist[] = { "mean", "var", NULL };
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$O!O!", kwlist,
+  /* parse the datasets or locations. */
+  static char *kwlist[] = { "mean", "var", "x", "output", NULL };
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$O!O!O&O&", kwlist,
                                    &Data_Type, &mean,
-                                   &Data_Type, &var))
+                                   &Data_Type, &var,
+                                   Matrix_Converter, &X,
+                                   PySize_t_Converter, &p))
                                      return NULL;
 
-  /* execute the prediction. */
-  if (!model_predict_all(self, mean, var)) {
+  /* if locations were given, return arrays of predictions. */
+  if (X) {
+    /* hold the model for prediction. */
+    if (!Model_hold(self, 0)) {
+      matrix_free(X);
+      return NULL;
+    }
+
+    /* allocate the output arrays. */
+    PyObject *mu = Array_New(X->rows);
+    PyObject *eta = Array_New(X->rows);
+    PyObject *tup = (mu && eta ? PyTuple_Pack(2, mu, eta) : NULL);
+    Py_XDECREF(mu);
+    Py_XDECREF(eta);
+    if (!tup) {
+      model_release(self);
+      matrix_free(X);
+      return NULL;
+    }
+
+    /* execute the prediction without holding the interpreter lock. */
+    double *mdata = (double*) ((Array*) mu)->data;
+    double *vdata = (double*) ((Array*) eta)->data;
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = model_predict_array(self, X, p, mdata, vdata);
+    Py_END_ALLOW_THREADS
+
+    /* release the model, free the locations and check for failures. */
+    model_release(self);
+    matrix_free(X);
+    if (!status) {
+      PyErr_SetString(PyExc_RuntimeError, "failed to compute predictions");
+      Py_DECREF(tup);
+      return NULL;
+    }
+
+    /* return the means and variances. */
+    return tup;
+  }
+
+  /* hold the output datasets and the model. */
+  Data *vout = (var != mean ? var : NULL);
+  if (!Model_hold_data(mean))
+    return NULL;
+
+  if (!Model_hold_data(vout)) {
+    Model_release_data(mean);
+    return NULL;
+  }
+
+  if (!Model_hold(self, 0)) {
+    Model_release_data(mean);
+    Model_release_data(vout);
+    return NULL;
+  }
+
+  /* execute the prediction without holding the interpreter lock. */
+  int status;
+  Py_BEGIN_ALLOW_THREADS
+  status = model_predict_all(self, mean, var);
+  Py_END_ALLOW_THREADS
+
+  /* release the model and the output datasets. */
+  model_release(self);
+  Model_release_data(mean);
+  Model_release_data(vout);
+
+  /* check for failures. */
+  if (!status) {
     PyErr_SetString(PyExc_RuntimeError, "failed to compute predictions");
     return NULL;
   }
@@ -589,6 +1000,153 @@ Model_method_predict (Model *self, PyObject *args, PyObject *kwargs) {
   Py_RETURN_NONE;
 }
 
+/* Model_method_save(): write a model to a binary file.
+ */
+static PyObject*
+Model_method_save (Model *self, PyObject *args, PyObject *kwargs) {
+  /* define the keyword argument list. */
+  static char *kwlist[] = { "file", NULL };
+
+  /* parse the filename argument. */
+  PyObject *fobj = NULL;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&", kwlist,
+                                   PyUnicode_FSConverter, &fobj))
+    return NULL;
+
+  /* check that the model is not being modified. */
+  if (!Model_check_busy(self, 0)) {
+    Py_DECREF(fobj);
+    return NULL;
+  }
+
+  /* write the model to the file. */
+  const int status = model_fwrite(self, PyBytes_AsString(fobj));
+
+  /* release the filename and check for failures. */
+  Py_DECREF(fobj);
+  if (!status) {
+    PyErr_SetNone(PyExc_IOError);
+    return NULL;
+  }
+
+  /* return nothing. */
+  Py_RETURN_NONE;
+}
+
+/* Model_check_type(): check that a restored model is an instance of
+ * the class through which it was requested.
+ */
+static PyObject*
+Model_check_type (PyObject *cls, Model *mdl) {
+  /* check the model type. */
+  if (!PyObject_TypeCheck((PyObject*) mdl, (PyTypeObject*) cls)) {
+    PyErr_Format(PyExc_TypeError, "expected %s, found %s",
+                 ((PyTypeObject*) cls)->tp_name, Py_TYPE(mdl)->tp_name);
+    Py_DECREF(mdl);
+    return NULL;
+  }
+
+  /* return the model. */
+  return (PyObject*) mdl;
+}
+
+/* Model_method_load(): read a model from a binary file.
+ */
+static PyObject*
+Model_method_load (PyObject *cls, PyObject *args, PyObject *kwargs) {
+  /* define the keyword argument list. */
+  static char *kwlist[] = { "file", NULL };
+
+  /* parse the filename argument. */
+  PyObject *fobj = NULL;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&", kwlist,
+                                   PyUnicode_FSConverter, &fobj))
+    return NULL;
+
+  /* read the model from the file. */
+  Model *mdl = model_fread(PyBytes_AsString(fobj));
+
+  /* release the filename and check for failures. */
+  Py_DECREF(fobj);
+  if (!mdl) {
+    PyErr_SetString(PyExc_IOError, "failed to read model file");
+    return NULL;
+  }
+
+  /* return the model. */
+  return Model_check_type(cls, mdl);
+}
+
+/* Model_method_tobytes(): return the binary representation of a model.
+ */
+static PyObject*
+Model_method_tobytes (Model *self, PyObject *args) {
+  /* check that the model is not being modified. */
+  if (!Model_check_busy(self, 0))
+    return NULL;
+
+  /* pack the model state. */
+  Pack pk;
+  pack_init(&pk);
+  if (!model_pack(self, &pk)) {
+    pack_free(&pk);
+    PyErr_SetString(PyExc_RuntimeError, "failed to pack model");
+    return NULL;
+  }
+
+  /* return the packed state as bytes. */
+  PyObject *bytes = PyBytes_FromStringAndSize(pk.buf, pk.len);
+  pack_free(&pk);
+  return bytes;
+}
+
+/* Model_method_frombytes(): create a model from its binary
+ * representation.
+ */
+static PyObject*
+Model_method_frombytes (PyObject *cls, PyObject *args) {
+  /* parse the buffer argument. */
+  Py_buffer buf;
+  if (!PyArg_ParseTuple(args, "y*", &buf))
+    return NULL;
+
+  /* unpack a copy of the model state. */
+  Pack pk;
+  pack_view(&pk, buf.buf, buf.len);
+  Model *mdl = model_unpack(&pk, 0);
+
+  /* release the buffer and check for failures. */
+  PyBuffer_Release(&buf);
+  if (!mdl) {
+    PyErr_SetString(PyExc_ValueError, "invalid model representation");
+    return NULL;
+  }
+
+  /* return the model. */
+  return Model_check_type(cls, mdl);
+}
+
+/* Model_method_reduce(): return the pickled state of a model.
+ */
+static PyObject*
+Model_method_reduce (Model *self, PyObject *args) {
+  /* get the constructor, which is resolved through the base type. */
+  PyObject *fn = PyObject_GetAttrString((PyObject*) &Model_Type,
+                                        "frombytes");
+  if (!fn)
+    return NULL;
+
+  /* get the binary representation. */
+  PyObject *bytes = Model_method_tobytes(self, NULL);
+  if (!bytes) {
+    Py_DECREF(fn);
+    return NULL;
+  }
+
+  /* return the constructor and its arguments. */
+  return Py_BuildValue("(N(N))", fn, bytes);
+}
+
 /* --- */
 
 /* Model_new(): allocation method for models.
@@ -625,6 +1183,22 @@ Model_dealloc (Model *self) {
   matrix_free(self->L);
   vector_free(self->h);
 
+  /* free the batched moment buffers. */
+  matrix_free(self->Phi);
+  matrix_free(self->Psi);
+  vector_free(self->hc);
+  vector_free(self->Gc);
+  vector_free(self->vc);
+
+  /* free the moment cache. */
+  for (size_t j = 0; self->Omega && j < self->M; j++)
+    matrix_free(self->Omega[j]);
+
+  free(self->Omega);
+  free(self->mver);
+  free(self->over);
+  free(self->oused);
+
   /* release the reference to the associated dataset. */
   Py_XDECREF(self->dat);
 
@@ -642,6 +1216,9 @@ Model_dealloc (Model *self) {
   /* free the temporary vector. */
   vector_free(self->tmp);
 
+  /* release the file mapping, now that no arrays view it. */
+  model_unmap(self);
+
   /* release the object memory. */
   Py_TYPE(self)->tp_free((PyObject*) self);
 }
@@ -731,6 +1308,18 @@ static PyGetSetDef Model_getset[] = {
     Model_getset_nu_doc,
     NULL
   },
+  { "cache",
+    (getter) Model_get_cache,
+    (setter) Model_set_cache,
+    Model_getset_cache_doc,
+    NULL
+  },
+  { "support_tol",
+    (getter) Model_get_supptol,
+    (setter) Model_set_supptol,
+    Model_getset_supptol_doc,
+    NULL
+  },
   { "wbar",
     (getter) Model_get_wmean,
     (setter) Model_set_wmean,
@@ -782,6 +1371,11 @@ static PyMethodDef Model_methods[] = {
     METH_VARARGS,
     Model_method_infer_doc
   },
+  { "observe",
+    (PyCFunction) Model_method_observe,
+    METH_VARARGS,
+    Model_method_observe_doc
+  },
   { "mean",
     (PyCFunction) Model_method_mean,
     METH_VARARGS,
@@ -797,6 +1391,31 @@ static PyMethodDef Model_methods[] = {
     METH_VARARGS | METH_KEYWORDS,
     Model_method_predict_doc
   },
+  { "save",
+    (PyCFunction) Model_method_save,
+    METH_VARARGS | METH_KEYWORDS,
+    Model_method_save_doc
+  },
+  { "load",
+    (PyCFunction) Model_method_load,
+    METH_VARARGS | METH_KEYWORDS | METH_CLASS,
+    Model_method_load_doc
+  },
+  { "tobytes",
+    (PyCFunction) Model_method_tobytes,
+    METH_NOARGS,
+    Model_method_tobytes_doc
+  },
+  { "frombytes",
+    (PyCFunction) Model_method_frombytes,
+    METH_VARARGS | METH_CLASS,
+    Model_method_frombytes_doc
+  },
+  { "__reduce__",
+    (PyCFunction) Model_method_reduce,
+    METH_NOARGS,
+    NULL
+  },
   { NULL }
 };
 
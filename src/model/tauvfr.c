@@ -88,6 +88,17 @@ MODEL_PREDICT (TauVFR) {
   return 1;
 }
 
+/* TauVFR_predict_moments(): return the prediction of a fixed-tau vfr model
+ * from the moments of its latent function.
+ *  - see model_predict_moments_fn() for more information.
+ */
+MODEL_PREDICT_MOMENTS (TauVFR) {
+  /* include the expected noise variance into the predicted variance. */
+  const double tauinv = 1.0 / mdl->tau;
+  *mean = mu;
+  *var = tauinv + eta;
+}
+
 /* TauVFR_infer(): perform complete inference in a fixed-tau vfr model.
  *  - see model_infer_fn() for more information.
  */
@@ -95,61 +106,18 @@ MODEL_INFER (TauVFR) {
   /* gain access to the dataset structure members. */
   const size_t N = mdl->dat->N;
   Data *dat = mdl->dat;
-  Datum *di;
-
-  /* declare views into the weight precisions and the projections. */
-  MatrixView G;
-  VectorView h;
-
-  /* loop over the factors. */
-  for (size_t j1 = 0, i1 = 0; j1 < mdl->M; j1++) {
-    /* get the projection subvector. */
-    const size_t K1 = mdl->factors[j1]->K;
-    h = vector_subvector(mdl->h, i1, K1);
-
-    /* loop over the weights of the current factor. */
-    for (size_t k1 = 0; k1 < K1; k1++) {
-      /* initialize the projection subvector element. */
-      double hk = 0.0;
-
-      /* compute the contributions of each observation. */
-      for (size_t i = 0; i < N; i++) {
-        di = data_get(dat, i);
-        hk += di->y * model_mean(mdl, di->x, di->p, j1, k1);
-      }
 
-      /* store the projection subvector element. */
-      vector_set(&h, k1, hk);
-
-      /* loop again over the factors. */
-      for (size_t j2 = 0, i2 = 0; j2 < mdl->M; j2++) {
-        /* get the precision submatrix. */
-        const size_t K2 = mdl->factors[j2]->K;
-        G = matrix_submatrix(mdl->Sinv, i1, i2, K1, K2);
-
-        /* loop again over the factor weights. */
-        for (size_t k2 = 0; k2 < K2; k2++) {
-          /* initialize the precision submatrix element. */
-          double gkk = 0.0;
-
-          /* compute the contributions of each observation. */
-          for (size_t i = 0; i < N; i++) {
-            di = data_get(dat, i);
-            gkk += model_var(mdl, di->x, di->p, j1, j2, k1, k2);
-          }
-
-          /* store the precision submatrix element. */
-          matrix_set(&G, k1, k2, gkk);
-        }
+  /* compute the first moments of every basis element. */
+  if (!model_moments(mdl))
+    return 0;
 
-        /* move to the next precision submatrix. */
-        i2 += K2;
-      }
-    }
+  /* store the projection coefficients of each observation. */
+  for (size_t i = 0; i < N; i++)
+    vector_set(mdl->hc, i, dat->y[i]);
 
-    /* move to the next projection subvector. */
-    i1 += K1;
-  }
+  /* compute the projections and precisions from the moments. */
+  if (!model_gram(mdl, mdl->hc, NULL))
+    return 0;
 
   /* include the diagonal term into the weight precisions. */
   VectorView Gdiag = matrix_diag(mdl->Sinv);
@@ -179,50 +147,21 @@ MODEL_UPDATE (TauVFR) {
   /* gain access to the dataset structure members. */
   const size_t N = mdl->dat->N;
   Data *dat = mdl->dat;
-  Datum *di;
 
   /* prepare for low-rank adjustment. */
   model_weight_adjust_init(mdl, j);
 
-  /* loop over the weights of the current factor. */
-  for (size_t k = 0; k < K; k++) {
-    /* initialize the projection subvector element. */
-    double hk = 0.0;
-
-    /* compute the contributions of each observation. */
-    for (size_t i = 0; i < N; i++) {
-      di = data_get(dat, i);
-      hk += di->y * model_mean(mdl, di->x, di->p, j, k);
-    }
-
-    /* store the projection subvector element. */
-    vector_set(mdl->h, k0 + k, hk);
-
-    /* loop again over the factors. */
-    for (size_t j2 = 0, i2 = 0; j2 < mdl->M; j2++) {
-      /* get the precision submatrix. */
-      const size_t K2 = mdl->factors[j2]->K;
-
-      /* loop again over the factor weights. */
-      for (size_t k2 = 0; k2 < K2; k2++) {
-        /* initialize the precision submatrix element. */
-        double gkk = 0.0;
-
-        /* compute the contributions of each observation. */
-        for (size_t i = 0; i < N; i++) {
-          di = data_get(dat, i);
-          gkk += model_var(mdl, di->x, di->p, j, j2, k, k2);
-        }
+  /* compute the first moments of every basis element. */
+  if (!model_moments(mdl))
+    return 0;
 
-        /* store the precision submatrix element. */
-        matrix_set(mdl->Sinv, k0 + k, i2 + k2, gkk);
-        matrix_set(mdl->Sinv, i2 + k2, k0 + k, gkk);
-      }
+  /* store the projection coefficients of each observation. */
+  for (size_t i = 0; i < N; i++)
+    vector_set(mdl->hc, i, dat->y[i]);
 
-      /* move to the next precision submatrix. */
-      i2 += K2;
-    }
-  }
+  /* compute the projections and precisions of the current factor. */
+  if (!model_gram_update(mdl, j, mdl->hc, NULL))
+    return 0;
 
   /* include the diagonal term into the weight precisions. */
   for (size_t k = 0; k < K; k++) {
@@ -241,6 +180,51 @@ MODEL_UPDATE (TauVFR) {
   return 1;
 }
 
+/* TauVFR_observe(): perform efficient single-observation inference
+ * in a fixed-tau vfr model.
+ *  - see model_observe_fn() for more information.
+ */
+MODEL_OBSERVE (TauVFR) {
+  /* update the projections, precisions and covariances. */
+  if (!model_weight_observe(mdl, i, mdl->dat->y[i], 1.0))
+    return 0;
+
+  /* update the weight means. */
+  chol_solve(mdl->L, mdl->h, mdl->wbar);
+
+  /* return success. */
+  return 1;
+}
+
+/* TauVFR_step(): perform stochastic inference in a fixed-tau
+ * vfr model.
+ *  - see model_step_fn() for more information.
+ */
+MODEL_STEP (TauVFR) {
+  /* gain access to the minibatch structure members. */
+  const size_t B = mdl->dat->N;
+  Data *dat = mdl->dat;
+
+  /* compute the first moments of every basis element. */
+  if (!model_moments(mdl))
+    return 0;
+
+  /* store the projection coefficients of each observation. */
+  for (size_t i = 0; i < B; i++)
+    vector_set(mdl->hc, i, dat->y[i]);
+
+  /* blend the projections and precisions into the posterior. */
+  if (!model_gram_step(mdl, mdl->hc, NULL, (double) N / B, rho))
+    return 0;
+
+  /* update the weight means and covariances. */
+  chol_solve(mdl->L, mdl->h, mdl->wbar);
+  chol_invert(mdl->L, mdl->Sigma);
+
+  /* return success. */
+  return 1;
+}
+
 /* TauVFR_gradient(): return the gradient of a single factor in a
  * fixed-tau vfr model.
  *  - see model_gradient_fn() for more information.
@@ -254,16 +238,17 @@ MODEL_GRADIENT (TauVFR) {
   const size_t K = fj->K;
 
   /* gain access to the specified observation. */
-  Datum *di = data_get(mdl->dat, i);
-  const size_t p = di->p;
-  const Vector *x = di->x;
-  const double y = di->y;
+  VectorView xi = data_x(mdl->dat, i);
+  const size_t p = mdl->dat->p[i];
+  const Vector *x = &xi;
+  const double y = mdl->dat->y[i];
 
   /* gain access to the fixed noise precision. */
   const double tau = mdl->tau;
 
-  /* create the vector view for individual gradient terms. */
-  VectorView g = vector_subvector(mdl->tmp, mdl->K, grad->len);
+  /* create a thread-local vector for individual gradient terms. */
+  double gdata[grad->len];
+  VectorView g = vector_view_array(gdata, grad->len);
 
   /* loop over the weights of the current factor. */
   for (size_t k = 0; k < K; k++) {
@@ -296,6 +281,9 @@ MODEL_GRADIENT (TauVFR) {
         continue;
       }
 
+      /* use the cached first moments of the other factor, if current. */
+      const int fresh = model_moments_fresh(mdl, j2);
+
       /* loop over the other factor weights. */
       for (size_t k2 = 0; k2 < K2; k2++) {
         /* compute the weight second moment. */
@@ -303,7 +291,8 @@ MODEL_GRADIENT (TauVFR) {
                            tau * wk * vector_get(mdl->wbar, i2 + k2);
 
         /* include the off-diagonal second-order contribution. */
-        const double E2 = factor_mean(mdl->factors[j2], x, p, k2);
+        const double E2 = (fresh ? matrix_get(mdl->Phi, i2 + k2, i) :
+                           factor_mean(mdl->factors[j2], x, p, k2));
         blas_daxpy(-wwT * E2, &g, grad);
       }
 
@@ -327,7 +316,8 @@ MODEL_MEANFIELD (TauVFR) {
   const size_t K = mdl->factors[j]->K;
 
   /* gain access to the dataset structure members. */
-  Datum *dat = mdl->dat->data + i;
+  const Data *dat = mdl->dat;
+  VectorView x = data_x(dat, i);
   const size_t M = mdl->M;
 
   /* gain access to the fixed noise precision. */
@@ -340,7 +330,7 @@ MODEL_MEANFIELD (TauVFR) {
   /* loop over the weights of the current factor. */
   for (size_t k = 0; k < K; k++) {
     /* compute and store the contribution. */
-    const double bk = tau * dat->y * vector_get(&wk, k);
+    const double bk = tau * dat->y[i] * vector_get(&wk, k);
     vector_set(b, k, bk);
   }
 
@@ -358,7 +348,7 @@ MODEL_MEANFIELD (TauVFR) {
     /* loop over the weights of the other factor. */
     for (size_t k2 = 0; k2 < K2; k2++) {
       /* get the other factor mean. */
-      const double phi2 = model_mean(mdl, dat->x, dat->p, j2, k2);
+      const double phi2 = model_mean(mdl, &x, dat->p[i], j2, k2);
 
       /* loop over the weights of the current factor. */
       for (size_t k = 0; k < K; k++) {
@@ -413,6 +403,12 @@ TauVFR_set_tau (Model *mdl, PyObject *value, void *closure) {
   if (PyErr_Occurred())
     return -1;
 
+  /* the model may not be modified while it is in use. */
+  if (mdl->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "model is in use");
+    return -1;
+  }
+
   /* check that the value is positive. */
   if (tau <= 0.0) {
     PyErr_SetString(PyExc_ValueError, "expected positive precision");
@@ -425,6 +421,7 @@ TauVFR_set_tau (Model *mdl, PyObject *value, void *closure) {
   /* set the noise parameters to 'spoof' a fixed precision. */
   mdl->alpha0 = mdl->alpha = 1.0e6;
   mdl->beta0  = mdl->beta  = 1.0e6 / tau;
+  mdl->iver = 0;
 
   /* return success. */
   return 0;
@@ -446,8 +443,11 @@ VFL_TYPE_NEW (TauVFR) {
   Model *mdl = (Model*) self;
   mdl->bound     = TauVFR_bound;
   mdl->predict   = TauVFR_predict;
+  mdl->predict_moments = TauVFR_predict_moments;
   mdl->infer     = TauVFR_infer;
   mdl->update    = TauVFR_update;
+  mdl->observe   = TauVFR_observe;
+  mdl->step      = TauVFR_step;
   mdl->gradient  = TauVFR_gradient;
   mdl->meanfield = TauVFR_meanfield;
 
@@ -39,6 +39,131 @@ static inline double ellfn (double xi) {
   return tanh(0.5 * xi) / (4.0 * xi);
 }
 
+/* xiall(): compute the logistic parameters that are optimal at every
+ * observation of the associated dataset, given the current weight
+ * posterior of a vfc model. the first and excess moments must be
+ * current, and the precision-weighted moments are overwritten.
+ *
+ * computation:
+ *  xi(x)^2 = E[(w' phi(x))^2]
+ *          = (wbar' E[phi])^2 + E[phi]' Sigma E[phi]
+ *            + sum_j tr((Sigma_jj + wbar_j wbar_j') Omega_j(x))
+ *
+ * arguments:
+ *  @mdl: model structure pointer.
+ *  @xi: output vector of logistic parameters.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int xiall (Model *mdl, Vector *xi) {
+  /* gain access to the moment buffers. */
+  const size_t N = mdl->dat->N;
+  const Matrix *Phi = mdl->Phi;
+  Matrix *Q = mdl->Psi;
+
+  /* compute the squared latent means. */
+  blas_dgemv(BLAS_TRANS, 1.0, Phi, mdl->wbar, 0.0, mdl->vc);
+  for (size_t i = 0; i < N; i++) {
+    const double mu = vector_get(mdl->vc, i);
+    vector_set(xi, i, mu * mu);
+  }
+
+  /* include the quadratic form of the weight covariances. */
+  blas_dgemm(BLAS_NO_TRANS, BLAS_NO_TRANS, 1.0, mdl->Sigma, Phi, 0.0, Q);
+  for (size_t k = 0; k < mdl->K; k++) {
+    const double *phi = Phi->data + k * Phi->stride;
+    const double *q = Q->data + k * Q->stride;
+    for (size_t i = 0; i < N; i++)
+      vector_set(xi, i, vector_get(xi, i) + phi[i] * q[i]);
+  }
+
+  /* include the excess second moments within each factor. */
+  for (size_t j = 0, i0 = 0; j < mdl->M; i0 += mdl->factors[j++]->K) {
+    const size_t K = mdl->factors[j]->K;
+    for (size_t k1 = 0; k1 < K; k1++) {
+      for (size_t k2 = k1; k2 < K; k2++) {
+        /* get the coefficient of the pair. */
+        const size_t i1 = i0 + k1, i2 = i0 + k2;
+        const double a = (k1 == k2 ? 1.0 : 2.0) *
+          (matrix_get(mdl->Sigma, i1, i2) +
+           vector_get(mdl->wbar, i1) * vector_get(mdl->wbar, i2));
+
+        /* get the excess moments of the pair. */
+        const double *omega = model_excess_row(mdl, j, k1, k2, mdl->vc);
+        if (!omega)
+          return 0;
+
+        /* include the contribution of the pair. */
+        for (size_t i = 0; i < N; i++)
+          vector_set(xi, i, vector_get(xi, i) + a * omega[i]);
+      }
+    }
+  }
+
+  /* take the square roots of the second moments. */
+  for (size_t i = 0; i < N; i++) {
+    const double xi2 = vector_get(xi, i);
+    vector_set(xi, i, xi2 > 0.0 ? sqrt(xi2) : 0.0);
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* xione(): compute the logistic parameter that is optimal at a single
+ * observation of the associated dataset, given the current weight
+ * posterior of a vfc model.
+ *  - see xiall() for more information.
+ *
+ * arguments:
+ *  @mdl: model structure pointer.
+ *  @i: dataset observation index.
+ *
+ * returns:
+ *  optimal logistic parameter at the observation.
+ */
+static double xione (Model *mdl, size_t i) {
+  /* get the observation location and output index. */
+  const VectorView x = data_x(mdl->dat, i);
+  const size_t p = mdl->dat->p[i];
+
+  /* compute the first moments of every basis element. */
+  VectorView u = vector_subvector(mdl->tmp, 0, mdl->K);
+  VectorView q = vector_subvector(mdl->tmp, mdl->K, mdl->K);
+  for (size_t j = 0, k = 0; j < mdl->M; j++)
+    for (size_t kf = 0; kf < mdl->factors[j]->K; kf++, k++)
+      vector_set(&u, k, factor_mean(mdl->factors[j], &x, p, kf));
+
+  /* compute the squared latent mean and the quadratic form
+   * of the weight covariances.
+   */
+  const double mu = blas_ddot(mdl->wbar, &u);
+  blas_dgemv(BLAS_NO_TRANS, 1.0, mdl->Sigma, &u, 0.0, &q);
+  double xi2 = mu * mu + blas_ddot(&u, &q);
+
+  /* include the excess second moments within each factor. */
+  for (size_t j = 0, i0 = 0; j < mdl->M; i0 += mdl->factors[j++]->K) {
+    const Factor *f = mdl->factors[j];
+    for (size_t k1 = 0; k1 < f->K; k1++) {
+      for (size_t k2 = k1; k2 < f->K; k2++) {
+        /* get the coefficient of the pair. */
+        const size_t i1 = i0 + k1, i2 = i0 + k2;
+        const double a = (k1 == k2 ? 1.0 : 2.0) *
+          (matrix_get(mdl->Sigma, i1, i2) +
+           vector_get(mdl->wbar, i1) * vector_get(mdl->wbar, i2));
+
+        /* include the excess moment of the pair. */
+        xi2 += a * (factor_var(f, &x, p, k1, k2) -
+                    vector_get(&u, i1) * vector_get(&u, i2));
+      }
+    }
+  }
+
+  /* return the square root of the second moment. */
+  return (xi2 > 0.0 ? sqrt(xi2) : 0.0);
+}
+
 /* --- */
 
 /* VFC_bound(): return the lower bound of a vfc model.
@@ -98,65 +223,25 @@ MODEL_INFER (VFC) {
   /* gain access to the dataset structure members. */
   const size_t N = mdl->dat->N;
   Data *dat = mdl->dat;
-  Datum *di;
   double xi;
 
-  /* declare views into the weight precisions and the projections. */
-  MatrixView G;
-  VectorView h;
-
-  /* loop over the factors. */
-  for (size_t j1 = 0, i1 = 0; j1 < mdl->M; j1++) {
-    /* get the projection subvector. */
-    const size_t K1 = mdl->factors[j1]->K;
-    h = vector_subvector(mdl->h, i1, K1);
-
-    /* loop over the weights of the current factor. */
-    for (size_t k1 = 0; k1 < K1; k1++) {
-      /* initialize the projection subvector element. */
-      double hk = 0.0;
-
-      /* compute the contribution of each observation. */
-      for (size_t i = 0; i < N; i++) {
-        di = data_get(dat, i);
-        hk += (2.0 * di->y - 1.0) * model_mean(mdl, di->x, di->p, j1, k1);
-      }
-
-      /* store the projection subvector element. */
-      vector_set(&h, k1, hk);
-
-      /* loop again over the factors. */
-      for (size_t j2 = 0, i2 = 0; j2 < mdl->M; j2++) {
-        /* get the precision submatrix. */
-        const size_t K2 = mdl->factors[j2]->K;
-        G = matrix_submatrix(mdl->Sinv, i1, i2, K1, K2);
-
-        /* loop again over the factor weights. */
-        for (size_t k2 = 0; k2 < K2; k2++) {
-          /* initialize the precision submatrix element. */
-          double gkk = 0.0;
-
-          /* compute the contributions of each observation. */
-          for (size_t i = 0; i < N; i++) {
-            di = data_get(dat, i);
-            xi = vector_get(mdl->xi, i);
-            gkk += 2.0 * ellfn(xi) * model_var(mdl, di->x, di->p,
-                                               j1, j2, k1, k2);
-          }
-
-          /* store the precision submatrix element. */
-          matrix_set(&G, k1, k2, gkk);
-        }
-
-        /* move to the next precision submatrix. */
-        i2 += K2;
-      }
-    }
+  /* compute the first and excess moments of every basis element. */
+  if (!model_moments(mdl) || !model_excess(mdl))
+    return 0;
 
-    /* move to the next projection subvector. */
-    i1 += K1;
+  /* store the projection and precision coefficients
+   * of each observation.
+   */
+  for (size_t i = 0; i < N; i++) {
+    xi = vector_get(mdl->xi, i);
+    vector_set(mdl->hc, i, 2.0 * dat->y[i] - 1.0);
+    vector_set(mdl->Gc, i, 2.0 * ellfn(xi));
   }
 
+  /* compute the projections and precisions from the moments. */
+  if (!model_gram(mdl, mdl->hc, mdl->Gc))
+    return 0;
+
   /* include the diagonal term into the weight precisions. */
   VectorView Gdiag = matrix_diag(mdl->Sinv);
   vector_add_const(&Gdiag, mdl->nu);
@@ -173,33 +258,7 @@ MODEL_INFER (VFC) {
   chol_invert(mdl->L, mdl->Sigma);
 
   /* update the logistic parameters. */
-  for (size_t i = 0; i < N; i++) {
-    /* initialize the parameter computation. */
-    di = data_get(dat, i);
-    xi = 0.0;
-
-    /* loop over the first trace dimension. */
-    for (size_t j1 = 0, i1 = 0; j1 < mdl->M; j1++) {
-      for (size_t k1 = 0; k1 < mdl->factors[j1]->K; k1++, i1++) {
-        /* loop over the second trace dimension. */
-        for (size_t j2 = 0, i2 = 0; j2 < mdl->M; j2++) {
-          for (size_t k2 = 0; k2 < mdl->factors[j2]->K; k2++, i2++) {
-            /* include the current contribution from the trace. */
-            xi += (matrix_get(mdl->Sigma, i1, i2) +
-                   vector_get(mdl->wbar, i1) *
-                   vector_get(mdl->wbar, i2)) *
-                  model_var(mdl, di->x, di->p, j1, j2, k1, k2);
-          }
-        }
-      }
-    }
-
-    /* store the computed logistic parameter. */
-    vector_set(mdl->xi, i, sqrt(xi));
-  }
-
-  /* return success. */
-  return 1;
+  return xiall(mdl, mdl->xi);
 }
 
 /* VFC_update(): perform efficient low-rank inference in a vfc model.
@@ -213,54 +272,31 @@ MODEL_UPDATE (VFC) {
   /* gain access to the dataset structure members. */
   const size_t N = mdl->dat->N;
   Data *dat = mdl->dat;
-  Datum *di;
   double xi;
 
   /* prepare for low-rank adjustment. */
   model_weight_adjust_init(mdl, j);
 
-  /* loop over the weights of the current factor. */
-  for (size_t k = 0; k < K; k++) {
-    /* initialize the projection subvector element. */
-    double hk = 0.0;
-
-    /* compute the contributions of each observation. */
-    for (size_t i = 0; i < N; i++) {
-      di = data_get(dat, i);
-      hk += (2.0 * di->y - 1.0) * model_mean(mdl, di->x, di->p, j, k);
-    }
-
-    /* store the projection subvector element. */
-    vector_set(mdl->h, k0 + k, hk);
-
-    /* loop again over the factors. */
-    for (size_t j2 = 0, i2 = 0; j2 < mdl->M; j2++) {
-      /* get the precision submatrix. */
-      const size_t K2 = mdl->factors[j2]->K;
-
-      /* loop again over the factor weights. */
-      for (size_t k2 = 0; k2 < K2; k2++) {
-        /* initialize the precision submatrix element. */
-        double gkk = 0.0;
-
-        /* compute the contributions of each observation. */
-        for (size_t i = 0; i < N; i++) {
-          di = data_get(dat, i);
-          xi = vector_get(mdl->xi, i);
-          gkk += 2.0 * ellfn(xi) * model_var(mdl, di->x, di->p,
-                                             j, j2, k, k2);
-        }
-
-        /* store the precision submatrix element. */
-        matrix_set(mdl->Sinv, k0 + k, i2 + k2, gkk);
-        matrix_set(mdl->Sinv, i2 + k2, k0 + k, gkk);
-      }
+  /* compute the first and excess moments of every basis element.
+   * only the moments of the current factor are recomputed, as those
+   * of all other factors are cached since the previous inference.
+   */
+  if (!model_moments(mdl) || !model_excess(mdl))
+    return 0;
 
-      /* move to the next precision submatrix. */
-      i2 += K2;
-    }
+  /* store the projection and precision coefficients
+   * of each observation.
+   */
+  for (size_t i = 0; i < N; i++) {
+    xi = vector_get(mdl->xi, i);
+    vector_set(mdl->hc, i, 2.0 * dat->y[i] - 1.0);
+    vector_set(mdl->Gc, i, 2.0 * ellfn(xi));
   }
 
+  /* compute the projections and precisions of the current factor. */
+  if (!model_gram_update(mdl, j, mdl->hc, mdl->Gc))
+    return 0;
+
   /* include the diagonal term into the weight precisions. */
   for (size_t k = 0; k < K; k++) {
     double gkk = matrix_get(mdl->Sinv, k0 + k, k0 + k);
@@ -276,31 +312,71 @@ MODEL_UPDATE (VFC) {
   blas_dscal(0.5, mdl->wbar);
 
   /* update the logistic parameters. */
-  for (size_t i = 0; i < N; i++) {
-    /* initialize the parameter computation. */
-    di = data_get(dat, i);
-    xi = 0.0;
-
-    /* loop over the first trace dimension. */
-    for (size_t j1 = 0, i1 = 0; j1 < mdl->M; j1++) {
-      for (size_t k1 = 0; k1 < mdl->factors[j1]->K; k1++, i1++) {
-        /* loop over the second trace dimension. */
-        for (size_t j2 = 0, i2 = 0; j2 < mdl->M; j2++) {
-          for (size_t k2 = 0; k2 < mdl->factors[j2]->K; k2++, i2++) {
-            /* include the current contribution from the trace. */
-            xi += (matrix_get(mdl->Sigma, i1, i2) +
-                   vector_get(mdl->wbar, i1) *
-                   vector_get(mdl->wbar, i2)) *
-                  model_var(mdl, di->x, di->p, j1, j2, k1, k2);
-          }
-        }
-      }
-    }
+  return xiall(mdl, mdl->xi);
+}
+
+/* VFC_observe(): perform efficient single-observation inference
+ * in a vfc model. the logistic parameters of previous observations
+ * are kept, and that of the new observation is made optimal under
+ * the weight posterior before its inclusion.
+ *  - see model_observe_fn() for more information.
+ */
+MODEL_OBSERVE (VFC) {
+  /* compute the logistic parameter of the new observation. */
+  const double xi = xione(mdl, i);
+  if (!(xi > 0.0))
+    return 0;
+
+  vector_set(mdl->xi, i, xi);
 
-    /* store the computed logistic parameter. */
-    vector_set(mdl->xi, i, sqrt(xi));
+  /* update the projections, precisions and covariances. */
+  const double y = mdl->dat->y[i];
+  if (!model_weight_observe(mdl, i, 2.0 * y - 1.0, 2.0 * ellfn(xi)))
+    return 0;
+
+  /* update the weight means. */
+  chol_solve(mdl->L, mdl->h, mdl->wbar);
+  blas_dscal(0.5, mdl->wbar);
+
+  /* return success. */
+  return 1;
+}
+
+/* VFC_step(): perform stochastic inference in a vfc model.
+ *  - see model_step_fn() for more information.
+ */
+MODEL_STEP (VFC) {
+  /* gain access to the minibatch structure members. */
+  const size_t B = mdl->dat->N;
+  Data *dat = mdl->dat;
+
+  /* compute the first and excess moments of every basis element. */
+  if (!model_moments(mdl) || !model_excess(mdl))
+    return 0;
+
+  /* store the projection and precision coefficients of each
+   * observation, using logistic parameters that are optimal
+   * under the current weight posterior.
+   */
+  if (!xiall(mdl, mdl->Gc))
+    return 0;
+
+  /* convert the logistic parameters into coefficients. */
+  for (size_t i = 0; i < B; i++) {
+    const double xi = vector_get(mdl->Gc, i);
+    vector_set(mdl->hc, i, 2.0 * dat->y[i] - 1.0);
+    vector_set(mdl->Gc, i, 2.0 * ellfn(xi));
   }
 
+  /* blend the projections and precisions into the posterior. */
+  if (!model_gram_step(mdl, mdl->hc, mdl->Gc, (double) N / B, rho))
+    return 0;
+
+  /* update the weight means and covariances. */
+  chol_solve(mdl->L, mdl->h, mdl->wbar);
+  blas_dscal(0.5, mdl->wbar);
+  chol_invert(mdl->L, mdl->Sigma);
+
   /* return success. */
   return 1;
 }
@@ -317,13 +393,14 @@ MODEL_GRADIENT (VFC) {
   const size_t K = fj->K;
 
   /* gain access to the specified observation. */
-  Datum *di = data_get(mdl->dat, i);
-  const size_t p = di->p;
-  const Vector *x = di->x;
-  const double y = di->y;
+  VectorView xi = data_x(mdl->dat, i);
+  const size_t p = mdl->dat->p[i];
+  const Vector *x = &xi;
+  const double y = mdl->dat->y[i];
 
-  /* create the vector view for individual gradient terms. */
-  VectorView g = vector_subvector(mdl->tmp, mdl->K, grad->len);
+  /* create a thread-local vector for individual gradient terms. */
+  double gdata[grad->len];
+  VectorView g = vector_view_array(gdata, grad->len);
 
   /* loop over the weights of the current factor. */
   for (size_t k = 0; k < K; k++) {
@@ -356,6 +433,9 @@ MODEL_GRADIENT (VFC) {
         continue;
       }
 
+      /* use the cached first moments of the other factor, if current. */
+      const int fresh = model_moments_fresh(mdl, j2);
+
       /* loop over the other factor weights. */
       for (size_t k2 = 0; k2 < K2; k2++) {
         /* compute the weight second moment. */
@@ -363,7 +443,8 @@ MODEL_GRADIENT (VFC) {
                            wk * vector_get(mdl->wbar, i2 + k2);
 
         /* include the off-diagonal second-order contribution. */
-        const double E2 = factor_mean(mdl->factors[j2], x, p, k2);
+        const double E2 = (fresh ? matrix_get(mdl->Phi, i2 + k2, i) :
+                           factor_mean(mdl->factors[j2], x, p, k2));
         blas_daxpy(-wwT * E2, &g, grad);
       }
 
@@ -394,6 +475,8 @@ VFL_TYPE_NEW (VFC) {
   mdl->predict   = VFC_predict;
   mdl->infer     = VFC_infer;
   mdl->update    = VFC_update;
+  mdl->observe   = VFC_observe;
+  mdl->step      = VFC_step;
   mdl->gradient  = VFC_gradient;
 
   /* return the new object. */
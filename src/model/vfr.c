@@ -105,6 +105,17 @@ MODEL_PREDICT (VFR) {
   return 1;
 }
 
+/* VFR_predict_moments(): return the prediction of a vfr model
+ * from the moments of its latent function.
+ *  - see model_predict_moments_fn() for more information.
+ */
+MODEL_PREDICT_MOMENTS (VFR) {
+  /* include the expected noise variance into the predicted variance. */
+  const double tauinv = mdl->beta / (mdl->alpha - 1.0);
+  *mean = mu;
+  *var = tauinv + eta;
+}
+
 /* VFR_infer(): perform complete inference in a vfr model.
  *  - see model_infer_fn() for more information.
  */
@@ -112,61 +123,18 @@ MODEL_INFER (VFR) {
   /* gain access to the dataset structure members. */
   const size_t N = mdl->dat->N;
   Data *dat = mdl->dat;
-  Datum *di;
-
-  /* declare views into the weight precisions and the projections. */
-  MatrixView G;
-  VectorView h;
 
-  /* loop over the factors. */
-  for (size_t j1 = 0, i1 = 0; j1 < mdl->M; j1++) {
-    /* get the projection subvector. */
-    const size_t K1 = mdl->factors[j1]->K;
-    h = vector_subvector(mdl->h, i1, K1);
-
-    /* loop over the weights of the current factor. */
-    for (size_t k1 = 0; k1 < K1; k1++) {
-      /* initialize the projection subvector element. */
-      double hk = 0.0;
-
-      /* compute the contributions of each observation. */
-      for (size_t i = 0; i < N; i++) {
-        di = data_get(dat, i);
-        hk += di->y * model_mean(mdl, di->x, di->p, j1, k1);
-      }
-
-      /* store the projection subvector element. */
-      vector_set(&h, k1, hk);
+  /* compute the first moments of every basis element. */
+  if (!model_moments(mdl))
+    return 0;
 
-      /* loop again over the factors. */
-      for (size_t j2 = 0, i2 = 0; j2 < mdl->M; j2++) {
-        /* get the precision submatrix. */
-        const size_t K2 = mdl->factors[j2]->K;
-        G = matrix_submatrix(mdl->Sinv, i1, i2, K1, K2);
-
-        /* loop again over the factor weights. */
-        for (size_t k2 = 0; k2 < K2; k2++) {
-          /* initialize the precision submatrix element. */
-          double gkk = 0.0;
-
-          /* compute the contributions of each observation. */
-          for (size_t i = 0; i < N; i++) {
-            di = data_get(dat, i);
-            gkk += model_var(mdl, di->x, di->p, j1, j2, k1, k2);
-          }
-
-          /* store the precision submatrix element. */
-          matrix_set(&G, k1, k2, gkk);
-        }
+  /* store the projection coefficients of each observation. */
+  for (size_t i = 0; i < N; i++)
+    vector_set(mdl->hc, i, dat->y[i]);
 
-        /* move to the next precision submatrix. */
-        i2 += K2;
-      }
-    }
-
-    /* move to the next projection subvector. */
-    i1 += K1;
-  }
+  /* compute the projections and precisions from the moments. */
+  if (!model_gram(mdl, mdl->hc, NULL))
+    return 0;
 
   /* include the diagonal term into the weight precisions. */
   VectorView Gdiag = matrix_diag(mdl->Sinv);
@@ -208,50 +176,21 @@ MODEL_UPDATE (VFR) {
   /* gain access to the dataset structure members. */
   const size_t N = mdl->dat->N;
   Data *dat = mdl->dat;
-  Datum *di;
 
   /* prepare for low-rank adjustment. */
   model_weight_adjust_init(mdl, j);
 
-  /* loop over the weights of the current factor. */
-  for (size_t k = 0; k < K; k++) {
-    /* initialize the projection subvector element. */
-    double hk = 0.0;
-
-    /* compute the contributions of each observation. */
-    for (size_t i = 0; i < N; i++) {
-      di = data_get(dat, i);
-      hk += di->y * model_mean(mdl, di->x, di->p, j, k);
-    }
-
-    /* store the projection subvector element. */
-    vector_set(mdl->h, k0 + k, hk);
-
-    /* loop again over the factors. */
-    for (size_t j2 = 0, i2 = 0; j2 < mdl->M; j2++) {
-      /* get the precision submatrix. */
-      const size_t K2 = mdl->factors[j2]->K;
-
-      /* loop again over the factor weights. */
-      for (size_t k2 = 0; k2 < K2; k2++) {
-        /* initialize the precision submatrix element. */
-        double gkk = 0.0;
-
-        /* compute the contributions of each observation. */
-        for (size_t i = 0; i < N; i++) {
-          di = data_get(dat, i);
-          gkk += model_var(mdl, di->x, di->p, j, j2, k, k2);
-        }
+  /* compute the first moments of every basis element. */
+  if (!model_moments(mdl))
+    return 0;
 
-        /* store the precision submatrix element. */
-        matrix_set(mdl->Sinv, k0 + k, i2 + k2, gkk);
-        matrix_set(mdl->Sinv, i2 + k2, k0 + k, gkk);
-      }
+  /* store the projection coefficients of each observation. */
+  for (size_t i = 0; i < N; i++)
+    vector_set(mdl->hc, i, dat->y[i]);
 
-      /* move to the next precision submatrix. */
-      i2 += K2;
-    }
-  }
+  /* compute the projections and precisions of the current factor. */
+  if (!model_gram_update(mdl, j, mdl->hc, NULL))
+    return 0;
 
   /* include the diagonal term into the weight precisions. */
   for (size_t k = 0; k < K; k++) {
@@ -273,10 +212,8 @@ MODEL_UPDATE (VFR) {
 
   /* compute the data inner product. */
   double yy = 0.0;
-  for (size_t i = 0; i < N; i++) {
-    di = data_get(dat, i);
-    yy += di->y * di->y;
-  }
+  for (size_t i = 0; i < N; i++)
+    yy += dat->y[i] * dat->y[i];
 
   /* update the noise shape and rate. */
   mdl->alpha = mdl->alpha0 + 0.5 * (double) N;
@@ -295,6 +232,97 @@ MODEL_UPDATE (VFR) {
   return 1;
 }
 
+/* VFR_observe(): perform efficient single-observation inference
+ * in a vfr model.
+ *  - see model_observe_fn() for more information.
+ */
+MODEL_OBSERVE (VFR) {
+  /* gain access to the dataset structure members. */
+  const size_t N = mdl->dat->N;
+  const double y = mdl->dat->y[i];
+
+  /* recover the data inner product of the previous observations
+   * from the current noise rate.
+   */
+  VectorView z = vector_subvector(mdl->tmp, 0, mdl->K);
+  blas_dtrmv(BLAS_TRANS, mdl->L, mdl->wbar, &z);
+  const double yy = 2.0 * (mdl->beta - mdl->beta0) +
+                    blas_ddot(&z, &z) + y * y;
+
+  /* update the projections, precisions and covariances. */
+  if (!model_weight_observe(mdl, i, y, 1.0))
+    return 0;
+
+  /* update the weight means. */
+  chol_solve(mdl->L, mdl->h, mdl->wbar);
+
+  /* compute the model inner product. */
+  blas_dtrmv(BLAS_TRANS, mdl->L, mdl->wbar, &z);
+  const double wSw = blas_ddot(&z, &z);
+
+  /* update the noise shape and rate. */
+  mdl->alpha = mdl->alpha0 + 0.5 * (double) N;
+  mdl->beta = mdl->beta0 + 0.5 * (yy - wSw);
+
+  /* update the noise precision. */
+  mdl->tau = mdl->alpha / mdl->beta;
+
+  /* fail if the update did not yield reasonable values, so that
+   * a full re-inference is performed.
+   */
+  return (isfinite(mdl->beta) && mdl->beta > 0.0);
+}
+
+/* VFR_step(): perform stochastic inference in a vfr model.
+ *  - see model_step_fn() for more information.
+ */
+MODEL_STEP (VFR) {
+  /* gain access to the minibatch structure members. */
+  const size_t B = mdl->dat->N;
+  Data *dat = mdl->dat;
+  const double scale = (double) N / B;
+
+  /* compute the natural noise rate of the current posterior,
+   * which is blended along with the projections and precisions.
+   */
+  VectorView z = vector_subvector(mdl->tmp, 0, mdl->K);
+  blas_dtrmv(BLAS_TRANS, mdl->L, mdl->wbar, &z);
+  double eta = mdl->beta + 0.5 * blas_ddot(&z, &z);
+
+  /* compute the first moments of every basis element. */
+  if (!model_moments(mdl))
+    return 0;
+
+  /* store the projection coefficients of each observation. */
+  for (size_t i = 0; i < B; i++)
+    vector_set(mdl->hc, i, dat->y[i]);
+
+  /* blend the projections and precisions into the posterior. */
+  if (!model_gram_step(mdl, mdl->hc, NULL, scale, rho))
+    return 0;
+
+  /* update the weight means and covariances. */
+  chol_solve(mdl->L, mdl->h, mdl->wbar);
+  chol_invert(mdl->L, mdl->Sigma);
+
+  /* compute the model and data inner products. */
+  blas_dtrmv(BLAS_TRANS, mdl->L, mdl->wbar, &z);
+  const double wSw = blas_ddot(&z, &z);
+  const double yy = data_inner(dat);
+
+  /* blend the noise shape and natural rate. */
+  mdl->alpha = (1.0 - rho) * mdl->alpha +
+               rho * (mdl->alpha0 + 0.5 * (double) N);
+  eta = (1.0 - rho) * eta + rho * (mdl->beta0 + 0.5 * scale * yy);
+
+  /* update the noise rate and precision. */
+  mdl->beta = eta - 0.5 * wSw;
+  mdl->tau = mdl->alpha / mdl->beta;
+
+  /* return whether the update yielded reasonable values. */
+  return (isfinite(mdl->beta) && mdl->beta > 0.0);
+}
+
 /* VFR_gradient(): return the gradient of a single factor in a vfr model.
  *  - see model_gradient_fn() for more information.
  */
@@ -307,16 +335,17 @@ MODEL_GRADIENT (VFR) {
   const size_t K = fj->K;
 
   /* gain access to the specified observation. */
-  Datum *di = data_get(mdl->dat, i);
-  const size_t p = di->p;
-  const Vector *x = di->x;
-  const double y = di->y;
+  VectorView xi = data_x(mdl->dat, i);
+  const size_t p = mdl->dat->p[i];
+  const Vector *x = &xi;
+  const double y = mdl->dat->y[i];
 
   /* gain access to the expected noise precision. */
   const double tau = mdl->tau;
 
-  /* create the vector view for individual gradient terms. */
-  VectorView g = vector_subvector(mdl->tmp, mdl->K, grad->len);
+  /* create a thread-local vector for individual gradient terms. */
+  double gdata[grad->len];
+  VectorView g = vector_view_array(gdata, grad->len);
 
   /* loop over the weights of the current factor. */
   for (size_t k = 0; k < K; k++) {
@@ -349,6 +378,9 @@ MODEL_GRADIENT (VFR) {
         continue;
       }
 
+      /* use the cached first moments of the other factor, if current. */
+      const int fresh = model_moments_fresh(mdl, j2);
+
       /* loop over the other factor weights. */
       for (size_t k2 = 0; k2 < K2; k2++) {
         /* compute the weight second moment. */
@@ -356,7 +388,8 @@ MODEL_GRADIENT (VFR) {
                            tau * wk * vector_get(mdl->wbar, i2 + k2);
 
         /* include the off-diagonal second-order contribution. */
-        const double E2 = factor_mean(mdl->factors[j2], x, p, k2);
+        const double E2 = (fresh ? matrix_get(mdl->Phi, i2 + k2, i) :
+                           factor_mean(mdl->factors[j2], x, p, k2));
         blas_daxpy(-wwT * E2, &g, grad);
       }
 
@@ -379,7 +412,8 @@ MODEL_MEANFIELD (VFR) {
   const size_t K = mdl->factors[j]->K;
 
   /* gain access to the dataset structure members. */
-  Datum *dat = mdl->dat->data + i;
+  const Data *dat = mdl->dat;
+  VectorView x = data_x(dat, i);
   const size_t M = mdl->M;
 
   /* gain access to the expected noise precision. */
@@ -392,7 +426,7 @@ MODEL_MEANFIELD (VFR) {
   /* loop over the weights of the current factor. */
   for (size_t k = 0; k < K; k++) {
     /* compute and store the contribution. */
-    const double bk = tau * dat->y * vector_get(&wk, k);
+    const double bk = tau * dat->y[i] * vector_get(&wk, k);
     vector_set(b, k, bk);
   }
 
@@ -410,7 +444,7 @@ MODEL_MEANFIELD (VFR) {
     /* loop over the weights of the other factor. */
     for (size_t k2 = 0; k2 < K2; k2++) {
       /* get the other factor mean. */
-      const double phi2 = model_mean(mdl, dat->x, dat->p, j2, k2);
+      const double phi2 = model_mean(mdl, &x, dat->p[i], j2, k2);
 
       /* loop over the weights of the current factor. */
       for (size_t k = 0; k < K; k++) {
@@ -465,6 +499,12 @@ VFR_set_alpha0 (Model *mdl, PyObject *value, void *closure) {
   if (PyErr_Occurred())
     return -1;
 
+  /* the model may not be modified while it is in use. */
+  if (mdl->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "model is in use");
+    return -1;
+  }
+
   /* set the shape. */
   if (!model_set_alpha0(mdl, a0)) {
     PyErr_SetString(PyExc_ValueError, "expected positive shape");
@@ -492,6 +532,12 @@ VFR_set_beta0 (Model *mdl, PyObject *value, void *closure) {
   if (PyErr_Occurred())
     return -1;
 
+  /* the model may not be modified while it is in use. */
+  if (mdl->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "model is in use");
+    return -1;
+  }
+
   /* set the rate. */
   if (!model_set_beta0(mdl, b0)) {
     PyErr_SetString(PyExc_ValueError, "expected positive rate");
@@ -542,8 +588,11 @@ VFL_TYPE_NEW (VFR) {
   Model *mdl = (Model*) self;
   mdl->bound     = VFR_bound;
   mdl->predict   = VFR_predict;
+  mdl->predict_moments = VFR_predict_moments;
   mdl->infer     = VFR_infer;
   mdl->update    = VFR_update;
+  mdl->observe   = VFR_observe;
+  mdl->step      = VFR_step;
   mdl->gradient  = VFR_gradient;
   mdl->meanfield = VFR_meanfield;
 
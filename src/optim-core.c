@@ -2,6 +2,9 @@
 /* include the vfl header. */
 #include <vfl/vfl.h>
 
+/* include the posix process header. */
+#include <unistd.h>
+
 /* Optim_reset(): reset the contents of an optimizer structure.
  *
  * arguments:
@@ -16,10 +19,13 @@ void Optim_reset (Optim *opt) {
   opt->init    = NULL;
   opt->iterate = NULL;
   opt->execute = NULL;
+  opt->prepare = NULL;
   opt->free    = NULL;
+  opt->copy    = NULL;
 
   /* initialize the associated model. */
   opt->mdl = NULL;
+  opt->busy = 0;
 
   /* initialize the iteration vectors. */
   opt->xa = NULL;
@@ -39,7 +45,14 @@ void Optim_reset (Optim *opt) {
   /* initialize the logging parameters. */
   opt->log_iters = 1;
   opt->log_parms = 0;
-  opt->log_fh = NULL;
+  opt->log = NULL;
+
+  /* initialize the instrumentation parameters. */
+  opt->timing = 0;
+  memset(&opt->stats, 0, sizeof(OptimStats));
+  opt->trace = NULL;
+  opt->trace_t0 = 0.0;
+  opt->trace_n = 0;
 
   /* initialize the lower bound. */
   opt->bound0 = opt->bound = -INFINITY;
@@ -60,8 +73,10 @@ int optim_set_model (Optim *opt, Model *mdl) {
   if (!opt || !mdl)
     return 0;
 
-  /* ensure that the model is capable of inference. */
-  if (!model_infer(mdl))
+  /* ensure that the model is capable of inference, unless the
+   * optimizer prepares its models in another manner.
+   */
+  if (opt->prepare ? !opt->prepare(opt, mdl) : !model_infer(mdl))
     return 0;
 
   /* drop the current model. */
@@ -99,10 +114,19 @@ int optim_set_model (Optim *opt, Model *mdl) {
   /* allocate the temporaries. */
   opt->Fs = matrix_alloc(pmax, pmax);
 
+  /* allocate the per-factor statistics. */
+  free(opt->stats.factors);
+  opt->stats.M = mdl->M;
+  opt->stats.factors = calloc(mdl->M + 1, sizeof(OptimFactorStats));
+
   /* check that allocation was successful. */
-  if (!opt->xa || !opt->xb || !opt->x || !opt->g || !opt->Fs)
+  if (!opt->xa || !opt->xb || !opt->x || !opt->g || !opt->Fs ||
+      !opt->stats.factors)
     return 0;
 
+  /* restart the accumulated statistics. */
+  optim_reset_stats(opt);
+
   /* initialize the lower bound. */
   opt->bound0 = opt->bound = model_bound(mdl);
 
@@ -249,25 +273,243 @@ int optim_set_log_file (Optim *opt, const char *fname) {
   if (!opt)
     return 0;
 
-  /* close any open file handles. */
-  if (opt->log_fh) {
-    fclose(opt->log_fh);
-    opt->log_fh = NULL;
-  }
+  /* close any open log stream. */
+  const int ok = stream_close(opt->log);
+  opt->log = NULL;
 
   /* return if the filename is null. */
   if (!fname)
-    return 1;
+    return ok;
 
-  /* open a new file handle. */
-  opt->log_fh = fopen(fname, "w");
-  if (!opt->log_fh)
+  /* open a new log stream. */
+  opt->log = stream_open(fname);
+  if (!opt->log)
     return 0;
 
   /* return success. */
   return 1;
 }
 
+/* optim_set_timing(): set the flag that enables or disables timing
+ * of the phases of optimization. counters are always accumulated.
+ *
+ * arguments:
+ *  @opt: optimizer structure pointer.
+ *  @b: timing flag.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int optim_set_timing (Optim *opt, int b) {
+  /* check the input arguments. */
+  if (!opt)
+    return 0;
+
+  /* set the parameter and return success. */
+  opt->timing = (b ? 1 : 0);
+  return 1;
+}
+
+/* optim_set_trace_file(): set the filename string for writing trace
+ * events of optimization, in the chrome trace-event json format.
+ * phases are timed while a trace is open, regardless of the timing
+ * flag.
+ *
+ * arguments:
+ *  @opt: optimizer structure pointer.
+ *  @fname: trace filename string, or null to close the trace.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int optim_set_trace_file (Optim *opt, const char *fname) {
+  /* check the input arguments. */
+  if (!opt)
+    return 0;
+
+  /* terminate and close any open trace stream. */
+  int ok = 1;
+  if (opt->trace) {
+    stream_printf(opt->trace, "\n]\n");
+    ok = stream_close(opt->trace);
+    opt->trace = NULL;
+  }
+
+  /* return if the filename is null. */
+  if (!fname)
+    return ok;
+
+  /* open a new trace stream. */
+  opt->trace = stream_open(fname);
+  if (!opt->trace)
+    return 0;
+
+  /* begin the array of events. */
+  opt->trace_t0 = bench_clock();
+  opt->trace_n = 0;
+  return stream_printf(opt->trace, "[\n");
+}
+
+/* optim_reset_stats(): reset the accumulated timers and counters
+ * of an optimizer.
+ *
+ * arguments:
+ *  @opt: optimizer structure pointer to modify.
+ */
+void optim_reset_stats (Optim *opt) {
+  /* return if the struct pointer is null. */
+  if (!opt)
+    return;
+
+  /* reset the optimizer-wide statistics. */
+  OptimStats *st = &opt->stats;
+  st->iters = 0;
+  st->time = 0.0;
+  memset(st->calls, 0, sizeof(st->calls));
+  memset(st->times, 0, sizeof(st->times));
+
+  /* reset the per-factor statistics. */
+  if (st->factors)
+    memset(st->factors, 0, st->M * sizeof(OptimFactorStats));
+}
+
+/* optim_phase_name(): get the name of an optimizer phase.
+ *
+ * arguments:
+ *  @ph: optimizer phase.
+ *
+ * returns:
+ *  static string naming the phase.
+ */
+const char *optim_phase_name (OptimPhase ph) {
+  /* define the phase names. */
+  static const char *names[OPTIM_PHASES] = {
+    "infer", "gradient", "solve", "eigen",
+    "update", "bound", "meanfield", "step"
+  };
+
+  /* return the name. */
+  return (ph < OPTIM_PHASES ? names[ph] : "unknown");
+}
+
+/* optim_clock(): read the clock at the start of an instrumented
+ * phase. the clock is only read when timing or tracing is enabled.
+ *
+ * arguments:
+ *  @opt: optimizer structure pointer.
+ *
+ * returns:
+ *  current clock value in seconds, or zero if timing is disabled.
+ */
+double optim_clock (const Optim *opt) {
+  /* read the clock only if required. */
+  return (opt->timing || opt->trace ? bench_clock() : 0.0);
+}
+
+/* optim_trace_event(): write a complete event into the trace stream
+ * of an optimizer.
+ *
+ * arguments:
+ *  @opt: optimizer structure pointer.
+ *  @name: event name string.
+ *  @j: factor index, or OPTIM_NO_FACTOR.
+ *  @t0: clock value at the start of the event.
+ *  @t1: clock value at the end of the event.
+ */
+static void optim_trace_event (Optim *opt, const char *name, size_t j,
+                               double t0, double t1) {
+  /* write the event timing, in microseconds since the trace start. */
+  stream_printf(opt->trace,
+    "%s{\"name\":\"%s\",\"cat\":\"optim\",\"ph\":\"X\","
+    "\"pid\":%d,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+    "\"args\":{\"iter\":%zu",
+    opt->trace_n ? ",\n" : "", name, (int) getpid(),
+    1.0e6 * (t0 - opt->trace_t0), 1.0e6 * (t1 - t0),
+    opt->stats.iters);
+
+  /* write the factor index, or the lower bound after iterations. */
+  if (j != OPTIM_NO_FACTOR)
+    stream_printf(opt->trace, ",\"factor\":%zu}}", j);
+  else if (!strcmp(name, "iterate") && isfinite(opt->bound))
+    stream_printf(opt->trace, ",\"bound\":%.9e}}", opt->bound);
+  else
+    stream_printf(opt->trace, "}}");
+
+  /* count the event. */
+  opt->trace_n++;
+}
+
+/* optim_phase(): record the completion of an instrumented phase.
+ *
+ * arguments:
+ *  @opt: optimizer structure pointer.
+ *  @ph: completed phase.
+ *  @j: index of the factor involved, or OPTIM_NO_FACTOR.
+ *  @t0: value returned by optim_clock() at the start of the phase.
+ */
+void optim_phase (Optim *opt, OptimPhase ph, size_t j, double t0) {
+  /* count the phase. */
+  opt->stats.calls[ph]++;
+
+  /* return if timing is disabled. */
+  if (!opt->timing && !opt->trace)
+    return;
+
+  /* accumulate the elapsed time. */
+  const double t1 = bench_clock();
+  opt->stats.times[ph] += t1 - t0;
+
+  /* write a trace event. */
+  if (opt->trace)
+    optim_trace_event(opt, optim_phase_name(ph), j, t0, t1);
+}
+
+/* optim_trial(): record a proposed parameter vector of a factor.
+ *
+ * arguments:
+ *  @opt: optimizer structure pointer.
+ *  @j: index of the factor.
+ *  @valid: whether the proposal was accepted.
+ */
+void optim_trial (Optim *opt, size_t j, int valid) {
+  /* count the trial, if the factor has statistics. */
+  if (j < opt->stats.M) {
+    opt->stats.factors[j].trials++;
+    opt->stats.factors[j].accepted += (valid ? 1 : 0);
+  }
+}
+
+/* optim_factor(): record the completion of an update to a factor.
+ *
+ * arguments:
+ *  @opt: optimizer structure pointer.
+ *  @j: index of the factor.
+ *  @valid: whether the update changed the factor parameters.
+ *  @t0: value returned by optim_clock() at the start of the update.
+ */
+void optim_factor (Optim *opt, size_t j, int valid, double t0) {
+  /* return if the factor has no statistics. */
+  if (j >= opt->stats.M)
+    return;
+
+  /* count the update. */
+  OptimFactorStats *fs = opt->stats.factors + j;
+  fs->updates++;
+  fs->unchanged += (valid ? 0 : 1);
+
+  /* return if timing is disabled. */
+  if (!opt->timing && !opt->trace)
+    return;
+
+  /* accumulate the elapsed time. */
+  const double t1 = bench_clock();
+  fs->time += t1 - t0;
+
+  /* write a trace event. */
+  if (opt->trace)
+    optim_trace_event(opt, "factor", j, t0, t1);
+}
+
 /* optim_iterate(): perform a single optimization iteration.
  *  - see optim_iterate_fn() for more information.
  */
@@ -281,15 +523,29 @@ int optim_iterate (Optim *opt) {
     return 0;
 
   /* run the iteration function. */
+  const double t0 = optim_clock(opt);
   const int ret = opt->iterate(opt);
   opt->iters++;
 
-  /* check if a log file handle is open. */
-  if (opt->log_fh) {
+  /* record the iteration. */
+  if (opt->timing || opt->trace) {
+    const double t1 = bench_clock();
+    opt->stats.time += t1 - t0;
+
+    if (opt->trace) {
+      optim_trace_event(opt, "iterate", OPTIM_NO_FACTOR, t0, t1);
+      stream_flush(opt->trace);
+    }
+  }
+
+  opt->stats.iters++;
+
+  /* check if a log stream is open. */
+  if (opt->log) {
     /* check if the current iteration should be logged. */
     if (opt->log_iters <= 1 || opt->iters % (opt->log_iters - 1) == 0) {
       /* print the basic log information. */
-      fprintf(opt->log_fh, "%6zu %16.9le", opt->iters, opt->bound);
+      stream_printf(opt->log, "%6zu %16.9le", opt->iters, opt->bound);
 
       /* check if the parameters should be logged. */
       if (opt->log_parms) {
@@ -300,13 +556,13 @@ int optim_iterate (Optim *opt) {
 
           /* print each of the factor parameters. */
           for (size_t p = 0; p < fj->P; p++)
-            fprintf(opt->log_fh, " %16.9le", factor_get(fj, p));
+            stream_printf(opt->log, " %16.9le", factor_get(fj, p));
         }
       }
 
-      /* print a newline. */
-      fprintf(opt->log_fh, "\n");
-      fflush(opt->log_fh);
+      /* print a newline, and hand the line to the writer thread. */
+      stream_printf(opt->log, "\n");
+      stream_flush(opt->log);
     }
   }
 
@@ -334,3 +590,89 @@ int optim_execute (Optim *opt) {
   return ret;
 }
 
+/* optim_replica(): create a new optimizer having the same type and
+ * control parameters as another optimizer. the replica has no model,
+ * log or trace.
+ *
+ * arguments:
+ *  @opt: optimizer structure pointer to copy.
+ *
+ * returns:
+ *  pointer to a new optimizer, or null on failure.
+ */
+Optim *optim_replica (const Optim *opt) {
+  /* check the input pointer. */
+  if (!opt)
+    return NULL;
+
+  /* allocate a new optimizer having the same type. */
+  PyObject *type = (PyObject*) Py_TYPE(opt);
+  Optim *dup = (Optim*) PyObject_CallObject(type, NULL);
+  if (!dup) {
+    PyErr_Clear();
+    return NULL;
+  }
+
+  /* copy the control parameters. */
+  dup->max_steps = opt->max_steps;
+  dup->max_iters = opt->max_iters;
+  dup->l0 = opt->l0;
+  dup->dl = opt->dl;
+  dup->timing = opt->timing;
+
+  /* copy the type-specific control parameters. */
+  if (opt->copy)
+    opt->copy(dup, opt);
+
+  /* return the replica. */
+  return dup;
+}
+
+/* optim_multistart_task: structure for holding the replicas of a
+ * multi-start optimization, shared by all threads.
+ *  @opts: array of optimizers, each with its own model.
+ *  @R: number of optimizers.
+ *  @next: index of the next optimizer to be executed.
+ */
+typedef struct {
+  Optim **opts;
+  size_t R, next;
+}
+optim_multistart_task;
+
+/* optim_multistart_thread(): execute replicas of a multi-start
+ * optimization, until none remain.
+ *  - see thread_fn() for more information.
+ */
+static void optim_multistart_thread (void *arg, size_t tid, size_t T) {
+  /* take and execute replicas in turn. */
+  optim_multistart_task *task = (optim_multistart_task*) arg;
+  while (1) {
+    const size_t r = __atomic_fetch_add(&task->next, 1, __ATOMIC_RELAXED);
+    if (r >= task->R)
+      break;
+
+    optim_execute(task->opts[r]);
+  }
+}
+
+/* optim_multistart(): execute a set of optimizers concurrently, each
+ * on its own model. the replicas are distributed over the thread pool,
+ * and the data-parallel operations within each replica run serially
+ * on the thread that executes it.
+ *
+ * arguments:
+ *  @opts: array of optimizers to execute.
+ *  @R: number of optimizers.
+ */
+void optim_multistart (Optim **opts, size_t R) {
+  /* check the input arguments. */
+  if (!opts || !R)
+    return;
+
+  /* use at most one thread per replica. */
+  const size_t T = thread_get_count();
+  optim_multistart_task task = { opts, R, 0 };
+  thread_execute(optim_multistart_thread, &task, (T < R ? T : R));
+}
+
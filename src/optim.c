@@ -54,6 +54,35 @@ PyDoc_STRVAR(
 "Filename for writing logging data (write-only)\n"
 "\n");
 
+PyDoc_STRVAR(
+  Optim_getset_timing_doc,
+"Phase timing flag (read/write)\n"
+"\n");
+
+PyDoc_STRVAR(
+  Optim_getset_tracefile_doc,
+"Filename for writing trace events, or None to close the trace\n"
+"(write-only)\n"
+"\n"
+"Events are written in the Chrome trace-event JSON format, and\n"
+"phases are timed while a trace is open.\n"
+"\n");
+
+PyDoc_STRVAR(
+  Optim_getset_stats_doc,
+"Accumulated timers and counters (read-only)\n"
+"\n"
+"The dictionary holds the iteration count and time, the calls and\n"
+"time of each phase of optimization, and for each factor the number\n"
+"of updates, proposed and accepted parameters, unchanged updates and\n"
+"time. Times are in seconds, and are zero unless timing is enabled.\n"
+"\n");
+
+PyDoc_STRVAR(
+  Optim_method_resetstats_doc,
+"Reset the accumulated timers and counters.\n"
+"\n");
+
 PyDoc_STRVAR(
   Optim_method_execute_doc,
 "Execute a round of free-running optimization.\n"
@@ -64,6 +93,72 @@ PyDoc_STRVAR(
 "Execute a single optimization iteration.\n"
 "\n");
 
+PyDoc_STRVAR(
+  Optim_method_multistart_doc,
+"multistart(replicas, randomize=None) -> (Model, list)\n"
+"\n"
+"Execute free-running optimization of several replicas of the\n"
+"associated model, and return the replica having the greatest\n"
+"lower bound along with the bound of each replica.\n"
+"\n"
+"Each replica holds copies of the factors and priors of the model,\n"
+"and shares its dataset. If given, randomize(model, r) is called on\n"
+"each replica before it is optimized, and may modify its factors.\n"
+"Replicas are optimized concurrently by the thread pool, using the\n"
+"control parameters of this optimizer. The associated model is left\n"
+"unchanged.\n"
+"\n");
+
+/* Optim_hold(): mark an optimizer and its model as in use by a
+ * computation that runs without the interpreter lock, failing if either
+ * is already in use.
+ */
+static int
+Optim_hold (Optim *self, int excl) {
+  /* fail if the optimizer is running. */
+  if (self->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "optimizer is in use");
+    return 0;
+  }
+
+  /* attempt to hold the model. */
+  if (self->mdl && !model_hold(self->mdl, excl)) {
+    PyErr_SetString(PyExc_RuntimeError, "model is in use");
+    return 0;
+  }
+
+  /* mark the optimizer and return success. */
+  self->busy++;
+  return 1;
+}
+
+/* Optim_release(): release an optimizer and its model from
+ * a computation started by Optim_hold().
+ */
+static void
+Optim_release (Optim *self) {
+  /* release the model and the optimizer. */
+  if (self->mdl)
+    model_release(self->mdl);
+
+  self->busy--;
+}
+
+/* Optim_setattro(): attribute setting method for optimizers, which
+ * rejects modifications while the optimizer is running.
+ */
+static int
+Optim_setattro (Optim *self, PyObject *name, PyObject *value) {
+  /* fail if the optimizer is running. */
+  if (self->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "optimizer is in use");
+    return -1;
+  }
+
+  /* set the attribute. */
+  return PyObject_GenericSetAttr((PyObject*) self, name, value);
+}
+
 /* Optim_get_bound(): method to get the lower bound of an optimizer.
  */
 static PyObject*
@@ -95,6 +190,12 @@ Optim_set_model (Optim *self, PyObject *value, void *closure) {
     return -1;
   }
 
+  /* the new model is inferred, and may not be in use. */
+  if (((Model*) value)->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "model is in use");
+    return -1;
+  }
+
   /* attempt to set the new model. */
   if (!optim_set_model(self, (Model*) value)) {
     PyErr_SetString(PyExc_RuntimeError, "failed to set model");
@@ -296,14 +397,151 @@ Optim_set_logfile (Optim *self, PyObject *value, void *closure) {
   return 0;
 }
 
+/* Optim_get_timing(): method to get the timing flag of an optimizer.
+ */
+static PyObject*
+Optim_get_timing (Optim *self) {
+  /* return the timing flag as a boolean. */
+  return PyBool_FromLong(self->timing);
+}
+
+/* Optim_set_timing(): method to set the timing flag of an optimizer.
+ */
+static int
+Optim_set_timing (Optim *self, PyObject *value, void *closure) {
+  /* check that the value is a boolean. */
+  if (!value || !PyBool_Check(value)) {
+    PyErr_SetString(PyExc_TypeError, "'timing' expects bool");
+    return -1;
+  }
+
+  /* set the value and return success. */
+  optim_set_timing(self, (int) PyLong_AsLong(value));
+  return 0;
+}
+
+/* Optim_set_tracefile(): method to set the trace file of an optimizer.
+ */
+static int
+Optim_set_tracefile (Optim *self, PyObject *value, void *closure) {
+  /* a value of none closes the trace. */
+  const char *fname = NULL;
+  if (value && value != Py_None) {
+    /* check that the value is a unicode type. */
+    if (!PyUnicode_Check(value)) {
+      PyErr_SetString(PyExc_TypeError, "'trace_file' expects str or None");
+      return -1;
+    }
+
+    /* get the filename as a c string. */
+    fname = PyUnicode_AsUTF8AndSize(value, NULL);
+    if (!fname)
+      return -1;
+  }
+
+  /* attempt to open or close the trace file. */
+  if (!optim_set_trace_file(self, fname)) {
+    PyErr_SetNone(PyExc_IOError);
+    return -1;
+  }
+
+  /* return success. */
+  return 0;
+}
+
+/* Optim_get_stats(): method to get the accumulated timers and counters
+ * of an optimizer, as a dictionary.
+ */
+static PyObject*
+Optim_get_stats (Optim *self) {
+  /* build the dictionary of phase statistics. */
+  const OptimStats *st = &self->stats;
+  PyObject *phases = PyDict_New();
+  if (!phases)
+    return NULL;
+
+  for (OptimPhase ph = 0; ph < OPTIM_PHASES; ph++) {
+    PyObject *item = Py_BuildValue("{s:n,s:d}",
+      "calls", (Py_ssize_t) st->calls[ph],
+      "time", st->times[ph]);
+
+    if (!item ||
+        PyDict_SetItemString(phases, optim_phase_name(ph), item) < 0) {
+      Py_XDECREF(item);
+      Py_DECREF(phases);
+      return NULL;
+    }
+
+    Py_DECREF(item);
+  }
+
+  /* build the list of factor statistics. */
+  PyObject *factors = PyList_New(st->M);
+  if (!factors) {
+    Py_DECREF(phases);
+    return NULL;
+  }
+
+  for (size_t j = 0; j < st->M; j++) {
+    const OptimFactorStats *fs = st->factors + j;
+    PyObject *item = Py_BuildValue("{s:n,s:n,s:n,s:n,s:d}",
+      "updates", (Py_ssize_t) fs->updates,
+      "trials", (Py_ssize_t) fs->trials,
+      "accepted", (Py_ssize_t) fs->accepted,
+      "unchanged", (Py_ssize_t) fs->unchanged,
+      "time", fs->time);
+
+    if (!item) {
+      Py_DECREF(factors);
+      Py_DECREF(phases);
+      return NULL;
+    }
+
+    PyList_SET_ITEM(factors, j, item);
+  }
+
+  /* build and return the complete dictionary. */
+  return Py_BuildValue("{s:n,s:d,s:N,s:N}",
+    "iters", (Py_ssize_t) st->iters,
+    "time", st->time,
+    "phases", phases,
+    "factors", factors);
+}
+
 /* --- */
 
+/* Optim_method_resetstats(): reset the accumulated statistics.
+ */
+static PyObject*
+Optim_method_resetstats (Optim *self, PyObject *args) {
+  /* the statistics may not be reset while the optimizer is running. */
+  if (self->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "optimizer is in use");
+    return NULL;
+  }
+
+  /* reset the statistics and return nothing. */
+  optim_reset_stats(self);
+  Py_RETURN_NONE;
+}
+
 /* Optim_method_execute(): execute a round of optimization.
  */
 static PyObject*
 Optim_method_execute (Optim *self, PyObject *args, PyObject *kwargs) {
-  /* execute and return nothing. */
+  /* hold the optimizer and its model. */
+  if (!Optim_hold(self, 1))
+    return NULL;
+
+  /* execute without holding the interpreter lock. */
+  Py_BEGIN_ALLOW_THREADS
   optim_execute(self);
+  Py_END_ALLOW_THREADS
+
+  /* release the optimizer and its model. */
+  Optim_release(self);
+
+  /* return nothing. */
   Py_RETURN_NONE;
 }
 
@@ -311,8 +549,132 @@ Optim_method_execute (Optim *self, PyObject *args, PyObject *kwargs) {
  */
 static PyObject*
 Optim_method_iterate (Optim *self, PyObject *args, PyObject *kwargs) {
-  /* iterate and return the result. */
-  return PyBool_FromLong(optim_iterate(self));
+  /* hold the optimizer and its model. */
+  if (!Optim_hold(self, 1))
+    return NULL;
+
+  /* iterate without holding the interpreter lock. */
+  int result;
+  Py_BEGIN_ALLOW_THREADS
+  result = optim_iterate(self);
+  Py_END_ALLOW_THREADS
+
+  /* release the optimizer and its model. */
+  Optim_release(self);
+
+  /* return the result. */
+  return PyBool_FromLong(result);
+}
+
+/* Optim_method_multistart(): execute a multi-start optimization.
+ */
+static PyObject*
+Optim_method_multistart (Optim *self, PyObject *args, PyObject *kwargs) {
+  /* parse the method arguments. */
+  size_t R = 0;
+  PyObject *randomize = Py_None;
+  static char *kwlist[] = { "replicas", "randomize", NULL };
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O", kwlist,
+                                   PySize_t_Converter, &R,
+                                   &randomize))
+    return NULL;
+
+  /* check the arguments. */
+  if (R == 0) {
+    PyErr_SetString(PyExc_ValueError, "expected positive replica count");
+    return NULL;
+  }
+
+  if (randomize != Py_None && !PyCallable_Check(randomize)) {
+    PyErr_SetString(PyExc_TypeError, "expected callable or None");
+    return NULL;
+  }
+
+  /* check that a model is associated. */
+  if (!self->mdl) {
+    PyErr_SetString(PyExc_RuntimeError, "no associated model");
+    return NULL;
+  }
+
+  /* hold the optimizer and its model, which is copied but unchanged. */
+  if (!Optim_hold(self, 0))
+    return NULL;
+
+  /* allocate the array of replica optimizers. */
+  Optim **opts = calloc(R, sizeof(Optim*));
+  if (!opts) {
+    Optim_release(self);
+    return PyErr_NoMemory();
+  }
+
+  /* create, randomize and associate each replica. */
+  PyObject *ret = NULL;
+  for (size_t r = 0; r < R; r++) {
+    /* copy the model. */
+    Model *mdl = model_copy(self->mdl);
+    if (!mdl) {
+      PyErr_SetString(PyExc_RuntimeError, "failed to copy model");
+      goto done;
+    }
+
+    /* randomize the model copy. */
+    if (randomize != Py_None) {
+      PyObject *res = PyObject_CallFunction(randomize, "On",
+                                            (PyObject*) mdl,
+                                            (Py_ssize_t) r);
+      Py_XDECREF(res);
+      if (!res) {
+        Py_DECREF(mdl);
+        goto done;
+      }
+    }
+
+    /* create an optimizer for the model copy. */
+    opts[r] = optim_replica(self);
+    const int ok = (opts[r] && optim_set_model(opts[r], mdl));
+    Py_DECREF(mdl);
+    if (!ok) {
+      PyErr_SetString(PyExc_RuntimeError, "failed to prepare replica");
+      goto done;
+    }
+  }
+
+  /* hold each replica, along with the shared dataset. */
+  for (size_t r = 0; r < R; r++)
+    model_hold(opts[r]->mdl, 1);
+
+  /* optimize the replicas without holding the interpreter lock. */
+  Py_BEGIN_ALLOW_THREADS
+  optim_multistart(opts, R);
+  Py_END_ALLOW_THREADS
+
+  /* release the replicas. */
+  for (size_t r = 0; r < R; r++)
+    model_release(opts[r]->mdl);
+
+  /* build the list of bounds, and locate the best replica. */
+  PyObject *bounds = PyList_New(R);
+  if (!bounds)
+    goto done;
+
+  size_t best = 0;
+  for (size_t r = 0; r < R; r++) {
+    PyList_SET_ITEM(bounds, r, PyFloat_FromDouble(opts[r]->bound));
+    if (opts[r]->bound > opts[best]->bound || isnan(opts[best]->bound))
+      best = r;
+  }
+
+  /* return the best model and the bounds. */
+  ret = Py_BuildValue("(ON)", (PyObject*) opts[best]->mdl, bounds);
+
+done:
+  /* release the replicas and the optimizer, and return. */
+  for (size_t r = 0; r < R; r++)
+    Py_XDECREF(opts[r]);
+
+  free(opts);
+  Optim_release(self);
+  return ret;
 }
 
 /* --- */
@@ -346,9 +708,12 @@ Optim_dealloc (Optim *self) {
   /* release the reference to the associated model. */
   Py_XDECREF(self->mdl);
 
-  /* close any open file handles. */
-  if (self->log_fh)
-    fclose(self->log_fh);
+  /* close any open log and trace streams. */
+  optim_set_log_file(self, NULL);
+  optim_set_trace_file(self, NULL);
+
+  /* free the statistics. */
+  free(self->stats.factors);
 
   /* free the iteration vectors. */
   vector_free(self->xa);
@@ -429,6 +794,24 @@ static PyGetSetDef Optim_getset[] = {
     Optim_getset_logfile_doc,
     NULL
   },
+  { "timing",
+    (getter) Optim_get_timing,
+    (setter) Optim_set_timing,
+    Optim_getset_timing_doc,
+    NULL
+  },
+  { "trace_file",
+    NULL,
+    (setter) Optim_set_tracefile,
+    Optim_getset_tracefile_doc,
+    NULL
+  },
+  { "stats",
+    (getter) Optim_get_stats,
+    NULL,
+    Optim_getset_stats_doc,
+    NULL
+  },
   { NULL }
 };
 
@@ -445,6 +828,16 @@ static PyMethodDef Optim_methods[] = {
     METH_VARARGS,
     Optim_method_iterate_doc
   },
+  { "multistart",
+    (PyCFunction) Optim_method_multistart,
+    METH_VARARGS | METH_KEYWORDS,
+    Optim_method_multistart_doc
+  },
+  { "reset_stats",
+    (PyCFunction) Optim_method_resetstats,
+    METH_NOARGS,
+    Optim_method_resetstats_doc
+  },
   { NULL }
 };
 
@@ -468,7 +861,7 @@ PyTypeObject Optim_Type = {
   0,                                             /* tp_call           */
   (reprfunc) Optim_repr,                         /* tp_str            */
   0,                                             /* tp_getattro       */
-  0,                                             /* tp_setattro       */
+  (setattrofunc) Optim_setattro,                 /* tp_setattro       */
   0,                                             /* tp_as_buffer      */
   Py_TPFLAGS_DEFAULT |
   Py_TPFLAGS_BASETYPE,                           /* tp_flags          */
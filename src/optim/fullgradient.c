@@ -26,7 +26,6 @@ OPTIM_ITERATE (FullGradient) {
   /* gain references to commonly accessed variables. */
   Factor **factors = opt->mdl->factors;
   Factor **priors = opt->mdl->priors;
-  const size_t N = opt->mdl->dat->N;
   const size_t M = opt->mdl->M;
 
   /* declare variables to track the bound between steps and iterations,
@@ -42,8 +41,13 @@ OPTIM_ITERATE (FullGradient) {
   MatrixView Fs;
 
   /* initialize the model using a full inference. */
+  double t = optim_clock(opt);
   model_infer(opt->mdl);
+  optim_phase(opt, OPTIM_PHASE_INFER, OPTIM_NO_FACTOR, t);
+
+  t = optim_clock(opt);
   bound = bound_init = model_bound(opt->mdl);
+  optim_phase(opt, OPTIM_PHASE_BOUND, OPTIM_NO_FACTOR, t);
 
   /* loop over each factor in the model. */
   for (size_t j = 0; j < M; j++) {
@@ -55,6 +59,9 @@ OPTIM_ITERATE (FullGradient) {
     if (P == 0 || factors[j]->fixed)
       continue;
 
+    /* start timing the factor update. */
+    const double tj = optim_clock(opt);
+
     /* configure the parameter and gradient vector views. */
     xa = vector_subvector(opt->xa, 0, P);
     xb = vector_subvector(opt->xb, 0, P);
@@ -69,16 +76,18 @@ OPTIM_ITERATE (FullGradient) {
     vector_copy(&xb, priors[j]->par);
 
     /* compute the parameter gradient from all observations. */
-    vector_set_zero(&x);
-    for (size_t i = 0; i < N; i++)
-      model_gradient(opt->mdl, i, j, &x);
+    t = optim_clock(opt);
+    model_gradient_all(opt->mdl, j, &x);
+    optim_phase(opt, OPTIM_PHASE_GRADIENT, j, t);
 
     /* copy and decompose the fisher information in order to compute
      * the natural gradient.
      */
+    t = optim_clock(opt);
     matrix_copy(&Fs, factors[j]->inf);
     chol_decomp(&Fs);
     chol_solve(&Fs, &x, &g);
+    optim_phase(opt, OPTIM_PHASE_SOLVE, j, t);
 
     /* add the natural gradient to the prior. */
     vector_add(&xb, &g);
@@ -86,8 +95,10 @@ OPTIM_ITERATE (FullGradient) {
     /* initialize the step length using the minimum eigenvalue of
      * the fisher information matrix.
      */
+    t = optim_clock(opt);
     gamma = eigen_minev(factors[j]->inf, &Fs, &g, &x);
     gamma /= opt->l0;
+    optim_phase(opt, OPTIM_PHASE_EIGEN, j, t);
 
     /* perform a back-tracking line search. */
     size_t steps = 0;
@@ -107,14 +118,22 @@ OPTIM_ITERATE (FullGradient) {
       /* attempt to set the proposed parameters. */
       if (model_set_parms(opt->mdl, j, &x)) {
         /* update the model and compute a new bound. */
+        t = optim_clock(opt);
         model_update(opt->mdl, j);
+        optim_phase(opt, OPTIM_PHASE_UPDATE, j, t);
+
+        t = optim_clock(opt);
         bound = model_bound(opt->mdl);
+        optim_phase(opt, OPTIM_PHASE_BOUND, j, t);
 
         /* if the bound has increased, accept it as a valid step. */
         if (bound > bound_prev)
           valid = 1;
       }
 
+      /* record the proposal. */
+      optim_trial(opt, j, valid);
+
       /* in case the step was invalid, update the step length and
        * increment the step count.
        */
@@ -126,10 +145,15 @@ OPTIM_ITERATE (FullGradient) {
     /* if a valid step was not identified. */
     if (!valid) {
       /* restore the previous parameters and reset the model. */
+      t = optim_clock(opt);
       model_set_parms(opt->mdl, j, &xa);
       model_update(opt->mdl, j);
+      optim_phase(opt, OPTIM_PHASE_UPDATE, j, t);
       bound = bound_prev;
     }
+
+    /* record the factor update. */
+    optim_factor(opt, j, valid, tj);
   }
 
   /* store the new lower bound into the optimizer. */
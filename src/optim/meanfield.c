@@ -27,8 +27,13 @@ OPTIM_ITERATE (MeanField) {
   double bound, bound_init;
 
   /* initialize the model using a full inference. */
+  double t = optim_clock(opt);
   model_infer(opt->mdl);
+  optim_phase(opt, OPTIM_PHASE_INFER, OPTIM_NO_FACTOR, t);
+
+  t = optim_clock(opt);
   bound = bound_init = model_bound(opt->mdl);
+  optim_phase(opt, OPTIM_PHASE_BOUND, OPTIM_NO_FACTOR, t);
 
   /* determine the maximum number of factors to update. */
   size_t M = 0, K = 0;
@@ -45,12 +50,25 @@ OPTIM_ITERATE (MeanField) {
 
   /* update each factor in the model. */
   for (size_t j = 0; j < M; j++) {
-    /* update the factor and, if necessary, re-infer the weights. */
-    if (model_meanfield(opt->mdl, j))
+    /* update the factor. */
+    const double tj = optim_clock(opt);
+    const int changed = model_meanfield(opt->mdl, j);
+    optim_phase(opt, OPTIM_PHASE_MEANFIELD, j, tj);
+
+    /* if necessary, re-infer the weights. */
+    if (changed) {
+      t = optim_clock(opt);
       model_update(opt->mdl, j);
+      optim_phase(opt, OPTIM_PHASE_UPDATE, j, t);
+    }
 
     /* recalculate the bound. */
+    t = optim_clock(opt);
     bound = model_bound(opt->mdl);
+    optim_phase(opt, OPTIM_PHASE_BOUND, j, t);
+
+    /* record the factor update. */
+    optim_factor(opt, j, changed, tj);
   }
 
   /* store the new lower bound into the optimizer. */
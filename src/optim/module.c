@@ -6,6 +6,7 @@
 
 int FullGradient_Type_init (PyObject *mod);
 int MeanField_Type_init (PyObject *mod);
+int Stochastic_Type_init (PyObject *mod);
 
 /* define documentation strings: */
 
@@ -39,7 +40,8 @@ PyInit_optim (void) {
 
   /* initialize the optimizer types. */
   if (FullGradient_Type_init(optim) < 0 ||
-      MeanField_Type_init(optim) < 0)
+      MeanField_Type_init(optim) < 0 ||
+      Stochastic_Type_init(optim) < 0)
     return NULL;
 
   /* return the new module. */
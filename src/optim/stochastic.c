@@ -0,0 +1,591 @@
+
+/* include the vfl header. */
+#include <vfl/vfl.h>
+
+/* Stochastic: structure for holding stochastic optimizers.
+ */
+typedef struct {
+  /* optimizer superclass. */
+  Optim super;
+
+  /* subclass struct members:
+   *  @batch: minibatch of observations, which is associated with the
+   *          model in place of its dataset during each iteration. the
+   *          minibatch is a complete dataset object, so that it may be
+   *          safely referenced by python while it is associated.
+   *  @B: number of observations in each minibatch.
+   *  @steps: number of steps taken since the model was associated.
+   *  @kappa: step length decay exponent.
+   *  @delay: step length delay.
+   *  @radius: trust radius of factor parameter steps.
+   *  @state: state of the minibatch sampler.
+   */
+  Data *batch;
+  size_t B, steps;
+  double kappa, delay, radius;
+  uint64_t state;
+}
+Stochastic;
+
+/* define documentation strings: */
+
+PyDoc_STRVAR(
+  Stochastic_doc,
+"Stochastic() -> Stochastic object\n"
+"\n"
+"Stochastic variational inference. Each iteration draws a minibatch\n"
+"of observations, uniformly and with replacement, from the dataset of\n"
+"the model. Minibatch estimates of the weight posterior and of the\n"
+"factor gradients are then scaled to the complete dataset, and a\n"
+"natural-gradient step of length (t + delay)^(-decay) is taken.\n"
+"Factor parameter steps are further limited to a trust radius in\n"
+"the fisher metric of the current parameters.\n"
+"\n"
+"The complete dataset is never accessed, and the lower bound is not\n"
+"evaluated, during iterations.\n");
+
+PyDoc_STRVAR(
+  Stochastic_getset_batch_doc,
+"Number of observations in each minibatch (read/write)\n"
+"\n");
+
+PyDoc_STRVAR(
+  Stochastic_getset_decay_doc,
+"Step length decay exponent, in (0.5, 1] (read/write)\n"
+"\n");
+
+PyDoc_STRVAR(
+  Stochastic_getset_delay_doc,
+"Step length delay, at least one (read/write)\n"
+"\n");
+
+PyDoc_STRVAR(
+  Stochastic_getset_radius_doc,
+"Trust radius of factor parameter steps, in the fisher metric\n"
+"of the current parameters (read/write)\n"
+"\n");
+
+PyDoc_STRVAR(
+  Stochastic_getset_seed_doc,
+"Minibatch sampler seed (write-only)\n"
+"\n");
+
+/* stochastic_rand(): draw a uniform random index from a range, using
+ * the xorshift64* generator of a stochastic optimizer.
+ *
+ * arguments:
+ *  @sopt: stochastic optimizer structure pointer.
+ *  @n: size of the index range.
+ *
+ * returns:
+ *  random index in [0, n).
+ */
+static size_t stochastic_rand (Stochastic *sopt, size_t n) {
+  /* advance the generator state. */
+  uint64_t x = sopt->state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  sopt->state = x;
+
+  /* scale the upper bits of the output into the range. */
+  const double u = (double) ((x * 2685821657736338717ULL) >> 11) *
+                   (1.0 / 9007199254740992.0);
+  return (size_t) (u * (double) n);
+}
+
+/* stochastic_sample(): draw a new minibatch of observations from
+ * a dataset into a stochastic optimizer.
+ *
+ * arguments:
+ *  @sopt: stochastic optimizer structure pointer.
+ *  @dat: dataset structure pointer to sample from.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int stochastic_sample (Stochastic *sopt, const Data *dat) {
+  /* determine the minibatch size. */
+  const size_t B = (sopt->B < dat->N ? sopt->B : dat->N);
+  const size_t D = dat->D;
+  Data *batch = sopt->batch;
+
+  /* reallocate the minibatch arrays, if required. the arrays may not
+   * be reallocated while they are viewed from python.
+   */
+  if (B > batch->cap || D != batch->D) {
+    if (batch->arrays)
+      return 0;
+
+    double *X = malloc(B * (D ? D : 1) * sizeof(double));
+    double *y = malloc(B * sizeof(double));
+    size_t *p = malloc(B * sizeof(size_t));
+    if (!X || !y || !p) {
+      free(X);
+      free(y);
+      free(p);
+      return 0;
+    }
+
+    /* replace the arrays. */
+    free(batch->X);
+    free(batch->y);
+    free(batch->p);
+    batch->X = X;
+    batch->y = y;
+    batch->p = p;
+    batch->cap = B;
+    batch->D = D;
+  }
+
+  /* copy randomly selected observations into the minibatch. */
+  for (size_t i = 0; i < B; i++) {
+    const size_t is = stochastic_rand(sopt, dat->N);
+    memcpy(batch->X + i * D, dat->X + is * D, D * sizeof(double));
+    batch->y[i] = dat->y[is];
+    batch->p[i] = dat->p[is];
+  }
+
+  /* store the minibatch size and version, and return success. */
+  batch->N = B;
+  data_touch(batch);
+  return 1;
+}
+
+/* stochastic_div_grad(): compute the gradient of the divergence of
+ * a model factor from its prior by central finite differences. the
+ * divergence does not depend on the dataset, and the parameters of
+ * the factor are restored on return.
+ *
+ * arguments:
+ *  @mdl: model structure pointer.
+ *  @j: index of the factor to differentiate.
+ *  @xa: current parameters of the factor.
+ *  @g: output divergence gradient vector.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int stochastic_div_grad (Model *mdl, size_t j, const Vector *xa,
+                                Vector *g) {
+  /* gain references to the factor and its prior. */
+  Factor *f = mdl->factors[j];
+  const Factor *fp = mdl->priors[j];
+
+  /* loop over each factor parameter. */
+  int ok = 1;
+  for (size_t p = 0; p < xa->len && ok; p++) {
+    /* compute the finite difference step size. */
+    const double xp = vector_get(xa, p);
+    const double h = 1.0e-6 * (fabs(xp) > 1.0 ? fabs(xp) : 1.0);
+
+    /* evaluate the divergence on either side of the parameter. */
+    ok = factor_set(f, p, xp + h);
+    const double dp = factor_div(f, fp);
+    ok = ok && factor_set(f, p, xp - h);
+    const double dm = factor_div(f, fp);
+
+    /* store the gradient element and restore the parameter. */
+    vector_set(g, p, (dp - dm) / (2.0 * h));
+    factor_set(f, p, xp);
+  }
+
+  /* return the result. */
+  return ok;
+}
+
+/* Stochastic_prepare(): preparation function for Stochastic.
+ *  - see optim_prepare_fn() for more information.
+ */
+OPTIM_PREPARE (Stochastic) {
+  /* the model must support stochastic steps over a non-empty dataset. */
+  if (!mdl->step || !mdl->dat || !mdl->dat->N || !mdl->K)
+    return 0;
+
+  /* start from the weight prior, without accessing the dataset. */
+  model_weight_prior(mdl);
+
+  /* restart the step length schedule. */
+  ((Stochastic*) opt)->steps = 0;
+
+  /* return success. */
+  return 1;
+}
+
+/* Stochastic_iterate(): iteration function for Stochastic.
+ *  - see optim_iterate_fn() for more information.
+ */
+OPTIM_ITERATE (Stochastic) {
+  /* gain references to commonly accessed variables. */
+  Stochastic *sopt = (Stochastic*) opt;
+  Model *mdl = opt->mdl;
+  Factor **factors = mdl->factors;
+  const size_t M = mdl->M;
+
+  /* gain access to the complete dataset, and sample a minibatch. */
+  Data *dat = mdl->dat;
+  const size_t N = dat->N;
+  if (!stochastic_sample(sopt, dat))
+    return 0;
+
+  /* compute the step length and the minibatch scale factor. */
+  const double rho = pow((double) sopt->steps + sopt->delay, -sopt->kappa);
+  const double scale = (double) N / sopt->batch->N;
+  sopt->steps++;
+
+  /* declare variables for holding factor parameters, gradients,
+   * and their associated fisher information matrices.
+   */
+  VectorView xa, xb, x, g;
+  MatrixView Fs;
+
+  /* associate the minibatch with the model for the duration of the
+   * iteration. the optimizer keeps its reference to the minibatch, and
+   * the model borrows it.
+   */
+  mdl->dat = sopt->batch;
+
+  /* take a step on the posterior nuisance parameters. */
+  double t = optim_clock(opt);
+  int ok = model_step(mdl, N, rho);
+  optim_phase(opt, OPTIM_PHASE_STEP, OPTIM_NO_FACTOR, t);
+
+  /* loop over each factor in the model. */
+  for (size_t j = 0; j < M && ok; j++) {
+    /* gain a reference to the current factor parameter count. */
+    const size_t P = factors[j]->P;
+    if (P == 0 || factors[j]->fixed)
+      continue;
+
+    /* start timing the factor update. */
+    const double tj = optim_clock(opt);
+
+    /* configure the parameter and gradient vector views. */
+    xa = vector_subvector(opt->xa, 0, P);
+    xb = vector_subvector(opt->xb, 0, P);
+    x = vector_subvector(opt->x, 0, P);
+    g = vector_subvector(opt->g, 0, P);
+
+    /* configure the fisher information martix view. */
+    Fs = matrix_submatrix(opt->Fs, 0, 0, P, P);
+
+    /* copy the current factor parameters. */
+    vector_copy(&xa, factors[j]->par);
+
+    /* estimate the gradient of the bound from the minibatch: the scaled
+     * gradient of the expected log-likelihood, less the gradient of the
+     * divergence of the factor from its prior.
+     */
+    t = optim_clock(opt);
+    ok = model_gradient_all(mdl, j, &x) &&
+         stochastic_div_grad(mdl, j, &xa, &g);
+    blas_dscal(scale, &x);
+    blas_daxpy(-1.0, &g, &x);
+    optim_phase(opt, OPTIM_PHASE_GRADIENT, j, t);
+
+    /* copy and decompose the fisher information in order to compute
+     * the natural gradient.
+     */
+    t = optim_clock(opt);
+    matrix_copy(&Fs, factors[j]->inf);
+    chol_decomp(&Fs);
+    chol_solve(&Fs, &x, &xb);
+    optim_phase(opt, OPTIM_PHASE_SOLVE, j, t);
+
+    /* limit the length of the step, measured in the fisher metric
+     * of the current parameters, to the trust radius.
+     */
+    const double dist = rho * sqrt(blas_ddot(&xb, &x));
+    double gamma = (dist > sopt->radius ? sopt->radius / dist : 1.0) * rho;
+
+    /* shorten the step until the proposed parameters are valid. */
+    size_t steps = 0;
+    int valid = 0;
+    do {
+      /* propose a new parameter vector. */
+      vector_copy(&x, &xa);
+      blas_daxpy(gamma, &xb, &x);
+
+      /* attempt to set the proposed parameters. */
+      valid = model_set_parms(mdl, j, &x);
+      optim_trial(opt, j, valid);
+
+      /* update the step length and increment the step count. */
+      gamma *= opt->dl;
+      steps++;
+    }
+    while (!valid && steps < opt->max_steps);
+
+    /* if a valid step was not identified, restore the parameters. */
+    if (!valid)
+      model_set_parms(mdl, j, &xa);
+
+    /* record the factor update. */
+    optim_factor(opt, j, valid, tj);
+  }
+
+  /* restore the complete dataset. */
+  mdl->dat = dat;
+
+  /* return whether or not the iteration succeeded. */
+  return ok;
+}
+
+/* Stochastic_execute(): execution function for Stochastic.
+ *  - see optim_iterate_fn() for more information.
+ */
+OPTIM_EXECUTE (Stochastic) {
+  /* loop for the specified number of iterations. */
+  int ret = 0;
+  for (size_t iter = 0; iter < opt->max_iters; iter++) {
+    /* perform an iteration, and break if it failed. */
+    ret = optim_iterate(opt);
+    if (!ret)
+      break;
+  }
+
+  /* return whether the final iteration changed the model. */
+  return ret;
+}
+
+/* Stochastic_free(): free function for Stochastic.
+ *  - see optim_free_fn() for more information.
+ */
+OPTIM_FREE (Stochastic) {
+  /* release the minibatch. */
+  Stochastic *sopt = (Stochastic*) opt;
+  Py_XDECREF(sopt->batch);
+}
+
+/* Stochastic_copy(): copy the control parameters of a stochastic
+ * optimizer into a replica.
+ *  - see optim_copy_fn() for more information.
+ */
+OPTIM_COPY (Stochastic) {
+  /* copy the minibatch size, step schedule and sampler state. */
+  Stochastic *sdest = (Stochastic*) dest;
+  const Stochastic *ssrc = (const Stochastic*) src;
+  sdest->B = ssrc->B;
+  sdest->kappa = ssrc->kappa;
+  sdest->delay = ssrc->delay;
+  sdest->radius = ssrc->radius;
+  sdest->state = ssrc->state;
+}
+
+/* --- */
+
+/* Stochastic_get_batch(): method to get the minibatch size.
+ */
+static PyObject*
+Stochastic_get_batch (Stochastic *self) {
+  /* return the minibatch size as an integer. */
+  return PyLong_FromSize_t(self->B);
+}
+
+/* Stochastic_set_batch(): method to set the minibatch size.
+ */
+static int
+Stochastic_set_batch (Stochastic *self, PyObject *value, void *closure) {
+  /* get the new value. */
+  const size_t v = PyLong_AsSize_t(value);
+  if (PyErr_Occurred())
+    return -1;
+
+  /* check the new value. */
+  if (v == 0) {
+    PyErr_SetString(PyExc_ValueError, "expected positive integer");
+    return -1;
+  }
+
+  /* set the new value and return success. */
+  self->B = v;
+  return 0;
+}
+
+/* Stochastic_get_decay(): method to get the step length decay.
+ */
+static PyObject*
+Stochastic_get_decay (Stochastic *self) {
+  /* return the exponent as a float. */
+  return PyFloat_FromDouble(self->kappa);
+}
+
+/* Stochastic_set_decay(): method to set the step length decay.
+ */
+static int
+Stochastic_set_decay (Stochastic *self, PyObject *value, void *closure) {
+  /* get the new value. */
+  const double v = PyFloat_AsDouble(value);
+  if (PyErr_Occurred())
+    return -1;
+
+  /* check the new value, which must satisfy the robbins-monro
+   * conditions on the step length schedule.
+   */
+  if (!(v > 0.5 && v <= 1.0)) {
+    PyErr_SetString(PyExc_ValueError, "expected float in (0.5, 1]");
+    return -1;
+  }
+
+  /* set the new value and return success. */
+  self->kappa = v;
+  return 0;
+}
+
+/* Stochastic_get_delay(): method to get the step length delay.
+ */
+static PyObject*
+Stochastic_get_delay (Stochastic *self) {
+  /* return the delay as a float. */
+  return PyFloat_FromDouble(self->delay);
+}
+
+/* Stochastic_set_delay(): method to set the step length delay.
+ */
+static int
+Stochastic_set_delay (Stochastic *self, PyObject *value, void *closure) {
+  /* get the new value. */
+  const double v = PyFloat_AsDouble(value);
+  if (PyErr_Occurred())
+    return -1;
+
+  /* check the new value, which keeps every step length in (0, 1]. */
+  if (!(v >= 1.0) || !isfinite(v)) {
+    PyErr_SetString(PyExc_ValueError, "expected float >= 1");
+    return -1;
+  }
+
+  /* set the new value and return success. */
+  self->delay = v;
+  return 0;
+}
+
+/* Stochastic_get_radius(): method to get the trust radius.
+ */
+static PyObject*
+Stochastic_get_radius (Stochastic *self) {
+  /* return the radius as a float. */
+  return PyFloat_FromDouble(self->radius);
+}
+
+/* Stochastic_set_radius(): method to set the trust radius.
+ */
+static int
+Stochastic_set_radius (Stochastic *self, PyObject *value, void *closure) {
+  /* get the new value. */
+  const double v = PyFloat_AsDouble(value);
+  if (PyErr_Occurred())
+    return -1;
+
+  /* check the new value. */
+  if (!(v > 0.0) || !isfinite(v)) {
+    PyErr_SetString(PyExc_ValueError, "expected positive float");
+    return -1;
+  }
+
+  /* set the new value and return success. */
+  self->radius = v;
+  return 0;
+}
+
+/* Stochastic_set_seed(): method to seed the minibatch sampler.
+ */
+static int
+Stochastic_set_seed (Stochastic *self, PyObject *value, void *closure) {
+  /* get the new value. */
+  const unsigned long long v = PyLong_AsUnsignedLongLong(value);
+  if (PyErr_Occurred())
+    return -1;
+
+  /* set the sampler state, which must be non-zero. */
+  self->state = (v ? (uint64_t) v : 1);
+  return 0;
+}
+
+/* Stochastic_new(): allocate a new stochastic optimizer.
+ *  - see PyTypeObject.tp_new for details.
+ */
+VFL_TYPE_NEW (Stochastic) {
+  /* allocate a new stochastic optimizer. */
+  Stochastic *self = (Stochastic*) type->tp_alloc(type, 0);
+  Optim_reset((Optim*) self);
+  if (!self)
+    return NULL;
+
+  /* set the function pointers. */
+  Optim *opt = (Optim*) self;
+  opt->iterate = Stochastic_iterate;
+  opt->execute = Stochastic_execute;
+  opt->prepare = Stochastic_prepare;
+  opt->free = Stochastic_free;
+  opt->copy = Stochastic_copy;
+
+  /* allocate an empty minibatch. */
+  self->batch = (Data*) PyObject_CallObject((PyObject*) &Data_Type, NULL);
+  if (!self->batch) {
+    Py_DECREF(self);
+    return NULL;
+  }
+
+  /* the minibatch is only modified by the optimizer. */
+  self->batch->busy = 1;
+
+  /* initialize the control parameters. */
+  self->B = 256;
+  self->steps = 0;
+  self->kappa = 0.7;
+  self->delay = 1.0;
+  self->radius = 0.1;
+  self->state = 88172645463325252ULL;
+
+  /* return the new object. */
+  return (PyObject*) self;
+}
+
+/* Stochastic_getset: property definition structure for
+ * stochastic optimizers.
+ */
+static PyGetSetDef Stochastic_getset[] = {
+  { "batch_size",
+    (getter) Stochastic_get_batch,
+    (setter) Stochastic_set_batch,
+    Stochastic_getset_batch_doc,
+    NULL
+  },
+  { "decay",
+    (getter) Stochastic_get_decay,
+    (setter) Stochastic_set_decay,
+    Stochastic_getset_decay_doc,
+    NULL
+  },
+  { "delay",
+    (getter) Stochastic_get_delay,
+    (setter) Stochastic_set_delay,
+    Stochastic_getset_delay_doc,
+    NULL
+  },
+  { "radius",
+    (getter) Stochastic_get_radius,
+    (setter) Stochastic_set_radius,
+    Stochastic_getset_radius_doc,
+    NULL
+  },
+  { "seed",
+    NULL,
+    (setter) Stochastic_set_seed,
+    Stochastic_getset_seed_doc,
+    NULL
+  },
+  { NULL }
+};
+
+/* Stochastic_methods: method definition structure for
+ * stochastic optimizers.
+ */
+static PyMethodDef Stochastic_methods[] = {
+  { NULL }
+};
+
+/* Stochastic_Type, Stochastic_Type_init() */
+VFL_TYPE (Stochastic, Optim, optim)
+
@@ -0,0 +1,469 @@
+
+/* include the vfl header. */
+#include <vfl/vfl.h>
+
+/* Profile: structure for holding a factor profiling context, along with
+ * the counts of its session once the context has exited.
+ */
+typedef struct {
+  /* object base. */
+  PyObject_HEAD
+
+  /* @active: whether the profiling session is in progress. */
+  int active;
+
+  /* factor type counts:
+   *  @ntypes: number of factor types.
+   *  @types: array of factor types.
+   *  @tcounts: array of factor type counts.
+   */
+  size_t ntypes;
+  PyTypeObject **types;
+  FactorCounts *tcounts;
+
+  /* factor instance counts:
+   *  @nfactors: number of factor instances.
+   *  @factors: array of factors, or null for deallocated factors.
+   *  @names: array of factor type names.
+   *  @fcounts: array of factor instance counts.
+   */
+  size_t nfactors;
+  Factor **factors;
+  const char **names;
+  FactorCounts *fcounts;
+}
+Profile;
+
+/* define documentation strings: */
+
+PyDoc_STRVAR(
+  Profile_doc,
+"Profile() -> Profile object\n"
+"\n"
+"Context that counts the calls to each factor function, and the\n"
+"cycles spent within them, while it is active. Counts are kept for\n"
+"each factor type and each factor instance. The cycles of product\n"
+"factors include those of their member factors.\n"
+"\n");
+
+PyDoc_STRVAR(
+  Profile_getset_clock_doc,
+"Counter used to measure cycles, 'tsc' or 'ns' (read-only)\n"
+"\n");
+
+PyDoc_STRVAR(
+  Profile_getset_types_doc,
+"Counts of each factor type, keyed by type name (read-only)\n"
+"\n");
+
+PyDoc_STRVAR(
+  Profile_getset_factors_doc,
+"Counts of each profiled factor instance (read-only)\n"
+"\n"
+"Each entry holds the factor, or None if it has been deallocated,\n"
+"its type name, and the counts of each function it called.\n"
+"\n");
+
+PyDoc_STRVAR(
+  Profile_method_enter_doc,
+"Begin a profiling session.\n"
+"\n");
+
+PyDoc_STRVAR(
+  Profile_method_exit_doc,
+"End a profiling session, and collect its counts.\n"
+"\n");
+
+/* Profile_clear(): release the collected counts of a profile.
+ */
+static void
+Profile_clear (Profile *self) {
+  /* release the held factor references. */
+  for (size_t i = 0; i < self->nfactors; i++)
+    Py_XDECREF(self->factors[i]);
+
+  /* free the count arrays. */
+  free(self->types);
+  free(self->tcounts);
+  free(self->factors);
+  free(self->names);
+  free(self->fcounts);
+
+  /* reset the counts. */
+  self->ntypes = self->nfactors = 0;
+  self->types = NULL;
+  self->tcounts = NULL;
+  self->factors = NULL;
+  self->names = NULL;
+  self->fcounts = NULL;
+}
+
+/* Profile_collect(): collect the counts of the most recent profiling
+ * session into a profile.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int
+Profile_collect (Profile *self) {
+  /* determine the numbers of types and factors. */
+  const size_t nt = factor_profile_types(NULL, NULL, 0);
+  const size_t nf = factor_profile_factors(NULL, NULL, NULL, 0);
+
+  /* allocate the count arrays. */
+  self->types = malloc((nt + 1) * sizeof(PyTypeObject*));
+  self->tcounts = malloc((nt + 1) * sizeof(FactorCounts));
+  self->factors = malloc((nf + 1) * sizeof(Factor*));
+  self->names = malloc((nf + 1) * sizeof(char*));
+  self->fcounts = malloc((nf + 1) * sizeof(FactorCounts));
+  if (!self->types || !self->tcounts || !self->factors ||
+      !self->names || !self->fcounts)
+    return 0;
+
+  /* copy the counts. */
+  self->ntypes = factor_profile_types(self->types, self->tcounts, nt);
+  self->nfactors = factor_profile_factors(self->factors, self->names,
+                                          self->fcounts, nf);
+
+  /* hold references to the factors that are still allocated. */
+  for (size_t i = 0; i < self->nfactors; i++)
+    Py_XINCREF(self->factors[i]);
+
+  /* return success. */
+  return 1;
+}
+
+/* Profile_build_ops(): build a dictionary of the calls and cycles of
+ * each factor function that was called.
+ */
+static PyObject*
+Profile_build_ops (const FactorCounts *c) {
+  /* create the dictionary. */
+  PyObject *ops = PyDict_New();
+  if (!ops)
+    return NULL;
+
+  /* add each function that was called. */
+  for (FactorOp op = 0; op < FACTOR_OPS; op++) {
+    if (!c->calls[op])
+      continue;
+
+    PyObject *item = Py_BuildValue("{s:K,s:K}",
+      "calls", (unsigned long long) c->calls[op],
+      "cycles", (unsigned long long) c->cycles[op]);
+
+    if (!item ||
+        PyDict_SetItemString(ops, factor_profile_op_name(op), item) < 0) {
+      Py_XDECREF(item);
+      Py_DECREF(ops);
+      return NULL;
+    }
+
+    Py_DECREF(item);
+  }
+
+  /* return the dictionary. */
+  return ops;
+}
+
+/* Profile_get_clock(): method to get the profiling counter name.
+ */
+static PyObject*
+Profile_get_clock (Profile *self) {
+  /* return the counter name as a string. */
+  return PyUnicode_FromString(factor_profile_clock());
+}
+
+/* Profile_get_types(): method to get the counts of each factor type.
+ */
+static PyObject*
+Profile_get_types (Profile *self) {
+  /* create the dictionary. */
+  PyObject *types = PyDict_New();
+  if (!types)
+    return NULL;
+
+  /* add the counts of each type. */
+  for (size_t t = 0; t < self->ntypes; t++) {
+    PyObject *ops = Profile_build_ops(self->tcounts + t);
+    if (!ops ||
+        PyDict_SetItemString(types, self->types[t]->tp_name, ops) < 0) {
+      Py_XDECREF(ops);
+      Py_DECREF(types);
+      return NULL;
+    }
+
+    Py_DECREF(ops);
+  }
+
+  /* return the dictionary. */
+  return types;
+}
+
+/* Profile_get_factors(): method to get the counts of each factor.
+ */
+static PyObject*
+Profile_get_factors (Profile *self) {
+  /* create the list. */
+  PyObject *factors = PyList_New(self->nfactors);
+  if (!factors)
+    return NULL;
+
+  /* add the counts of each factor. */
+  for (size_t i = 0; i < self->nfactors; i++) {
+    PyObject *f = (self->factors[i] ? (PyObject*) self->factors[i]
+                                     : Py_None);
+
+    PyObject *item = Py_BuildValue("{s:O,s:s,s:N}",
+      "factor", f,
+      "type", self->names[i],
+      "ops", Profile_build_ops(self->fcounts + i));
+
+    if (!item) {
+      Py_DECREF(factors);
+      return NULL;
+    }
+
+    PyList_SET_ITEM(factors, i, item);
+  }
+
+  /* return the list. */
+  return factors;
+}
+
+/* --- */
+
+/* Profile_method_enter(): begin a profiling session.
+ */
+static PyObject*
+Profile_method_enter (Profile *self, PyObject *args) {
+  /* check that no other session is active. */
+  if (!factor_profile_enable()) {
+    PyErr_SetString(PyExc_RuntimeError, "profiling is already active");
+    return NULL;
+  }
+
+  /* discard any previously collected counts. */
+  Profile_clear(self);
+  self->active = 1;
+
+  /* return a new reference to the profile. */
+  Py_INCREF(self);
+  return (PyObject*) self;
+}
+
+/* Profile_method_exit(): end a profiling session.
+ */
+static PyObject*
+Profile_method_exit (Profile *self, PyObject *args) {
+  /* end the session, if it is active. */
+  if (self->active) {
+    factor_profile_disable();
+    self->active = 0;
+
+    /* collect the counts of the session. */
+    if (!Profile_collect(self)) {
+      Profile_clear(self);
+      return PyErr_NoMemory();
+    }
+  }
+
+  /* do not suppress exceptions. */
+  Py_RETURN_FALSE;
+}
+
+/* --- */
+
+/* Profile_new(): allocation method for profiles.
+ */
+static PyObject*
+Profile_new (PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+  /* allocate a new profile with no counts. */
+  Profile *self = (Profile*) type->tp_alloc(type, 0);
+  if (!self)
+    return NULL;
+
+  /* return the new object. */
+  return (PyObject*) self;
+}
+
+/* Profile_dealloc(): deallocation method for profiles.
+ */
+static void
+Profile_dealloc (Profile *self) {
+  /* end any active session. */
+  if (self->active)
+    factor_profile_disable();
+
+  /* release the counts and the object memory. */
+  Profile_clear(self);
+  Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/* Profile_str(): string conversion function for profiles, which
+ * tabulates the counts of each function of each factor type in
+ * order of decreasing cycles.
+ */
+static PyObject*
+Profile_str (Profile *self) {
+  /* collect the rows of the table. */
+  const size_t nmax = self->ntypes * FACTOR_OPS;
+  size_t *rows = malloc((nmax + 1) * sizeof(size_t));
+  if (!rows)
+    return PyErr_NoMemory();
+
+  size_t n = 0;
+  for (size_t r = 0; r < nmax; r++) {
+    if (self->tcounts[r / FACTOR_OPS].calls[r % FACTOR_OPS])
+      rows[n++] = r;
+  }
+
+  /* sort the rows by decreasing cycles. */
+  for (size_t a = 1; a < n; a++) {
+    const size_t r = rows[a];
+    const uint64_t cr = self->tcounts[r / FACTOR_OPS].cycles[r % FACTOR_OPS];
+
+    size_t b = a;
+    for (; b > 0; b--) {
+      const size_t s = rows[b - 1];
+      if (self->tcounts[s / FACTOR_OPS].cycles[s % FACTOR_OPS] >= cr)
+        break;
+
+      rows[b] = s;
+    }
+
+    rows[b] = r;
+  }
+
+  /* allocate the table text. */
+  const size_t width = 128;
+  char *str = malloc((n + 1) * width);
+  if (!str) {
+    free(rows);
+    return PyErr_NoMemory();
+  }
+
+  /* write the header and each row. */
+  size_t len = snprintf(str, width, "%-28s %-10s %14s %18s %14s\n",
+                        "type", "function", "calls",
+                        factor_profile_clock(), "per call");
+
+  for (size_t i = 0; i < n; i++) {
+    const size_t t = rows[i] / FACTOR_OPS;
+    const FactorOp op = rows[i] % FACTOR_OPS;
+    const uint64_t calls = self->tcounts[t].calls[op];
+    const uint64_t cycles = self->tcounts[t].cycles[op];
+
+    len += snprintf(str + len, width, "%-28.28s %-10.10s %14llu %18llu %14.1f\n",
+                    self->types[t]->tp_name, factor_profile_op_name(op),
+                    (unsigned long long) calls,
+                    (unsigned long long) cycles,
+                    (double) cycles / (double) calls);
+  }
+
+  /* build and return the string. */
+  PyObject *obj = PyUnicode_FromStringAndSize(str, len);
+  free(rows);
+  free(str);
+  return obj;
+}
+
+/* Profile_getset: property definition structure for profiles.
+ */
+static PyGetSetDef Profile_getset[] = {
+  { "clock",
+    (getter) Profile_get_clock,
+    NULL,
+    Profile_getset_clock_doc,
+    NULL
+  },
+  { "types",
+    (getter) Profile_get_types,
+    NULL,
+    Profile_getset_types_doc,
+    NULL
+  },
+  { "factors",
+    (getter) Profile_get_factors,
+    NULL,
+    Profile_getset_factors_doc,
+    NULL
+  },
+  { NULL }
+};
+
+/* Profile_methods: method definition structure for profiles.
+ */
+static PyMethodDef Profile_methods[] = {
+  { "__enter__",
+    (PyCFunction) Profile_method_enter,
+    METH_NOARGS,
+    Profile_method_enter_doc
+  },
+  { "__exit__",
+    (PyCFunction) Profile_method_exit,
+    METH_VARARGS,
+    Profile_method_exit_doc
+  },
+  { NULL }
+};
+
+/* Profile_Type: type definition structure for profiles.
+ */
+PyTypeObject Profile_Type = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "vfl.Profile",                                 /* tp_name           */
+  sizeof(Profile),                               /* tp_basicsize      */
+  0,                                             /* tp_itemsize       */
+  (destructor) Profile_dealloc,                  /* tp_dealloc        */
+  0,                                             /* tp_print          */
+  0,                                             /* tp_getattr        */
+  0,                                             /* tp_setattr        */
+  0,                                             /* tp_reserved       */
+  0,                                             /* tp_repr           */
+  0,                                             /* tp_as_number      */
+  0,                                             /* tp_as_sequence    */
+  0,                                             /* tp_as_mapping     */
+  0,                                             /* tp_hash           */
+  0,                                             /* tp_call           */
+  (reprfunc) Profile_str,                        /* tp_str            */
+  0,                                             /* tp_getattro       */
+  0,                                             /* tp_setattro       */
+  0,                                             /* tp_as_buffer      */
+  Py_TPFLAGS_DEFAULT,                            /* tp_flags          */
+  Profile_doc,                                   /* tp_doc            */
+  0,                                             /* tp_traverse       */
+  0,                                             /* tp_clear          */
+  0,                                             /* tp_richcompare    */
+  0,                                             /* tp_weaklistoffset */
+  0,                                             /* tp_iter           */
+  0,                                             /* tp_iternext       */
+  Profile_methods,                               /* tp_methods        */
+  0,                                             /* tp_members        */
+  Profile_getset,                                /* tp_getset         */
+  0,                                             /* tp_base           */
+  0,                                             /* tp_dict           */
+  0,                                             /* tp_descr_get      */
+  0,                                             /* tp_descr_set      */
+  0,                                             /* tp_dictoffset     */
+  0,                                             /* tp_init           */
+  0,                                             /* tp_alloc          */
+  Profile_new                                    /* tp_new            */
+};
+
+/* Profile_Type_init(): type initialization function for profiles.
+ */
+int
+Profile_Type_init (PyObject *mod) {
+  /* finalize the type object. */
+  if (PyType_Ready(&Profile_Type) < 0)
+    return -1;
+
+  /* take a reference to the type and add it to the module. */
+  Py_INCREF(&Profile_Type);
+  PyModule_AddObject(mod, "Profile", (PyObject*) &Profile_Type);
+
+  /* return success. */
+  return 0;
+}
+
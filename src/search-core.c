@@ -127,10 +127,44 @@
 "  var[gid] = sum;"                                                 "\n" \
 "}\n"
 
+/* * * * private function declarations: * * * */
+
+/* search-device.c: */
+#ifdef __VFL_USE_OPENCL
+int search_device (Search *S);
+int search_program (Search *S);
+#endif
+
+/* search-factor.c: */
+int search_factor (Search *S);
+
 /* * * * private function definitions: * * * */
 
+/* free_program(): free the compute program and kernel of a search
+ * structure, leaving its context and command queue intact.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ */
+static void free_program (Search *S) {
+#ifdef __VFL_USE_OPENCL
+  /* release the kernel and program. */
+  if (S->kern) clReleaseKernel(S->kern);
+  if (S->prog) clReleaseProgram(S->prog);
+
+  /* reset the opencl variables. */
+  S->prog = NULL;
+  S->kern = NULL;
+
+  /* free the kernel source code string. */
+  free(S->src);
+  S->src = NULL;
+#endif
+}
+
 /* set_kernel(): initialize the compute device kernel information
- * used by a search structure.
+ * used by a search structure. the compute context is created once,
+ * and the program is only rebuilt when its source code changes.
  *
  * arguments:
  *  @S: search structure pointer.
@@ -147,50 +181,36 @@ static int set_kernel (Search *S) {
 
   /* allocate memory for the complete program code. */
   const unsigned int len = strlen(SEARCH_FORMAT) + strlen(ksrc) + 8;
-  S->src = malloc(len);
-  if (!S->src) {
+  char *src = malloc(len);
+  if (!src) {
     free(ksrc);
     return 0;
   }
 
   /* write the complete program code and free the model kernel code. */
-  sprintf(S->src, SEARCH_FORMAT, ksrc);
+  sprintf(src, SEARCH_FORMAT, ksrc);
   free(ksrc);
 
-  /* get the first available compute platform. */
-  int ret = clGetPlatformIDs(1, &S->plat, NULL);
-  if (ret != CL_SUCCESS)
-    return 0;
-
-  /* connect to the first available compute device. */
-  ret = clGetDeviceIDs(S->plat, CL_DEVICE_TYPE_GPU, 1, &S->dev, NULL);
-  if (ret != CL_SUCCESS)
-    return 0;
-
-  /* create a compute context. */
-  S->ctx = clCreateContext(NULL, 1, &S->dev, NULL, NULL, &ret);
-  if (!S->ctx)
-    return 0;
-
-  /* create a command queue. */
-  S->queue = clCreateCommandQueue(S->ctx, S->dev, 0, &ret);
-  if (!S->queue)
-    return 0;
+  /* keep the current kernel if the program code is unchanged. */
+  if (S->kern && S->src && !strcmp(S->src, src)) {
+    free(src);
+    return 1;
+  }
 
-  /* create the compute program. */
-  S->prog = clCreateProgramWithSource(S->ctx, 1, (const char**) &S->src,
-                                      NULL, &ret);
+  /* release the current kernel and store the new program code. */
+  free_program(S);
+  S->src = src;
 
-  /* check for program creation failure. */
-  if (!S->prog)
+  /* open the compute device, if necessary. */
+  if (!search_device(S))
     return 0;
 
-  /* build the program executable. */
-  ret = clBuildProgram(S->prog, 0, NULL, NULL, NULL, NULL);
-  if (ret != CL_SUCCESS)
+  /* create and build the compute program. */
+  if (!search_program(S))
     return 0;
 
   /* create the compute kernel. */
+  int ret;
   S->kern = clCreateKernel(S->prog, "vfl_variance", &ret);
   if (!S->kern || ret != CL_SUCCESS)
     return 0;
@@ -200,7 +220,7 @@ static int set_kernel (Search *S) {
                                  sizeof(size_t), &S->wgsize, NULL);
 
   /* check for query failure. */
-  if (ret != CL_SUCCESS)
+  if (ret != CL_SUCCESS || S->wgsize == 0)
     return 0;
 #endif
 
@@ -248,22 +268,17 @@ static int set_arguments (Search *S) {
  *  @S: search structure pointer.
  */
 void free_kernel (Search *S) {
+  /* release the program and kernel. */
+  free_program(S);
+
 #ifdef __VFL_USE_OPENCL
-  /* release the opencl variables. */
-  clReleaseProgram(S->prog);
-  clReleaseKernel(S->kern);
-  clReleaseCommandQueue(S->queue);
-  clReleaseContext(S->ctx);
+  /* release the command queue and context. */
+  if (S->queue) clReleaseCommandQueue(S->queue);
+  if (S->ctx) clReleaseContext(S->ctx);
 
   /* reset the opencl variables. */
-  S->prog = NULL;
-  S->kern = NULL;
   S->queue = NULL;
   S->ctx = NULL;
-
-  /* free the kernel source code string. */
-  free(S->src);
-  S->src = NULL;
 #endif
 }
 
@@ -274,10 +289,6 @@ void free_kernel (Search *S) {
  *  @S: search structure pointer.
  */
 void free_buffers (Search *S) {
-  /* free the dense covariance matrix. */
-  matrix_free(S->cov);
-  S->cov = NULL;
-
 #ifdef __VFL_USE_OPENCL
   /* free the host-side calculation variables. */
   free(S->par);
@@ -300,9 +311,9 @@ void free_buffers (Search *S) {
   S->dev_xdat = S->dev_pdat = S->dev_C = NULL;
   S->dev_cblk = NULL;
 #else
-  /* free the kernel vector. */
-  vector_free(S->cs);
-  S->cs = NULL;
+  /* free the host-side calculation variables. */
+  free(S->var);
+  S->var = S->xgrid = S->xmax = NULL;
 #endif
 }
 
@@ -334,14 +345,14 @@ static int refresh_buffers (Search *S) {
 
 #ifdef __VFL_USE_OPENCL
   /* check for any differences. */
-  if (S->D != D || S->P != P || S->N != N || S->n != n) {
+  if (S->D != D || S->P != P || S->N != N || S->n != n || !S->par) {
     /* free the buffers. */
     free_buffers(S);
 
     /* determine the sizes of the buffers. */
     S->sz_par   = sizeof(cl_double) * P;
     S->sz_var   = sizeof(cl_double) * N;
-    S->sz_xgrid = sizeof(cl_double) * N;
+    S->sz_xgrid = sizeof(cl_double) * N * D;
     S->sz_xmax  = sizeof(cl_double) * D;
     S->sz_xdat  = sizeof(cl_double) * D * n;
     S->sz_cblk  = sizeof(cl_double) * N * n;
@@ -353,11 +364,6 @@ static int refresh_buffers (Search *S) {
                        + S->sz_xmax + S->sz_xdat + S->sz_pdat
                        + S->sz_C;
 
-    /* allocate the dense covariance matrix. */
-    S->cov = matrix_alloc(n, n);
-    if (!S->cov)
-      return 0;
-
     /* allocate the host-side memory block. */
     char *ptr = malloc(bytes);
     if (!ptr)
@@ -425,29 +431,33 @@ static int refresh_buffers (Search *S) {
     /* store the new sizes. */
     S->D = D;
     S->P = P;
-    S->G = G;
     S->N = N;
     S->n = n;
   }
 #else
   /* check for any differences. */
-  if (S->n != n) {
+  if (S->n != n || S->N != N || !S->var) {
     /* free the buffers. */
     free_buffers(S);
 
-    /* allocate the dense covariance matrix and kernel vector. */
-    S->cov = matrix_alloc(n, n);
-    S->cs = vector_alloc(n);
-    if (!S->cov || !S->cs)
+    /* allocate the host-side memory block. */
+    S->var = malloc((N + N * S->D + S->D) * sizeof(double));
+    if (!S->var)
       return 0;
 
+    /* initialize xgrid and xmax. */
+    S->xgrid = S->var + N;
+    S->xmax = S->xgrid + N * S->D;
+
     /* store the new sizes. */
-    S->G = G;
     S->N = N;
     S->n = n;
   }
 #endif
 
+  /* store the total grid size. */
+  S->G = G;
+
   /* return success. */
   return 1;
 }
@@ -462,80 +472,37 @@ static int refresh_buffers (Search *S) {
  *  integer indicating success (1) or failure (0).
  */
 static int fill_buffers (Search *S) {
-#ifdef __VFL_USE_OPENCL
-  /* store the current noise precision and weight ratio. */
-  S->par[0] = 1.0 / (S->mdl->nu * S->mdl->tau);
-
-  /* store the current factor parameters. */
-  for (size_t j = 0, p0 = 1; j < S->mdl->M; j++) {
-    /* get the current factor parameter vector. */
-    const Vector *par = S->mdl->factors[j]->par;
-
-    /* copy the vector elements into the local array. */
-    for (size_t p = 0; p < par->len; p++)
-      S->par[p0 + p] = vector_get(par, p);
+  /* bring the cholesky factor of the covariance matrix up to date. */
+  if (!search_factor(S))
+    return 0;
 
-    /* increment the array offset. */
-    p0 += par->len;
-  }
-#endif
+#ifdef __VFL_USE_OPENCL
+  /* store the current noise precision and weight ratio, and the
+   * current factor parameters, as prepared for the model kernel.
+   */
+  memcpy(S->par, S->jit.par, S->P * sizeof(cl_double));
 
-  /* compute the covariance matrix elements. */
+  /* store the data array values, in factor order. */
   for (size_t i = 0; i < S->n; i++) {
-    /* get the row-wise observation. */
-    Datum *di = data_get(S->dat, i);
-
-#ifdef __VFL_USE_OPENCL
-    /* while we're here, store the data array values. */
-    S->pdat[i] = di->p;
+    S->pdat[i] = S->pc[i];
     for (size_t d = 0; d < S->D; d++)
-      S->xdat[i * S->D + d] = vector_get(di->x, d);
-#endif
-
-    /* loop over the elements of each row. */
-    for (size_t j = 0; j <= i; j++) {
-      /* get the column-wise observation. */
-      Datum *dj = data_get(S->dat, j);
-
-      /* compute the covariance matrix element. */
-      const double cij = model_cov(S->mdl, di->x, dj->x, di->p, dj->p);
-
-      /* store the computed matrix element. */
-      matrix_set(S->cov, i, j, cij);
-      if (i != j)
-        matrix_set(S->cov, j, i, cij);
-    }
+      S->xdat[i * S->D + d] = S->xc[i * S->D + d];
   }
 
-  /* compute the current model->data fit error estimate. */
-  VectorView z = vector_subvector(S->mdl->tmp, 0, S->mdl->K);
-  blas_dtrmv(BLAS_TRANS, S->mdl->L, S->mdl->wbar, &z);
-  const double wSw = blas_ddot(&z, &z);
-  const double yy = data_inner(S->dat);
-  const double alpha = S->mdl->alpha0 + (double) S->mdl->dat->N;
-  const double beta = S->mdl->beta0 + (yy - wSw);
-  const double tauinv = beta / alpha;
-
-  /* add the noise estimate as jitter to the variances. */
-  z = matrix_diag(S->cov);
-  vector_add_const(&z, tauinv);
-
-  /* compute the cholesky decomposition of the covariance matrix. */
-  if (!chol_decomp(S->cov) || !chol_invert(S->cov, S->cov)) {
-    /* output a warning message. */
-    fprintf(stderr, "cov (%zux%zu) is singular!\n",
-            S->cov->rows, S->cov->cols);
-    fflush(stderr);
-
-    /* return failure. */
+  /* the opencl kernel requires the inverse covariance matrix. */
+  Matrix *C = matrix_alloc(S->n, S->n);
+  if (!C || !chol_invert(S->cov, C)) {
+    matrix_free(C);
     return 0;
   }
 
-#ifdef __VFL_USE_OPENCL
   /* pack the inverted matrix into the host-side array. */
   for (size_t i = 0, cidx = 0; i < S->n; i++)
     for (size_t j = 0; j <= i; j++, cidx++)
-      S->C[cidx] = matrix_get(S->cov, i, j);
+      S->C[cidx] = matrix_get(C, i, j);
+
+  /* free the inverted matrix. */
+  matrix_free(C);
 #endif
 
   /* return success. */
@@ -627,21 +594,133 @@ static int read_buffers (Search *S) {
 #endif
 }
 
+/* SEARCH_BLOCK: number of grid points whose kernel vectors are solved
+ * against the cholesky factor together by the cpu variance kernel.
+ * the innermost loops of the kernel run over a full block, so they
+ * are vectorized by the compiler.
+ */
+#define SEARCH_BLOCK 16
+
+/* search_task: structure for holding the shared argument of parallel
+ * variance computations on the cpu.
+ */
+typedef struct {
+  /* @S: search structure pointer.
+   * @N: number of grid points in the computation.
+   * @ok: per-thread status flags.
+   */
+  Search *S;
+  size_t N;
+  int *ok;
+}
+search_task;
+
+/* search_variance_thread(): compute the posterior predictive variance
+ * at the grid points assigned to a single thread. this is the cpu
+ * equivalent of vfl_variance(), except that the quadratic form of
+ * each kernel vector is computed by a forward substitution against
+ * the cholesky factor of the covariance matrix.
+ *  - see thread_fn() for more information.
+ */
+static void search_variance_thread (void *arg, size_t tid, size_t T) {
+  /* get the task structure and the range of grid points. */
+  search_task *task = (search_task*) arg;
+  const Search *S = task->S;
+  const ModelJit *jit = &S->jit;
+  const Matrix *L = S->cov;
+  const size_t n = S->n, D = S->D, B = SEARCH_BLOCK;
+  size_t i0, i1;
+  thread_range(task->N, tid, T, &i0, &i1);
+
+  /* allocate the kernel vectors of a block of grid points, stored
+   * with the elements of each vector in a column.
+   */
+  double *C = malloc((n ? n : 1) * B * sizeof(double));
+  task->ok[tid] = (C != NULL);
+  if (!C)
+    return;
+
+  /* loop over the blocks of grid points. */
+  for (size_t ib = i0; ib < i1; ib += B) {
+    /* initialize the variances of the block. */
+    const size_t nb = (ib + B < i1 ? B : i1 - ib);
+    double sum[SEARCH_BLOCK];
+    for (size_t b = 0; b < B; b++)
+      sum[b] = 0.0;
+
+    /* sum variances of each output together. */
+    for (size_t ps = 0; ps < S->K; ps++) {
+      /* include the auto-covariance contributions. */
+      for (size_t b = 0; b < nb; b++) {
+        const double *xs = S->xgrid + (ib + b) * D;
+        sum[b] += model_jit_cov(jit, xs, xs, ps, ps);
+      }
+
+      /* compute the kernel vectors, padding unused columns. */
+      for (size_t b = 0; b < B; b++) {
+        if (b < nb) {
+          const double *xs = S->xgrid + (ib + b) * D;
+          model_jit_rows(jit, S->xc, S->pc, xs, ps, n, C + b, B);
+        }
+        else {
+          for (size_t j = 0; j < n; j++)
+            C[j * B + b] = 0.0;
+        }
+      }
+
+      /* solve for the whitened kernel vectors, and subtract their
+       * squared norms from the variances.
+       */
+      for (size_t i = 0; i < n; i++) {
+        /* eliminate the preceding elements. */
+        const double *Li = L->data + i * L->stride;
+        double *ci = C + i * B;
+        for (size_t j = 0; j < i; j++) {
+          const double lij = Li[j];
+          const double *cj = C + j * B;
+          for (size_t b = 0; b < B; b++)
+            ci[b] -= lij * cj[b];
+        }
+
+        /* scale by the diagonal element and accumulate. */
+        const double linv = 1.0 / Li[i];
+        for (size_t b = 0; b < B; b++) {
+          ci[b] *= linv;
+          sum[b] -= ci[b] * ci[b];
+        }
+      }
+    }
+
+    /* store the computed results. */
+    for (size_t b = 0; b < nb; b++)
+      S->var[ib + b] = sum[b];
+  }
+
+  /* free the kernel vectors. */
+  free(C);
+}
+
 /* launch_kernel(): enqueue a set of kernel execution requests
- * to the compute device associated to a search structure.
+ * to the compute device associated to a search structure. without
+ * opencl, the variances are computed by the cpu in parallel.
  *
  * arguments:
  *  @S: search structure pointer.
- *  @Ntask: pointer to the task size.
+ *  @N: number of grid points in the computation.
  *
  * returns:
  *  integer indicating success (1) or failure (0).
  */
-static int launch_kernel (Search *S, size_t *Ntask) {
+static int launch_kernel (Search *S, size_t N) {
 #ifdef __VFL_USE_OPENCL
+  /* determine the total number of work items, which must be
+   * a multiple of the work-group size.
+   */
+  const size_t Ntask = ((N + S->wgsize - 1) / S->wgsize) * S->wgsize;
+
   /* enqueue the kernel. */
   int ret = clEnqueueNDRangeKernel(S->queue, S->kern, 1, NULL,
-                                   Ntask, &S->wgsize,
+                                   &Ntask, &S->wgsize,
                                    0, NULL, NULL);
 
   /* check for queueing failures. */
@@ -650,12 +729,60 @@ static int launch_kernel (Search *S, size_t *Ntask) {
 
   /* block until the kernel has completed. */
   clFinish(S->queue);
+#else
+  /* compute the variances over blocks of grid points in parallel. */
+  const size_t T = thread_plan(N, SEARCH_BLOCK);
+  int ok[T];
+  search_task task = { S, N, ok };
+  thread_execute(search_variance_thread, &task, T);
+
+  /* check the status of each thread. */
+  for (size_t t = 0; t < T; t++) {
+    if (!ok[t])
+      return 0;
+  }
 #endif
 
   /* return success. */
   return 1;
 }
 
+/* weight_variance(): compute the posterior predictive variances at
+ * the grid points of a search from the factor moments and the weight
+ * posterior of its model. this requires O(K^2) operations per grid
+ * point, independent of the number of observations.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ *  @N: number of grid points in the computation.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int weight_variance (Search *S, size_t N) {
+  /* allocate the variances of individual outputs. */
+  double *v = malloc((N ? N : 1) * sizeof(double));
+  if (!v)
+    return 0;
+
+  /* initialize the summed variances. */
+  for (size_t i = 0; i < N; i++)
+    S->var[i] = 0.0;
+
+  /* sum variances of each output together. */
+  MatrixView X = matrix_view_array(S->xgrid, N, S->D);
+  int ok = 1;
+  for (size_t ps = 0; ps < S->K && ok; ps++) {
+    ok = model_predict_array(S->mdl, &X, ps, NULL, v);
+    for (size_t i = 0; i < N && ok; i++)
+      S->var[i] += v[i];
+  }
+
+  /* free the output variances and return the status. */
+  free(v);
+  return ok;
+}
+
 /* * * * function definitions: * * * */
 
 /* search_set_model(): set the model emulated by a search structure.
@@ -674,9 +801,11 @@ int search_set_model (Search *S, Model *mdl) {
 
   /* check if a model is already assigned to the search. */
   if (S->mdl) {
-    /* release all variables tied to the model. */
+    /* release all buffers tied to the model. the compute context
+     * and program are retained, and replaced by set_kernel() only
+     * if the program code changes.
+     */
     free_buffers(S);
-    free_kernel(S);
 
     /* release the reference to the current model. */
     Py_DECREF(S->mdl);
@@ -766,6 +895,26 @@ int search_set_outputs (Search *S, size_t num) {
   return 1;
 }
 
+/* search_set_space(): set the space in which posterior variances
+ * are computed by a search structure.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ *  @space: new variance computation space.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int search_set_space (Search *S, SearchSpace space) {
+  /* check the input arguments. */
+  if (!S || (space != SEARCH_FUNCTION && space != SEARCH_WEIGHT))
+    return 0;
+
+  /* store the new space. */
+  S->space = space;
+  return 1;
+}
+
 /* search_execute(): perform a search procedure to locate the
  * maximum of the posterior predictive variance of a gaussian
  * process.
@@ -799,17 +948,21 @@ int search_execute (Search *S, Vector *x) {
   if (!refresh_buffers(S))
     return 0;
 
-  /* fill the non-grid data buffers on the host side. */
-  if (!fill_buffers(S))
-    return 0;
+  /* in function space, prepare the covariance factor and buffers. */
+  const int fspace = (S->space == SEARCH_FUNCTION);
+  if (fspace) {
+    /* fill the non-grid data buffers on the host side. */
+    if (!fill_buffers(S))
+      return 0;
 
-  /* write all data buffers to the compute device. */
-  if (!write_buffers(S))
-    return 0;
+    /* write all data buffers to the compute device. */
+    if (!write_buffers(S))
+      return 0;
 
-  /* set the kernel arguments. */
-  if (!set_arguments(S))
-    return 0;
+    /* set the kernel arguments. */
+    if (!set_arguments(S))
+      return 0;
+  }
 
   /* allocate the grid iteration variables. */
   if (!grid_iterator_alloc(S->grid, NULL, &idx, &sz, &gx))
@@ -821,6 +974,7 @@ int search_execute (Search *S, Vector *x) {
   dmax.x = &xview;
   dmax.y = 0.0;
   dmax.p = 0;
+  memset(S->xmax, 0, S->D * sizeof(double));
 
   /* loop until no tasks remain. */
   Nrem = S->G;
@@ -830,65 +984,33 @@ int search_execute (Search *S, Vector *x) {
 
     /* fill the required amount of grid array elements. */
     for (size_t i = 0; i < N; i++) {
-#ifdef __VFL_USE_OPENCL
       /* copy the grid point into the array. */
       for (size_t d = 0; d < S->D; d++)
         S->xgrid[i * S->D + d] = vector_get(gx, d);
-#else
-      /* initialize variables for checking for new maxima. */
-      double sum = 0.0;
-      dmax.x = gx;
-
-      /* loop over the outputs. */
-      for (size_t ps = 0; ps < S->K; ps++) {
-        /* include the first term. */
-        sum += model_cov(S->mdl, gx, gx, ps, ps);
-
-        /* compute the kernel vector elements. */
-        Datum *dj = S->dat->data;
-        for (size_t j = 0; j < S->n; j++, dj++)
-          vector_set(S->cs, j, model_cov(S->mdl, dj->x, gx, dj->p, ps));
-
-        /* include the second term. */
-        for (size_t j = 0; j < S->n; j++)
-          for (size_t k = 0; k < S->n; k++)
-            sum -= vector_get(S->cs, j)
-                 * vector_get(S->cs, k)
-                 * matrix_get(S->cov, j, k);
-      }
-
-      /* check if the current variance is larger. */
-      if (sum > dmax.y && !data_find(S->dat, &dmax)) {
-        /* copy the location of the greater variance. */
-        vector_copy(x, gx);
-        dmax.y = sum;
-      }
-#endif
 
       /* move to the next grid point. */
       grid_iterator_next(S->grid, idx, sz, gx);
     }
 
-    /* write the grid to the device. */
-    if (!write_grid(S))
-      return 0;
-
-    /* determine the total number of work items. */
-    size_t Ntask = 1;
-    while (Ntask < N)
-      Ntask *= S->wgsize;
+    /* compute the variances in the requested space. */
+    if (fspace) {
+      /* write the grid to the device. */
+      if (!write_grid(S))
+        return 0;
 
-    /* execute the kernel over the current grid points. */
-    if (!launch_kernel(S, &Ntask))
-      return 0;
+      /* execute the kernel over the current grid points. */
+      if (!launch_kernel(S, N))
+        return 0;
 
-    /* read the results from the device. */
-    if (!read_buffers(S))
+      /* read the results from the device. */
+      if (!read_buffers(S))
+        return 0;
+    }
+    else if (!weight_variance(S, N))
       return 0;
 
-#ifdef __VFL_USE_OPENCL
     /* loop over the array of computed variances. */
-    cl_double *xi = S->xgrid;
+    double *xi = S->xgrid;
     for (size_t i = 0; i < N; i++, xi += S->D) {
       /* initialize the datum to search for existing observations. */
       xview = vector_view_array(xi, S->D);
@@ -896,11 +1018,10 @@ int search_execute (Search *S, Vector *x) {
       /* check if the current variance is larger. */
       if (S->var[i] > dmax.y && !data_find(S->dat, &dmax)) {
         /* copy the location of the larger variance. */
-        memcpy(S->xmax, xi, S->sz_xmax);
+        memcpy(S->xmax, xi, S->D * sizeof(double));
         dmax.y = S->var[i];
       }
     }
-#endif
 
     /* update the remaining task count. */
     Nrem -= N;
@@ -909,11 +1030,9 @@ int search_execute (Search *S, Vector *x) {
   /* free the grid iteration variables. */
   grid_iterator_free(idx, sz, gx);
 
-#ifdef __VFL_USE_OPENCL
   /* store the identified location in the output vector. */
   for (size_t d = 0; d < S->D; d++)
     vector_set(x, d, S->xmax[d]);
-#endif
 
   /* return success. */
   return 1;
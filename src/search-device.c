@@ -0,0 +1,375 @@
+
+/* include the vfl header. */
+#include <vfl/vfl.h>
+
+/* the remainder of this file requires opencl. */
+#ifdef __VFL_USE_OPENCL
+
+/* include headers for cache file management. */
+#include <unistd.h>
+
+/* SEARCH_CACHE_MAGIC: magic string at the start of program cache files.
+ */
+#define SEARCH_CACHE_MAGIC "VFLCLBIN"
+
+/* device_types: compute device types, in order of preference, that
+ * are searched when no device type is requested.
+ */
+static const cl_device_type device_types[] = {
+  CL_DEVICE_TYPE_GPU,
+  CL_DEVICE_TYPE_ACCELERATOR,
+  CL_DEVICE_TYPE_CPU
+};
+
+/* device_type_requested(): determine the compute device type requested
+ * through the VFL_OPENCL_DEVICE environment variable.
+ *
+ * arguments:
+ *  @type: pointer to the output device type.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) a type was requested.
+ */
+static int device_type_requested (cl_device_type *type) {
+  /* check for a device type in the environment. */
+  const char *env = getenv("VFL_OPENCL_DEVICE");
+  if (!env || !*env)
+    return 0;
+
+  /* parse the device type. */
+  if (!strcmp(env, "gpu"))
+    *type = CL_DEVICE_TYPE_GPU;
+  else if (!strcmp(env, "cpu"))
+    *type = CL_DEVICE_TYPE_CPU;
+  else if (!strcmp(env, "accelerator"))
+    *type = CL_DEVICE_TYPE_ACCELERATOR;
+  else
+    *type = CL_DEVICE_TYPE_ALL;
+
+  /* return success. */
+  return 1;
+}
+
+/* device_has_fp64(): check whether a compute device supports
+ * double-precision arithmetic, which the search kernel requires.
+ *
+ * arguments:
+ *  @dev: compute device identifier.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) doubles are supported.
+ */
+static int device_has_fp64 (cl_device_id dev) {
+  /* query the double-precision capabilities of the device. */
+  cl_device_fp_config cfg = 0;
+  if (clGetDeviceInfo(dev, CL_DEVICE_DOUBLE_FP_CONFIG,
+                      sizeof(cl_device_fp_config), &cfg, NULL)
+      != CL_SUCCESS)
+    return 0;
+
+  /* return the result. */
+  return (cfg != 0);
+}
+
+/* device_find(): find the first compute device of a given type
+ * that supports double-precision arithmetic on any platform.
+ *
+ * arguments:
+ *  @type: compute device type to search for.
+ *  @plat: pointer to the output platform identifier.
+ *  @dev: pointer to the output device identifier.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) a device was found.
+ */
+static int device_find (cl_device_type type,
+                        cl_platform_id *plat,
+                        cl_device_id *dev) {
+  /* get the available compute platforms. */
+  cl_platform_id plats[16];
+  cl_uint nplat = 0;
+  if (clGetPlatformIDs(16, plats, &nplat) != CL_SUCCESS)
+    return 0;
+
+  /* bound the platform count. */
+  if (nplat > 16)
+    nplat = 16;
+
+  /* loop over the platforms. */
+  for (cl_uint i = 0; i < nplat; i++) {
+    /* get the devices of the requested type. */
+    cl_device_id devs[16];
+    cl_uint ndev = 0;
+    if (clGetDeviceIDs(plats[i], type, 16, devs, &ndev) != CL_SUCCESS)
+      continue;
+
+    /* bound the device count. */
+    if (ndev > 16)
+      ndev = 16;
+
+    /* return the first suitable device. */
+    for (cl_uint j = 0; j < ndev; j++) {
+      if (device_has_fp64(devs[j])) {
+        *plat = plats[i];
+        *dev = devs[j];
+        return 1;
+      }
+    }
+  }
+
+  /* no device was found. */
+  return 0;
+}
+
+/* search_device(): open the compute device, context and command queue
+ * of a search structure. these are retained across changes of the
+ * search model, so this function does nothing if the search structure
+ * already holds a context.
+ *
+ * by default, gpu devices are preferred over accelerators, which are
+ * preferred over cpu devices. the VFL_OPENCL_DEVICE environment
+ * variable ('gpu', 'cpu', 'accelerator' or 'all') overrides this.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int search_device (Search *S) {
+  /* return if a context already exists. */
+  if (S->ctx && S->queue)
+    return 1;
+
+  /* find a suitable device of the requested type, or of the
+   * most preferred available type.
+   */
+  cl_device_type type;
+  int found = 0;
+  if (device_type_requested(&type)) {
+    found = device_find(type, &S->plat, &S->dev);
+  }
+  else {
+    const size_t ntypes = sizeof(device_types) / sizeof(cl_device_type);
+    for (size_t i = 0; i < ntypes && !found; i++)
+      found = device_find(device_types[i], &S->plat, &S->dev);
+  }
+
+  /* check that a device was found. */
+  if (!found)
+    return 0;
+
+  /* create a compute context. */
+  int ret;
+  S->ctx = clCreateContext(NULL, 1, &S->dev, NULL, NULL, &ret);
+  if (!S->ctx)
+    return 0;
+
+  /* create a command queue. */
+  S->queue = clCreateCommandQueue(S->ctx, S->dev, 0, &ret);
+  if (!S->queue)
+    return 0;
+
+  /* return success. */
+  return 1;
+}
+
+/* cache_path(): build the name of the cache file of the program held
+ * by a search structure. the name is derived from the program source
+ * and the identity of the compute device and its driver.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ *  @path: output string of at least CACHE_PATH characters.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the cache is available.
+ */
+static int cache_path (const Search *S, char *path) {
+  /* get the cache directory. */
+  char dir[CACHE_PATH];
+  if (!cache_dir(dir))
+    return 0;
+
+  /* hash the program source. */
+  uint64_t h = cache_hash(CACHE_HASH_INIT, S->src);
+
+  /* hash the device and driver identification strings. */
+  const cl_device_info info[] = {
+    CL_DEVICE_NAME, CL_DEVICE_VERSION, CL_DRIVER_VERSION
+  };
+  for (size_t i = 0; i < sizeof(info) / sizeof(cl_device_info); i++) {
+    char str[256];
+    if (clGetDeviceInfo(S->dev, info[i], sizeof(str), str, NULL)
+        != CL_SUCCESS)
+      return 0;
+
+    str[sizeof(str) - 1] = '\0';
+    h = cache_hash(h, str);
+  }
+
+  /* build the file name. */
+  const int len = snprintf(path, CACHE_PATH, "%s/%016llx.clbin",
+                           dir, (unsigned long long) h);
+
+  /* return whether the name fit. */
+  return (len > 0 && len < CACHE_PATH);
+}
+
+/* cache_load(): create a program from a cached binary. the source
+ * stored in the cache file must match the program source exactly.
+ *
+ * cache files hold the magic string, the source and binary sizes
+ * as 64-bit integers, the source, and finally the binary.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ *  @path: cache file name.
+ *
+ * returns:
+ *  program created from the cached binary, or null on failure.
+ */
+static cl_program cache_load (const Search *S, const char *path) {
+  /* open the cache file. */
+  FILE *fh = fopen(path, "rb");
+  if (!fh)
+    return NULL;
+
+  /* read the header. */
+  char magic[8];
+  uint64_t sz[2];
+  if (fread(magic, 1, 8, fh) != 8 ||
+      memcmp(magic, SEARCH_CACHE_MAGIC, 8) ||
+      fread(sz, sizeof(uint64_t), 2, fh) != 2 ||
+      sz[0] != strlen(S->src) || sz[1] == 0) {
+    fclose(fh);
+    return NULL;
+  }
+
+  /* read the source and binary. */
+  const size_t len = sz[1];
+  char *buf = malloc(sz[0] + len);
+  if (!buf || fread(buf, 1, sz[0] + len, fh) != sz[0] + len ||
+      memcmp(buf, S->src, sz[0])) {
+    free(buf);
+    fclose(fh);
+    return NULL;
+  }
+
+  /* close the cache file. */
+  fclose(fh);
+
+  /* create the program from the binary. */
+  const unsigned char *bin = (const unsigned char*) buf + sz[0];
+  cl_int status, ret;
+  cl_program prog = clCreateProgramWithBinary(S->ctx, 1, &S->dev, &len,
+                                              &bin, &status, &ret);
+  free(buf);
+
+  /* check for creation failures. */
+  if (!prog)
+    return NULL;
+
+  /* build the program executable. */
+  if (ret != CL_SUCCESS || status != CL_SUCCESS ||
+      clBuildProgram(prog, 1, &S->dev, NULL, NULL, NULL) != CL_SUCCESS) {
+    clReleaseProgram(prog);
+    return NULL;
+  }
+
+  /* return the program. */
+  return prog;
+}
+
+/* cache_store(): write the binary of a built program into the cache.
+ * the file is written under a temporary name and then renamed, so
+ * that concurrent searches never read partially written files.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ *  @path: cache file name.
+ */
+static void cache_store (const Search *S, const char *path) {
+  /* get the size of the program binary. */
+  size_t len = 0;
+  if (clGetProgramInfo(S->prog, CL_PROGRAM_BINARY_SIZES,
+                       sizeof(size_t), &len, NULL) != CL_SUCCESS ||
+      len == 0)
+    return;
+
+  /* get the program binary. */
+  unsigned char *bin = malloc(len);
+  if (!bin || clGetProgramInfo(S->prog, CL_PROGRAM_BINARIES,
+                               sizeof(unsigned char*), &bin, NULL)
+              != CL_SUCCESS) {
+    free(bin);
+    return;
+  }
+
+  /* build the temporary file name. */
+  char tmp[CACHE_PATH + 32];
+  snprintf(tmp, sizeof(tmp), "%s.%ld", path, (long) getpid());
+
+  /* write the cache file. */
+  const uint64_t sz[2] = { strlen(S->src), len };
+  FILE *fh = fopen(tmp, "wb");
+  int ok = (fh != NULL);
+  ok = ok && fwrite(SEARCH_CACHE_MAGIC, 1, 8, fh) == 8;
+  ok = ok && fwrite(sz, sizeof(uint64_t), 2, fh) == 2;
+  ok = ok && fwrite(S->src, 1, sz[0], fh) == sz[0];
+  ok = ok && fwrite(bin, 1, len, fh) == len;
+  if (fh && fclose(fh))
+    ok = 0;
+
+  /* move the file into place, or remove it. */
+  if (!ok || rename(tmp, path))
+    remove(tmp);
+
+  /* free the program binary. */
+  free(bin);
+}
+
+/* search_program(): create and build the compute program of a search
+ * structure from its source code string, using a cached binary of the
+ * program if one is available.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int search_program (Search *S) {
+  /* attempt to load the program from the cache. */
+  char path[CACHE_PATH];
+  const int cached = cache_path(S, path);
+  if (cached) {
+    S->prog = cache_load(S, path);
+    if (S->prog)
+      return 1;
+  }
+
+  /* create the compute program from source. */
+  int ret;
+  S->prog = clCreateProgramWithSource(S->ctx, 1, (const char**) &S->src,
+                                      NULL, &ret);
+
+  /* check for program creation failure. */
+  if (!S->prog)
+    return 0;
+
+  /* build the program executable. */
+  ret = clBuildProgram(S->prog, 1, &S->dev, NULL, NULL, NULL);
+  if (ret != CL_SUCCESS)
+    return 0;
+
+  /* store the program binary into the cache. */
+  if (cached)
+    cache_store(S, path);
+
+  /* return success. */
+  return 1;
+}
+
+#endif /* __VFL_USE_OPENCL */
+
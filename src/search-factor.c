@@ -0,0 +1,315 @@
+
+/* include the vfl header. */
+#include <vfl/vfl.h>
+
+/* free_factor(): free the cached covariance factor of a search.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ */
+void free_factor (Search *S) {
+  /* free the cache arrays. */
+  matrix_free(S->cov);
+  free(S->xc);
+  free(S->pc);
+  free(S->key);
+
+  /* reset the cache. */
+  S->cov = NULL;
+  S->xc = NULL;
+  S->pc = NULL;
+  S->key = NULL;
+  S->nkey = 0;
+  S->nc = 0;
+  S->cap = 0;
+}
+
+/* factor_key(): build the array of model state that determines the
+ * covariance matrix of a search: the input dimensionality, the model
+ * precisions and the version of each factor. the versions of product
+ * factors follow the parameters of their members.
+ *
+ * arguments:
+ *  @mdl: model structure pointer.
+ *  @len: pointer to the output array length.
+ *
+ * returns:
+ *  newly allocated model state array, or null on failure.
+ */
+static double *factor_key (const Model *mdl, size_t *len) {
+  /* allocate the array. */
+  const size_t n = 3 + mdl->M;
+  double *key = malloc(n * sizeof(double));
+  if (!key)
+    return NULL;
+
+  /* store the dimensionality and precisions. */
+  size_t i = 0;
+  key[i++] = (double) mdl->D;
+  key[i++] = mdl->nu;
+  key[i++] = mdl->tau;
+
+  /* store the factor versions. */
+  for (size_t j = 0; j < mdl->M; j++)
+    key[i++] = (double) factor_version(mdl->factors[j]);
+
+  /* return the array. */
+  *len = i;
+  return key;
+}
+
+/* factor_jitter(): compute the noise variance that is added to the
+ * diagonal of the covariance matrix of a search. the estimate is held
+ * until the factor is next rebuilt.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ *
+ * returns:
+ *  estimated noise variance.
+ */
+static double factor_jitter (const Search *S) {
+  /* compute the current model->data fit error estimate. */
+  VectorView z = vector_subvector(S->mdl->tmp, 0, S->mdl->K);
+  blas_dtrmv(BLAS_TRANS, S->mdl->L, S->mdl->wbar, &z);
+  const double wSw = blas_ddot(&z, &z);
+  const double yy = data_inner(S->dat);
+  const double alpha = S->mdl->alpha0 + (double) S->mdl->dat->N;
+  const double beta = S->mdl->beta0 + (yy - wSw);
+
+  /* return the noise estimate. */
+  return beta / alpha;
+}
+
+/* factor_reserve(): ensure that the factor cache of a search has
+ * capacity for a given number of observations.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ *  @n: required number of observations.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int factor_reserve (Search *S, size_t n) {
+  /* return if the capacity is sufficient. */
+  if (S->cov && n <= S->cap)
+    return 1;
+
+  /* grow the capacity geometrically. */
+  const size_t D = S->mdl->D;
+  size_t cap = 2 * S->cap;
+  if (cap < n)
+    cap = n;
+
+  /* allocate new factor and observation arrays. */
+  Matrix *L = matrix_alloc(cap, cap);
+  double *xc = malloc((cap ? cap : 1) * (D ? D : 1) * sizeof(double));
+  size_t *pc = malloc((cap ? cap : 1) * sizeof(size_t));
+  if (!L || !xc || !pc) {
+    matrix_free(L);
+    free(xc);
+    free(pc);
+    return 0;
+  }
+
+  /* copy the current factor and observations into the new arrays. */
+  for (size_t i = 0; i < S->nc; i++) {
+    memcpy(L->data + i * L->stride, S->cov->data + i * S->cov->stride,
+           S->nc * sizeof(double));
+    memcpy(xc + i * D, S->xc + i * D, D * sizeof(double));
+    pc[i] = S->pc[i];
+  }
+
+  /* replace the arrays. */
+  matrix_free(S->cov);
+  free(S->xc);
+  free(S->pc);
+  S->cov = L;
+  S->xc = xc;
+  S->pc = pc;
+  S->cap = cap;
+
+  /* store the current size of the factor. */
+  S->cov->rows = S->cov->cols = S->nc;
+
+  /* return success. */
+  return 1;
+}
+
+/* factor_append(): append an observation to the factor cache of
+ * a search, by extending the cholesky factor of the covariance
+ * matrix with one row. this requires O(n^2) operations. as with
+ * chol_decomp(), the transpose of the factor is kept in the upper
+ * triangle.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ *  @i: dataset index of the new observation.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int factor_append (Search *S, size_t i) {
+  /* get the new observation and the factor size. */
+  VectorView xz = data_x(S->dat, i);
+  const size_t pz = S->dat->p[i];
+  const size_t D = S->mdl->D;
+  const size_t n = S->nc;
+
+  /* get the new factor row. */
+  Matrix *L = S->cov;
+  double *lz = L->data + n * L->stride;
+
+  /* compute the covariances with the cached observations. */
+  model_jit_rows(&S->jit, S->xc, S->pc, xz.data, pz, n, lz, 1);
+
+  /* solve for the new row by forward substitution. */
+  double sum = 0.0;
+  for (size_t j = 0; j < n; j++) {
+    const double *lj = L->data + j * L->stride;
+    double lzj = lz[j];
+    for (size_t k = 0; k < j; k++)
+      lzj -= lj[k] * lz[k];
+
+    lz[j] = lzj / lj[j];
+    sum += lz[j] * lz[j];
+  }
+
+  /* compute the new diagonal element. */
+  const double dz = model_jit_cov(&S->jit, xz.data, xz.data, pz, pz)
+                  + S->jitter - sum;
+  if (!(dz > 0.0))
+    return 0;
+
+  /* store the diagonal element and the transposed row. */
+  lz[n] = sqrt(dz);
+  for (size_t j = 0; j < n; j++)
+    L->data[j * L->stride + n] = lz[j];
+
+  /* store the new observation. */
+  memcpy(S->xc + n * D, xz.data, D * sizeof(double));
+  S->pc[n] = pz;
+
+  /* increment the factor size and return success. */
+  S->nc++;
+  L->rows = L->cols = S->nc;
+  return 1;
+}
+
+/* factor_match(): match the observations in the factor cache of
+ * a search to the observations in its dataset.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ *  @seen: array of flags indicating cached dataset entries.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) every cached observation
+ *  was found in the dataset.
+ */
+static int factor_match (const Search *S, char *seen) {
+  /* loop over the cached observations. */
+  const size_t D = S->mdl->D;
+  for (size_t j = 0; j < S->nc; j++) {
+    /* build a datum from the cached observation. */
+    VectorView xj = vector_view_array(S->xc + j * D, D);
+    Datum dj;
+    dj.x = &xj;
+    dj.p = S->pc[j];
+
+    /* locate the observation in the dataset. */
+    const size_t i = data_find(S->dat, &dj);
+    if (!i || seen[i - 1])
+      return 0;
+
+    /* mark the observation as cached. */
+    seen[i - 1] = 1;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* search_factor(): bring the cached cholesky factor of the covariance
+ * matrix of a search up to date with its model and dataset.
+ *
+ * when the model state is unchanged and the dataset holds every cached
+ * observation, only the new observations are appended to the factor,
+ * at O(n^2) operations each. otherwise, the factor is rebuilt from an
+ * empty cache, and the noise variance added to its diagonal is estimated
+ * again. the held estimate goes stale as observations are appended, but
+ * re-estimating it would force a rebuild on every new observation.
+ *
+ * arguments:
+ *  @S: search structure pointer.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int search_factor (Search *S) {
+  /* prepare the covariance kernel at the current model state. */
+  if (!model_jit_init(&S->jit, S->mdl))
+    return 0;
+
+  /* build the current model state. */
+  size_t nkey;
+  double *key = factor_key(S->mdl, &nkey);
+  if (!key)
+    return 0;
+
+  /* allocate flags for marking cached observations. */
+  const size_t n = S->dat->N;
+  char *seen = calloc(n ? n : 1, sizeof(char));
+  if (!seen) {
+    free(key);
+    return 0;
+  }
+
+  /* check whether the cached factor may be extended. */
+  int reuse = (S->key && S->nkey == nkey &&
+               !memcmp(S->key, key, nkey * sizeof(double)) &&
+               S->nc <= n && factor_match(S, seen));
+
+  /* if not, reset the cache and estimate the noise variance. */
+  if (!reuse) {
+    free_factor(S);
+    memset(seen, 0, n * sizeof(char));
+    S->jitter = factor_jitter(S);
+    S->key = key;
+    S->nkey = nkey;
+    S->nbuild++;
+    key = NULL;
+  }
+
+  /* ensure the cache has capacity for every observation. */
+  int ok = factor_reserve(S, n);
+
+  /* append the new observations to the factor. */
+  size_t i = 0;
+  for (; i < n && ok; i++) {
+    if (!seen[i])
+      ok = factor_append(S, i);
+  }
+
+  /* free the temporary arrays. */
+  free(seen);
+  free(key);
+
+  /* check for failures. */
+  if (!ok) {
+    /* output a warning message, if the matrix was singular. */
+    if (i) {
+      fprintf(stderr, "cov (%zux%zu) is singular!\n", n, n);
+      fflush(stderr);
+    }
+
+    /* invalidate the cache and return failure. */
+    free_factor(S);
+    return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
@@ -29,6 +29,26 @@ PyDoc_STRVAR(
 "Function output(s) to search at each execution (read/write)\n"
 "\n");
 
+PyDoc_STRVAR(
+  Search_getset_space_doc,
+"Space in which variances are computed (read/write)\n"
+"\n"
+"In 'function' space, variances are computed from the gaussian\n"
+"process covariances of all observations. In 'weight' space, they\n"
+"are computed from factor moments and the weight posterior of the\n"
+"model, at a cost that does not depend on the number of observations.\n"
+"\n");
+
+PyDoc_STRVAR(
+  Search_getset_rebuilds_doc,
+"Number of times the covariance factor was rebuilt (read-only)\n"
+"\n"
+"In 'function' space, the cholesky factor of the covariance matrix\n"
+"is kept between executions. Observations added since the previous\n"
+"execution extend it, and it is only rebuilt when the model changes\n"
+"or cached observations are removed from the dataset.\n"
+"\n");
+
 PyDoc_STRVAR(
   Search_method_execute_doc,
 "Find the next location with maximum posterior variance.\n"
@@ -38,6 +58,7 @@ PyDoc_STRVAR(
 
 void free_buffers (Search *S);
 void free_kernel (Search *S);
+void free_factor (Search *S);
 
 /* --- */
 
@@ -175,6 +196,60 @@ Search_set_outputs (Search *self, PyObject *value, void *closure) {
   return 0;
 }
 
+/* Search_get_space(): method for getting search spaces.
+ */
+static PyObject*
+Search_get_space (Search *self) {
+  /* return the space as a string. */
+  return PyUnicode_FromString(self->space == SEARCH_WEIGHT
+                              ? "weight" : "function");
+}
+
+/* Search_set_space(): method for setting search spaces.
+ */
+static int
+Search_set_space (Search *self, PyObject *value, void *closure) {
+  /* check that the value is a unicode type. */
+  if (!value || !PyUnicode_Check(value)) {
+    PyErr_SetString(PyExc_TypeError, "'space' expects str");
+    return -1;
+  }
+
+  /* get the space name as a c string. */
+  const char *name = PyUnicode_AsUTF8AndSize(value, NULL);
+  if (!name)
+    return -1;
+
+  /* parse the space name. */
+  SearchSpace space;
+  if (!strcmp(name, "function"))
+    space = SEARCH_FUNCTION;
+  else if (!strcmp(name, "weight"))
+    space = SEARCH_WEIGHT;
+  else {
+    PyErr_SetString(PyExc_ValueError,
+                    "'space' expects 'function' or 'weight'");
+    return -1;
+  }
+
+  /* set the space. */
+  if (!search_set_space(self, space)) {
+    PyErr_SetNone(PyExc_RuntimeError);
+    return -1;
+  }
+
+  /* return success. */
+  return 0;
+}
+
+/* Search_get_rebuilds(): method for getting search factor rebuild counts.
+ */
+static PyObject*
+Search_get_rebuilds (Search *self) {
+  /* return the rebuild count as an integer. */
+  return PyLong_FromSize_t(self->nbuild);
+}
+
 /* --- */
 
 static PyObject*
@@ -226,6 +301,9 @@ Search_new (PyTypeObject *type, PyObject *args, PyObject *kwargs) {
   self->mdl = NULL;
   self->dat = NULL;
 
+  /* compute variances in function space by default. */
+  self->space = SEARCH_FUNCTION;
+
   /* initialize the buffer sizes. */
   self->D = self->P = self->K = self->N = self->n = 0;
 
@@ -250,11 +328,19 @@ Search_new (PyTypeObject *type, PyObject *args, PyObject *kwargs) {
   self->C = NULL;
   self->pdat = NULL;
 #else
-  self->cs = NULL;
+  self->var = self->xgrid = self->xmax = NULL;
 #endif
-  self->cov = NULL;
   self->vmax = 0.0;
 
+  /* initialize the factor cache. */
+  self->cov = NULL;
+  self->xc = NULL;
+  self->pc = NULL;
+  self->key = NULL;
+  self->nkey = self->nc = self->cap = self->nbuild = 0;
+  self->jitter = 0.0;
+  memset(&self->jit, 0, sizeof(ModelJit));
+
   /* return the new object. */
   return (PyObject*) self;
 }
@@ -263,9 +349,13 @@ Search_new (PyTypeObject *type, PyObject *args, PyObject *kwargs) {
  */
 static void
 Search_dealloc (Search *self) {
-  /* free the the kernel and calculation buffers. */
+  /* free the the kernel, calculation buffers, factor cache and
+   * compiled covariance kernel.
+   */
   free_buffers(self);
   free_kernel(self);
+  free_factor(self);
+  model_jit_free(&self->jit);
 
   /* release the object memory. */
   Py_TYPE(self)->tp_free((PyObject*) self);
@@ -306,6 +396,18 @@ static PyGetSetDef Search_getset[] = {
     Search_getset_outputs_doc,
     NULL
   },
+  { "space",
+    (getter) Search_get_space,
+    (setter) Search_set_space,
+    Search_getset_space_doc,
+    NULL
+  },
+  { "rebuilds",
+    (getter) Search_get_rebuilds,
+    NULL,
+    Search_getset_rebuilds_doc,
+    NULL
+  },
   { NULL }
 };
 
@@ -15,16 +15,18 @@
  *  sum of absolute values of the vector elements.
  */
 double blas_dasum (const Vector *x) {
-#ifdef __VFL_USE_ATLAS
-  /* use atlas blas. */
+#ifdef __VFL_USE_CBLAS
+  /* use the external blas. */
   return cblas_dasum(x->len, x->data, x->stride);
 #else
   /* initialize the result. */
+  const double *xd = x->data;
+  const size_t xs = x->stride;
   double result = 0.0;
 
   /* compute the sum of the absolute values of the vector elements. */
   for (size_t i = 0; i < x->len; i++)
-    result += fabs(vector_get(x, i));
+    result += fabs(xd[i * xs]);
 
   /* return the result. */
   return result;
@@ -44,8 +46,8 @@ double blas_dasum (const Vector *x) {
  *  euclidean norm of the input vector.
  */
 inline double blas_dnrm2 (const Vector *x) {
-#ifdef __VFL_USE_ATLAS
-  /* use atlas blas. */
+#ifdef __VFL_USE_CBLAS
+  /* use the external blas. */
   return cblas_dnrm2(x->len, x->data, x->stride);
 #else
   /* compute and return the result. */
@@ -66,19 +68,41 @@ inline double blas_dnrm2 (const Vector *x) {
  *  euclidean inner product (dot product) of the two input vectors.
  */
 double blas_ddot (const Vector *x, const Vector *y) {
-#ifdef __VFL_USE_ATLAS
-  /* use atlas blas. */
+#ifdef __VFL_USE_CBLAS
+  /* use the external blas. */
   return cblas_ddot(x->len, x->data, x->stride, y->data, y->stride);
 #else
-  /* initialize the result. */
-  double result = 0.0;
+  /* get the vector elements. */
+  const double *xd = x->data, *yd = y->data;
+  const size_t n = x->len, xs = x->stride, ys = y->stride;
 
-  /* compute the sum of the products of each pair of vector elements. */
-  for (size_t i = 0; i < x->len; i++)
-    result += vector_get(x, i) * vector_get(y, i);
+  /* sum strided vector elements in order. */
+  if (xs != 1 || ys != 1) {
+    double result = 0.0;
+    for (size_t i = 0; i < n; i++)
+      result += xd[i * xs] * yd[i * ys];
+
+    return result;
+  }
+
+  /* sum contiguous vector elements into independent partial sums,
+   * which allows the loop to be vectorized.
+   */
+  double sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    sum[0] += xd[i]     * yd[i];
+    sum[1] += xd[i + 1] * yd[i + 1];
+    sum[2] += xd[i + 2] * yd[i + 2];
+    sum[3] += xd[i + 3] * yd[i + 3];
+  }
+
+  /* include the remaining elements. */
+  for (; i < n; i++)
+    sum[0] += xd[i] * yd[i];
 
   /* return the result. */
-  return result;
+  return (sum[0] + sum[1]) + (sum[2] + sum[3]);
 #endif
 }
 
@@ -93,13 +117,24 @@ double blas_ddot (const Vector *x, const Vector *y) {
  *  @y: input and output vector of the sum.
  */
 void blas_daxpy (double alpha, const Vector *x, Vector *y) {
-#ifdef __VFL_USE_ATLAS
-  /* use atlas blas. */
+#ifdef __VFL_USE_CBLAS
+  /* use the external blas. */
   cblas_daxpy(x->len, alpha, x->data, x->stride, y->data, y->stride);
 #else
+  /* get the vector elements. */
+  const double *xd = x->data;
+  double *yd = y->data;
+  const size_t n = x->len, xs = x->stride, ys = y->stride;
+
   /* compute the sum over all vector elements. */
-  for (size_t i = 0; i < x->len; i++)
-    vector_set(y, i, vector_get(y, i) + alpha * vector_get(x, i));
+  if (xs == 1 && ys == 1) {
+    for (size_t i = 0; i < n; i++)
+      yd[i] += alpha * xd[i];
+  }
+  else {
+    for (size_t i = 0; i < n; i++)
+      yd[i * ys] += alpha * xd[i * xs];
+  }
 #endif
 }
 
@@ -113,13 +148,15 @@ void blas_daxpy (double alpha, const Vector *x, Vector *y) {
  *  @y: input and output vector.
  */
 void blas_dscal (double alpha, Vector *y) {
-#ifdef __VFL_USE_BLAS
-  /* use atlas blas. */
+#ifdef __VFL_USE_CBLAS
+  /* use the external blas. */
   cblas_dscal(y->len, alpha, y->data, y->stride);
 #else
   /* compute the scaled value of each vector element. */
+  double *yd = y->data;
+  const size_t ys = y->stride;
   for (size_t i = 0; i < y->len; i++)
-    vector_set(y, i, vector_get(y, i) * alpha);
+    yd[i * ys] *= alpha;
 #endif
 }
 
@@ -145,8 +182,8 @@ void blas_dscal (double alpha, Vector *y) {
  */
 void blas_dgemv (BlasTranspose trans, double alpha, const Matrix *A,
                  const Vector *x, double beta, Vector *y) {
-#ifdef __VFL_USE_ATLAS
-  /* use atlas blas. */
+#ifdef __VFL_USE_CBLAS
+  /* use the external blas. */
   cblas_dgemv(CblasRowMajor, (enum CBLAS_TRANSPOSE) trans,
               A->rows, A->cols, alpha, A->data, A->stride,
               x->data, x->stride, beta,
@@ -172,11 +209,12 @@ void blas_dgemv (BlasTranspose trans, double alpha, const Matrix *A,
     }
   }
   else if (trans == BLAS_TRANS) {
-    /* perform: y <- y + alpha A' x */
-    for (size_t j = 0; j < A->cols; j++) {
-      VectorView aj = matrix_col(A, j);
-      const double ax = blas_ddot(&aj, x);
-      vector_set(y, j, vector_get(y, j) + alpha * ax);
+    /* perform: y <- y + alpha A' x, by accumulating scaled rows
+     * of the matrix to avoid strided accesses along its columns.
+     */
+    for (size_t i = 0; i < A->rows; i++) {
+      VectorView ai = matrix_row(A, i);
+      blas_daxpy(alpha * vector_get(x, i), &ai, y);
     }
   }
 #endif
@@ -201,8 +239,8 @@ void blas_dgemv (BlasTranspose trans, double alpha, const Matrix *A,
  */
 void blas_dtrmv (BlasTranspose trans, const Matrix *L,
                  const Vector *x, Vector *y) {
-#ifdef __VFL_USE_ATLAS
-  /* use atlas blas. */
+#ifdef __VFL_USE_CBLAS
+  /* use the external blas. */
   vector_copy(y, x);
   cblas_dtrmv(CblasRowMajor, CblasLower, (enum CBLAS_TRANSPOSE) trans,
               CblasNonUnit, L->rows, L->data, L->stride,
@@ -248,8 +286,8 @@ void blas_dtrmv (BlasTranspose trans, const Matrix *L,
  *  @x: input and output vector.
  */
 void blas_dtrsv (BlasTriangle tri, const Matrix *A, Vector *x) {
-#ifdef __VFL_USE_ATLAS
-  /* use atlas blas. */
+#ifdef __VFL_USE_CBLAS
+  /* use the external blas. */
   cblas_dtrsv(CblasRowMajor, (enum CBLAS_UPLO) tri,
               CblasNoTrans, CblasNonUnit,
               A->rows, A->data, A->stride,
@@ -283,3 +321,525 @@ void blas_dtrsv (BlasTriangle tri, const Matrix *A, Vector *x) {
 #endif
 }
 
+
+/* --- */
+
+/* BLAS_BLOCK_M: row tile size of the output of the built-in blocked
+ * matrix-matrix product.
+ */
+#define BLAS_BLOCK_M 64
+
+/* BLAS_BLOCK_N: column tile size of the output of the built-in blocked
+ * matrix-matrix product.
+ */
+#define BLAS_BLOCK_N 128
+
+/* BLAS_BLOCK_K: inner dimension tile size used by the built-in
+ * blocked matrix-matrix product.
+ */
+#define BLAS_BLOCK_K 128
+
+/* BLAS_BLOCK_NB: diagonal block size used by the built-in blocked
+ * triangular solve and symmetric rank-k update.
+ */
+#define BLAS_BLOCK_NB 64
+
+#ifndef __VFL_USE_CBLAS
+/* dgemm_kernel(): accumulate the product of a packed tile of the
+ * first operand (m-by-k, row-major) and a packed tile of the second
+ * operand (k-by-n, row-major) into a tile of the output matrix. four
+ * output rows are updated together, and the innermost loops run over
+ * contiguous rows of the second tile, so they are vectorized by the
+ * compiler.
+ */
+static void dgemm_kernel (size_t m, size_t n, size_t k, double alpha,
+                          const double *restrict Ap,
+                          const double *restrict Bp,
+                          double *restrict C, size_t ldc) {
+  /* loop over groups of four output rows. */
+  size_t i = 0;
+  for (; i + 4 <= m; i += 4) {
+    /* get the output rows and packed first-operand rows. */
+    double *restrict c0 = C + i * ldc;
+    double *restrict c1 = c0 + ldc;
+    double *restrict c2 = c1 + ldc;
+    double *restrict c3 = c2 + ldc;
+    const double *a = Ap + i * k;
+
+    /* accumulate the scaled rows of the second tile. */
+    for (size_t l = 0; l < k; l++) {
+      const double *restrict b = Bp + l * n;
+      const double x0 = alpha * a[l];
+      const double x1 = alpha * a[k + l];
+      const double x2 = alpha * a[2 * k + l];
+      const double x3 = alpha * a[3 * k + l];
+      for (size_t j = 0; j < n; j++) {
+        c0[j] += x0 * b[j];
+        c1[j] += x1 * b[j];
+        c2[j] += x2 * b[j];
+        c3[j] += x3 * b[j];
+      }
+    }
+  }
+
+  /* handle the remaining output rows. */
+  for (; i < m; i++) {
+    double *restrict c0 = C + i * ldc;
+    const double *a = Ap + i * k;
+    for (size_t l = 0; l < k; l++) {
+      const double *restrict b = Bp + l * n;
+      const double x0 = alpha * a[l];
+      for (size_t j = 0; j < n; j++)
+        c0[j] += x0 * b[j];
+    }
+  }
+}
+#endif
+
+/* blas_dgemm(): compute the linear combination of a matrix and the
+ * product of two dense matrices.
+ *
+ * the user is responsible for ensuring that all matrix operands are
+ * non-null and of conformal sizes. the output matrix may not overlap
+ * either of the input matrices.
+ *
+ * operation:
+ *  C <- alpha op(A) op(B) + beta C
+ *
+ * arguments:
+ *  @transA: transposition state of the first matrix in the product.
+ *  @transB: transposition state of the second matrix in the product.
+ *  @alpha: scale factor for the matrix-matrix product.
+ *  @A: first input matrix to the product operation.
+ *  @B: second input matrix to the product operation.
+ *  @beta: scale factor for the output matrix.
+ *  @C: input and output matrix to the combined operation.
+ */
+void blas_dgemm (BlasTranspose transA, BlasTranspose transB,
+                 double alpha, const Matrix *A, const Matrix *B,
+                 double beta, Matrix *C) {
+  /* determine the inner dimension of the product. */
+  const size_t n = (transA == BLAS_NO_TRANS ? A->cols : A->rows);
+
+#ifdef __VFL_USE_CBLAS
+  /* use the external blas. */
+  cblas_dgemm(CblasRowMajor,
+              (enum CBLAS_TRANSPOSE) transA,
+              (enum CBLAS_TRANSPOSE) transB,
+              C->rows, C->cols, n, alpha,
+              A->data, A->stride,
+              B->data, B->stride, beta,
+              C->data, C->stride);
+#else
+  /* determine the element spacings of each operand along its rows
+   * (over the outer dimension) and along the inner dimension.
+   */
+  const size_t ai = (transA == BLAS_NO_TRANS ? A->stride : 1);
+  const size_t al = (transA == BLAS_NO_TRANS ? 1 : A->stride);
+  const size_t bj = (transB == BLAS_NO_TRANS ? 1 : B->stride);
+  const size_t bl = (transB == BLAS_NO_TRANS ? B->stride : 1);
+
+  /* perform: C <- beta C */
+  for (size_t i = 0; i < C->rows; i++) {
+    double *ci = C->data + i * C->stride;
+    for (size_t j = 0; j < C->cols; j++)
+      ci[j] = (beta == 0.0 ? 0.0 : beta * ci[j]);
+  }
+
+  /* if the scale factor to the matrix-matrix portion is zero, return. */
+  if (alpha == 0.0 || n == 0)
+    return;
+
+  /* allocate the packed tiles of each operand. */
+  double *Ap = malloc(BLAS_BLOCK_M * BLAS_BLOCK_K * sizeof(double));
+  double *Bp = malloc(BLAS_BLOCK_K * BLAS_BLOCK_N * sizeof(double));
+
+  /* loop over the tiles of the inner dimension. */
+  for (size_t l0 = 0; l0 < n; l0 += BLAS_BLOCK_K) {
+    const size_t l1 = (l0 + BLAS_BLOCK_K < n ? l0 + BLAS_BLOCK_K : n);
+    const size_t nl = l1 - l0;
+
+    /* loop over the column tiles of the output matrix. */
+    for (size_t j0 = 0; j0 < C->cols; j0 += BLAS_BLOCK_N) {
+      const size_t j1 = (j0 + BLAS_BLOCK_N < C->cols ?
+                         j0 + BLAS_BLOCK_N : C->cols);
+      const size_t nj = j1 - j0;
+
+      /* pack the tile of the second operand. */
+      if (Bp) {
+        for (size_t l = 0; l < nl; l++) {
+          const double *blj = B->data + (l0 + l) * bl + j0 * bj;
+          for (size_t j = 0; j < nj; j++)
+            Bp[l * nj + j] = blj[j * bj];
+        }
+      }
+
+      /* loop over the row tiles of the output matrix. */
+      for (size_t i0 = 0; i0 < C->rows; i0 += BLAS_BLOCK_M) {
+        const size_t i1 = (i0 + BLAS_BLOCK_M < C->rows ?
+                           i0 + BLAS_BLOCK_M : C->rows);
+        const size_t ni = i1 - i0;
+        double *Cij = C->data + i0 * C->stride + j0;
+
+        /* without packing buffers, accumulate strided products. */
+        if (!Ap || !Bp) {
+          for (size_t i = i0; i < i1; i++) {
+            const double *ail = A->data + i * ai + l0 * al;
+            double *ci = C->data + i * C->stride;
+            for (size_t j = j0; j < j1; j++) {
+              const double *blj = B->data + j * bj + l0 * bl;
+              double sum = 0.0;
+              for (size_t l = 0; l < nl; l++)
+                sum += ail[l * al] * blj[l * bl];
+
+              ci[j] += alpha * sum;
+            }
+          }
+
+          continue;
+        }
+
+        /* pack the tile of the first operand. */
+        for (size_t i = 0; i < ni; i++) {
+          const double *ail = A->data + (i0 + i) * ai + l0 * al;
+          for (size_t l = 0; l < nl; l++)
+            Ap[i * nl + l] = ail[l * al];
+        }
+
+        /* compute the contribution of the current tiles. */
+        dgemm_kernel(ni, nj, nl, alpha, Ap, Bp, Cij, C->stride);
+      }
+    }
+  }
+
+  /* free the packed tiles. */
+  free(Ap);
+  free(Bp);
+#endif
+}
+
+/* blas_dsyrk(): compute the linear combination of a symmetric matrix
+ * and the product of a dense matrix with its transpose. only the
+ * requested triangle of the output matrix is accessed.
+ *
+ * the user is responsible for ensuring that all matrix operands are
+ * non-null and of conformal sizes. the output matrix may not overlap
+ * the input matrix.
+ *
+ * operation:
+ *  C <- alpha A A' + beta C      if trans == BLAS_NO_TRANS
+ *  C <- alpha A' A + beta C      if trans == BLAS_TRANS
+ *
+ * arguments:
+ *  @tri: triangle of the output matrix to compute.
+ *  @trans: transposition state of the input matrix.
+ *  @alpha: scale factor for the matrix-matrix product.
+ *  @A: input matrix to the product operation.
+ *  @beta: scale factor for the output matrix.
+ *  @C: input and output symmetric matrix.
+ */
+void blas_dsyrk (BlasTriangle tri, BlasTranspose trans, double alpha,
+                 const Matrix *A, double beta, Matrix *C) {
+  /* determine the output and inner dimensions of the product. */
+  const size_t n = C->rows;
+  const size_t k = (trans == BLAS_NO_TRANS ? A->cols : A->rows);
+
+#ifdef __VFL_USE_CBLAS
+  /* use the external blas. */
+  cblas_dsyrk(CblasRowMajor, (enum CBLAS_UPLO) tri,
+              (enum CBLAS_TRANSPOSE) trans, n, k, alpha,
+              A->data, A->stride, beta,
+              C->data, C->stride);
+#else
+  /* determine the transposition of the second operand. */
+  const BlasTranspose transB = (trans == BLAS_NO_TRANS ?
+                                BLAS_TRANS : BLAS_NO_TRANS);
+
+  /* allocate a buffer for diagonal tiles. */
+  double *buf = malloc(BLAS_BLOCK_NB * BLAS_BLOCK_NB * sizeof(double));
+
+  /* loop over the diagonal tiles of the output matrix. */
+  for (size_t i0 = 0; i0 < n; i0 += BLAS_BLOCK_NB) {
+    const size_t ni = (i0 + BLAS_BLOCK_NB < n ? BLAS_BLOCK_NB : n - i0);
+
+    /* get the rows of op(A) in the current tile row. */
+    MatrixView Ai = (trans == BLAS_NO_TRANS ?
+                     matrix_submatrix(A, i0, 0, ni, k) :
+                     matrix_submatrix(A, 0, i0, k, ni));
+
+    /* compute the off-diagonal tiles of the current tile row
+     * (or column) in the requested triangle.
+     */
+    const size_t j0 = (tri == BLAS_LOWER ? 0 : i0 + ni);
+    const size_t nj = (tri == BLAS_LOWER ? i0 : n - i0 - ni);
+    if (nj) {
+      MatrixView Aj = (trans == BLAS_NO_TRANS ?
+                       matrix_submatrix(A, j0, 0, nj, k) :
+                       matrix_submatrix(A, 0, j0, k, nj));
+
+      MatrixView Cij = matrix_submatrix(C, i0, j0, ni, nj);
+      blas_dgemm(trans, transB, alpha, &Ai, &Aj, beta, &Cij);
+    }
+
+    /* compute the diagonal tile, either into a temporary buffer
+     * or, without one, element by element.
+     */
+    if (buf) {
+      MatrixView T = matrix_view_array(buf, ni, ni);
+      blas_dgemm(trans, transB, alpha, &Ai, &Ai, 0.0, &T);
+      for (size_t i = 0; i < ni; i++) {
+        double *ci = C->data + (i0 + i) * C->stride + i0;
+        const size_t ja = (tri == BLAS_LOWER ? 0 : i);
+        const size_t jb = (tri == BLAS_LOWER ? i + 1 : ni);
+        for (size_t j = ja; j < jb; j++)
+          ci[j] = (beta == 0.0 ? 0.0 : beta * ci[j]) + buf[i * ni + j];
+      }
+    }
+    else {
+      for (size_t i = 0; i < ni; i++) {
+        const size_t ja = (tri == BLAS_LOWER ? 0 : i);
+        const size_t jb = (tri == BLAS_LOWER ? i + 1 : ni);
+        for (size_t j = ja; j < jb; j++) {
+          double sum = 0.0;
+          for (size_t l = 0; l < k; l++) {
+            sum += (trans == BLAS_NO_TRANS ?
+                    matrix_get(&Ai, i, l) * matrix_get(&Ai, j, l) :
+                    matrix_get(&Ai, l, i) * matrix_get(&Ai, l, j));
+          }
+
+          double *cij = C->data + (i0 + i) * C->stride + i0 + j;
+          *cij = (beta == 0.0 ? 0.0 : beta * *cij) + alpha * sum;
+        }
+      }
+    }
+  }
+
+  /* free the diagonal tile buffer. */
+  free(buf);
+#endif
+}
+
+/* blas_dtrsm(): solve a triangular system of linear equations with
+ * multiple right-hand sides.
+ *
+ * the user is responsible for ensuring that all matrix operands are
+ * non-null and of conformal sizes. only the requested triangle of
+ * the triangular matrix is accessed.
+ *
+ * operation:
+ *  B <- alpha inv(op(T)) B       if side == BLAS_LEFT
+ *  B <- alpha B inv(op(T))       if side == BLAS_RIGHT
+ *
+ * where op(T) is tril(T) or triu(T), as selected by @tri, or its
+ * transpose if @trans is BLAS_TRANS.
+ *
+ * arguments:
+ *  @side: side of the right-hand sides on which the matrix acts.
+ *  @tri: triangle to access in the triangular matrix.
+ *  @trans: transposition state of the triangular matrix.
+ *  @alpha: scale factor for the right-hand sides.
+ *  @T: input triangular matrix.
+ *  @B: input right-hand sides and output solutions.
+ */
+void blas_dtrsm (BlasSide side, BlasTriangle tri, BlasTranspose trans,
+                 double alpha, const Matrix *T, Matrix *B) {
+#ifdef __VFL_USE_CBLAS
+  /* use the external blas. */
+  cblas_dtrsm(CblasRowMajor, (enum CBLAS_SIDE) side,
+              (enum CBLAS_UPLO) tri, (enum CBLAS_TRANSPOSE) trans,
+              CblasNonUnit, B->rows, B->cols, alpha,
+              T->data, T->stride,
+              B->data, B->stride);
+#else
+  /* get the sizes of the right-hand sides. */
+  const size_t m = B->rows, n = B->cols;
+  const size_t ts = T->stride, bs = B->stride;
+  const double *t = T->data;
+  double *b = B->data;
+
+  /* determine whether op(T) is lower triangular. */
+  const int lower = ((tri == BLAS_LOWER) == (trans == BLAS_NO_TRANS));
+
+  /* define the elements of op(T). */
+  #define OPT(i, j) \
+    (trans == BLAS_NO_TRANS ? t[(i) * ts + (j)] : t[(j) * ts + (i)])
+
+  /* define the blocks of op(T). */
+  #define OPT_BLOCK(i0, j0, ni, nj) \
+    (trans == BLAS_NO_TRANS ? matrix_submatrix(T, i0, j0, ni, nj) \
+                            : matrix_submatrix(T, j0, i0, nj, ni))
+
+  /* perform: B <- alpha B */
+  if (alpha != 1.0) {
+    for (size_t i = 0; i < m; i++)
+      for (size_t j = 0; j < n; j++)
+        b[i * bs + j] *= alpha;
+  }
+
+  if (side == BLAS_LEFT) {
+    /* solve op(T) X = B by blocks of rows. each row of the solution
+     * is updated with contiguous multiples of previously solved rows.
+     */
+    for (size_t kb = 0; kb < m; kb += BLAS_BLOCK_NB) {
+      const size_t nk = (kb + BLAS_BLOCK_NB < m ? BLAS_BLOCK_NB : m - kb);
+
+      /* forward substitution starts at the first row block,
+       * backward substitution at the last.
+       */
+      const size_t i0 = (lower ? kb : m - kb - nk);
+      const size_t i1 = i0 + nk;
+
+      /* solve the diagonal block. */
+      for (size_t ii = 0; ii < nk; ii++) {
+        const size_t i = (lower ? i0 + ii : i1 - 1 - ii);
+        double *bi = b + i * bs;
+        const size_t ka = (lower ? i0 : i + 1);
+        const size_t kz = (lower ? i : i1);
+        for (size_t kk = ka; kk < kz; kk++) {
+          const double tik = OPT(i, kk);
+          const double *bk = b + kk * bs;
+          for (size_t j = 0; j < n; j++)
+            bi[j] -= tik * bk[j];
+        }
+
+        const double tinv = 1.0 / OPT(i, i);
+        for (size_t j = 0; j < n; j++)
+          bi[j] *= tinv;
+      }
+
+      /* update the remaining rows with the solved block. */
+      const size_t r0 = (lower ? i1 : 0);
+      const size_t nr = (lower ? m - i1 : i0);
+      if (nr) {
+        MatrixView Tr = OPT_BLOCK(r0, i0, nr, nk);
+        MatrixView Xk = matrix_submatrix(B, i0, 0, nk, n);
+        MatrixView Br = matrix_submatrix(B, r0, 0, nr, n);
+        blas_dgemm(trans, BLAS_NO_TRANS, -1.0, &Tr, &Xk, 1.0, &Br);
+      }
+    }
+  }
+  else {
+    /* solve X op(T) = B by blocks of columns. each block is first
+     * updated with the previously solved columns, then solved one
+     * row of the right-hand sides at a time.
+     */
+    for (size_t kb = 0; kb < n; kb += BLAS_BLOCK_NB) {
+      const size_t nk = (kb + BLAS_BLOCK_NB < n ? BLAS_BLOCK_NB : n - kb);
+
+      /* upper op(T) is solved from the first column block,
+       * and lower op(T) from the last.
+       */
+      const size_t j0 = (lower ? n - kb - nk : kb);
+      const size_t j1 = j0 + nk;
+
+      /* update the block with the solved columns. */
+      const size_t s0 = (lower ? j1 : 0);
+      const size_t ns = (lower ? n - j1 : j0);
+      if (ns) {
+        MatrixView Xs = matrix_submatrix(B, 0, s0, m, ns);
+        MatrixView Ts = OPT_BLOCK(s0, j0, ns, nk);
+        MatrixView Bk = matrix_submatrix(B, 0, j0, m, nk);
+        blas_dgemm(BLAS_NO_TRANS, trans, -1.0, &Xs, &Ts, 1.0, &Bk);
+      }
+
+      /* solve the block. */
+      for (size_t i = 0; i < m; i++) {
+        double *bi = b + i * bs;
+        for (size_t jj = 0; jj < nk; jj++) {
+          const size_t j = (lower ? j1 - 1 - jj : j0 + jj);
+          const size_t ka = (lower ? j + 1 : j0);
+          const size_t kz = (lower ? j1 : j);
+          double x = bi[j];
+          for (size_t kk = ka; kk < kz; kk++)
+            x -= bi[kk] * OPT(kk, j);
+
+          bi[j] = x / OPT(j, j);
+        }
+      }
+    }
+  }
+
+  /* undefine the element and block macros. */
+  #undef OPT
+  #undef OPT_BLOCK
+#endif
+}
+
+/* --- */
+
+/* blas_backend(): return the name of the library that provides the
+ * basic linear algebra subroutines.
+ *
+ * returns:
+ *  constant string naming the blas backend.
+ */
+const char *blas_backend (void) {
+#if defined(__VFL_USE_ATLAS)
+  return "atlas";
+#elif defined(__VFL_USE_OPENBLAS)
+  return "openblas";
+#elif defined(__VFL_USE_BLIS)
+  return "blis";
+#elif defined(__VFL_USE_CBLAS)
+  return "cblas";
+#else
+  return "builtin";
+#endif
+}
+
+/* blas_get_threads(): return the number of threads used by the blas
+ * backend within each call.
+ *
+ * returns:
+ *  thread count of the backend, or zero if the backend does not
+ *  report its thread count.
+ */
+size_t blas_get_threads (void) {
+#if defined(__VFL_USE_OPENBLAS)
+  /* query openblas. */
+  return (size_t) openblas_get_num_threads();
+#elif defined(__VFL_USE_BLIS)
+  /* query blis. */
+  return (size_t) bli_thread_get_num_threads();
+#elif defined(__VFL_USE_CBLAS)
+  /* other libraries fix their thread count at build time. */
+  return 0;
+#else
+  /* the built-in routines execute on the calling thread. */
+  return 1;
+#endif
+}
+
+/* blas_set_threads(): set the number of threads used by the blas
+ * backend within each call. when the thread pool of vfl executes blas
+ * routines from several threads at once, a count of one avoids
+ * oversubscribing the processors.
+ *
+ * arguments:
+ *  @count: new thread count, which must be positive.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0). the method will
+ *  return failure if the backend does not support thread control.
+ */
+int blas_set_threads (size_t count) {
+  /* check the thread count. */
+  if (!count)
+    return 0;
+
+#if defined(__VFL_USE_OPENBLAS)
+  /* configure openblas. */
+  openblas_set_num_threads((int) count);
+  return 1;
+#elif defined(__VFL_USE_BLIS)
+  /* configure blis. */
+  bli_thread_set_num_threads((dim_t) count);
+  return 1;
+#elif defined(__VFL_USE_CBLAS)
+  /* other libraries fix their thread count at build time. */
+  return 0;
+#else
+  /* the built-in routines only run on the calling thread. */
+  return (count == 1);
+#endif
+}
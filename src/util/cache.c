@@ -0,0 +1,80 @@
+
+/* include the vfl header. */
+#include <vfl/vfl.h>
+
+/* include headers for cache directory management. */
+#include <sys/stat.h>
+#include <errno.h>
+
+/* cache_dir(): determine the directory that holds cached compiled
+ * programs, creating it if necessary. the directory is taken from
+ * the VFL_CACHE_DIR environment variable, or defaults to 'vfl' in
+ * the user cache directory. an empty VFL_CACHE_DIR disables caching.
+ *
+ * arguments:
+ *  @dir: output string of at least CACHE_PATH characters.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the cache is available.
+ */
+int cache_dir (char *dir) {
+  /* check for an explicitly specified directory. */
+  const char *env = getenv("VFL_CACHE_DIR");
+  if (env) {
+    if (!*env || strlen(env) >= CACHE_PATH)
+      return 0;
+
+    strcpy(dir, env);
+  }
+  else {
+    /* build the default directory name. */
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    int len;
+    if (xdg && *xdg)
+      len = snprintf(dir, CACHE_PATH, "%s/vfl", xdg);
+    else if (home && *home)
+      len = snprintf(dir, CACHE_PATH, "%s/.cache/vfl", home);
+    else
+      return 0;
+
+    /* check for truncation. */
+    if (len < 0 || len >= CACHE_PATH)
+      return 0;
+
+    /* create the parent of the default directory. */
+    char *sep = strrchr(dir, '/');
+    *sep = '\0';
+    mkdir(dir, 0755);
+    *sep = '/';
+  }
+
+  /* create the directory, if it does not exist. */
+  if (mkdir(dir, 0755) && errno != EEXIST)
+    return 0;
+
+  /* return success. */
+  return 1;
+}
+
+/* cache_hash(): update a 64-bit fnv-1a hash with a string.
+ *
+ * arguments:
+ *  @h: current hash value, initially CACHE_HASH_INIT.
+ *  @str: string to include in the hash.
+ *
+ * returns:
+ *  updated hash value.
+ */
+uint64_t cache_hash (uint64_t h, const char *str) {
+  /* include each character and the terminator. */
+  do {
+    h ^= (unsigned char) *str;
+    h *= 0x100000001b3ULL;
+  }
+  while (*str++);
+
+  /* return the updated hash. */
+  return h;
+}
+
@@ -2,6 +2,51 @@
 /* include the cholesky decomposition header. */
 #include <vfl/util/chol.h>
 
+/* CHOL_BLOCK: column block size of the built-in blocked cholesky
+ * decomposition.
+ */
+#define CHOL_BLOCK 64
+
+#ifndef __VFL_USE_LAPACK
+/* chol_block(): compute the cholesky decomposition of a small diagonal
+ * block of a symmetric positive definite matrix, in place. each element
+ * of the factor is computed from an inner product of contiguous rows.
+ *
+ * arguments:
+ *  @A: diagonal block to decompose in place.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+static int chol_block (Matrix *A) {
+  /* loop over the rows of the block. */
+  const size_t n = A->cols;
+  for (size_t i = 0; i < n; i++) {
+    double *ai = A->data + i * A->stride;
+
+    /* loop over the elements of the lower triangle of the row. */
+    for (size_t j = 0; j <= i; j++) {
+      /* subtract the inner product of the preceding row elements. */
+      const double *aj = A->data + j * A->stride;
+      VectorView vi = vector_view_array(ai, j);
+      VectorView vj = vector_view_array((double*) aj, j);
+      const double aij = ai[j] - blas_ddot(&vi, &vj);
+
+      /* store the off-diagonal or diagonal element. */
+      if (j < i)
+        ai[j] = aij / aj[j];
+      else if (aij > 0.0)
+        ai[j] = sqrt(aij);
+      else
+        return 0;
+    }
+  }
+
+  /* return success. */
+  return 1;
+}
+#endif
+
 /* chol_decomp(): compute the cholesky decomposition of a symmetric
  * positive definite matrix.
  *
@@ -16,34 +61,32 @@ int chol_decomp (Matrix *A) {
   /* locally store the matrix size. */
   const size_t n = A->cols;
 
-#ifdef __VFL_USE_ATLAS
-  /* use atlas lapack. */
-  if (clapack_dpotrf(CblasRowMajor, CblasLower, n, A->data, A->stride))
+#ifdef __VFL_USE_LAPACK
+  /* use the external lapack. */
+  if (lapack_dpotrf(n, A->data, A->stride))
     return 0;
 #else
-  /* perform decomposition column-wise. */
-  for (size_t j = 0; j < n; j++) {
-    /* v := A(j : n, j) */
-    VectorView v = matrix_subcol(A, j, j, n - j);
-
-    if (j > 0) {
-      /* w := A(j, 1 : j)
-       * M := A(j : n, 1 : j)
-       */
-      VectorView w = matrix_subrow(A, j, 0, j);
-      MatrixView M = matrix_submatrix(A, j, 0, n - j, j);
-
-      /* v <- v - M w */
-      blas_dgemv(BLAS_NO_TRANS, -1.0, &M, &w, 1.0, &v);
-    }
-
-    /* ensure the positive-definiteness is satisfied. */
-    const double Ajj = matrix_get(A, j, j);
-    if (Ajj <= 0.0)
+  /* perform decomposition by blocks of columns. */
+  for (size_t k0 = 0; k0 < n; k0 += CHOL_BLOCK) {
+    const size_t nk = (k0 + CHOL_BLOCK < n ? CHOL_BLOCK : n - k0);
+    const size_t nr = n - k0 - nk;
+
+    /* A11 <- chol(A11) */
+    MatrixView A11 = matrix_submatrix(A, k0, k0, nk, nk);
+    if (!chol_block(&A11))
       return 0;
 
-    /* v <- v ./ sqrt(A(j,j)) */
-    blas_dscal(1.0 / sqrt(Ajj), &v);
+    /* skip the trailing updates after the last block. */
+    if (!nr)
+      break;
+
+    /* A21 <- A21 inv(L11') */
+    MatrixView A21 = matrix_submatrix(A, k0 + nk, k0, nr, nk);
+    blas_dtrsm(BLAS_RIGHT, BLAS_LOWER, BLAS_TRANS, 1.0, &A11, &A21);
+
+    /* A22 <- A22 - A21 A21' */
+    MatrixView A22 = matrix_submatrix(A, k0 + nk, k0 + nk, nr, nr);
+    blas_dsyrk(BLAS_LOWER, BLAS_NO_TRANS, -1.0, &A21, 1.0, &A22);
   }
 #endif
 
@@ -70,13 +113,13 @@ int chol_invert (const Matrix *L, Matrix *B) {
   /* locally store the matrix size. */
   const size_t n = L->cols;
 
-#ifdef __VFL_USE_ATLAS
+#ifdef __VFL_USE_LAPACK
   /* if the matrices are different, perform a copy. */
   if (B != L)
     matrix_copy(B, L);
 
-  /* use atlas lapack. */
-  if (clapack_dpotri(CblasRowMajor, CblasLower, n, B->data, B->stride))
+  /* use the external lapack. */
+  if (lapack_dpotri(n, B->data, B->stride))
     return 0;
 
   /* symmetrize the inverted matrix. */
@@ -84,18 +127,28 @@ int chol_invert (const Matrix *L, Matrix *B) {
     for (size_t j = i + 1; j < n; j++)
       matrix_set(B, i, j, matrix_get(B, j, i));
 #else
+  /* if the inverse overwrites the factorization, work from a copy. */
+  Matrix *Lcopy = NULL;
+  if (B == L) {
+    Lcopy = matrix_alloc(n, n);
+    if (!Lcopy)
+      return 0;
+
+    matrix_copy(Lcopy, L);
+    L = Lcopy;
+  }
+
   /* initialize the matrix inverse. */
   matrix_set_ident(B);
 
-  /* invert each column of the identity matrix. */
-  for (size_t j = 0; j < n; j++) {
-    /* extract the current column. */
-    VectorView b = matrix_col(B, j);
+  /* perform forward and backward substitution on every column of
+   * the identity matrix: B <- inv(L') inv(L) I
+   */
+  blas_dtrsm(BLAS_LEFT, BLAS_LOWER, BLAS_NO_TRANS, 1.0, L, B);
+  blas_dtrsm(BLAS_LEFT, BLAS_LOWER, BLAS_TRANS, 1.0, L, B);
 
-    /* perform forward and backward substitution. */
-    blas_dtrsv(BLAS_LOWER, L, &b);
-    blas_dtrsv(BLAS_UPPER, L, &b);
-  }
+  /* free the copied factorization. */
+  matrix_free(Lcopy);
 #endif
 
   /* return success. */
@@ -224,3 +277,149 @@ int chol_downdate (Matrix *L, Vector *y) {
   return 1;
 }
 
+
+/* chol_mirror(): copy the transposed factor held in the upper triangle
+ * of a cholesky factor matrix into its lower triangle, starting from
+ * a given column.
+ *
+ * arguments:
+ *  @L: cholesky factors of the matrix.
+ *  @k0: first column to copy.
+ */
+static void chol_mirror (Matrix *L, size_t k0) {
+  /* copy each row of the upper triangle into its column. */
+  const size_t n = L->cols;
+  for (size_t i = k0; i < n; i++) {
+    const double *li = L->data + i * L->stride;
+    for (size_t j = i + 1; j < n; j++)
+      L->data[j * L->stride + i] = li[j];
+  }
+}
+
+/* chol_update_block(): update the cholesky decomposition of a symmetric
+ * positive definite matrix to reflect the application of a block of
+ * symmetric rank-one updates, held in the rows of a matrix.
+ *
+ * each column of the factor receives every update before moving to the
+ * next column, and works from the transposed factor in the upper
+ * triangle, where the columns are contiguous. the lower triangle is
+ * only mirrored once, over the columns that were modified.
+ *
+ * arguments:
+ *  @L: cholesky factors of the matrix.
+ *  @X: matrix of update row vectors to apply, overwritten.
+ */
+void chol_update_block (Matrix *L, Matrix *X) {
+  /* locally store the factor size, and the first modified column. */
+  const size_t n = L->cols;
+  size_t kmin = n;
+
+  /* perform updating column-wise. */
+  for (size_t k = 0; k < n; k++) {
+    /* lk := L(k+1 : n, k), held transposed in the upper triangle. */
+    VectorView lk = matrix_subrow(L, k, k + 1, n - k - 1);
+
+    /* loop over the update vectors. */
+    for (size_t r = 0; r < X->rows; r++) {
+      /* get the relevant quantities, and skip identity rotations. */
+      const double Lkk = matrix_get(L, k, k);
+      const double xk = matrix_get(X, r, k);
+      if (xk == 0.0)
+        continue;
+
+      /* compute scale factors for the column update. */
+      const double rk = sqrt(Lkk * Lkk + xk * xk);
+      const double s = xk / Lkk;
+      const double c = rk / Lkk;
+
+      /* update the matrix diagonal. */
+      matrix_set(L, k, k, rk);
+
+      /* yk := x(k+1 : n) */
+      VectorView yk = matrix_subrow(X, r, k + 1, n - k - 1);
+
+      /* lk <- (lk + s yk) / c */
+      blas_daxpy(s, &yk, &lk);
+      blas_dscal(1.0 / c, &lk);
+
+      /* yk <- c yk - s lk */
+      blas_daxpy(-s / c, &lk, &yk);
+      blas_dscal(c, &yk);
+
+      /* track the first modified column. */
+      if (k < kmin)
+        kmin = k;
+    }
+  }
+
+  /* mirror the modified columns into the lower triangle. */
+  chol_mirror(L, kmin);
+}
+
+/* chol_downdate_block(): update the cholesky decomposition of a symmetric
+ * positive definite matrix to reflect the application of a block of
+ * symmetric rank-one downdates, held in the rows of a matrix.
+ *  - see chol_update_block() for more information.
+ *
+ * arguments:
+ *  @L: cholesky factors of the matrix.
+ *  @Y: matrix of downdate row vectors to apply, overwritten.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the downdates preserved
+ *  positive definiteness. on failure, the factors are left invalid.
+ */
+int chol_downdate_block (Matrix *L, Matrix *Y) {
+  /* locally store the factor size, and the first modified column. */
+  const size_t n = L->cols;
+  size_t kmin = n;
+
+  /* perform downdating column-wise. */
+  for (size_t k = 0; k < n; k++) {
+    /* lk := L(k+1 : n, k), held transposed in the upper triangle. */
+    VectorView lk = matrix_subrow(L, k, k + 1, n - k - 1);
+
+    /* loop over the downdate vectors. */
+    for (size_t r = 0; r < Y->rows; r++) {
+      /* get the relevant quantities, and skip identity rotations. */
+      const double Lkk = matrix_get(L, k, k);
+      const double yk = matrix_get(Y, r, k);
+      if (yk == 0.0)
+        continue;
+
+      /* check that positive-definiteness is preserved. */
+      const double r2 = Lkk * Lkk - yk * yk;
+      if (r2 <= 0.0)
+        return 0;
+
+      /* compute scale factors for the column update. */
+      const double rk = sqrt(r2);
+      const double s = yk / Lkk;
+      const double c = rk / Lkk;
+
+      /* update the matrix diagonal. */
+      matrix_set(L, k, k, rk);
+
+      /* zk := y(k+1 : n) */
+      VectorView zk = matrix_subrow(Y, r, k + 1, n - k - 1);
+
+      /* lk <- (lk - s zk) / c */
+      blas_daxpy(-s, &zk, &lk);
+      blas_dscal(1.0 / c, &lk);
+
+      /* zk <- c zk - s lk */
+      blas_daxpy(-s / c, &lk, &zk);
+      blas_dscal(c, &zk);
+
+      /* track the first modified column. */
+      if (k < kmin)
+        kmin = k;
+    }
+  }
+
+  /* mirror the modified columns into the lower triangle. */
+  chol_mirror(L, kmin);
+
+  /* return success. */
+  return 1;
+}
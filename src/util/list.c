@@ -58,10 +58,60 @@ PyList_FromMatrix (const Matrix *A) {
   return lst;
 }
 
+/* list_get_buffer(): attempt to access the contents of an object as
+ * a contiguous buffer of real numbers.
+ *
+ * arguments:
+ *  @obj: object to access.
+ *  @view: pointer to the buffer view to fill.
+ *  @ndim: required number of buffer dimensions.
+ *
+ * returns:
+ *  integer indicating whether (1) or not (0) the buffer was obtained.
+ *  on failure, no python exception is set.
+ */
+static int list_get_buffer (PyObject *obj, Py_buffer *view, int ndim) {
+  /* check that the object supports the buffer protocol. */
+  if (!PyObject_CheckBuffer(obj))
+    return 0;
+
+  /* request a contiguous buffer. */
+  if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT)) {
+    PyErr_Clear();
+    return 0;
+  }
+
+  /* check that the buffer holds native doubles of the correct shape. */
+  const char *fmt = view->format;
+  if (fmt && (fmt[0] == '@' || fmt[0] == '='))
+    fmt++;
+
+  if (!fmt || strcmp(fmt, "d") || view->ndim != ndim ||
+      view->itemsize != sizeof(double)) {
+    PyBuffer_Release(view);
+    return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
 /* PySequence_AsVector(): create a vector from a PySequence object.
  */
 Vector*
 PySequence_AsVector (PyObject *pyseq) {
+  /* copy the contents of buffers of doubles directly. */
+  Py_buffer view;
+  if (list_get_buffer(pyseq, &view, 1)) {
+    const size_t n = view.shape[0];
+    Vector *x = (n ? vector_alloc(n) : NULL);
+    if (x)
+      memcpy(x->data, view.buf, n * sizeof(double));
+
+    PyBuffer_Release(&view);
+    return x;
+  }
+
   /* fail if the input object is not a sequence. */
   if (!PySequence_Check(pyseq))
     return NULL;
@@ -107,6 +157,18 @@ PySequence_AsVector (PyObject *pyseq) {
  */
 Matrix*
 PySequence_AsMatrix (PyObject *pyseq) {
+  /* copy the contents of buffers of doubles directly. */
+  Py_buffer view;
+  if (list_get_buffer(pyseq, &view, 2)) {
+    const size_t n1 = view.shape[0], n2 = view.shape[1];
+    Matrix *A = (n1 && n2 ? matrix_alloc(n1, n2) : NULL);
+    if (A)
+      memcpy(A->data, view.buf, n1 * n2 * sizeof(double));
+
+    PyBuffer_Release(&view);
+    return A;
+  }
+
   /* fail if the input object is not a sequence. */
   if (!PySequence_Check(pyseq))
     return NULL;
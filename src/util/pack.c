@@ -0,0 +1,411 @@
+
+/* include the vfl header. */
+#include <vfl/vfl.h>
+
+/* pack_init(): initialize an empty packed buffer for writing.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to initialize.
+ */
+void pack_init (Pack *pk) {
+  /* initialize the buffer contents. */
+  pk->buf = NULL;
+  pk->len = pk->cap = pk->pos = 0;
+}
+
+/* pack_view(): initialize a packed buffer for reading from borrowed
+ * memory, which is never modified or freed through the buffer.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to initialize.
+ *  @buf: memory to read from.
+ *  @len: number of bytes available for reading.
+ */
+void pack_view (Pack *pk, const char *buf, size_t len) {
+  /* initialize the buffer contents. */
+  pk->buf = (char*) buf;
+  pk->len = len;
+  pk->cap = pk->pos = 0;
+}
+
+/* pack_free(): free the contents of an owned packed buffer.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to free.
+ */
+void pack_free (Pack *pk) {
+  /* free owned contents and reset the buffer. */
+  if (pk->cap)
+    free(pk->buf);
+
+  pack_init(pk);
+}
+
+/* pack_write(): append bytes to a packed buffer, growing its storage
+ * geometrically as required.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to modify.
+ *  @src: bytes to append, or null to append zeros.
+ *  @n: number of bytes to append.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_write (Pack *pk, const void *src, size_t n) {
+  /* grow the buffer, if required. */
+  if (pk->len + n > pk->cap) {
+    size_t cap = (pk->cap ? 2 * pk->cap : 256);
+    while (cap < pk->len + n)
+      cap *= 2;
+
+    char *buf = realloc(pk->buf, cap);
+    if (!buf)
+      return 0;
+
+    pk->buf = buf;
+    pk->cap = cap;
+  }
+
+  /* append the bytes. */
+  if (src)
+    memcpy(pk->buf + pk->len, src, n);
+  else
+    memset(pk->buf + pk->len, 0, n);
+
+  /* advance the length and return success. */
+  pk->len += n;
+  return 1;
+}
+
+/* pack_write_align(): pad a packed buffer with zeros up to the next
+ * multiple of PACK_ALIGN bytes.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to modify.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_write_align (Pack *pk) {
+  /* append the required number of zeros. */
+  const size_t rem = pk->len % PACK_ALIGN;
+  return (rem ? pack_write(pk, NULL, PACK_ALIGN - rem) : 1);
+}
+
+/* pack_write_size(): append a size to a packed buffer, as a 64-bit
+ * unsigned integer.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to modify.
+ *  @v: value to append.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_write_size (Pack *pk, size_t v) {
+  /* append the widened value. */
+  const uint64_t u = v;
+  return pack_write(pk, &u, sizeof(uint64_t));
+}
+
+/* pack_write_double(): append a double to a packed buffer.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to modify.
+ *  @v: value to append.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_write_double (Pack *pk, double v) {
+  /* append the value. */
+  return pack_write(pk, &v, sizeof(double));
+}
+
+/* pack_write_string(): append a length-prefixed string to a packed
+ * buffer.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to modify.
+ *  @s: null-terminated string to append.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_write_string (Pack *pk, const char *s) {
+  /* append the length and the characters. */
+  const size_t n = strlen(s);
+  return pack_write_size(pk, n) && pack_write(pk, s, n);
+}
+
+/* pack_write_vector(): append the elements of a vector to a packed
+ * buffer. the length is not stored.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to modify.
+ *  @v: vector to append.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_write_vector (Pack *pk, const Vector *v) {
+  /* append contiguous vectors in a single copy. */
+  if (v->stride == 1)
+    return pack_write(pk, v->data, v->len * sizeof(double));
+
+  /* otherwise, append each element. */
+  for (size_t i = 0; i < v->len; i++) {
+    if (!pack_write_double(pk, vector_get(v, i)))
+      return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* pack_write_matrix(): append the elements of a matrix to a packed
+ * buffer in row-major order. the sizes are not stored.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to modify.
+ *  @A: matrix to append.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_write_matrix (Pack *pk, const Matrix *A) {
+  /* append each row. */
+  for (size_t i = 0; i < A->rows; i++) {
+    if (!pack_write(pk, A->data + i * A->stride, A->cols * sizeof(double)))
+      return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* pack_read(): consume bytes from a packed buffer.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to read.
+ *  @n: number of bytes to consume.
+ *
+ * returns:
+ *  pointer to the consumed bytes within the buffer, or null if fewer
+ *  than @n bytes remain.
+ */
+const char *pack_read (Pack *pk, size_t n) {
+  /* check that the bytes are available. */
+  if (n > pk->len - pk->pos)
+    return NULL;
+
+  /* advance the position and return the bytes. */
+  const char *ptr = pk->buf + pk->pos;
+  pk->pos += n;
+  return ptr;
+}
+
+/* pack_read_align(): skip the padding that was written into a packed
+ * buffer by pack_write_align().
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to read.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_read_align (Pack *pk) {
+  /* consume the required number of bytes. */
+  const size_t rem = pk->pos % PACK_ALIGN;
+  return (rem ? pack_read(pk, PACK_ALIGN - rem) != NULL : 1);
+}
+
+/* pack_read_size(): consume a size from a packed buffer.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to read.
+ *  @v: pointer to the output value.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_read_size (Pack *pk, size_t *v) {
+  /* consume the widened value. */
+  uint64_t u;
+  const char *ptr = pack_read(pk, sizeof(uint64_t));
+  if (!ptr)
+    return 0;
+
+  /* check that the value is representable. */
+  memcpy(&u, ptr, sizeof(uint64_t));
+  if (u > SIZE_MAX)
+    return 0;
+
+  /* store the value and return success. */
+  *v = (size_t) u;
+  return 1;
+}
+
+/* pack_read_double(): consume a double from a packed buffer.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to read.
+ *  @v: pointer to the output value.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_read_double (Pack *pk, double *v) {
+  /* consume the value. */
+  const char *ptr = pack_read(pk, sizeof(double));
+  if (!ptr)
+    return 0;
+
+  /* store the value and return success. */
+  memcpy(v, ptr, sizeof(double));
+  return 1;
+}
+
+/* pack_read_string(): consume a length-prefixed string from a packed
+ * buffer.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to read.
+ *  @s: output character array.
+ *  @n: size of the output array, including the terminator.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_read_string (Pack *pk, char *s, size_t n) {
+  /* consume the length, and check that the string fits. */
+  size_t len;
+  if (!pack_read_size(pk, &len) || len >= n)
+    return 0;
+
+  /* consume the characters. */
+  const char *ptr = pack_read(pk, len);
+  if (!ptr)
+    return 0;
+
+  /* store the terminated string and return success. */
+  memcpy(s, ptr, len);
+  s[len] = '\0';
+  return 1;
+}
+
+/* pack_read_vector(): consume the elements of a vector from a packed
+ * buffer. the vector length determines the number of elements.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to read.
+ *  @v: output vector.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_read_vector (Pack *pk, Vector *v) {
+  /* consume the elements. */
+  const char *ptr = pack_read(pk, v->len * sizeof(double));
+  if (!ptr)
+    return 0;
+
+  /* store each element. */
+  for (size_t i = 0; i < v->len; i++) {
+    double vi;
+    memcpy(&vi, ptr + i * sizeof(double), sizeof(double));
+    vector_set(v, i, vi);
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* pack_read_matrix(): consume the elements of a matrix from a packed
+ * buffer in row-major order. the matrix sizes determine the number
+ * of elements.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to read.
+ *  @A: output matrix.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_read_matrix (Pack *pk, Matrix *A) {
+  /* consume each row. */
+  for (size_t i = 0; i < A->rows; i++) {
+    VectorView ai = matrix_row(A, i);
+    if (!pack_read_vector(pk, &ai))
+      return 0;
+  }
+
+  /* return success. */
+  return 1;
+}
+
+/* pack_write_type(): append the name of the type of an object to a
+ * packed buffer.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to modify.
+ *  @obj: object whose type name is appended.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int pack_write_type (Pack *pk, const PyObject *obj) {
+  /* append the fully qualified type name. */
+  return pack_write_string(pk, Py_TYPE(obj)->tp_name);
+}
+
+/* pack_read_type(): consume a type name from a packed buffer, and
+ * resolve it within the vfl module.
+ *
+ * arguments:
+ *  @pk: pointer to the packed buffer to read.
+ *  @base: type that the resolved type must derive from.
+ *
+ * returns:
+ *  new reference to the resolved type, or null on failure.
+ */
+PyTypeObject *pack_read_type (Pack *pk, PyTypeObject *base) {
+  /* consume the type name. */
+  char name[128];
+  if (!pack_read_string(pk, name, sizeof(name)))
+    return NULL;
+
+  /* import the vfl module. */
+  PyObject *obj = PyImport_ImportModule("vfl");
+  if (!obj) {
+    PyErr_Clear();
+    return NULL;
+  }
+
+  /* resolve each component of the name. the leading component
+   * names the vfl module for core types, and a sub-module otherwise.
+   */
+  char *save = NULL;
+  char *tok = strtok_r(name, ".", &save);
+  if (tok && !strcmp(tok, "vfl"))
+    tok = strtok_r(NULL, ".", &save);
+
+  for (; tok && obj; tok = strtok_r(NULL, ".", &save)) {
+    PyObject *next = PyObject_GetAttrString(obj, tok);
+    Py_DECREF(obj);
+    obj = next;
+  }
+
+  /* check that a subtype of the base type was resolved. */
+  if (!obj || !PyType_Check(obj) ||
+      !PyType_IsSubtype((PyTypeObject*) obj, base)) {
+    PyErr_Clear();
+    Py_XDECREF(obj);
+    return NULL;
+  }
+
+  /* return the type. */
+  return (PyTypeObject*) obj;
+}
+
@@ -0,0 +1,227 @@
+
+/* include the stream header. */
+#include <vfl/util/stream.h>
+
+/* include c library headers. */
+#include <stdarg.h>
+#include <string.h>
+
+/* STREAM_CHUNK: number of pending bytes beyond which output is handed
+ * to the writer thread without waiting for a flush.
+ */
+#define STREAM_CHUNK 65536
+
+/* stream_writer(): background thread function that writes and flushes
+ * the pending output of a stream, until the stream is closed.
+ *
+ * arguments:
+ *  @arg: stream structure pointer.
+ *
+ * returns:
+ *  null pointer.
+ */
+static void *stream_writer (void *arg) {
+  /* initialize the output buffer, which is swapped with the pending
+   * buffer so that writing proceeds without holding the lock.
+   */
+  Stream *s = (Stream*) arg;
+  char *out = NULL;
+  size_t cap = 0;
+
+  /* loop until the stream is closed and drained. */
+  pthread_mutex_lock(&s->lock);
+  while (1) {
+    /* wait for pending output or closure. */
+    while (!s->ready && !s->stop)
+      pthread_cond_wait(&s->wake, &s->lock);
+
+    /* take the pending bytes. */
+    char *buf = s->buf;
+    const size_t bcap = s->cap, n = s->len;
+    s->buf = out;
+    s->cap = cap;
+    s->len = 0;
+    s->ready = 0;
+    out = buf;
+    cap = bcap;
+
+    /* break once the stream is closed and all bytes are taken. */
+    const int stop = s->stop;
+    pthread_mutex_unlock(&s->lock);
+
+    /* write and flush the taken bytes. */
+    const int err = (n && (fwrite(out, 1, n, s->fh) != n ||
+                           fflush(s->fh) != 0));
+
+    /* record any error, and check for completion. */
+    pthread_mutex_lock(&s->lock);
+    s->err |= err;
+    if (stop && !s->len)
+      break;
+  }
+
+  /* release the output buffer and return. */
+  pthread_mutex_unlock(&s->lock);
+  free(out);
+  return NULL;
+}
+
+/* stream_open(): open a new buffered output file.
+ *
+ * arguments:
+ *  @fname: filename to write to.
+ *
+ * returns:
+ *  pointer to a new stream, or null on failure.
+ */
+Stream *stream_open (const char *fname) {
+  /* allocate the stream structure. */
+  Stream *s = calloc(1, sizeof(Stream));
+  if (!s)
+    return NULL;
+
+  /* open the output file. */
+  s->fh = fopen(fname, "w");
+  if (!s->fh) {
+    free(s);
+    return NULL;
+  }
+
+  /* initialize the synchronization primitives. */
+  pthread_mutex_init(&s->lock, NULL);
+  pthread_cond_init(&s->wake, NULL);
+
+  /* start the writer thread. */
+  if (pthread_create(&s->thread, NULL, stream_writer, s)) {
+    pthread_cond_destroy(&s->wake);
+    pthread_mutex_destroy(&s->lock);
+    fclose(s->fh);
+    free(s);
+    return NULL;
+  }
+
+  /* return the new stream. */
+  return s;
+}
+
+/* stream_printf(): append formatted text to the pending output of a
+ * stream. the text is written once the stream is flushed, once enough
+ * text is pending, or once the stream is closed.
+ *
+ * arguments:
+ *  @s: stream structure pointer.
+ *  @fmt: printf-style format string.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int stream_printf (Stream *s, const char *fmt, ...) {
+  /* check the input pointers. */
+  if (!s || !fmt)
+    return 0;
+
+  /* lock the pending buffer. */
+  va_list vl;
+  int ok = 1;
+  pthread_mutex_lock(&s->lock);
+
+  /* loop until the formatted text fits. */
+  while (1) {
+    /* attempt to format the text into the available space. */
+    const size_t avail = s->cap - s->len;
+    va_start(vl, fmt);
+    const int n = vsnprintf(s->buf ? s->buf + s->len : NULL,
+                            avail, fmt, vl);
+    va_end(vl);
+
+    /* check for formatting errors. */
+    if (n < 0) {
+      ok = 0;
+      break;
+    }
+
+    /* accept the text if it fit. */
+    if ((size_t) n < avail) {
+      s->len += (size_t) n;
+      break;
+    }
+
+    /* otherwise, grow the buffer and try again. */
+    size_t cap = (s->cap ? 2 * s->cap : 4096);
+    while (cap <= s->len + (size_t) n)
+      cap *= 2;
+
+    char *buf = realloc(s->buf, cap);
+    if (!buf) {
+      ok = 0;
+      break;
+    }
+
+    s->buf = buf;
+    s->cap = cap;
+  }
+
+  /* hand large amounts of pending text to the writer. */
+  if (s->len >= STREAM_CHUNK) {
+    s->ready = 1;
+    pthread_cond_signal(&s->wake);
+  }
+
+  /* unlock the buffer and return. */
+  pthread_mutex_unlock(&s->lock);
+  return ok;
+}
+
+/* stream_flush(): request that the pending output of a stream be
+ * written and flushed. the request returns without waiting for the
+ * writer thread.
+ *
+ * arguments:
+ *  @s: stream structure pointer.
+ */
+void stream_flush (Stream *s) {
+  /* return if the stream is null. */
+  if (!s)
+    return;
+
+  /* wake the writer thread. */
+  pthread_mutex_lock(&s->lock);
+  s->ready = 1;
+  pthread_cond_signal(&s->wake);
+  pthread_mutex_unlock(&s->lock);
+}
+
+/* stream_close(): write all pending output of a stream, close its
+ * file, and free the stream.
+ *
+ * arguments:
+ *  @s: stream structure pointer.
+ *
+ * returns:
+ *  integer indicating whether all output was written (1) or not (0).
+ */
+int stream_close (Stream *s) {
+  /* return if the stream is null. */
+  if (!s)
+    return 1;
+
+  /* stop and join the writer thread. */
+  pthread_mutex_lock(&s->lock);
+  s->stop = 1;
+  pthread_cond_signal(&s->wake);
+  pthread_mutex_unlock(&s->lock);
+  pthread_join(s->thread, NULL);
+
+  /* close the file. */
+  const int ok = (fclose(s->fh) == 0 && !s->err);
+
+  /* free the stream resources. */
+  pthread_cond_destroy(&s->wake);
+  pthread_mutex_destroy(&s->lock);
+  free(s->buf);
+  free(s);
+
+  /* return the result. */
+  return ok;
+}
+
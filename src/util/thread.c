@@ -0,0 +1,358 @@
+
+/* enable posix functionality. */
+#define _POSIX_C_SOURCE 200809L
+
+/* include c library headers. */
+#include <pthread.h>
+#include <unistd.h>
+
+/* include the threading header. */
+#include <vfl/util/thread.h>
+
+/* THREAD_MAX: maximum number of threads supported by the pool.
+ */
+#define THREAD_MAX 256
+
+/* pool: persistent pool of worker threads used to execute tasks.
+ * the calling thread always executes the task as thread zero, so
+ * a pool of 'count' threads holds (count - 1) workers.
+ *
+ * members:
+ *  @lock: mutex protecting every member of the pool.
+ *  @start: condition signaled when a new task is available.
+ *  @done: condition signaled when the last worker finishes.
+ *  @workers: array of worker thread handles.
+ *  @count: configured thread count, or zero if not yet configured.
+ *  @nworkers: number of running worker threads.
+ *  @gen: generation counter, incremented once per task.
+ *  @base: generation counter value when the workers were started.
+ *  @pending: number of workers still executing the current task.
+ *  @busy: whether a task is executing or the workers are stopping.
+ *  @quit: whether the workers have been asked to exit.
+ *  @fn, @arg, @T: function, argument and thread count of the task.
+ */
+static struct {
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+
+  pthread_t workers[THREAD_MAX];
+  size_t count, nworkers;
+  size_t gen, base, pending;
+  int busy, quit;
+
+  thread_fn fn;
+  void *arg;
+  size_t T;
+}
+pool = {
+  PTHREAD_MUTEX_INITIALIZER,
+  PTHREAD_COND_INITIALIZER,
+  PTHREAD_COND_INITIALIZER
+};
+
+/* pool_atfork: registration state of the fork handlers of the pool.
+ */
+static pthread_once_t pool_atfork = PTHREAD_ONCE_INIT;
+
+/* thread_fork_prepare(): hold the pool lock across a fork, so that the
+ * child never inherits it in a locked state.
+ */
+static void thread_fork_prepare (void) {
+  pthread_mutex_lock(&pool.lock);
+}
+
+/* thread_fork_parent(): release the pool lock in the parent process
+ * after a fork.
+ */
+static void thread_fork_parent (void) {
+  pthread_mutex_unlock(&pool.lock);
+}
+
+/* thread_fork_child(): reset the pool in the child process after a
+ * fork. the child does not inherit the worker threads, so the pool
+ * is marked as empty and idle, and new workers are started on the
+ * next task.
+ */
+static void thread_fork_child (void) {
+  /* re-initialize the lock and conditions. */
+  pthread_mutex_init(&pool.lock, NULL);
+  pthread_cond_init(&pool.start, NULL);
+  pthread_cond_init(&pool.done, NULL);
+
+  /* reset the pool state, keeping the configured count. */
+  pool.nworkers = 0;
+  pool.pending = 0;
+  pool.busy = 0;
+  pool.quit = 0;
+}
+
+/* thread_atfork(): register the fork handlers of the pool.
+ */
+static void thread_atfork (void) {
+  pthread_atfork(thread_fork_prepare, thread_fork_parent,
+                 thread_fork_child);
+}
+
+/* thread_worker(): main function of each worker thread in the pool.
+ *
+ * arguments:
+ *  @ptr: thread index, cast to a pointer.
+ *
+ * returns:
+ *  null pointer.
+ */
+static void *thread_worker (void *ptr) {
+  /* get the thread index and the task generation at startup. */
+  const size_t tid = (size_t) ptr;
+  pthread_mutex_lock(&pool.lock);
+  size_t gen = pool.base;
+
+  /* loop until the pool is shut down. */
+  while (1) {
+    /* wait for a new task, or for the shutdown signal. */
+    while (pool.gen == gen && !pool.quit)
+      pthread_cond_wait(&pool.start, &pool.lock);
+
+    /* exit if requested. */
+    if (pool.quit)
+      break;
+
+    /* copy the task information. */
+    gen = pool.gen;
+    thread_fn fn = pool.fn;
+    void *arg = pool.arg;
+    const size_t T = pool.T;
+    pthread_mutex_unlock(&pool.lock);
+
+    /* execute the task, if this thread participates in it. */
+    if (tid < T)
+      fn(arg, tid, T);
+
+    /* signal completion of the task. */
+    pthread_mutex_lock(&pool.lock);
+    if (--pool.pending == 0)
+      pthread_cond_signal(&pool.done);
+  }
+
+  /* release the lock and exit. */
+  pthread_mutex_unlock(&pool.lock);
+  return NULL;
+}
+
+/* thread_default_count(): determine the default number of threads,
+ * either from the environment or from the number of online processors.
+ *
+ * returns:
+ *  default thread count.
+ */
+static size_t thread_default_count (void) {
+  /* check for a thread count in the environment. */
+  const char *env = getenv("VFL_NUM_THREADS");
+  long n = (env ? strtol(env, NULL, 10) : 0);
+
+  /* fall back to the number of online processors. */
+  if (n < 1)
+    n = sysconf(_SC_NPROCESSORS_ONLN);
+
+  /* bound the count to the supported range. */
+  if (n < 1) n = 1;
+  if (n > THREAD_MAX) n = THREAD_MAX;
+
+  /* return the computed count. */
+  return (size_t) n;
+}
+
+/* thread_stop(): stop all workers of the thread pool. the pool lock
+ * must be held by the caller, and no task may be executing. the pool
+ * is marked as busy while the lock is released to join the workers,
+ * so that tasks submitted meanwhile are executed serially instead of
+ * being published to exiting workers.
+ */
+static void thread_stop (void) {
+  /* signal the workers to exit. */
+  const size_t nworkers = pool.nworkers;
+  pool.busy = 1;
+  pool.quit = 1;
+  pthread_cond_broadcast(&pool.start);
+
+  /* wait for each worker to exit. */
+  pthread_mutex_unlock(&pool.lock);
+  for (size_t i = 0; i < nworkers; i++)
+    pthread_join(pool.workers[i], NULL);
+
+  /* reset the pool state. */
+  pthread_mutex_lock(&pool.lock);
+  pool.nworkers = 0;
+  pool.quit = 0;
+  pool.busy = 0;
+}
+
+/* thread_start(): start the workers of the thread pool. the pool lock
+ * must be held by the caller. if any worker fails to start, the pool
+ * simply runs with fewer threads.
+ */
+static void thread_start (void) {
+  /* configure the thread count, if required. */
+  if (pool.count == 0)
+    pool.count = thread_default_count();
+
+  /* reset the pool in child processes forked while it runs. */
+  pthread_once(&pool_atfork, thread_atfork);
+
+  /* start the workers. */
+  pool.base = pool.gen;
+  while (pool.nworkers + 1 < pool.count) {
+    void *ptr = (void*) (pool.nworkers + 1);
+    if (pthread_create(pool.workers + pool.nworkers, NULL,
+                       thread_worker, ptr) != 0)
+      break;
+
+    pool.nworkers++;
+  }
+}
+
+/* thread_get_count(): get the number of threads used for parallel
+ * tasks, including the calling thread.
+ *
+ * returns:
+ *  thread count.
+ */
+size_t thread_get_count (void) {
+  /* lock the pool and configure the count, if required. */
+  pthread_mutex_lock(&pool.lock);
+  if (pool.count == 0)
+    pool.count = thread_default_count();
+
+  /* read the count and unlock the pool. */
+  const size_t count = pool.count;
+  pthread_mutex_unlock(&pool.lock);
+
+  /* return the count. */
+  return count;
+}
+
+/* thread_set_count(): set the number of threads used for parallel
+ * tasks, including the calling thread. any running workers are
+ * stopped, and new workers are started on the next task.
+ *
+ * arguments:
+ *  @count: new thread count, or zero for the default count.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+int thread_set_count (size_t count) {
+  /* check the thread count. */
+  if (count > THREAD_MAX)
+    return 0;
+
+  /* lock the pool and check that no task is executing. */
+  pthread_mutex_lock(&pool.lock);
+  if (pool.busy) {
+    pthread_mutex_unlock(&pool.lock);
+    return 0;
+  }
+
+  /* stop the current workers and store the new count. */
+  thread_stop();
+  pool.count = (count ? count : thread_default_count());
+
+  /* unlock the pool and return success. */
+  pthread_mutex_unlock(&pool.lock);
+  return 1;
+}
+
+/* thread_plan(): determine the number of threads that should be used
+ * to process a set of items.
+ *
+ * arguments:
+ *  @N: number of items to process.
+ *  @grain: minimum number of items to process per thread.
+ *
+ * returns:
+ *  thread count, at least one.
+ */
+size_t thread_plan (size_t N, size_t grain) {
+  /* compute the largest useful number of threads. */
+  const size_t Tmax = (grain ? N / grain : N);
+  const size_t count = thread_get_count();
+
+  /* return the bounded thread count. */
+  if (Tmax < 1) return 1;
+  return (Tmax < count ? Tmax : count);
+}
+
+/* thread_range(): compute the contiguous range of items processed by
+ * a thread. the ranges depend only on the item and thread counts, so
+ * per-thread results may be reduced deterministically.
+ *
+ * arguments:
+ *  @N: number of items to process.
+ *  @tid: thread index.
+ *  @T: thread count.
+ *  @i0: pointer to the output first item index.
+ *  @i1: pointer to the output end (last + 1) item index.
+ */
+void thread_range (size_t N, size_t tid, size_t T,
+                   size_t *i0, size_t *i1) {
+  /* divide the items as evenly as possible. */
+  *i0 = (N * tid) / T;
+  *i1 = (N * (tid + 1)) / T;
+}
+
+/* thread_execute(): execute a task on a set of threads, and wait for
+ * all threads to finish. if the pool is already executing a task (e.g.
+ * in a nested call, or from another thread), or if it cannot supply
+ * the requested threads, the task is executed serially by the caller
+ * with the same thread indices.
+ *
+ * arguments:
+ *  @fn: function to execute in each thread.
+ *  @arg: task argument pointer.
+ *  @T: number of threads, usually from thread_plan().
+ */
+void thread_execute (thread_fn fn, void *arg, size_t T) {
+  /* handle single-threaded tasks directly. */
+  if (T <= 1) {
+    fn(arg, 0, 1);
+    return;
+  }
+
+  /* lock the pool and start the workers, if required. */
+  pthread_mutex_lock(&pool.lock);
+  if (!pool.busy && pool.nworkers == 0)
+    thread_start();
+
+  /* execute serially if the pool is unavailable. */
+  if (pool.busy || pool.nworkers + 1 < T) {
+    pthread_mutex_unlock(&pool.lock);
+    for (size_t tid = 0; tid < T; tid++)
+      fn(arg, tid, T);
+
+    return;
+  }
+
+  /* publish the task to the workers. */
+  pool.busy = 1;
+  pool.fn = fn;
+  pool.arg = arg;
+  pool.T = T;
+  pool.pending = pool.nworkers;
+  pool.gen++;
+  pthread_cond_broadcast(&pool.start);
+  pthread_mutex_unlock(&pool.lock);
+
+  /* execute the first portion of the task. */
+  fn(arg, 0, T);
+
+  /* wait for the workers to finish. */
+  pthread_mutex_lock(&pool.lock);
+  while (pool.pending)
+    pthread_cond_wait(&pool.done, &pool.lock);
+
+  /* mark the pool as idle. */
+  pool.busy = 0;
+  pthread_mutex_unlock(&pool.lock);
+}
+
@@ -15,6 +15,8 @@ int Model_Type_init (PyObject *mod);
 int Optim_Type_init (PyObject *mod);
 int Datum_Type_init (PyObject *mod);
 int Data_Type_init (PyObject* mod);
+int Array_Type_init (PyObject *mod);
+int Profile_Type_init (PyObject *mod);
 
 /* define documentation strings: */
 
@@ -26,6 +28,304 @@ PyDoc_STRVAR(
 "including data, factors, models, and optimizers.\n"
 );
 
+PyDoc_STRVAR(
+  vfl_get_threads_doc,
+"get_threads() -> int\n"
+"\n"
+"Return the number of threads used for parallel computations.\n"
+);
+
+PyDoc_STRVAR(
+  vfl_set_threads_doc,
+"set_threads(n)\n"
+"\n"
+"Set the number of threads used for parallel computations.\n"
+"A value of zero restores the default, which is read from the\n"
+"VFL_NUM_THREADS environment variable or the processor count.\n"
+);
+
+PyDoc_STRVAR(
+  vfl_get_blas_threads_doc,
+"get_blas_threads() -> int\n"
+"\n"
+"Return the number of threads used within each call to the linear\n"
+"algebra backend, or zero if the backend does not report it.\n"
+);
+
+PyDoc_STRVAR(
+  vfl_set_blas_threads_doc,
+"set_blas_threads(n)\n"
+"\n"
+"Set the number of threads used within each call to the linear\n"
+"algebra backend. A value of one avoids oversubscription when the\n"
+"backend is called from the threads set by set_threads().\n"
+);
+
+PyDoc_STRVAR(
+  vfl_bench_factor_doc,
+"bench_factor(factor, data, op, reps=1) -> (float, int)\n"
+"\n"
+"Time repeated passes of a factor function over a dataset, returning\n"
+"the elapsed seconds and the number of function evaluations. The op\n"
+"is one of 'mean', 'var', 'cov', 'diff_mean', 'diff_var', 'mean_all'\n"
+"or 'var_all'.\n"
+);
+
+PyDoc_STRVAR(
+  vfl_bench_model_doc,
+"bench_model(model, op, reps=1) -> (float, int)\n"
+"\n"
+"Time repeated evaluations of a model function, returning the elapsed\n"
+"seconds and the number of function evaluations. The op is one of\n"
+"'infer', 'update' (once per factor) or 'bound'.\n"
+);
+
+PyDoc_STRVAR(
+  vfl_profile_doc,
+"profile() -> Profile\n"
+"\n"
+"Create a context that counts the calls to the mean, var, cov,\n"
+"diff_mean, diff_var and meanfield functions of every factor, and the\n"
+"cycles spent within them, while it is active:\n"
+"\n"
+"  with vfl.profile() as prof:\n"
+"    opt.execute()\n"
+"  print(prof)\n"
+);
+
+/* --- */
+
+/* bench_factor_ops, bench_model_ops: names of the functions that may
+ * be timed by vfl_bench_factor() and vfl_bench_model(), in the order
+ * of their enumerations.
+ */
+static const char *bench_factor_ops[] = {
+  "mean", "var", "cov", "diff_mean", "diff_var", "mean_all", "var_all",
+  NULL
+};
+static const char *bench_model_ops[] = {
+  "infer", "update", "bound",
+  NULL
+};
+
+/* bench_op(): look up a benchmarked function by name.
+ *
+ * arguments:
+ *  @names: null-terminated array of function names.
+ *  @name: name to look up.
+ *
+ * returns:
+ *  index of the name in the array, or -1 if it was not found.
+ */
+static int bench_op (const char **names, const char *name) {
+  /* search the array for the name. */
+  for (int i = 0; names[i]; i++) {
+    if (!strcmp(names[i], name))
+      return i;
+  }
+
+  /* the name was not found. */
+  PyErr_Format(PyExc_ValueError, "unknown benchmark function '%s'", name);
+  return -1;
+}
+
+/* vfl_get_threads(): get the number of threads used by vfl.
+ */
+static PyObject*
+vfl_get_threads (PyObject *self, PyObject *args) {
+  /* return the thread count. */
+  return PyLong_FromSize_t(thread_get_count());
+}
+
+/* vfl_set_threads(): set the number of threads used by vfl.
+ */
+static PyObject*
+vfl_set_threads (PyObject *self, PyObject *args) {
+  /* parse the thread count. */
+  Py_ssize_t n;
+  if (!PyArg_ParseTuple(args, "n", &n))
+    return NULL;
+
+  /* check the thread count. */
+  if (n < 0) {
+    PyErr_SetString(PyExc_ValueError, "expected non-negative thread count");
+    return NULL;
+  }
+
+  /* set the thread count. */
+  if (!thread_set_count((size_t) n)) {
+    PyErr_SetString(PyExc_RuntimeError, "failed to set thread count");
+    return NULL;
+  }
+
+  /* return nothing. */
+  Py_RETURN_NONE;
+}
+
+/* vfl_get_blas_threads(): get the number of threads used by the
+ * linear algebra backend.
+ */
+static PyObject*
+vfl_get_blas_threads (PyObject *self, PyObject *args) {
+  /* return the thread count. */
+  return PyLong_FromSize_t(blas_get_threads());
+}
+
+/* vfl_set_blas_threads(): set the number of threads used by the
+ * linear algebra backend.
+ */
+static PyObject*
+vfl_set_blas_threads (PyObject *self, PyObject *args) {
+  /* parse the thread count. */
+  Py_ssize_t n;
+  if (!PyArg_ParseTuple(args, "n", &n))
+    return NULL;
+
+  /* check the thread count. */
+  if (n <= 0) {
+    PyErr_SetString(PyExc_ValueError, "expected positive thread count");
+    return NULL;
+  }
+
+  /* set the thread count. */
+  if (!blas_set_threads((size_t) n)) {
+    PyErr_Format(PyExc_RuntimeError,
+                 "thread count of the '%s' backend cannot be set to %zd",
+                 blas_backend(), n);
+    return NULL;
+  }
+
+  /* return nothing. */
+  Py_RETURN_NONE;
+}
+
+/* vfl_bench_factor(): time repeated passes of a factor function
+ * over a dataset.
+ */
+static PyObject*
+vfl_bench_factor (PyObject *self, PyObject *args, PyObject *kwargs) {
+  /* parse the arguments. */
+  static char *kwlist[] = { "factor", "data", "op", "reps", NULL };
+  PyObject *f, *dat;
+  const char *name;
+  Py_ssize_t reps = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!s|n", kwlist,
+                                   &Factor_Type, &f, &Data_Type, &dat,
+                                   &name, &reps))
+    return NULL;
+
+  /* look up the function. */
+  const int op = bench_op(bench_factor_ops, name);
+  if (op < 0)
+    return NULL;
+
+  /* check the repetition count. */
+  if (reps <= 0) {
+    PyErr_SetString(PyExc_ValueError, "expected positive repetitions");
+    return NULL;
+  }
+
+  /* run the benchmark. */
+  double sec;
+  size_t evals;
+  if (!bench_factor((Factor*) f, (Data*) dat, (BenchFactorOp) op,
+                    (size_t) reps, &sec, &evals)) {
+    PyErr_Format(PyExc_RuntimeError, "failed to benchmark factor '%s'",
+                 name);
+    return NULL;
+  }
+
+  /* return the elapsed time and evaluation count. */
+  return Py_BuildValue("(dn)", sec, (Py_ssize_t) evals);
+}
+
+/* vfl_bench_model(): time repeated evaluations of a model function.
+ */
+static PyObject*
+vfl_bench_model (PyObject *self, PyObject *args, PyObject *kwargs) {
+  /* parse the arguments. */
+  static char *kwlist[] = { "model", "op", "reps", NULL };
+  PyObject *mdl;
+  const char *name;
+  Py_ssize_t reps = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!s|n", kwlist,
+                                   &Model_Type, &mdl, &name, &reps))
+    return NULL;
+
+  /* look up the function. */
+  const int op = bench_op(bench_model_ops, name);
+  if (op < 0)
+    return NULL;
+
+  /* check the repetition count. */
+  if (reps <= 0) {
+    PyErr_SetString(PyExc_ValueError, "expected positive repetitions");
+    return NULL;
+  }
+
+  /* run the benchmark. */
+  double sec;
+  size_t evals;
+  if (!bench_model((Model*) mdl, (BenchModelOp) op, (size_t) reps,
+                   &sec, &evals)) {
+    PyErr_Format(PyExc_RuntimeError, "failed to benchmark model '%s'",
+                 name);
+    return NULL;
+  }
+
+  /* return the elapsed time and evaluation count. */
+  return Py_BuildValue("(dn)", sec, (Py_ssize_t) evals);
+}
+
+/* vfl_profile(): create a factor profiling context.
+ */
+static PyObject*
+vfl_profile (PyObject *self) {
+  /* return a new profile. */
+  return PyObject_CallObject((PyObject*) &Profile_Type, NULL);
+}
+
+/* vfl_methods: array of functions in the vfl module.
+ */
+static PyMethodDef vfl_methods[] = {
+  { "get_threads",
+    (PyCFunction) vfl_get_threads,
+    METH_NOARGS,
+    vfl_get_threads_doc
+  },
+  { "set_threads",
+    (PyCFunction) vfl_set_threads,
+    METH_VARARGS,
+    vfl_set_threads_doc
+  },
+  { "get_blas_threads",
+    (PyCFunction) vfl_get_blas_threads,
+    METH_NOARGS,
+    vfl_get_blas_threads_doc
+  },
+  { "set_blas_threads",
+    (PyCFunction) vfl_set_blas_threads,
+    METH_VARARGS,
+    vfl_set_blas_threads_doc
+  },
+  { "bench_factor",
+    (PyCFunction) vfl_bench_factor,
+    METH_VARARGS | METH_KEYWORDS,
+    vfl_bench_factor_doc
+  },
+  { "bench_model",
+    (PyCFunction) vfl_bench_model,
+    METH_VARARGS | METH_KEYWORDS,
+    vfl_bench_model_doc
+  },
+  { "profile",
+    (PyCFunction) vfl_profile,
+    METH_NOARGS,
+    vfl_profile_doc
+  },
+  { NULL, NULL, 0, NULL }
+};
+
 /* vfl_module: module definition structure for vfl core types.
  */
 static PyModuleDef vfl_module = {
@@ -33,7 +333,7 @@ static PyModuleDef vfl_module = {
   "vfl",                                         /* m_name     */
   vfl_module_doc,                                /* m_doc      */
   -1,                                            /* m_size     */
-  NULL,                                          /* m_methods  */
+  vfl_methods,                                   /* m_methods  */
   NULL,                                          /* m_slots    */
   NULL,                                          /* m_traverse */
   NULL,                                          /* m_clear    */
@@ -49,13 +349,19 @@ PyInit_vfl (void) {
   if (!vfl)
     return NULL;
 
+  /* store the name of the linear algebra backend. */
+  if (PyModule_AddStringConstant(vfl, "blas", blas_backend()) < 0)
+    return NULL;
+
   /* intialize the core module types. */
   if (Search_Type_init(vfl) < 0 ||
       Factor_Type_init(vfl) < 0 ||
       Model_Type_init(vfl) < 0 ||
       Optim_Type_init(vfl) < 0 ||
       Datum_Type_init(vfl) < 0 ||
-      Data_Type_init(vfl) < 0)
+      Data_Type_init(vfl) < 0 ||
+      Array_Type_init(vfl) < 0 ||
+      Profile_Type_init(vfl) < 0)
     return NULL;
 
   /* initialize the factor sub-module. */
@@ -0,0 +1,69 @@
+import unittest, os, sys, json, subprocess, tempfile
+import vfl
+
+# locate the benchmark script.
+script = os.path.join(os.path.dirname(os.path.dirname(
+                      os.path.abspath(__file__))), 'scripts', 'bench.py')
+
+# run the benchmark script, returning its exit status.
+def bench(*args):
+  return subprocess.run([sys.executable, script] + list(args),
+                        stdout = subprocess.DEVNULL,
+                        stderr = subprocess.DEVNULL).returncode
+
+# unit tests for the benchmark suite.
+class TestBench(unittest.TestCase):
+  def setUp(self):
+    self.dir = tempfile.TemporaryDirectory()
+    self.file = os.path.join(self.dir.name, 'base.json')
+
+  def tearDown(self):
+    self.dir.cleanup()
+
+  def test_results(self):
+    # run a reduced set of benchmarks.
+    self.assertEqual(bench('--quick', '--repeat', '1',
+                           '--only', 'example/sinc/*',
+                           '--output', self.file), 0)
+
+    # every requested benchmark should have been timed.
+    with open(self.file) as fh:
+      out = json.load(fh)
+
+    names = [r['name'] for r in out['results']]
+    for op in ('infer', 'update', 'predict', 'search'):
+      self.assertIn('example/sinc/' + op, names)
+
+    for r in out['results']:
+      self.assertTrue(r['name'].startswith('example/sinc/'))
+      self.assertGreater(r['per_eval'], 0)
+
+  def test_compare(self):
+    # write a baseline of a single benchmark.
+    self.assertEqual(bench('--quick', '--repeat', '1',
+                           '--only', 'example/sinc/infer',
+                           '--output', self.file), 0)
+
+    # results should not regress against themselves.
+    self.assertEqual(bench('--compare', self.file,
+                           '--results', self.file), 0)
+
+    # slower results should be reported.
+    with open(self.file) as fh:
+      out = json.load(fh)
+
+    for r in out['results']:
+      r['seconds'] *= 2
+      r['per_eval'] *= 2
+
+    slow = os.path.join(self.dir.name, 'slow.json')
+    with open(slow, 'w') as fh:
+      json.dump(out, fh)
+
+    self.assertEqual(bench('--compare', self.file,
+                           '--results', slow), 1)
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
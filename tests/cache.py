@@ -0,0 +1,92 @@
+import unittest
+import vfl
+from tests.common import TestCase, data, factors
+
+# factors with a product.
+def product():
+  return [vfl.factor.Polynomial(order = 2),
+          vfl.factor.Impulse(mu = 3, tau = 1) *
+          vfl.factor.Cosine(mu = 1, tau = 1)]
+
+# build a model with or without a moment cache.
+def build(Typ, cache, factors, classes = False, **kwargs):
+  mdl = Typ(data = data(0, 200, classes), factors = factors(),
+            nu = 1e-3, **kwargs)
+  if cache is not None:
+    mdl.cache = cache
+
+  return mdl
+
+# prediction locations.
+xs = [[0.37 * i] for i in range(30)]
+
+# unit tests for the moment cache.
+class TestCache(TestCase):
+  def assertSameModel(self, mdlA, mdlB):
+    # compare the bounds, weights and predictions of two models.
+    self.assertClose(mdlA.bound, mdlB.bound)
+    for a, b in zip(mdlA.wbar, mdlB.wbar):
+      self.assertClose(a, b)
+
+    muA, etaA = mdlA.predict(x = xs)
+    muB, etaB = mdlB.predict(x = xs)
+    for a, b in zip(list(muA) + list(etaA), list(muB) + list(etaB)):
+      self.assertClose(a, b)
+
+  def pair(self, Typ = vfl.model.VFR, factors = product, classes = False):
+    # build a cached and an uncached model.
+    kwargs = {}
+    if Typ is vfl.model.VFR:
+      kwargs = {'alpha0': 10, 'beta0': 10}
+
+    return (build(Typ, None, factors, classes, **kwargs),
+            build(Typ, 0, factors, classes, **kwargs))
+
+  def test_infer(self):
+    # cached inference should match uncached inference.
+    for Typ, classes in ((vfl.model.VFR, False), (vfl.model.VFC, True)):
+      cached, fresh = self.pair(Typ, classes = classes)
+      self.assertGreater(cached.cache, 0)
+      cached.infer()
+      fresh.infer()
+      self.assertSameModel(cached, fresh)
+
+  def test_optimize(self):
+    # cached optimization should match uncached optimization.
+    for Opt in (vfl.optim.FullGradient, vfl.optim.MeanField):
+      cached, fresh = self.pair(factors = factors)
+      for mdl in (cached, fresh):
+        opt = Opt(model = mdl, max_iters = 5)
+        opt.execute()
+
+      self.assertSameModel(cached, fresh)
+      self.assertClose(cached[1].mu, fresh[1].mu)
+      self.assertClose(cached[2].mu, fresh[2].mu)
+
+  def test_modified(self):
+    # cached moments of modified factors should not be reused.
+    cached, fresh = self.pair()
+    cached.infer()
+    cached[1][0].mu = 4
+    cached[1].update()
+    fresh[1][0].mu = 4
+    fresh[1].update()
+    cached.infer()
+    fresh.infer()
+    self.assertSameModel(cached, fresh)
+
+  def test_augment(self):
+    # cached moments of modified datasets should not be reused.
+    cached, fresh = self.pair()
+    cached.infer()
+    for mdl in (cached, fresh):
+      x = memoryview(data(200, 220).x).tolist()
+      mdl.data.augment(x = x, y = [0.5] * len(x))
+      mdl.infer()
+
+    self.assertSameModel(cached, fresh)
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
@@ -0,0 +1,63 @@
+import unittest, math
+import vfl
+
+# build the locations and values of a sinusoidal dataset over a range
+# of indices. values may be thresholded into classes.
+def points(a = 0, b = 200, classes = False):
+  x = [[0.05 * i] for i in range(a, b)]
+  y = [math.sin(xi[0]) + 0.1 * xi[0] for xi in x]
+  if classes:
+    y = [float(yi > 0.5) for yi in y]
+
+  return x, y
+
+# build a sinusoidal dataset over a range of indices.
+def data(a = 0, b = 200, classes = False):
+  x, y = points(a, b, classes)
+  return vfl.Data(x = x, y = y)
+
+# factors with location and precision parameters.
+def factors():
+  return [vfl.factor.Polynomial(order = 2),
+          vfl.factor.Impulse(mu = 3, tau = 1),
+          vfl.factor.Cosine(mu = 1, tau = 1)]
+
+# build a regression model over a sinusoidal dataset.
+def regression():
+  return vfl.model.VFR(alpha0 = 10, beta0 = 10, nu = 1e-3,
+                       data = data(), factors = factors())
+
+# compute the weight precisions and projections of a model from the
+# moments of its factors at each of its observations.
+def gram(mdl, pts):
+  K = sum(f.weights for f in mdl)
+  G = [[0.0] * K for i in range(K)]
+  h = [0.0] * K
+  for d in pts:
+    # include the first moments of every weight.
+    m = [f.mean(d, k) for f in mdl for k in range(f.weights)]
+    for i in range(K):
+      h[i] += d.y * m[i]
+      for j in range(K):
+        G[i][j] += m[i] * m[j]
+
+    # include the second moments within each factor.
+    k0 = 0
+    for f in mdl:
+      for a in range(f.weights):
+        for b in range(f.weights):
+          G[k0 + a][k0 + b] += f.var(d, a, b) - m[k0 + a] * m[k0 + b]
+
+      k0 += f.weights
+
+  # include the weight prior.
+  for i in range(K):
+    G[i][i] += mdl.nu
+
+  return G, h
+
+# base class for tests that compare computed values.
+class TestCase(unittest.TestCase):
+  def assertClose(self, a, b, rel = 1e-9):
+    self.assertLessEqual(abs(a - b), rel * max(1, abs(a), abs(b)))
+
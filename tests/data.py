@@ -1,5 +1,5 @@
 
-import unittest, os
+import unittest, os, math, random, struct, tempfile
 import vfl
 
 # unit tests for vfl.Data
@@ -43,6 +43,38 @@ class TestData(unittest.TestCase):
       self.assertEqual(datA[i].x, datB[i].x)
       self.assertEqual(datA[i].y, datB[i].y)
 
+  def test_write_exact(self):
+    # build a dataset of values that need every significant digit.
+    rnd = random.Random(7)
+    x = [[rnd.uniform(-1, 1) * 10 ** rnd.randint(-300, 300)]
+         for i in range(100)]
+    y = [math.pi, 1 / 3, 0.1, -2.5e-7, 5e-324, 1.7976931348623157e308]
+    y += [rnd.gauss(0, 1) for i in range(94)]
+    datA = vfl.Data(x = x, y = y)
+
+    # text files should hold the exact values.
+    with tempfile.TemporaryDirectory() as tmp:
+      filename = os.path.join(tmp, 'data.dat')
+      datA.write(file = filename)
+      datB = vfl.Data(file = filename)
+
+    self.assertEqual(datA.x.tolist(), datB.x.tolist())
+    self.assertEqual(datA.y.tolist(), datB.y.tolist())
+
+  def test_read_oversized(self):
+    # binary files whose sizes overflow should not be read. the
+    # header below wraps around to the size of the written file.
+    dat = vfl.Data(grid = [[1, 1, 3]])
+    with tempfile.TemporaryDirectory() as tmp:
+      filename = os.path.join(tmp, 'data.dat')
+      dat.write(file = filename, binary = True)
+      with open(filename, 'r+b') as fh:
+        fh.seek(16)
+        fh.write(struct.pack('=QQ', 9, 2 ** 61 - 1))
+
+      with self.assertRaises(IOError):
+        vfl.Data(file = filename)
+
   def test_augment_from_file(self):
     # write a few temporary files.
     files = ['data.py.tmp.1', 'data.py.tmp.2', 'data.py.tmp.3']
@@ -123,6 +155,29 @@ class TestData(unittest.TestCase):
       datC = vfl.Data(grid = [[1, 1, 3], [1, 1, 3]])
       dat.augment(data = datC)
 
+  def test_augment_from_block(self):
+    # Data accept blocks of locations and values at creation.
+    dat = vfl.Data(x = [[3], [1], [2]], y = [0.3, 0.1, 0.2])
+    self.assertEqual(len(dat), 3)
+    self.assertEqual(dat.dims, 1)
+    self.assertEqual([d.x[0] for d in dat], [1, 2, 3])
+    self.assertEqual([d.y for d in dat], [0.1, 0.2, 0.3])
+
+    # blocks are sorted and merged into existing observations.
+    dat.augment(x = [[2.5], [0.5]], output = 1)
+    dat.augment(x = [[1.5], [4]])
+    self.assertEqual([d.output for d in dat], [0, 0, 0, 0, 0, 1, 1])
+    self.assertEqual([d.x[0] for d in dat], [1, 1.5, 2, 3, 4, 0.5, 2.5])
+    self.assertEqual([d.y for d in dat], [0.1, 0, 0.2, 0.3, 0, 0, 0])
+
+    # values must match the locations in count.
+    with self.assertRaises(RuntimeError):
+      dat.augment(x = [[1], [2]], y = [1])
+
+    # values require locations.
+    with self.assertRaises(ValueError):
+      dat.augment(y = [1])
+
   def test_augment_from_grid(self):
     # Data accept grids at creation.
     dat = vfl.Data(grid = [[1, 2, 5]])
@@ -171,6 +226,78 @@ class TestData(unittest.TestCase):
     with self.assertRaises(TypeError):
       dat[2] = 'baz'
 
+  def test_sequence_entries(self):
+    # values of sequence elements are written through to the data.
+    dat = vfl.Data(grid = [[1, 1, 3]])
+    for d in dat:
+      d.y = 2 * d.x[0]
+
+    self.assertEqual([e.y for e in dat], [2, 4, 6])
+
+    # locations and outputs of sequence elements are read-only.
+    d = dat[1]
+    with self.assertRaises(TypeError):
+      d.x = [9]
+    with self.assertRaises(TypeError):
+      d[0] = 9
+    with self.assertRaises(TypeError):
+      d.output = 1
+
+    self.assertEqual([e.x[0] for e in dat], [1, 2, 3])
+
+    # elements may not be written once the data have changed.
+    dat.augment(datum = vfl.Datum(output = 0, x = [0], y = 0))
+    with self.assertRaises(RuntimeError):
+      d.y = 7
+
+    self.assertEqual([e.y for e in dat], [0, 2, 4, 6])
+
+  def test_file_formats(self):
+    # Data may be written and read as text or binary files.
+    dat = vfl.Data(grid = [[0.5, 0.25, 1.5]], outputs = [0, 1])
+    dat[0] = vfl.Datum(output = 0, x = [0.1], y = -2.5e-7)
+    with tempfile.TemporaryDirectory() as tmp:
+      for binary in (False, True):
+        fname = os.path.join(tmp, 'data.dat')
+        dat.write(file = fname, binary = binary)
+        rd = vfl.Data(file = fname)
+        self.assertEqual(len(rd), len(dat))
+        self.assertEqual([d.output for d in rd], [d.output for d in dat])
+        self.assertEqual([d.x[0] for d in rd], [d.x[0] for d in dat])
+        self.assertEqual([d.y for d in rd], [d.y for d in dat])
+
+        # mapped datasets may still be modified and augmented.
+        rd.augment(datum = vfl.Datum(output = 0, x = [0], y = 1))
+        self.assertEqual(len(rd), len(dat) + 1)
+        self.assertEqual(rd[0].x[0], 0)
+
+  def test_arrays(self):
+    # Data exposes its observations as shared arrays.
+    dat = vfl.Data(grid = [[1, 1, 3]], outputs = [0, 1])
+    x = memoryview(dat.x)
+    self.assertEqual(x.shape, (6, 1))
+    self.assertEqual(x.tolist(), [[1], [2], [3], [1], [2], [3]])
+    self.assertEqual(dat.output.tolist(), [0, 0, 0, 1, 1, 1])
+    self.assertTrue(x.readonly)
+
+    # observed values are read-only, and written through entries.
+    self.assertTrue(memoryview(dat.y).readonly)
+    with self.assertRaises(TypeError):
+      dat.y[4] = 7
+
+    d = dat[4]
+    d.y = 7
+    self.assertEqual(dat.y[4], 7)
+
+    # datasets may not be resized while their arrays are alive.
+    with self.assertRaises(BufferError):
+      dat.augment(datum = vfl.Datum(output = 0, x = [0], y = 0))
+
+    x.release()
+    del x
+    dat.augment(datum = vfl.Datum(output = 0, x = [0], y = 0))
+    self.assertEqual(len(dat), 7)
+
 # when run as a script, run the unit tests.
 if __name__ == '__main__':
   unittest.main()
@@ -0,0 +1,76 @@
+import unittest, os, math, pickle, tempfile
+import vfl
+
+# build and infer a regression model.
+def build(tau = 100):
+  x = [[0.05 * i] for i in range(200)]
+  y = [math.sin(xi[0]) for xi in x]
+  dat = vfl.Data(x = x, y = y)
+  factors = [vfl.factor.Polynomial(order = 2),
+             vfl.factor.Impulse(mu = 3, tau = 1) *
+             vfl.factor.Cosine(mu = 1, tau = 1)]
+  mdl = vfl.model.TauVFR(tau = tau, nu = 1e-3, data = dat,
+                         factors = factors)
+  mdl.infer()
+  return mdl
+
+# prediction locations.
+xs = [[0.37 * i] for i in range(25)]
+
+# unit tests for model files and pickling.
+class TestModelFiles(unittest.TestCase):
+  def setUp(self):
+    self.dir = tempfile.TemporaryDirectory()
+    self.file = os.path.join(self.dir.name, 'model.bin')
+
+  def tearDown(self):
+    self.dir.cleanup()
+
+  def assertSamePredictions(self, mdlA, mdlB):
+    muA, etaA = mdlA.predict(x = xs)
+    muB, etaB = mdlB.predict(x = xs)
+    self.assertEqual(list(muA), list(muB))
+    self.assertEqual(list(etaA), list(etaB))
+
+  def test_load(self):
+    # loaded models should predict exactly as the originals.
+    mdl = build()
+    mdl.save(file = self.file)
+    loaded = vfl.model.TauVFR.load(file = self.file)
+    self.assertIsInstance(loaded, vfl.model.TauVFR)
+    self.assertSamePredictions(mdl, loaded)
+
+  def test_pickle(self):
+    # unpickled models should predict exactly as the originals.
+    mdl = build()
+    copy = pickle.loads(pickle.dumps(mdl))
+    self.assertIsInstance(copy, vfl.model.TauVFR)
+    self.assertSamePredictions(mdl, copy)
+
+  def test_overwrite(self):
+    # load a model from a file.
+    mdlA = build(tau = 100)
+    mdlA.save(file = self.file)
+    loaded = vfl.Model.load(file = self.file)
+
+    # replacing the file should not affect the loaded model.
+    mdlB = build(tau = 10)
+    mdlB.save(file = self.file)
+    self.assertSamePredictions(mdlA, loaded)
+    self.assertSamePredictions(mdlB, vfl.Model.load(file = self.file))
+
+    # no temporary files should remain.
+    self.assertEqual(os.listdir(self.dir.name), ['model.bin'])
+
+  def test_failure(self):
+    # failed saves should raise, and leave no files behind.
+    mdl = build()
+    with self.assertRaises(IOError):
+      mdl.save(file = os.path.join(self.dir.name, 'none', 'model.bin'))
+
+    self.assertEqual(os.listdir(self.dir.name), [])
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
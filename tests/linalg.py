@@ -0,0 +1,77 @@
+import unittest, math
+import vfl
+from tests.common import gram
+
+# build and infer a regression model with one hundred weights, which
+# spans several blocks of the linear algebra kernels.
+def build(N = 150, M = 50):
+  x = [[10 * i / N] for i in range(N)]
+  y = [math.sin(xi[0]) for xi in x]
+  factors = [vfl.factor.Cosine(mu = 0.1 * (j + 1), tau = 100)
+             for j in range(M)]
+  mdl = vfl.model.TauVFR(tau = 10, nu = 1e-2, data = vfl.Data(x = x, y = y),
+                         factors = factors)
+  mdl.infer()
+  return mdl
+
+# unit tests for the linear algebra kernels.
+class TestLinalg(unittest.TestCase):
+  def test_posterior(self):
+    # compute the reference precisions and projections.
+    mdl = build()
+    G, h = gram(mdl, mdl.data)
+    K = len(h)
+
+    # the weight covariance should invert the precisions.
+    Sigma = memoryview(mdl.Sigma).tolist()
+    for i in range(K):
+      for j in range(K):
+        e = sum(Sigma[i][k] * G[k][j] for k in range(K))
+        self.assertAlmostEqual(e, float(i == j), delta = 1e-9)
+
+    # the weight means should solve the projections.
+    for i in range(K):
+      e = sum(G[i][k] * wk for k, wk in enumerate(mdl.wbar))
+      self.assertAlmostEqual(e, h[i], delta = 1e-9 * max(1, abs(h[i])))
+
+  def test_backend(self):
+    # the backend should be named.
+    self.assertIn(vfl.blas, ('builtin', 'atlas', 'openblas', 'blis', 'cblas'))
+
+    # single-threaded calls should be supported by any backend that
+    # reports its thread count.
+    n = vfl.get_blas_threads()
+    if n:
+      try:
+        vfl.set_blas_threads(1)
+        self.assertEqual(vfl.get_blas_threads(), 1)
+      finally:
+        vfl.set_blas_threads(n)
+
+    # thread counts should be positive.
+    with self.assertRaises(ValueError):
+      vfl.set_blas_threads(0)
+
+  def test_threads(self):
+    # posteriors should not depend on the backend thread count.
+    n = vfl.get_blas_threads()
+    ref = build()
+    try:
+      vfl.set_blas_threads(max(2, n))
+    except RuntimeError:
+      self.skipTest('backend thread count is fixed')
+
+    try:
+      mdl = build()
+    finally:
+      vfl.set_blas_threads(max(1, n))
+
+    for a, b in zip(memoryview(mdl.Sigma).tolist(),
+                    memoryview(ref.Sigma).tolist()):
+      for u, v in zip(a, b):
+        self.assertAlmostEqual(u, v, delta = 1e-9 * max(1, abs(v)))
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
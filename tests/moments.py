@@ -0,0 +1,55 @@
+import unittest, math
+import vfl
+from tests.common import gram
+
+# build the observations of a two-dimensional dataset.
+def points(N = 120):
+  x = [[4 * i / N, math.cos(i)] for i in range(N)]
+  return [vfl.Datum(x = xi, y = math.sin(xi[0]) + 0.5 * xi[1]) for xi in x]
+
+# build a dataset from a list of observations.
+def data(pts):
+  dat = vfl.Data()
+  for d in pts:
+    dat.augment(datum = d)
+
+  return dat
+
+# factor sets to test, covering every factor type.
+def factors():
+  F = vfl.factor
+  return [[F.Polynomial(order = 3)],
+          [F.Impulse(mu = 2, tau = 1), F.FixedImpulse(mu = 1, tau = 4)],
+          [F.Cosine(mu = 1, tau = 10), F.Decay(alpha = 10, beta = 10)],
+          [F.Impulse(mu = 2, tau = 1) * F.Polynomial(dim = 1, order = 2),
+           F.Cosine(mu = 1, tau = 10) * F.Impulse(dim = 1, mu = 0, tau = 1)]]
+
+# unit tests for batched factor moments.
+class TestMoments(unittest.TestCase):
+  def test_posterior(self):
+    # posteriors built from batched moments should match posteriors
+    # built from the moments at each observation.
+    pts = points()
+    for fs in factors():
+      mdl = vfl.model.TauVFR(tau = 10, nu = 1e-2, data = data(pts),
+                             factors = fs)
+      mdl.infer()
+      G, h = gram(mdl, pts)
+      K = len(h)
+
+      # the weight covariance should invert the precisions.
+      Sigma = [list(row) for row in mdl.Sigma]
+      for i in range(K):
+        for j in range(K):
+          e = sum(Sigma[i][k] * G[k][j] for k in range(K))
+          self.assertAlmostEqual(e, float(i == j), delta = 1e-8)
+
+      # the weight means should solve the projections.
+      for i in range(K):
+        e = sum(G[i][k] * wk for k, wk in enumerate(mdl.wbar))
+        self.assertAlmostEqual(e, h[i], delta = 1e-8 * max(1, abs(h[i])))
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
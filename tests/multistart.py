@@ -0,0 +1,53 @@
+import unittest
+import vfl
+from tests.common import TestCase, regression
+
+# deterministically move the factors of a replica.
+def randomize(mdl, r):
+  mdl[1].mu = 2 + 0.5 * r
+  mdl[2].mu = 0.8 + 0.1 * r
+
+# optimizer types to test.
+types = [vfl.optim.FullGradient, vfl.optim.MeanField]
+
+# unit tests for multi-start optimization.
+class TestMultistart(TestCase):
+  def test_serial(self):
+    # each replica should match a serial optimization of its copy.
+    for Opt in types:
+      opt = Opt(model = regression(), max_iters = 10)
+      best, bounds = opt.multistart(replicas = 4, randomize = randomize)
+      for r in range(4):
+        mdl = regression()
+        randomize(mdl, r)
+        Opt(model = mdl, max_iters = 10).execute()
+        self.assertClose(bounds[r], mdl.bound)
+
+      # the best replica should be returned.
+      r = bounds.index(max(bounds))
+      mdl = regression()
+      randomize(mdl, r)
+      Opt(model = mdl, max_iters = 10).execute()
+      self.assertClose(best.bound, mdl.bound)
+      self.assertClose(best[1].mu, mdl[1].mu)
+      self.assertClose(best[2].mu, mdl[2].mu)
+      for a, b in zip(best.wbar, mdl.wbar):
+        self.assertClose(a, b)
+
+  def test_unchanged(self):
+    # the optimized model should be left unchanged.
+    mdl = regression()
+    mdl.infer()
+    wbar = list(mdl.wbar)
+    opt = vfl.optim.FullGradient(model = mdl, max_iters = 10)
+    best, bounds = opt.multistart(replicas = 4, randomize = randomize)
+    self.assertIsNot(best, mdl)
+    self.assertIs(best.data, mdl.data)
+    self.assertEqual(mdl[1].mu, 3)
+    self.assertEqual(mdl[2].mu, 1)
+    self.assertEqual(list(mdl.wbar), wbar)
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
@@ -0,0 +1,76 @@
+import unittest
+import vfl
+from tests.common import points, data
+
+# build a regression model over a range of indices.
+def build(Typ, a, b, **kwargs):
+  factors = [vfl.factor.Polynomial(order = 2),
+             vfl.factor.Impulse(mu = 3, tau = 1)]
+  return Typ(data = data(a, b), factors = factors,
+             nu = 1e-3, **kwargs)
+
+# model types and parameters to test.
+types = [(vfl.model.TauVFR, {'tau': 100}),
+         (vfl.model.VFR, {'alpha0': 10, 'beta0': 10})]
+
+# unit tests for single-observation updates.
+class TestObserve(unittest.TestCase):
+  def observe(self, mdl, a, b):
+    # observe each datum in a range.
+    x, y = points(a, b)
+    for xi, yi in zip(x, y):
+      mdl.observe(vfl.Datum(x = xi, y = yi))
+
+  def assertInferred(self, mdl, Typ, kwargs):
+    # compare a model against a fresh inference over its dataset.
+    ref = build(Typ, 0, 130, **kwargs)
+    ref.infer()
+    self.assertEqual(len(mdl.data), len(ref.data))
+    self.assertAlmostEqual(mdl.bound, ref.bound,
+                           delta = 1e-9 * abs(ref.bound))
+    for a, b in zip(mdl.wbar, ref.wbar):
+      self.assertAlmostEqual(a, b, delta = 1e-9)
+    for a, b in zip(memoryview(mdl.Sigma).tolist(),
+                    memoryview(ref.Sigma).tolist()):
+      for u, v in zip(a, b):
+        self.assertAlmostEqual(u, v, delta = 1e-9 * max(1, abs(v)))
+
+  def test_stream(self):
+    # streamed observations should match complete inference.
+    for Typ, kwargs in types:
+      mdl = build(Typ, 0, 100, **kwargs)
+      mdl.infer()
+      self.observe(mdl, 100, 130)
+      self.assertInferred(mdl, Typ, kwargs)
+
+  def test_uninferred(self):
+    # models that were never inferred should be inferred.
+    for Typ, kwargs in types:
+      mdl = build(Typ, 0, 100, **kwargs)
+      self.observe(mdl, 100, 130)
+      self.assertInferred(mdl, Typ, kwargs)
+
+  def test_augmented(self):
+    # datasets modified after inference should be inferred.
+    for Typ, kwargs in types:
+      mdl = build(Typ, 0, 100, **kwargs)
+      mdl.infer()
+      x, y = points(100, 110)
+      mdl.data.augment(x = x, y = y)
+      self.observe(mdl, 110, 130)
+      self.assertInferred(mdl, Typ, kwargs)
+
+  def test_factor_changed(self):
+    # factors modified after inference should be inferred.
+    for Typ, kwargs in types:
+      mdl = build(Typ, 0, 100, **kwargs)
+      mdl[1].mu = 2
+      mdl.infer()
+      mdl[1].mu = 3
+      self.observe(mdl, 100, 130)
+      self.assertInferred(mdl, Typ, kwargs)
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
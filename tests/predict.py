@@ -0,0 +1,54 @@
+import unittest
+import vfl
+from tests.common import TestCase, data
+
+# build and infer a model.
+def build(Typ, classes = False, **kwargs):
+  factors = [vfl.factor.Polynomial(order = 2),
+             vfl.factor.Impulse(mu = 3, tau = 1) *
+             vfl.factor.Cosine(mu = 1, tau = 1),
+             vfl.factor.Decay(alpha = 10, beta = 10)]
+  mdl = Typ(data = data(classes = classes), factors = factors,
+            nu = 1e-3, **kwargs)
+  mdl.infer()
+  return mdl
+
+# models to test.
+def models():
+  return [build(vfl.model.TauVFR, tau = 100),
+          build(vfl.model.VFR, alpha0 = 10, beta0 = 10),
+          build(vfl.model.VFC, classes = True)]
+
+# prediction locations, spanning several blocks.
+xs = [[0.013 * i - 1] for i in range(1000)]
+
+# unit tests for batched predictions.
+class TestPredict(TestCase):
+  def assertClose(self, a, b):
+    super().assertClose(a, b, rel = 1e-10)
+
+  def test_locations(self):
+    # batched predictions should match single predictions.
+    for mdl in models():
+      mu, eta = mdl.predict(x = xs)
+      self.assertEqual(len(mu), len(xs))
+      self.assertEqual(len(eta), len(xs))
+      for xi, m, v in zip(xs, mu, eta):
+        d = vfl.Datum(x = xi, y = 0)
+        self.assertClose(m, mdl.mean(d))
+        self.assertClose(v, mdl.var(d))
+
+  def test_datasets(self):
+    # predictions into datasets should match predictions at locations.
+    for mdl in models():
+      mu, eta = mdl.predict(x = xs)
+      mean = vfl.Data(x = xs, y = [0] * len(xs))
+      var = vfl.Data(x = xs, y = [0] * len(xs))
+      mdl.predict(mean = mean, var = var)
+      self.assertEqual(list(mean.y), list(mu))
+      self.assertEqual(list(var.y), list(eta))
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
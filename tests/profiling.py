@@ -0,0 +1,57 @@
+import unittest
+import vfl
+from tests.common import regression
+
+# get the call count of a function from a set of counts.
+def calls(ops, op):
+  return ops.get(op, {}).get('calls', 0)
+
+# unit tests for factor profiling.
+class TestProfile(unittest.TestCase):
+  def test_calls(self):
+    # build a product and a datum.
+    f = vfl.factor.Impulse(mu = 3, tau = 1) * \
+        vfl.factor.Cosine(mu = 1, tau = 1)
+    d = vfl.Datum(x = [0.5], y = 1)
+
+    # count calls to the product and its members.
+    with vfl.profile() as prof:
+      for i in range(7):
+        f.mean(d)
+
+      f.var(d)
+
+    for name in ('factor.Product', 'factor.Impulse', 'factor.Cosine'):
+      self.assertEqual(calls(prof.types[name], 'mean'), 7)
+      self.assertEqual(calls(prof.types[name], 'var'), 1)
+
+    # the product should also be counted as an instance.
+    ops = [e['ops'] for e in prof.factors if e['factor'] is f]
+    self.assertEqual(len(ops), 1)
+    self.assertEqual(calls(ops[0], 'mean'), 7)
+
+    # calls outside of the context should not be counted.
+    f.mean(d)
+    self.assertEqual(calls(prof.types['factor.Product'], 'mean'), 7)
+
+  def test_optimize(self):
+    # profiled runs should match unprofiled runs.
+    mdlA = regression()
+    vfl.optim.FullGradient(model = mdlA, max_iters = 5).execute()
+    mdlB = regression()
+    with vfl.profile() as prof:
+      vfl.optim.FullGradient(model = mdlB, max_iters = 5).execute()
+
+    self.assertEqual(mdlA.bound, mdlB.bound)
+    self.assertEqual(list(mdlA.wbar), list(mdlB.wbar))
+
+    # each optimized factor should have computed its gradients.
+    for name in ('factor.Impulse', 'factor.Cosine'):
+      ops = prof.types[name]
+      self.assertGreater(calls(ops, 'mean_all') + calls(ops, 'mean'), 0)
+      self.assertGreater(calls(ops, 'diff_mean'), 0)
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
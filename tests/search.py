@@ -0,0 +1,152 @@
+import unittest, os, sys, math, subprocess, tempfile
+import vfl
+
+# build a dataset with a gap in the middle of its inputs.
+def data():
+  x = [[0.1 * i] for i in list(range(0, 20, 2)) + list(range(40, 60, 2))]
+  y = [math.sin(xi[0]) for xi in x]
+  return vfl.Data(x = x, y = y)
+
+# build and infer a regression model over a dataset.
+def build(dat, factors = None):
+  if factors is None:
+    factors = [vfl.factor.Cosine(mu = 1, tau = 1)]
+
+  mdl = vfl.model.TauVFR(tau = 100, nu = 1e-3, data = dat,
+                         factors = factors)
+  mdl.infer()
+  return mdl
+
+# search grid, and the locations along it.
+grid = [[0.5, 0.001, 5.5]]
+xs = [[0.5 + 0.001 * i] for i in range(5001)]
+
+# search a model for its location of maximum variance.
+def search(mdl, dat, space = 'function'):
+  S = vfl.Search(model = mdl, data = dat, grid = grid, outputs = 1)
+  S.space = space
+  return S.execute()
+
+# unit tests for vfl.Search
+class TestSearch(unittest.TestCase):
+  def tearDown(self):
+    vfl.set_threads(os.cpu_count() or 1)
+
+  def assertSameLocation(self, a, b):
+    self.assertEqual(len(a), len(b))
+    for u, v in zip(a, b):
+      self.assertAlmostEqual(u, v, delta = 2e-3)
+
+  def test_threads(self):
+    # searches should not depend on the number of threads.
+    dat = data()
+    mdl = build(dat)
+    vfl.set_threads(1)
+    x1 = search(mdl, dat)
+    vfl.set_threads(4)
+    x4 = search(mdl, dat)
+    self.assertSameLocation(x1, x4)
+
+  def test_observe(self):
+    # build a search over the training data.
+    dat = data()
+    mdl = build(dat)
+    S = vfl.Search(model = mdl, data = dat, grid = grid, outputs = 1)
+    S.execute()
+    self.assertEqual(S.rebuilds, 1)
+
+    # observing real outputs should extend the cached factor.
+    for i in range(5):
+      x = S.execute()
+      mdl.observe(vfl.Datum(x = x, y = math.sin(x[0])))
+      self.assertEqual(len(dat), 21 + i)
+
+    self.assertEqual(S.rebuilds, 1)
+
+  def test_rebuild(self):
+    # build a search over a model with a product factor.
+    dat = data()
+    mdl = build(dat, [vfl.factor.Cosine(mu = 1, tau = 1) *
+                      vfl.factor.Cosine(dim = 0, mu = 2, tau = 1)])
+    S = vfl.Search(model = mdl, data = dat, grid = grid, outputs = 1)
+    S.execute()
+
+    # changes to the members of products should rebuild the factor.
+    mdl[0][0].mu = 1.5
+    self.assertSameLocation(S.execute(), search(mdl, dat))
+    mdl[0][1].tau = 10
+    self.assertSameLocation(S.execute(), search(mdl, dat))
+    self.assertEqual(S.rebuilds, 3)
+
+  def test_select(self):
+    # build a search over a copy of the training data.
+    mdl = build(data())
+    dat = data()
+    S = vfl.Search(model = mdl, data = dat, grid = grid, outputs = 1)
+
+    # searches over greedily selected locations, which extend the
+    # cached factor, should match fresh searches.
+    for i in range(5):
+      x = S.execute()
+      dat.augment(x = [x], y = [0])
+      self.assertSameLocation(S.execute(), search(mdl, dat))
+
+  def test_weight(self):
+    # weight-space searches should find the maximum predicted variance.
+    dat = data()
+    mdl = build(dat)
+    mu, eta = mdl.predict(x = xs)
+    eta = list(eta)
+    i = max(range(len(xs)), key = lambda i: eta[i])
+    self.assertSameLocation(search(mdl, dat, space = 'weight'), xs[i])
+
+  def test_jit(self):
+    # build a model with sums and products of factor kernels.
+    dat = data()
+    mdl = build(dat, [vfl.factor.Cosine(mu = 1, tau = 1),
+                      vfl.factor.Decay(alpha = 10, beta = 10),
+                      vfl.factor.Impulse(mu = 3, tau = 1) *
+                      vfl.factor.Cosine(mu = 2, tau = 1)])
+
+    # compiled kernels should match the factor functions.
+    x = search(mdl, dat)
+    try:
+      os.environ['VFL_JIT'] = '0'
+      self.assertSameLocation(search(mdl, dat), x)
+    finally:
+      del os.environ['VFL_JIT']
+
+  def test_target(self):
+    # build a compiler that reports a given target.
+    with tempfile.TemporaryDirectory() as tmp:
+      cc = os.path.join(tmp, 'cc')
+      with open(cc, 'w') as fh:
+        fh.write('#!/bin/sh\n'
+                 'case " $* " in *" --help=target "*)\n'
+                 '  echo "$TARGET"; exit 0;;\n'
+                 'esac\n'
+                 'exec cc "$@"\n')
+
+      os.chmod(cc, 0o755)
+
+      # search in processes that see different targets.
+      root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+      cache = os.path.join(tmp, 'cache')
+      code = ('import sys; sys.path.insert(0, sys.argv[1]);'
+              'from tests.search import *;'
+              'dat = data(); search(build(dat), dat)')
+      for target in ('a', 'b', 'a'):
+        env = dict(os.environ, CC = cc, TARGET = target,
+                   VFL_CACHE_DIR = cache)
+        env.pop('VFL_JIT', None)
+        subprocess.run([sys.executable, '-c', code, root],
+                       env = env, check = True)
+
+      # each target should have compiled its own kernel.
+      objs = [f for f in os.listdir(cache) if f.endswith('.so')]
+      self.assertEqual(len(objs), 2)
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
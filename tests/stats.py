@@ -0,0 +1,71 @@
+import unittest, os, json, tempfile
+import vfl
+from tests.common import regression
+
+# run an optimizer with or without instrumentation.
+def fit(timing = False, trace = None):
+  mdl = regression()
+  opt = vfl.optim.FullGradient(model = mdl, max_iters = 5)
+  opt.timing = timing
+  opt.trace_file = trace
+  opt.execute()
+  opt.trace_file = None
+  return mdl, opt
+
+# unit tests for optimizer statistics.
+class TestStats(unittest.TestCase):
+  def setUp(self):
+    self.dir = tempfile.TemporaryDirectory()
+    self.file = os.path.join(self.dir.name, 'trace.json')
+
+  def tearDown(self):
+    self.dir.cleanup()
+
+  def calls(self, opt):
+    # get the call counts of each phase.
+    return {k: v['calls'] for k, v in opt.stats['phases'].items()}
+
+  def test_timing(self):
+    # instrumented runs should match uninstrumented runs.
+    mdlA, optA = fit()
+    mdlB, optB = fit(timing = True, trace = self.file)
+    self.assertEqual(mdlA.bound, mdlB.bound)
+    self.assertEqual(list(mdlA.wbar), list(mdlB.wbar))
+    self.assertEqual(self.calls(optA), self.calls(optB))
+
+    # only instrumented runs should accumulate time.
+    self.assertEqual(optA.stats['phases']['infer']['time'], 0)
+    self.assertGreater(optB.stats['phases']['infer']['time'], 0)
+
+  def test_counts(self):
+    # each iteration should infer once, and update each factor.
+    mdl, opt = fit()
+    self.assertEqual(opt.stats['iters'], 5)
+    self.assertEqual(opt.stats['phases']['infer']['calls'], 5)
+    self.assertEqual(len(opt.stats['factors']), len(mdl))
+    for f in opt.stats['factors']:
+      self.assertLessEqual(f['accepted'], f['trials'])
+
+    # reset statistics should be zero.
+    opt.reset_stats()
+    self.assertEqual(opt.stats['iters'], 0)
+    self.assertEqual(set(self.calls(opt).values()), {0})
+
+  def test_trace(self):
+    # traces should hold one complete event for each phase call.
+    mdl, opt = fit(trace = self.file)
+    with open(self.file) as f:
+      events = json.load(f)
+
+    for name, calls in self.calls(opt).items():
+      n = len([e for e in events if e['name'] == name])
+      self.assertEqual(n, calls)
+
+    for e in events:
+      self.assertEqual(e['ph'], 'X')
+      self.assertGreaterEqual(e['dur'], 0)
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
@@ -0,0 +1,68 @@
+import unittest, threading
+import vfl
+
+# build a quadratic regression model.
+def build(N = 400):
+  x = [[4 * i / N - 2] for i in range(N)]
+  y = [1 + 0.5 * xi[0] - 0.3 * xi[0]**2 for xi in x]
+  dat = vfl.Data(x = x, y = y)
+  return vfl.model.TauVFR(tau = 100, nu = 1e-3, data = dat,
+                          factors = [vfl.factor.Polynomial(order = 2)])
+
+# run stochastic optimization over a model.
+def fit(mdl, seed = 7, iters = 200):
+  opt = vfl.optim.Stochastic(model = mdl, max_iters = iters)
+  opt.batch_size = 50
+  opt.seed = seed
+  opt.execute()
+  return opt
+
+# unit tests for vfl.optim.Stochastic
+class TestStochastic(unittest.TestCase):
+  def test_weights(self):
+    # minibatch steps should approach the complete posterior.
+    ref = build()
+    ref.infer()
+    mdl = build()
+    fit(mdl)
+    for a, b in zip(ref.wbar, mdl.wbar):
+      self.assertAlmostEqual(a, b, delta = 1e-4)
+
+  def test_seed(self):
+    # equal seeds should draw equal minibatches.
+    mdlA = build()
+    mdlB = build()
+    fit(mdlA)
+    fit(mdlB)
+    self.assertEqual(list(mdlA.wbar), list(mdlB.wbar))
+
+  def test_data(self):
+    # the complete dataset should be restored after each iteration.
+    mdl = build()
+    dat = mdl.data
+    fit(mdl, iters = 5)
+    self.assertIs(mdl.data, dat)
+    self.assertEqual(len(mdl.data), 400)
+
+  def test_batch(self):
+    # run the optimizer in another thread.
+    mdl = build(N = 20000)
+    opt = vfl.optim.Stochastic(model = mdl, max_iters = 2000)
+    t = threading.Thread(target = opt.execute)
+    t.start()
+
+    # any dataset seen during the iterations may not be modified.
+    while t.is_alive():
+      try:
+        mdl.data.augment(x = [[0]], y = [0])
+      except RuntimeError:
+        continue
+
+      self.assertFalse(t.is_alive())
+
+    t.join()
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
@@ -0,0 +1,64 @@
+import unittest, math
+import vfl
+
+# build a regression model over a wide dataset.
+def build(factors, tol, N = 400):
+  x = [[0.1 * i - 20] for i in range(N)]
+  y = [math.exp(-(xi[0] - 3)**2) + 0.01 * xi[0] for xi in x]
+  dat = vfl.Data(x = x, y = y)
+  mdl = vfl.model.TauVFR(tau = 100, nu = 1e-3, data = dat,
+                         factors = factors)
+  mdl.support_tol = tol
+  mdl.infer()
+  return mdl
+
+# prediction locations.
+xs = [[0.5 * i - 20] for i in range(80)]
+
+# unit tests for compactly supported factors.
+class TestSupport(unittest.TestCase):
+  def assertClose(self, a, b, rel):
+    self.assertLessEqual(abs(a - b), rel * max(1, abs(a), abs(b)))
+
+  def compare(self, make, rel):
+    # compare restricted and unrestricted models.
+    full = build(make(), 0)
+    part = build(make(), 1e-12)
+    self.assertClose(full.bound, part.bound, rel)
+    muA, etaA = full.predict(x = xs)
+    muB, etaB = part.predict(x = xs)
+    for a, b in zip(list(muA) + list(etaA), list(muB) + list(etaB)):
+      self.assertClose(a, b, rel)
+
+  def test_impulse(self):
+    # restricting impulses should not change the model appreciably.
+    make = lambda: [vfl.factor.Polynomial(order = 1),
+                    vfl.factor.Impulse(mu = 3, tau = 16),
+                    vfl.factor.Impulse(mu = -5, tau = 25)]
+    self.compare(make, 1e-8)
+
+  def test_product(self):
+    # products with polynomials are not compactly supported, and
+    # should be evaluated at every observation.
+    make = lambda: [vfl.factor.Impulse(mu = 3, tau = 16) *
+                    vfl.factor.Polynomial(order = 12)]
+    self.compare(make, 1e-12)
+
+  def test_augment(self):
+    # indices should be rebuilt when the dataset changes.
+    make = lambda: [vfl.factor.Polynomial(order = 1),
+                    vfl.factor.Impulse(mu = 3, tau = 16)]
+    mdl = build(make(), 1e-12)
+    mdl.data.augment(x = [[3.1], [2.9]], y = [2, 2])
+    mdl.infer()
+
+    # compare against a model over the complete dataset.
+    ref = vfl.model.TauVFR(tau = 100, nu = 1e-3, data = mdl.data,
+                           factors = make())
+    ref.infer()
+    self.assertClose(mdl.bound, ref.bound, 1e-8)
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
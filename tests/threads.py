@@ -0,0 +1,142 @@
+import unittest, os, math, threading, time
+import vfl
+
+# build a regression model over a sinusoidal dataset.
+def build(N = 500):
+  x = [[10 * i / N] for i in range(N)]
+  y = [math.sin(xi[0]) + 0.1 * math.cos(7 * xi[0]) for xi in x]
+  dat = vfl.Data(x = x, y = y)
+  factors = [vfl.factor.Polynomial(order = 2)] + \
+            [vfl.factor.Impulse(mu = m, tau = 1) for m in range(10)]
+  return vfl.model.TauVFR(tau = 100, nu = 1e-3, data = dat,
+                          factors = factors)
+
+# unit tests for the thread pool.
+class TestThreads(unittest.TestCase):
+  def tearDown(self):
+    vfl.set_threads(os.cpu_count() or 1)
+
+  def infer(self, n):
+    # infer a model and return its bound and predictions.
+    vfl.set_threads(n)
+    mdl = build()
+    mdl.infer()
+    mu, eta = mdl.predict(x = [[0.5 * i] for i in range(20)])
+    return mdl.bound, list(mu), list(eta)
+
+  def test_infer(self):
+    # inference should not depend on the thread count.
+    L1, mu1, eta1 = self.infer(1)
+    L4, mu4, eta4 = self.infer(4)
+    self.assertAlmostEqual(L1, L4, delta = 1e-9 * abs(L1))
+    for a, b in zip(mu1 + eta1, mu4 + eta4):
+      self.assertAlmostEqual(a, b, delta = 1e-9 * max(1, abs(a)))
+
+  def test_optimize(self):
+    # optimization should not depend on the thread count.
+    bounds = []
+    for n in (1, 4):
+      vfl.set_threads(n)
+      mdl = build()
+      opt = vfl.optim.FullGradient(model = mdl, max_iters = 3)
+      opt.execute()
+      bounds.append(mdl.bound)
+
+    self.assertAlmostEqual(bounds[0], bounds[1],
+                           delta = 1e-6 * abs(bounds[0]))
+
+  def test_busy(self):
+    # build a model that takes a while to optimize.
+    vfl.set_threads(2)
+    mdl = build(N = 20000)
+    dat = mdl.data
+    opt = vfl.optim.FullGradient(model = mdl, max_iters = 3)
+
+    # run the optimizer in another thread.
+    t = threading.Thread(target = opt.execute)
+    t.start()
+    time.sleep(0.05)
+
+    # the model, its factors, dataset and optimizer may not change.
+    calls = [lambda: dat.augment(x = [[0.5]], y = [1.0]),
+             lambda: mdl.add(vfl.factor.Polynomial(order = 1)),
+             lambda: setattr(mdl[0], 'order', 5),
+             lambda: setattr(mdl[1], 'mu', 3.0),
+             lambda: setattr(opt, 'max_iters', 5),
+             lambda: mdl.infer()]
+    errors = 0
+    for f in calls:
+      try:
+        f()
+      except RuntimeError:
+        errors += 1
+
+    running = t.is_alive()
+    t.join()
+    if running:
+      self.assertEqual(errors, len(calls))
+
+    # once released, the model may be modified again.
+    dat.augment(x = [[0.5]], y = [1.0])
+    mdl.infer()
+
+  def test_resize(self):
+    # run inference repeatedly in another thread.
+    mdl = build(N = 2000)
+    stop = threading.Event()
+    def run():
+      while not stop.is_set():
+        mdl.infer()
+
+    t = threading.Thread(target = run, daemon = True)
+    t.start()
+
+    # resizing the pool should never stall tasks submitted meanwhile.
+    try:
+      end = time.time() + 2
+      while time.time() < end:
+        try:
+          vfl.set_threads(2 + int(1000 * time.time()) % 3)
+        except RuntimeError:
+          pass
+    finally:
+      stop.set()
+      t.join(timeout = 60)
+
+    self.assertFalse(t.is_alive())
+
+  @unittest.skipUnless(hasattr(os, 'fork'), 'requires fork()')
+  def test_fork(self):
+    # start the pool in the parent.
+    vfl.set_threads(4)
+    mdl = build()
+    mdl.infer()
+    L = mdl.bound
+
+    # the child must be able to run the pool again.
+    pid = os.fork()
+    if pid == 0:
+      status = 1
+      try:
+        mdl.infer()
+        status = 0 if abs(mdl.bound - L) <= 1e-9 * abs(L) else 1
+      finally:
+        os._exit(status)
+
+    # wait for the child, with a timeout in case it hangs.
+    for i in range(600):
+      done, status = os.waitpid(pid, os.WNOHANG)
+      if done:
+        break
+      time.sleep(0.1)
+    else:
+      os.kill(pid, 9)
+      os.waitpid(pid, 0)
+      self.fail('forked child did not finish')
+
+    self.assertEqual(status, 0)
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
@@ -0,0 +1,69 @@
+import unittest
+import vfl
+from tests.common import TestCase, data
+
+# build and infer a model. classifiers are inferred until their
+# logistic parameters have converged.
+def build(Typ, factors, classes = False, **kwargs):
+  mdl = Typ(data = data(classes = classes), factors = factors(), nu = 1e-3, **kwargs)
+  for i in range(100 if classes else 1):
+    mdl.infer()
+
+  return mdl
+
+# factors with location and precision parameters.
+def regression():
+  return [vfl.factor.Polynomial(order = 1),
+          vfl.factor.Impulse(mu = 3, tau = 1),
+          vfl.factor.Cosine(mu = 1, tau = 10)]
+
+def classification():
+  return [vfl.factor.Polynomial(order = 1),
+          vfl.factor.Cosine(mu = 1, tau = 10)]
+
+# unit tests for low-rank model updates.
+class TestUpdate(TestCase):
+  def assertUpdated(self, mdl, ref):
+    # move the reference to the updated parameters and infer it.
+    for f, g in zip(mdl, ref):
+      if isinstance(f, (vfl.factor.Impulse, vfl.factor.Cosine)):
+        g.mu = f.mu
+        g.tau = f.tau
+
+    ref.infer()
+
+    # compare the updated model against the reference.
+    self.assertClose(mdl.bound, ref.bound)
+    for a, b in zip(mdl.wbar, ref.wbar):
+      self.assertClose(a, b)
+
+    for a, b in zip(memoryview(mdl.Sigma).tolist(),
+                    memoryview(ref.Sigma).tolist()):
+      for u, v in zip(a, b):
+        self.assertClose(u, v)
+
+  def test_regression(self):
+    # updated regression models should match complete inference.
+    types = [(vfl.model.TauVFR, {'tau': 100}),
+             (vfl.model.VFR, {'alpha0': 10, 'beta0': 10})]
+    for Typ, kwargs in types:
+      mdl = build(Typ, regression, **kwargs)
+      ref = build(Typ, regression, **kwargs)
+      opt = vfl.optim.FullGradient(model = mdl)
+      for i in range(3):
+        opt.iterate()
+        self.assertUpdated(mdl, ref)
+
+  def test_classification(self):
+    # from converged logistic parameters, a single accepted update
+    # should match complete inference.
+    mdl = build(vfl.model.VFC, classification, classes = True)
+    ref = build(vfl.model.VFC, classification, classes = True)
+    opt = vfl.optim.FullGradient(model = mdl)
+    opt.iterate()
+    self.assertUpdated(mdl, ref)
+
+# when run as a script, run the unit tests.
+if __name__ == '__main__':
+  unittest.main()
+
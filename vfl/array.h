@@ -0,0 +1,71 @@
+
+/* ensure once-only inclusion. */
+#ifndef __VFL_ARRAY_H__
+#define __VFL_ARRAY_H__
+
+/* include c library headers. */
+#include <stdint.h>
+
+/* Array_Check(): macro to check if a PyObject is an Array.
+ */
+#define Array_Check(v) (Py_TYPE(v) == &Array_Type)
+
+/* ARRAY_DOUBLE, ARRAY_SIZE: buffer format strings of the supported
+ * array element types.
+ */
+#define ARRAY_DOUBLE "d"
+#if SIZE_MAX == UINT64_MAX
+#define ARRAY_SIZE "Q"
+#else
+#define ARRAY_SIZE "I"
+#endif
+
+/* Array_Type: globally available array type structure.
+ */
+PyAPI_DATA(PyTypeObject) Array_Type;
+
+/* Array: structure for exposing a one- or two-dimensional array of
+ * numbers to python through the buffer protocol. arrays either view
+ * the memory of another object, or own their memory.
+ */
+typedef struct {
+  /* object base. */
+  PyObject_HEAD
+
+  /* memory ownership:
+   *  @owner: object holding the viewed memory, or null if the array
+   *          owns its memory.
+   *  @count: counter of arrays viewing the owner, or null.
+   */
+  PyObject *owner;
+  size_t *count;
+
+  /* array layout:
+   *  @data: pointer to the first array element.
+   *  @format: buffer format string of the array elements.
+   *  @itemsize: size of each array element, in bytes.
+   *  @ndim: number of array dimensions, one or two.
+   *  @shape: array sizes along each dimension.
+   *  @strides: array spacings along each dimension, in bytes.
+   *  @readonly: whether the array elements may not be modified.
+   */
+  char *data;
+  const char *format;
+  Py_ssize_t itemsize;
+  int ndim;
+  Py_ssize_t shape[2];
+  Py_ssize_t strides[2];
+  int readonly;
+}
+Array;
+
+/* function declarations (array.c): */
+
+PyObject *Array_View (PyObject *owner, size_t *count, void *data,
+                      const char *format, int ndim,
+                      size_t n1, size_t n2, int readonly);
+
+PyObject *Array_New (size_t n);
+
+#endif /* !__VFL_ARRAY_H__ */
+
@@ -0,0 +1,54 @@
+
+/* ensure once-only inclusion. */
+#ifndef __VFL_BENCH_H__
+#define __VFL_BENCH_H__
+
+/* include vfl headers. */
+#include <vfl/model.h>
+
+/* BenchFactorOp: enumeration of the factor functions that may be
+ * timed by bench_factor().
+ *  @BENCH_MEAN: first moments, for each basis element.
+ *  @BENCH_VAR: second moments, for each pair of basis elements.
+ *  @BENCH_COV: covariances between neighboring observations.
+ *  @BENCH_DIFF_MEAN: first moment gradients.
+ *  @BENCH_DIFF_VAR: second moment gradients.
+ *  @BENCH_MEAN_ALL: first moments over the dataset.
+ *  @BENCH_VAR_ALL: second moments over the dataset.
+ */
+typedef enum {
+  BENCH_MEAN,
+  BENCH_VAR,
+  BENCH_COV,
+  BENCH_DIFF_MEAN,
+  BENCH_DIFF_VAR,
+  BENCH_MEAN_ALL,
+  BENCH_VAR_ALL
+}
+BenchFactorOp;
+
+/* BenchModelOp: enumeration of the model functions that may be
+ * timed by bench_model().
+ *  @BENCH_INFER: complete inference of the weights.
+ *  @BENCH_UPDATE: weight updates for each factor.
+ *  @BENCH_BOUND: evaluation of the lower bound.
+ */
+typedef enum {
+  BENCH_INFER,
+  BENCH_UPDATE,
+  BENCH_BOUND
+}
+BenchModelOp;
+
+/* function declarations (bench.c): */
+
+double bench_clock (void);
+
+int bench_factor (const Factor *f, const Data *dat, BenchFactorOp op,
+                  size_t reps, double *sec, size_t *evals);
+
+int bench_model (Model *mdl, BenchModelOp op, size_t reps,
+                 double *sec, size_t *evals);
+
+#endif /* !__VFL_BENCH_H__ */
+
@@ -15,7 +15,29 @@
  */
 PyAPI_DATA(PyTypeObject) Data_Type;
 
-/* Data: structure for holding observations.
+/* DataIndex: structure for holding the observations of a dataset in
+ * sorted order along each dimension, used to locate the observations
+ * that lie within an axis-aligned box.
+ */
+typedef struct {
+  /* @ver: dataset version that the index was built from.
+   * @N: number of indexed observations.
+   * @D: number of indexed dimensions.
+   */
+  size_t ver, N, D;
+
+  /* @order: (D, N) row-major array of observation indices, with each
+   *         row sorted by the locations along one dimension.
+   * @keys: (D, N) row-major array of the sorted locations.
+   */
+  size_t *order;
+  double *keys;
+}
+DataIndex;
+
+/* Data: structure for holding observations. observations are stored
+ * in a columnar layout, and datum objects are only created when the
+ * dataset is indexed from python.
  */
 typedef struct {
   /* object base. */
@@ -24,15 +46,46 @@ typedef struct {
   /* dataset size parameters:
    *  @N: number of observations.
    *  @D: number of dimensions.
+   *  @cap: number of allocated observations.
+   */
+  size_t N, D, cap;
+
+  /* core dataset arrays:
+   *  @X: (N, D) row-major array of observation locations.
+   *  @y: (N, 1) array of observed values.
+   *  @p: (N, 1) array of observation output indices.
+   */
+  double *X;
+  double *y;
+  size_t *p;
+
+  /* memory-mapped storage:
+   *  @map: private file mapping holding the arrays, or null if the
+   *        arrays were allocated on the heap.
+   *  @maplen: size of the file mapping, in bytes.
+   */
+  void *map;
+  size_t maplen;
+
+  /* @arrays: number of python arrays viewing the dataset arrays,
+   *          which may not be reallocated while any are alive.
+   */
+  size_t arrays;
+
+  /* @busy: number of computations reading the dataset without the
+   *        interpreter lock, during which it may not be modified.
    */
-  size_t N, D;
+  size_t busy;
 
-  /* core dataset array:
-   *  @data: array of observations.
-   *  @swp: storage for swapping.
+  /* @ver: version of the dataset contents, which changes whenever
+   *       observations are added, removed, modified or reordered.
    */
-  Datum *data;
-  Datum swp;
+  size_t ver;
+
+  /* @idx: sorted index of the observations, built on demand and
+   *       rebuilt whenever the dataset version changes, or null.
+   */
+  DataIndex *idx;
 }
 Data;
 
@@ -40,11 +93,19 @@ Data;
 
 int data_resize (Data *dat, size_t N, size_t D);
 
+void data_release (Data *dat);
+
+void data_touch (Data *dat);
+
 /* function declarations (data-entries.c): */
 
 double data_inner (const Data *dat);
 
-Datum *data_get (const Data *dat, size_t i);
+VectorView data_x (const Data *dat, size_t i);
+
+int data_get (const Data *dat, size_t i, Datum *d);
+
+Data data_view (const Data *dat, size_t i, size_t n);
 
 int data_set (Data *dat, size_t i, const Datum *d);
 
@@ -56,17 +117,33 @@ int data_augment_from_grid (Data *dat, size_t p, const Matrix *grid);
 
 int data_augment_from_data (Data *dat, const Data *dsrc);
 
+int data_augment_from_matrix (Data *dat, size_t p, const Matrix *X,
+                              const Vector *y);
+
 /* function declarations, input/output (data-fileio.c): */
 
 int data_fread (Data *dat, const char *fname);
 
 int data_fwrite (const Data *dat, const char *fname);
 
+int data_fwrite_binary (const Data *dat, const char *fname);
+
+/* function declarations, indexing (data-index.c): */
+
+void data_index_free (Data *dat);
+
+size_t *data_index_box (Data *dat, const double *lo, const double *hi,
+                        size_t *n);
+
 /* function declarations, sorting (data-sort.c): */
 
+int data_cmp (const Data *dat, size_t i, size_t p, const Vector *x);
+
 int data_sort_single (Data *dat, size_t i);
 
 int data_sort (Data *dat);
 
+int data_sort_from (Data *dat, size_t i);
+
 #endif /* !__VFL_DATA_H__ */
 
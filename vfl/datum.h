@@ -28,6 +28,15 @@ typedef struct {
   size_t p;
   Vector *x;
   double y;
+
+  /* dataset entry that the datum was read from, if any, to which its
+   * observed value is written through:
+   *  @dat: dataset object holding the entry, or null.
+   *  @i: index of the entry within the dataset.
+   *  @ver: dataset version when the entry was read.
+   */
+  PyObject *dat;
+  size_t i, ver;
 }
 Datum;
 
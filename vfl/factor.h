@@ -6,6 +6,7 @@
 /* include vfl headers. */
 #include <vfl/util/specfun.h>
 #include <vfl/util/blas.h>
+#include <vfl/util/pack.h>
 #include <vfl/data.h>
 
 /* Factor_Check(): macro to check if a PyObject is a Factor.
@@ -62,6 +63,37 @@ typedef double (*factor_mean_fn) (const Factor *f, const Vector *x,
 typedef double (*factor_var_fn) (const Factor *f, const Vector *x,
                                  size_t p, size_t i, size_t j);
 
+/* factor_mean_all_fn(): compute the first moments of a basis element
+ * at every observation of a dataset.
+ *
+ * arguments:
+ *  @f: factor structure pointer.
+ *  @dat: dataset structure pointer.
+ *  @i: basis element index.
+ *  @phi: output vector of first moments, one per observation.
+ *
+ * returns:
+ *  phi_n <- E[ phi^{p_n}(x_n | theta(f))_i ]
+ */
+typedef void (*factor_mean_all_fn) (const Factor *f, const Data *dat,
+                                    size_t i, Vector *phi);
+
+/* factor_var_all_fn(): compute the second moments of basis elements
+ * at every observation of a dataset.
+ *
+ * arguments:
+ *  @f: factor structure pointer.
+ *  @dat: dataset structure pointer.
+ *  @i: first basis element index.
+ *  @j: second basis element index.
+ *  @phi: output vector of second moments, one per observation.
+ *
+ * returns:
+ *  phi_n <- E[ phi^{p_n}(x_n | theta(f))_i phi^{p_n}(x_n | theta(f))_j ]
+ */
+typedef void (*factor_var_all_fn) (const Factor *f, const Data *dat,
+                                   size_t i, size_t j, Vector *phi);
+
 /* factor_cov_fn(): return the covariance of basis elements.
  *
  * arguments:
@@ -152,6 +184,22 @@ typedef int (*factor_meanfield_fn) (Factor *f, const Factor *fp,
  */
 typedef double (*factor_div_fn) (const Factor *f, const Factor *f2);
 
+/* factor_support_fn(): narrow an axis-aligned box of input locations
+ * to the effective support of a factor, outside of which the first
+ * and second moments of every basis element (and their gradients)
+ * fall below a tolerance. factors without this function are taken to
+ * have unbounded support.
+ *
+ * arguments:
+ *  @f: factor structure pointer.
+ *  @tol: tolerance below which moments are treated as zero.
+ *  @D: number of dimensions of the box.
+ *  @lo: (D, 1) array of lower bounds to narrow.
+ *  @hi: (D, 1) array of upper bounds to narrow.
+ */
+typedef void (*factor_support_fn) (const Factor *f, double tol, size_t D,
+                                   double *lo, double *hi);
+
 /* factor_init_fn(): initialize a factor structure
  * in a type-specific manner.
  *
@@ -211,6 +259,30 @@ typedef int (*factor_set_fn) (Factor *f, size_t i, double value);
  */
 typedef int (*factor_copy_fn) (const Factor *f, Factor *fdup);
 
+/* factor_pack_fn(): append any extra information held by a factor
+ * to a packed buffer.
+ *
+ * arguments:
+ *  @f: factor structure pointer to access.
+ *  @pk: packed buffer to write into.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+typedef int (*factor_pack_fn) (const Factor *f, Pack *pk);
+
+/* factor_unpack_fn(): restore any extra information of a factor
+ * from a packed buffer, as written by its factor_pack_fn().
+ *
+ * arguments:
+ *  @f: factor structure pointer to modify.
+ *  @pk: packed buffer to read from.
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+typedef int (*factor_unpack_fn) (Factor *f, Pack *pk);
+
 /* factor_free_fn(): free any extra (e.g. aliased) memory that is
  * associated with a factor.
  *
@@ -240,6 +312,20 @@ double name ## _mean (const Factor *f, const Vector *x, \
 double name ## _var (const Factor *f, const Vector *x, \
                      size_t p, size_t i, size_t j)
 
+/* FACTOR_MEAN_ALL(): macro function for declaring and defining
+ * functions conforming to factor_mean_all_fn().
+ */
+#define FACTOR_MEAN_ALL(name) \
+void name ## _mean_all (const Factor *f, const Data *dat, \
+                        size_t i, Vector *phi)
+
+/* FACTOR_VAR_ALL(): macro function for declaring and defining
+ * functions conforming to factor_var_all_fn().
+ */
+#define FACTOR_VAR_ALL(name) \
+void name ## _var_all (const Factor *f, const Data *dat, \
+                       size_t i, size_t j, Vector *phi)
+
 /* FACTOR_COV(): macro function for declaring and defining
  * functions conforming to factor_cov_fn().
  */
@@ -283,6 +369,13 @@ int name ## _meanfield (Factor *f, const Factor *fp, \
 #define FACTOR_DIV(name) \
 double name ## _div (const Factor *f, const Factor *f2)
 
+/* FACTOR_SUPPORT(): macro function for declaring and defining
+ * functions conforming to factor_support_fn().
+ */
+#define FACTOR_SUPPORT(name) \
+void name ## _support (const Factor *f, double tol, size_t D, \
+                       double *lo, double *hi)
+
 /* FACTOR_INIT(): macro function for declaring and defining
  * functions conforming to factor_init_fn().
  */
@@ -313,6 +406,18 @@ int name ## _set (Factor *f, size_t i, double value)
 #define FACTOR_COPY(name) \
 int name ## _copy (const Factor *f, Factor *fdup)
 
+/* FACTOR_PACK(): macro function for declaring and defining
+ * functions conforming to factor_pack_fn().
+ */
+#define FACTOR_PACK(name) \
+int name ## _pack (const Factor *f, Pack *pk)
+
+/* FACTOR_UNPACK(): macro function for declaring and defining
+ * functions conforming to factor_unpack_fn().
+ */
+#define FACTOR_UNPACK(name) \
+int name ## _unpack (Factor *f, Pack *pk)
+
 /* FACTOR_FREE(): macro function for declaring and defining
  * functions conforming to factor_free_fn().
  */
@@ -350,12 +455,85 @@ static PyObject* Typ ## _get_ ## name (Typ *self) { \
 static int Typ ## _set_ ## name (Typ *self, PyObject *value, void *cl) { \
   const double v = PyFloat_AsDouble(value); \
   if (PyErr_Occurred()) return -1; \
+  if (((Factor*) self)->busy) { \
+    PyErr_SetString(PyExc_RuntimeError, "factor is in use"); \
+    return -1; } \
   if (!factor_set((Factor*) self, idx, v)) { \
     PyErr_SetString(PyExc_ValueError, \
       "failed to set '" #name "' parameter"); \
     return -1; } \
   return 0; }
 
+/* FactorOp: enumeration of the factor functions that are counted and
+ * timed while profiling is enabled.
+ *  @FACTOR_OP_MEAN: first moments.
+ *  @FACTOR_OP_VAR: second moments.
+ *  @FACTOR_OP_COV: covariances.
+ *  @FACTOR_OP_MEAN_ALL: batched first moments.
+ *  @FACTOR_OP_VAR_ALL: batched second moments.
+ *  @FACTOR_OP_DIFF_MEAN: first moment gradients.
+ *  @FACTOR_OP_DIFF_VAR: second moment gradients.
+ *  @FACTOR_OP_MEANFIELD: mean-field updates.
+ *  @FACTOR_OPS: number of profiled functions.
+ */
+typedef enum {
+  FACTOR_OP_MEAN,
+  FACTOR_OP_VAR,
+  FACTOR_OP_COV,
+  FACTOR_OP_MEAN_ALL,
+  FACTOR_OP_VAR_ALL,
+  FACTOR_OP_DIFF_MEAN,
+  FACTOR_OP_DIFF_VAR,
+  FACTOR_OP_MEANFIELD,
+  FACTOR_OPS
+}
+FactorOp;
+
+/* FactorCounts: structure for holding the call counts and cumulative
+ * cycles of each profiled factor function.
+ */
+typedef struct {
+  uint64_t calls[FACTOR_OPS];
+  uint64_t cycles[FACTOR_OPS];
+}
+FactorCounts;
+
+/* FactorProfile: structure for holding the profiling state of a
+ * single factor instance.
+ */
+typedef struct {
+  /* @session: profiling session that the counts belong to.
+   * @slot: index of the factor in the session registry.
+   * @type: counts of the factor type within the session.
+   * @counts: counts of the factor instance within the session.
+   */
+  size_t session, slot;
+  FactorCounts *type;
+  FactorCounts counts;
+}
+FactorProfile;
+
+/* factor_profiling: whether or not factor functions are profiled.
+ */
+extern int factor_profiling;
+
+/* Profile_Type: globally available factor profile type structure.
+ */
+PyAPI_DATA(PyTypeObject) Profile_Type;
+
+/* FACTOR_PROFILE_START(): macro function that reads the cycle counter
+ * at the start of a profiled factor function. the counter is only read
+ * while profiling is enabled, and zero is returned otherwise.
+ */
+#define FACTOR_PROFILE_START() \
+  (factor_profiling ? factor_profile_cycles() : 0)
+
+/* FACTOR_PROFILE_STOP(): macro function that records a call to a
+ * profiled factor function, given the result of FACTOR_PROFILE_START().
+ */
+#define FACTOR_PROFILE_STOP(f, op, t0) \
+  do { if (t0) factor_profile_record(f, op, t0); } while (0)
+
 /* struct factor: structure for holding a variational factor.
  *
  * each factor holds information on a set of @M basis elements,
@@ -375,6 +553,10 @@ struct factor {
    *   @var: second moment.
    *   @cov: covariance.
    *
+   *  batched expectations:
+   *   @mean_all: first moments over a dataset.
+   *   @var_all: second moments over a dataset.
+   *
    *  gradients:
    *   @diff_mean: gradient of the first moment.
    *   @diff_var: gradient of the second moment.
@@ -385,27 +567,37 @@ struct factor {
    *  divergence:
    *   @div: kl-divergence between two factors of the same type.
    *
+   *  support:
+   *   @support: effective support of the moments.
+   *
    *  maintenance hooks:
    *   @init: hook for initialization.
    *   @resize: hook for resize handling.
    *   @kernel: hook for kernel construction.
    *   @set: hook for setting parameter values.
    *   @copy: hook for copying extra memory between factors.
+   *   @pack: hook for serializing extra information.
+   *   @unpack: hook for deserializing extra information.
    *   @free: hook for extra functionality during deallocation.
    */
   factor_mean_fn      eval;
   factor_mean_fn      mean;
   factor_var_fn       var;
   factor_cov_fn       cov;
+  factor_mean_all_fn  mean_all;
+  factor_var_all_fn   var_all;
   factor_diff_mean_fn diff_mean;
   factor_diff_var_fn  diff_var;
   factor_meanfield_fn meanfield;
   factor_div_fn       div;
+  factor_support_fn   support;
   factor_init_fn      init;
   factor_resize_fn    resize;
   factor_kernel_fn    kernel;
   factor_set_fn       set;
   factor_copy_fn      copy;
+  factor_pack_fn      pack;
+  factor_unpack_fn    unpack;
   factor_free_fn      free;
 
   /* factor sizes:
@@ -425,12 +617,25 @@ struct factor {
    */
   int fixed;
 
+  /* @ver: version of the factor state, which is reassigned from a
+   *       global counter whenever the factor parameters change.
+   */
+  size_t ver;
+
+  /* @busy: number of computations using the factor without the
+   *        interpreter lock, during which it may not be modified.
+   */
+  size_t busy;
+
   /* storage of core data:
    *  @inf: fisher information matrix.
    *  @par: parameter vector.
    */
   Matrix *inf;
   Vector *par;
+
+  /* @prof: profiling counts of the factor. */
+  FactorProfile prof;
 };
 
 /* function declarations (factor-core.c): */
@@ -451,6 +656,14 @@ double factor_get (const Factor *f, size_t i);
 
 int factor_set (Factor *f, size_t i, double value);
 
+void factor_touch (Factor *f);
+
+size_t factor_version (const Factor *f);
+
+void factor_hold (Factor *f);
+
+void factor_release (Factor *f);
+
 void factor_fix (Factor *f, int fixed);
 
 double factor_eval (const Factor *f, const Vector *x,
@@ -465,6 +678,12 @@ double factor_var (const Factor *f, const Vector *x,
 double factor_cov (const Factor *f, const Vector *x1, const Vector *x2,
                    size_t p1, size_t p2);
 
+int factor_mean_all (const Factor *f, const Data *dat,
+                     size_t i, Vector *phi);
+
+int factor_var_all (const Factor *f, const Data *dat,
+                    size_t i, size_t j, Vector *phi);
+
 int factor_diff_mean (const Factor *f, const Vector *x,
                       size_t p, size_t i, Vector *df);
 
@@ -477,7 +696,36 @@ int factor_meanfield (Factor *f, const Factor *fp, const Datum *dat,
 
 double factor_div (const Factor *f, const Factor *f2);
 
+int factor_support (const Factor *f, double tol, size_t D,
+                    double *lo, double *hi);
+
 char *factor_kernel (const Factor *f, size_t p0);
 
+int factor_pack (const Factor *f, Pack *pk);
+
+Factor *factor_unpack (Pack *pk);
+
+/* function declarations (factor-profile.c): */
+
+uint64_t factor_profile_cycles (void);
+
+const char *factor_profile_clock (void);
+
+const char *factor_profile_op_name (FactorOp op);
+
+int factor_profile_enable (void);
+
+void factor_profile_disable (void);
+
+void factor_profile_record (const Factor *f, FactorOp op, uint64_t t0);
+
+void factor_profile_forget (Factor *f);
+
+size_t factor_profile_types (PyTypeObject **types, FactorCounts *counts,
+                             size_t n);
+
+size_t factor_profile_factors (Factor **factors, const char **names,
+                               FactorCounts *counts, size_t n);
+
 #endif /* !__VFL_FACTOR_H__ */
 
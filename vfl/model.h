@@ -5,6 +5,7 @@
 
 /* include vfl headers. */
 #include <vfl/util/chol.h>
+#include <vfl/util/thread.h>
 #include <vfl/factor.h>
 
 /* Model_Check(): macro to check if a PyObject is a Model.
@@ -16,6 +17,11 @@
  */
 #define Model_CheckExact(v) (Py_TYPE(v) == &Model_Type)
 
+/* MODEL_CACHE_BUDGET: default memory budget of the excess moment
+ * cache of a model, in bytes.
+ */
+#define MODEL_CACHE_BUDGET 268435456
+
 /* Model_Type: globally available model type structure.
  */
 PyAPI_DATA(PyTypeObject) Model_Type;
@@ -61,6 +67,23 @@ typedef double (*model_bound_fn) (const Model *mdl);
 typedef int (*model_predict_fn) (const Model *mdl, const Vector *x,
                                  size_t p, double *mean, double *var);
 
+/* model_predict_moments_fn(): return the predicted mean and variance
+ * of the model from the posterior mean and variance of its latent
+ * function (i.e. the inner product of the weights and the basis) at
+ * an observation input vector. models that provide this function
+ * are predicted in batches.
+ *
+ * arguments:
+ *  @mdl: model structure pointer.
+ *  @mu: posterior mean of the latent function.
+ *  @eta: posterior variance of the latent function.
+ *  @mean: pointer to the predicted mean.
+ *  @var: pointer to the predicted variance.
+ */
+typedef void (*model_predict_moments_fn) (const Model *mdl,
+                                          double mu, double eta,
+                                          double *mean, double *var);
+
 /* model_infer_fn(): update the posterior nuisance parameters of a model.
  *
  * arguments:
@@ -84,9 +107,42 @@ typedef int (*model_infer_fn) (Model *mdl);
  */
 typedef int (*model_update_fn) (Model *mdl, size_t j);
 
+/* model_observe_fn(): update the posterior nuisance parameters of a
+ * model to include a single observation that was newly added into its
+ * associated dataset, using low-rank updates to the inverse covariance
+ * matrix and its cholesky factors. the remaining posterior parameters
+ * must be current with respect to the other observations.
+ *
+ * arguments:
+ *  @mdl: model structure pointer.
+ *  @i: dataset index of the new observation.
+ *
+ * returns:
+ *  integer indicating inference success (1) or failure (0).
+ */
+typedef int (*model_observe_fn) (Model *mdl, size_t i);
+
+/* model_step_fn(): take a stochastic natural-gradient step on the
+ * posterior nuisance parameters of a model, using a minibatch of
+ * observations that is temporarily held as its associated dataset.
+ * the minibatch statistics are scaled into unbiased estimates over
+ * the complete dataset, and blended into the current posterior.
+ *
+ * arguments:
+ *  @mdl: model structure pointer.
+ *  @N: number of observations in the complete dataset.
+ *  @rho: step length, in (0, 1].
+ *
+ * returns:
+ *  integer indicating success (1) or failure (0).
+ */
+typedef int (*model_step_fn) (Model *mdl, size_t N, double rho);
+
 /* model_gradient_fn(): return the gradient of the variational lower bound
  * with respect to the parameters of a single factor, taken against a
- * single observation in the model-associated dataset.
+ * single observation in the model-associated dataset. gradient
+ * functions may be called concurrently from multiple threads, and
+ * must not modify the model.
  *
  * arguments:
  *  @mdl: model structure pointer.
@@ -100,8 +156,10 @@ typedef int (*model_update_fn) (Model *mdl, size_t j);
 typedef int (*model_gradient_fn) (const Model *mdl, size_t i, size_t j,
                                   Vector *grad);
 
-/* model_meanfield_fn(): perform an assumed-density mean-field update
- * of a single factor in a variational feature learning model.
+/* model_meanfield_fn(): compute the coefficients of an assumed-density
+ * mean-field update of a single factor in a variational feature learning
+ * model. mean-field functions may be called concurrently from multiple
+ * threads, and must not modify the model.
  *
  * arguments:
  *  @mdl: model structure pointer.
@@ -135,6 +193,13 @@ double name ## _bound (const Model *mdl)
 int name ## _predict (const Model *mdl, const Vector *x, \
                       size_t p, double *mean, double *var)
 
+/* MODEL_PREDICT_MOMENTS(): macro function for declaring and defining
+ * functions conforming to model_predict_moments_fn().
+ */
+#define MODEL_PREDICT_MOMENTS(name) \
+void name ## _predict_moments (const Model *mdl, double mu, double eta, \
+                               double *mean, double *var)
+
 /* MODEL_INFER(): macro function for declaring and defining
  * functions conforming to model_infer_fn().
  */
@@ -147,6 +212,18 @@ int name ## _infer (Model *mdl)
 #define MODEL_UPDATE(name) \
 int name ## _update (Model *mdl, size_t j)
 
+/* MODEL_OBSERVE(): macro function for declaring and defining
+ * functions conforming to model_observe_fn().
+ */
+#define MODEL_OBSERVE(name) \
+int name ## _observe (Model *mdl, size_t i)
+
+/* MODEL_STEP(): macro function for declaring and defining
+ * functions conforming to model_step_fn().
+ */
+#define MODEL_STEP(name) \
+int name ## _step (Model *mdl, size_t N, double rho)
+
 /* MODEL_GRADIENT(): macro function for declaring and defining
  * functions conforming to model_gradient_fn().
  */
@@ -171,16 +248,22 @@ struct model {
    *  @init: initialization.
    *  @bound: variational lower bound.
    *  @predict: predictive mean and variance.
+   *  @predict_moments: predictions from latent moments.
    *  @infer: complete posterior nuisance inference.
    *  @update: partial posterior nuisance inference.
+   *  @observe: single-observation posterior nuisance inference.
+   *  @step: stochastic posterior nuisance inference.
    *  @gradient: lower bound gradient computation.
    *  @meanfield: assumed-density mean-field computation.
    */
   model_init_fn init;
   model_bound_fn bound;
   model_predict_fn predict;
+  model_predict_moments_fn predict_moments;
   model_infer_fn infer;
   model_update_fn update;
+  model_observe_fn observe;
+  model_step_fn step;
   model_gradient_fn gradient;
   model_meanfield_fn meanfield;
 
@@ -231,6 +314,43 @@ struct model {
   Matrix *L;
   Vector *h;
 
+  /* batched moment buffers:
+   *  @Phi: first moments of each basis element (rows) at each
+   *        observation (columns) of the associated dataset.
+   *  @Psi: precision-weighted copy of the first moments.
+   *  @hc: projection coefficients of each observation.
+   *  @Gc: precision coefficients of each observation.
+   *  @vc: second moments of a pair of basis elements at each
+   *       observation.
+   */
+  Matrix *Phi, *Psi;
+  Vector *hc, *Gc, *vc;
+
+  /* moment cache, keyed by factor and dataset versions:
+   *  @mver: factor versions of the first moments in @Phi (0 = stale).
+   *  @mdat: dataset of the first moments in @Phi.
+   *  @mdver: dataset version of the first moments in @Phi.
+   *  @Omega: array of per-factor blocks holding the excess of the
+   *          second moments over the products of first moments of
+   *          each pair of basis elements (rows) at each observation
+   *          (columns), or null for uncached blocks.
+   *  @over: first moment versions of each block in @Omega.
+   *  @oused: pass index of the last use of each block in @Omega.
+   *  @opass: current pass index over the blocks in @Omega.
+   *  @budget: memory budget of the blocks in @Omega, in bytes.
+   */
+  size_t *mver;
+  const Data *mdat;
+  size_t mdver;
+  Matrix **Omega;
+  size_t *over, *oused, opass, budget;
+
+  /* @stol: tolerance below which the moments of factors having compact
+   *        support are treated as zero, or zero to evaluate every
+   *        factor at every observation.
+   */
+  double stol;
+
   /* variational heart of the model:
    *  @factors: array of variational features/factors to be inferred.
    *  @priors: array of feature priors to use during inference.
@@ -242,12 +362,114 @@ struct model {
    */
   Data *dat;
 
+  /* inference state:
+   *  @iver: version of the dataset for which the weight posterior was
+   *         last completely inferred or observed, or zero if the
+   *         posterior has since been modified.
+   *  @ifver: latest factor version at that time.
+   */
+  size_t iver, ifver;
+
   /* @tmp: temporary vector used to store transient intermediates
    *       during bound, inference and gradient calculations.
    */
   Vector *tmp;
+
+  /* memory-mapped storage:
+   *  @map: private file mapping holding the weight posterior and
+   *        intermediates of a model read from a binary file, or null
+   *        if the arrays were allocated on the heap.
+   *  @maplen: size of the file mapping, in bytes.
+   */
+  void *map;
+  size_t maplen;
+
+  /* @arrays: number of python arrays viewing the weight means and
+   *          covariances, which may not be reallocated while any
+   *          are alive.
+   */
+  size_t arrays;
+
+  /* computation state:
+   *  @busy: number of computations using the model without the
+   *         interpreter lock, during which it may not be modified.
+   *  @excl: whether the running computation modifies the model, in
+   *         which case no other computation may use it.
+   */
+  size_t busy;
+  int excl;
 };
 
+/* model_jit_cov_fn(): evaluate the covariance of a model function at
+ * two input locations, using compiled kernel code.
+ *
+ * arguments:
+ *  @par: kernel parameters, laid out as by model_kernel().
+ *  @nu: model weight precision.
+ *  @tau: model noise precision.
+ *  @x1: first input location.
+ *  @x2: second input location.
+ *  @p1: first function output index.
+ *  @p2: second function output index.
+ *  @D: input dimensionality.
+ *
+ * returns:
+ *  covariance of the model function, as by model_cov().
+ */
+typedef double (*model_jit_cov_fn) (const double *par,
+                                    double nu, double tau,
+                                    const double *x1, const double *x2,
+                                    size_t p1, size_t p2, size_t D);
+
+/* model_jit_rows_fn(): evaluate the covariances of a model function
+ * between an array of input locations and a single input location,
+ * using compiled kernel code.
+ *
+ * arguments:
+ *  @par: kernel parameters, laid out as by model_kernel().
+ *  @nu: model weight precision.
+ *  @tau: model noise precision.
+ *  @X1: array of first input locations, one per @D elements.
+ *  @P1: array of first function output indices.
+ *  @x2: second input location.
+ *  @p2: second function output index.
+ *  @n: number of first input locations.
+ *  @D: input dimensionality.
+ *  @c: output array of covariances.
+ *  @inc: stride between elements of @c.
+ */
+typedef void (*model_jit_rows_fn) (const double *par,
+                                   double nu, double tau,
+                                   const double *X1, const size_t *P1,
+                                   const double *x2, size_t p2,
+                                   size_t n, size_t D,
+                                   double *c, size_t inc);
+
+/* ModelJit: structure for holding the compiled covariance kernel of a
+ * model, along with the model state that it is evaluated against.
+ */
+typedef struct {
+  /* compiled functions, or null if the kernel is unavailable:
+   *  @cov: single covariance function.
+   *  @rows: multiple covariance function.
+   */
+  model_jit_cov_fn cov;
+  model_jit_rows_fn rows;
+
+  /* model state:
+   *  @mdl: model used to build the kernel.
+   *  @par: kernel parameters, laid out as by model_kernel().
+   *  @nu: weight precision.
+   *  @tau: noise precision.
+   *  @D: input dimensionality.
+   */
+  const Model *mdl;
+  double *par;
+  double nu, tau;
+  size_t D;
+}
+ModelJit;
+
 /* function declarations (model-core.c): */
 
 void Model_reset (Model *mdl);
@@ -268,6 +490,12 @@ int model_add_factor (Model *mdl, Factor *f);
 
 int model_clear_factors (Model *mdl);
 
+Model *model_copy (const Model *mdl);
+
+int model_hold (Model *mdl, int excl);
+
+void model_release (Model *mdl);
+
 double model_mean (const Model *mdl, const Vector *x,
                    size_t p, size_t j, size_t k);
 
@@ -290,23 +518,86 @@ int model_eval_all (const Model *mdl, Data *dat);
 
 int model_predict_all (const Model *mdl, Data *mean, Data *var);
 
+int model_predict_array (const Model *mdl, const Matrix *X, size_t p,
+                         double *mean, double *var);
+
 int model_reset (Model *mdl);
 
 int model_infer (Model *mdl);
 
 int model_update (Model *mdl, size_t j);
 
+int model_observe (Model *mdl, const Datum *d);
+
+int model_step (Model *mdl, size_t N, double rho);
+
 int model_gradient (const Model *mdl, size_t i, size_t j, Vector *grad);
 
+int model_gradient_all (const Model *mdl, size_t j, Vector *grad);
+
 int model_meanfield (const Model *mdl, size_t j);
 
+/* function declarations, input/output (model-fileio.c): */
+
+int model_pack (const Model *mdl, Pack *pk);
+
+Model *model_unpack (Pack *pk, int share);
+
+int model_fwrite (const Model *mdl, const char *fname);
+
+Model *model_fread (const char *fname);
+
+void model_unmap (Model *mdl);
+
+/* function declarations, compiled kernels (model-jit.c): */
+
+int model_jit_init (ModelJit *jit, const Model *mdl);
+
+void model_jit_free (ModelJit *jit);
+
+double model_jit_cov (const ModelJit *jit,
+                      const double *x1, const double *x2,
+                      size_t p1, size_t p2);
+
+void model_jit_rows (const ModelJit *jit,
+                     const double *X1, const size_t *P1,
+                     const double *x2, size_t p2,
+                     size_t n, double *c, size_t inc);
+
 /* global, yet internally used function declarations (model-core.c): */
 
 size_t model_weight_idx (const Model *mdl, size_t j, size_t k);
 
+int model_moments (Model *mdl);
+
+int model_moments_fresh (const Model *mdl, size_t j);
+
+int model_excess (Model *mdl);
+
+const double *model_excess_row (const Model *mdl, size_t j,
+                                 size_t k1, size_t k2, Vector *v);
+
+void model_set_budget (Model *mdl, size_t bytes);
+
+int model_set_support_tol (Model *mdl, double tol);
+
+int model_support (const Model *mdl, size_t j, size_t **idx, size_t *n);
+
+int model_gram (Model *mdl, const Vector *c, const Vector *w);
+
+int model_gram_update (Model *mdl, size_t j,
+                       const Vector *c, const Vector *w);
+
+void model_weight_prior (Model *mdl);
+
+int model_gram_step (Model *mdl, const Vector *c, const Vector *w,
+                     double scale, double rho);
+
 void model_weight_adjust_init (const Model *mdl, size_t j);
 
 int model_weight_adjust (Model *mdl, size_t j);
 
+int model_weight_observe (Model *mdl, size_t i, double c, double g);
+
 #endif /* !__VFL_MODEL_H__ */
 
@@ -5,6 +5,7 @@
 
 /* include vfl headers. */
 #include <vfl/util/eigen.h>
+#include <vfl/util/stream.h>
 #include <vfl/model.h>
 
 /* Optim_Check(): macro to check if a PyObject is an Optim.
@@ -23,6 +24,72 @@ PyAPI_DATA(PyTypeObject) Optim_Type;
 /* Optim: defined type for the optimizer structure. */
 typedef struct optim Optim;
 
+/* OPTIM_NO_FACTOR: factor index of optimizer phases that do not
+ * involve a single factor.
+ */
+#define OPTIM_NO_FACTOR ((size_t) -1)
+
+/* OptimPhase: enumeration of the instrumented phases of optimization.
+ *  @OPTIM_PHASE_INFER: complete inference of the weights.
+ *  @OPTIM_PHASE_GRADIENT: accumulation of parameter gradients.
+ *  @OPTIM_PHASE_SOLVE: cholesky solution for natural gradients.
+ *  @OPTIM_PHASE_EIGEN: minimum eigenvalue estimation for step lengths.
+ *  @OPTIM_PHASE_UPDATE: weight updates after parameter changes.
+ *  @OPTIM_PHASE_BOUND: evaluation of the lower bound.
+ *  @OPTIM_PHASE_MEANFIELD: mean-field factor updates.
+ *  @OPTIM_PHASE_STEP: stochastic steps on the noise parameters.
+ *  @OPTIM_PHASES: number of phases.
+ */
+typedef enum {
+  OPTIM_PHASE_INFER,
+  OPTIM_PHASE_GRADIENT,
+  OPTIM_PHASE_SOLVE,
+  OPTIM_PHASE_EIGEN,
+  OPTIM_PHASE_UPDATE,
+  OPTIM_PHASE_BOUND,
+  OPTIM_PHASE_MEANFIELD,
+  OPTIM_PHASE_STEP,
+  OPTIM_PHASES
+}
+OptimPhase;
+
+/* OptimFactorStats: structure for holding the accumulated timers and
+ * counters of the updates made to a single model factor.
+ */
+typedef struct {
+  /* @updates: number of factor updates.
+   * @trials: number of proposed parameter vectors.
+   * @accepted: number of accepted parameter vectors.
+   * @unchanged: number of updates that left the parameters unchanged.
+   * @time: wall time spent updating the factor, in seconds.
+   */
+  size_t updates, trials, accepted, unchanged;
+  double time;
+}
+OptimFactorStats;
+
+/* OptimStats: structure for holding the accumulated timers and
+ * counters of an optimizer.
+ */
+typedef struct {
+  /* @iters: number of iterations.
+   * @time: wall time spent iterating, in seconds.
+   * @calls: number of entries into each phase.
+   * @times: wall time spent within each phase, in seconds.
+   */
+  size_t iters;
+  double time;
+  size_t calls[OPTIM_PHASES];
+  double times[OPTIM_PHASES];
+
+  /* @M: number of factors with statistics.
+   * @factors: array of per-factor statistics.
+   */
+  size_t M;
+  OptimFactorStats *factors;
+}
+OptimStats;
+
 /* optim_init_fn(): initialize an optimization structure
  * in a type-specific manner.
  *
@@ -45,6 +112,18 @@ typedef int (*optim_init_fn) (Optim *opt);
  */
 typedef int (*optim_iterate_fn) (Optim *opt);
 
+/* optim_prepare_fn(): prepare a model for association with an
+ * optimizer, in place of the default complete inference.
+ *
+ * arguments:
+ *  @opt: optimizer structure pointer.
+ *  @mdl: model structure pointer to prepare.
+ *
+ * returns:
+ *  integer indicating preparation success (1) or failure (0).
+ */
+typedef int (*optim_prepare_fn) (Optim *opt, Model *mdl);
+
 /* optim_free_fn(): free any extra (e.g. aliased) memory that is
  * associated with an optimizer.
  *
@@ -53,6 +132,15 @@ typedef int (*optim_iterate_fn) (Optim *opt);
  */
 typedef void (*optim_free_fn) (Optim *opt);
 
+/* optim_copy_fn(): copy the type-specific control parameters of an
+ * optimizer into a replica of the same type.
+ *
+ * arguments:
+ *  @dest: optimizer structure pointer to modify.
+ *  @src: optimizer structure pointer to copy from.
+ */
+typedef void (*optim_copy_fn) (Optim *dest, const Optim *src);
+
 /* OPTIM_INIT(): macro function for declaring and defining
  * functions conforming to optim_init_fn().
  */
@@ -71,12 +159,24 @@ int name ## _iterate (Optim *opt)
 #define OPTIM_EXECUTE(name) \
 int name ## _execute (Optim *opt)
 
+/* OPTIM_PREPARE(): macro function for declaring and defining
+ * functions conforming to optim_prepare_fn().
+ */
+#define OPTIM_PREPARE(name) \
+int name ## _prepare (Optim *opt, Model *mdl)
+
 /* OPTIM_FREE(): macro function for declaring and defining
  * functions conforming to optim_free_fn().
  */
 #define OPTIM_FREE(name) \
 void name ## _free (Optim *opt)
 
+/* OPTIM_COPY(): macro function for declaring and defining
+ * functions conforming to optim_copy_fn().
+ */
+#define OPTIM_COPY(name) \
+void name ## _copy (Optim *dest, const Optim *src)
+
 /* struct optim: structure for holding an optimizer, used to
  * learn the variational parameters of a model.
  */
@@ -88,16 +188,25 @@ struct optim {
    *  @init: hook for initialization.
    *  @iterate: hook for iterating on the lower bound.
    *  @execute: hook for running free-run optimization.
+   *  @prepare: hook for preparing newly associated models.
    *  @free: hook for freeing extra allocated memory.
+   *  @copy: hook for copying control parameters into replicas.
    */
   optim_init_fn init;
   optim_iterate_fn iterate;
   optim_iterate_fn execute;
+  optim_prepare_fn prepare;
   optim_free_fn free;
+  optim_copy_fn copy;
 
   /* @mdl: associated variational feature model. */
   Model *mdl;
 
+  /* @busy: number of computations running the optimizer without the
+   *        interpreter lock, during which it may not be modified.
+   */
+  size_t busy;
+
   /* proximal gradient step and endpoints:
    *  @xa: initial point, gamma = 0.
    *  @xb: final point, gamma --> inf.
@@ -121,11 +230,24 @@ struct optim {
   /* logging control variables:
    *  @log_iters: frequency of log outputs, in iterations.
    *  @log_parms: whether or not to log factor parameters.
-   *  @log_fh: file handle of the optimizer log.
+   *  @log: buffered stream of the optimizer log.
    */
   size_t log_iters;
   int log_parms;
-  FILE *log_fh;
+  Stream *log;
+
+  /* instrumentation variables:
+   *  @timing: whether or not phases are timed.
+   *  @stats: accumulated timers and counters.
+   *  @trace: buffered stream of trace events, or null.
+   *  @trace_t0: clock value at the start of the trace.
+   *  @trace_n: number of events written to the trace.
+   */
+  int timing;
+  OptimStats stats;
+  Stream *trace;
+  double trace_t0;
+  size_t trace_n;
 
   /* temporary structures:
    *  @Fs: spectrally-shifted fisher information matrix.
@@ -153,9 +275,29 @@ int optim_set_log_parms (Optim *opt, int b);
 
 int optim_set_log_file (Optim *opt, const char *fname);
 
+int optim_set_timing (Optim *opt, int b);
+
+int optim_set_trace_file (Optim *opt, const char *fname);
+
+void optim_reset_stats (Optim *opt);
+
+const char *optim_phase_name (OptimPhase ph);
+
+double optim_clock (const Optim *opt);
+
+void optim_phase (Optim *opt, OptimPhase ph, size_t j, double t0);
+
+void optim_trial (Optim *opt, size_t j, int valid);
+
+void optim_factor (Optim *opt, size_t j, int valid, double t0);
+
 int optim_iterate (Optim *opt);
 
 int optim_execute (Optim *opt);
 
+Optim *optim_replica (const Optim *opt);
+
+void optim_multistart (Optim **opts, size_t R);
+
 #endif /* !__VFL_OPTIM_H__ */
 
@@ -23,6 +23,17 @@
  */
 PyAPI_DATA(PyTypeObject) Search_Type;
 
+/* SearchSpace: enumeration of the spaces in which posterior
+ * variances may be computed by a search.
+ *  @SEARCH_FUNCTION: gaussian process covariances over observations.
+ *  @SEARCH_WEIGHT: factor moments against the weight posterior.
+ */
+typedef enum {
+  SEARCH_FUNCTION,
+  SEARCH_WEIGHT
+}
+SearchSpace;
+
 /* Search: structure for holding the state of a variance search.
  */
 typedef struct {
@@ -38,6 +49,10 @@ typedef struct {
   Model *mdl;
   Data *dat;
 
+  /* @space: variance computation space.
+   */
+  SearchSpace space;
+
   /* current buffer states:
    *  @D: dimension count.
    *  @P: parameter count.
@@ -59,7 +74,8 @@ typedef struct {
   size_t sz_par, sz_var, sz_xgrid, sz_xmax, sz_xdat, sz_cblk, sz_C, sz_pdat;
   size_t wgsize;
 
-  /* opencl core variables:
+  /* opencl core variables, of which the device, context and queue
+   * are retained for the lifetime of the search:
    *  @plat: compute platform identifier.
    *  @dev: compute device identifier.
    *  @ctx: compute context.
@@ -86,18 +102,39 @@ typedef struct {
    *  @xdat: data input location matrix.
    *  @pdat: data output index vector.
    *  @C: inverse covariance matrix.
-   *  @cov: double-precision covariance matrix.
    *  @vmax: current maximum variance.
    */
 #ifdef __VFL_USE_OPENCL
   cl_double *par, *var, *xgrid, *xmax, *xdat, *C;
   cl_uint *pdat;
 #else
-  Vector *cs;
+  double *var, *xgrid, *xmax;
 #endif
-  Matrix *cov;
   float vmax;
 
+  /* cached covariance factorization, which is extended when only new
+   * observations have been added since the previous search:
+   *  @cov: cholesky factor of the covariance matrix of the cached
+   *        observations, with storage for @cap observations.
+   *  @xc: cached observation locations, in factor order.
+   *  @pc: cached observation output indices, in factor order.
+   *  @key: model state used to compute the factor.
+   *  @nkey: length of the model state array.
+   *  @nc: number of cached observations.
+   *  @cap: capacity of the cache.
+   *  @nbuild: number of times the factor has been rebuilt.
+   *  @jitter: noise variance added to the factor diagonal, which is
+   *           estimated when the factor is rebuilt.
+   *  @jit: compiled covariance kernel of the model.
+   */
+  Matrix *cov;
+  double *xc;
+  size_t *pc;
+  double *key;
+  size_t nkey, nc, cap, nbuild;
+  double jitter;
+  ModelJit jit;
+
   /* opencl device memory addresses:
    *
    *  inputs:
@@ -134,6 +171,8 @@ int search_set_grid (Search *S, Matrix *grid);
 
 int search_set_outputs (Search *S, size_t num);
 
+int search_set_space (Search *S, SearchSpace space);
+
 int search_execute (Search *S, Vector *x);
 
 #endif /* !__VFL_SEARCH_H__ */
@@ -7,17 +7,28 @@
 #include <vfl/util/matrix.h>
 #include <vfl/util/vector.h>
 
-/* determine whether or not atlas is used. */
-#ifdef __VFL_USE_ATLAS
-/* include the atlas blas header. */
+/* atlas provides a cblas interface, in addition to its own lapack. */
+#if defined(__VFL_USE_ATLAS) && !defined(__VFL_USE_CBLAS)
+#define __VFL_USE_CBLAS
+#endif
+
+/* determine whether or not an external cblas is used. */
+#ifdef __VFL_USE_CBLAS
+/* include the cblas header. */
 #include <cblas.h>
-#include <clapack.h>
+
+/* include the thread control header of the blis library. */
+#ifdef __VFL_USE_BLIS
+#include <blis.h>
+#endif
 #else
 /* define values for cblas enumerations. */
 #define CblasNoTrans 111
 #define CblasTrans   112
 #define CblasUpper   121
 #define CblasLower   122
+#define CblasLeft    141
+#define CblasRight   142
 #endif
 
 /* BlasTranspose: enumeration of all possible ways to transpose
@@ -38,6 +49,15 @@ typedef enum {
 }
 BlasTriangle;
 
+/* BlasSide: enumeration of the sides on which a triangular matrix
+ * may act in a solve.
+ */
+typedef enum {
+  BLAS_LEFT  = CblasLeft,
+  BLAS_RIGHT = CblasRight
+}
+BlasSide;
+
 /* function declarations (util/blas.c): */
 
 double blas_dasum (const Vector *x);
@@ -60,5 +80,25 @@ void blas_dtrmv (BlasTranspose trans, const Matrix *L,
 
 void blas_dtrsv (BlasTriangle tri, const Matrix *L, Vector *x);
 
+/* --- */
+
+void blas_dgemm (BlasTranspose transA, BlasTranspose transB,
+                 double alpha, const Matrix *A, const Matrix *B,
+                 double beta, Matrix *C);
+
+void blas_dsyrk (BlasTriangle tri, BlasTranspose trans, double alpha,
+                 const Matrix *A, double beta, Matrix *C);
+
+void blas_dtrsm (BlasSide side, BlasTriangle tri, BlasTranspose trans,
+                 double alpha, const Matrix *T, Matrix *B);
+
+/* --- */
+
+const char *blas_backend (void);
+
+size_t blas_get_threads (void);
+
+int blas_set_threads (size_t count);
+
 #endif /* !__VFL_BLAS_H__ */
 
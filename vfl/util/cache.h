@@ -0,0 +1,24 @@
+
+/* ensure once-only inclusion. */
+#ifndef __VFL_CACHE_H__
+#define __VFL_CACHE_H__
+
+/* include c library headers. */
+#include <stdint.h>
+
+/* CACHE_PATH: maximum length of cache directory and file names.
+ */
+#define CACHE_PATH 4096
+
+/* CACHE_HASH_INIT: initial value of cache file name hashes.
+ */
+#define CACHE_HASH_INIT 0xcbf29ce484222325ULL
+
+/* function declarations (util/cache.c): */
+
+int cache_dir (char *dir);
+
+uint64_t cache_hash (uint64_t h, const char *str);
+
+#endif /* !__VFL_CACHE_H__ */
+
@@ -6,6 +6,26 @@
 /* include the blas header. */
 #include <vfl/util/blas.h>
 
+/* determine which lapack interface, if any, is used. atlas provides
+ * its own clapack interface, and all other backends are accessed
+ * through the standard lapacke interface.
+ */
+#if defined(__VFL_USE_ATLAS)
+#include <clapack.h>
+#define __VFL_USE_LAPACK
+#define lapack_dpotrf(n, A, lda) \
+  clapack_dpotrf(CblasRowMajor, CblasLower, n, A, lda)
+#define lapack_dpotri(n, A, lda) \
+  clapack_dpotri(CblasRowMajor, CblasLower, n, A, lda)
+#elif defined(__VFL_USE_LAPACKE)
+#include <lapacke.h>
+#define __VFL_USE_LAPACK
+#define lapack_dpotrf(n, A, lda) \
+  LAPACKE_dpotrf(LAPACK_ROW_MAJOR, 'L', n, A, lda)
+#define lapack_dpotri(n, A, lda) \
+  LAPACKE_dpotri(LAPACK_ROW_MAJOR, 'L', n, A, lda)
+#endif
+
 /* function declarations (util/chol.c): */
 
 int chol_decomp (Matrix *A);
@@ -18,5 +38,9 @@ void chol_update (Matrix *L, Vector *x);
 
 int chol_downdate (Matrix *L, Vector *y);
 
+void chol_update_block (Matrix *L, Matrix *X);
+
+int chol_downdate_block (Matrix *L, Matrix *Y);
+
 #endif /* !__VFL_CHOL_H__ */
 
@@ -0,0 +1,72 @@
+
+/* ensure once-only inclusion. */
+#ifndef __VFL_PACK_H__
+#define __VFL_PACK_H__
+
+/* include c library headers. */
+#include <stdint.h>
+
+/* include vfl headers. */
+#include <vfl/util/matrix.h>
+
+/* PACK_ALIGN: byte alignment of bulk arrays within packed buffers,
+ * measured from the start of the buffer.
+ */
+#define PACK_ALIGN 64
+
+/* Pack: structure for holding a packed byte buffer, which is either
+ * owned and grown while writing, or borrowed while reading.
+ */
+typedef struct {
+  /* @buf: buffer contents.
+   * @len: number of bytes written, or available for reading.
+   * @cap: number of allocated bytes, or zero for borrowed buffers.
+   * @pos: read position within the buffer.
+   */
+  char *buf;
+  size_t len, cap, pos;
+}
+Pack;
+
+/* function declarations (util/pack.c): */
+
+void pack_init (Pack *pk);
+
+void pack_view (Pack *pk, const char *buf, size_t len);
+
+void pack_free (Pack *pk);
+
+int pack_write (Pack *pk, const void *src, size_t n);
+
+int pack_write_align (Pack *pk);
+
+int pack_write_size (Pack *pk, size_t v);
+
+int pack_write_double (Pack *pk, double v);
+
+int pack_write_string (Pack *pk, const char *s);
+
+int pack_write_vector (Pack *pk, const Vector *v);
+
+int pack_write_matrix (Pack *pk, const Matrix *A);
+
+const char *pack_read (Pack *pk, size_t n);
+
+int pack_read_align (Pack *pk);
+
+int pack_read_size (Pack *pk, size_t *v);
+
+int pack_read_double (Pack *pk, double *v);
+
+int pack_read_string (Pack *pk, char *s, size_t n);
+
+int pack_read_vector (Pack *pk, Vector *v);
+
+int pack_read_matrix (Pack *pk, Matrix *A);
+
+int pack_write_type (Pack *pk, const PyObject *obj);
+
+PyTypeObject *pack_read_type (Pack *pk, PyTypeObject *base);
+
+#endif /* !__VFL_PACK_H__ */
+
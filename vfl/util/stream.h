@@ -0,0 +1,56 @@
+
+/* ensure once-only inclusion. */
+#ifndef __VFL_STREAM_H__
+#define __VFL_STREAM_H__
+
+/* include c library headers. */
+#include <stdlib.h>
+#include <stdio.h>
+
+/* include the posix threads header. */
+#include <pthread.h>
+
+/* Stream: structure for holding a buffered output file, whose contents
+ * are written and flushed by a background thread.
+ */
+typedef struct {
+  /* @fh: file handle written by the background thread.
+   * @thread: background writer thread.
+   * @lock: mutex protecting the pending buffer and flags.
+   * @wake: condition signaling pending output or closure.
+   */
+  FILE *fh;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+
+  /* pending output buffer:
+   *  @buf: bytes written since the last hand-off to the writer.
+   *  @len: number of pending bytes.
+   *  @cap: capacity of the pending buffer.
+   */
+  char *buf;
+  size_t len, cap;
+
+  /* state flags:
+   *  @ready: whether the pending bytes should be written.
+   *  @stop: whether the stream is closing.
+   *  @err: whether any write has failed.
+   */
+  int ready, stop, err;
+}
+Stream;
+
+/* function declarations (util/stream.c): */
+
+Stream *stream_open (const char *fname);
+
+int stream_printf (Stream *s, const char *fmt, ...)
+  __attribute__ ((format (printf, 2, 3)));
+
+void stream_flush (Stream *s);
+
+int stream_close (Stream *s);
+
+#endif /* !__VFL_STREAM_H__ */
+
@@ -0,0 +1,37 @@
+
+/* ensure once-only inclusion. */
+#ifndef __VFL_THREAD_H__
+#define __VFL_THREAD_H__
+
+/* include c library headers. */
+#include <stdlib.h>
+
+/* THREAD_GRAIN: default minimum number of observations processed by
+ * each thread in data-parallel operations.
+ */
+#define THREAD_GRAIN 256
+
+/* thread_fn(): function executed by each thread of a parallel task.
+ *
+ * arguments:
+ *  @arg: shared task argument pointer.
+ *  @tid: index of the executing thread, in [0, T).
+ *  @T: number of threads executing the task.
+ */
+typedef void (*thread_fn) (void *arg, size_t tid, size_t T);
+
+/* function declarations (util/thread.c): */
+
+size_t thread_get_count (void);
+
+int thread_set_count (size_t count);
+
+size_t thread_plan (size_t N, size_t grain);
+
+void thread_range (size_t N, size_t tid, size_t T,
+                   size_t *i0, size_t *i1);
+
+void thread_execute (thread_fn fn, void *arg, size_t T);
+
+#endif /* !__VFL_THREAD_H__ */
+
@@ -7,14 +7,17 @@
 #include <Python.h>
 
 /* include vfl inference object headers. */
+#include <vfl/array.h>
 #include <vfl/datum.h>
 #include <vfl/data.h>
 #include <vfl/model.h>
 #include <vfl/optim.h>
 #include <vfl/factor.h>
 #include <vfl/search.h>
+#include <vfl/bench.h>
 
 /* include vfl utility headers. */
+#include <vfl/util/cache.h>
 #include <vfl/util/list.h>
 #include <vfl/util/size_t.h>
 